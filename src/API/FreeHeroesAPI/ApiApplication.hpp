@@ -6,30 +6,18 @@
 
 #pragma once
 
-#include <memory>
-#include <string>
-
-#include "FreeHeroesAPIExport.hpp"
+#include "ApiEngine.hpp"
 
 namespace FreeHeroes {
 
+// Engine with single session.
 class FREEHEROESAPI_EXPORT ApiApplication {
 public:
-    struct MapInfo {
-        int m_version  = 0;
-        int m_width    = 0;
-        int m_height   = 0;
-        int m_depth    = 0;
-        int m_tileSize = 0;
-    };
-    struct RenderWindow {
-        int m_x      = 0;
-        int m_y      = 0;
-        int m_z      = 0;
-        int m_width  = 0;
-        int m_height = 0;
-    };
-    using Bitmap = const uint8_t*;
+    using MapInfo       = ApiMapInfo;
+    using RenderWindow  = ApiRenderWindow;
+    using DirtyRect     = ApiDirtyRect;
+    using DirtyRectList = ApiDirtyRectList;
+    using Bitmap        = ApiBitmap;
 
 public:
     ApiApplication() noexcept;
@@ -47,10 +35,16 @@ public:
 
     void derandomize();
     void setRenderWindow(const RenderWindow& renderWindow) noexcept;
+    void setAnimationTick(int tick) noexcept; // tick < 0 - take animation frame from clock.
     void prepareRender();
 
-    void   paint();
-    Bitmap getRGBA() const noexcept;
+    void paint();
+    // same result as paint(), but when render window only scrolled since last paint, shifts previous result
+    // and paints newly exposed tiles only.
+    void paintRegion();
+
+    const DirtyRectList& getDirtyRects() const noexcept;
+    Bitmap               getRGBA() const noexcept;
 
 private:
     struct Impl;
@@ -59,9 +53,10 @@ private:
 
 class FREEHEROESAPI_EXPORT ApiApplicationNoexcept {
 public:
-    using MapInfo      = ApiApplication::MapInfo;
-    using Bitmap       = ApiApplication::Bitmap;
-    using RenderWindow = ApiApplication::RenderWindow;
+    using MapInfo       = ApiApplication::MapInfo;
+    using Bitmap        = ApiApplication::Bitmap;
+    using RenderWindow  = ApiApplication::RenderWindow;
+    using DirtyRectList = ApiApplication::DirtyRectList;
 
 public:
     ApiApplicationNoexcept() noexcept;
@@ -79,10 +74,14 @@ public:
 
     bool derandomize() noexcept;
     bool setRenderWindow(const RenderWindow& renderWindow) noexcept;
+    bool setAnimationTick(int tick) noexcept;
     bool prepareRender() noexcept;
 
-    bool   paint() noexcept;
-    Bitmap getRGBA() const noexcept;
+    bool paint() noexcept;
+    bool paintRegion() noexcept;
+
+    const DirtyRectList& getDirtyRects() const noexcept;
+    Bitmap               getRGBA() const noexcept;
 
 private:
     struct Impl;
@@ -20,6 +20,24 @@ FHAppHandle toHandle(ApiApplicationNoexcept* app)
     return reinterpret_cast<FHAppHandle>(app);
 }
 
+ApiEngineNoexcept* toEngine(FHEngineHandle engine)
+{
+    return reinterpret_cast<ApiEngineNoexcept*>(engine);
+}
+
+ApiSessionNoexcept* toSession(FHSessionHandle session)
+{
+    return reinterpret_cast<ApiSessionNoexcept*>(session);
+}
+
+void copyDirtyRects(const ApiDirtyRectList& dirtyRects, FHRect* rects, int maxRects, int* rectCount)
+{
+    if (rectCount)
+        *rectCount = static_cast<int>(dirtyRects.size());
+    for (int i = 0; rects && i < maxRects && i < static_cast<int>(dirtyRects.size()); ++i)
+        rects[i] = FHRect{ .x = dirtyRects[i].m_x, .y = dirtyRects[i].m_y, .width = dirtyRects[i].m_width, .height = dirtyRects[i].m_height };
+}
+
 }
 
 FHApiPointers fh_get_api_pointers_v1()
@@ -159,6 +177,223 @@ FHBitmap fh_get_map_paint_result_v1(FHAppHandle app)
     return toApp(app)->getRGBA();
 }
 
+FHResult fh_set_map_animation_tick_v1(FHAppHandle app, int tick)
+{
+    if (!app)
+        return 0;
+    return toApp(app)->setAnimationTick(tick);
+}
+
+FHResult fh_map_paint_region_v1(FHAppHandle app, FHRect* rects, int maxRects, int* rectCount)
+{
+    if (!app)
+        return 0;
+    if (!toApp(app)->paintRegion())
+        return 0;
+
+    copyDirtyRects(toApp(app)->getDirtyRects(), rects, maxRects, rectCount);
+    return 1;
+}
+
+FHEngineApiPointers fh_get_engine_api_pointers_v1()
+{
+    return FHEngineApiPointers{
+        .engine_create                  = &fh_engine_create_v1,
+        .engine_destroy                 = &fh_engine_destroy_v1,
+        .engine_get_last_error          = &fh_engine_get_last_error_v1,
+        .engine_get_last_output         = &fh_engine_get_last_output_v1,
+        .engine_init                    = &fh_engine_init_v1,
+        .engine_reinit                  = &fh_engine_reinit_v1,
+        .engine_convert_lod             = &fh_engine_convert_lod_v1,
+        .session_create                 = &fh_session_create_v1,
+        .session_destroy                = &fh_session_destroy_v1,
+        .session_get_last_error         = &fh_session_get_last_error_v1,
+        .session_get_last_output        = &fh_session_get_last_output_v1,
+        .session_map_load               = &fh_session_map_load_v1,
+        .session_get_map_version        = &fh_session_get_map_version_v1,
+        .session_get_map_width          = &fh_session_get_map_width_v1,
+        .session_get_map_height         = &fh_session_get_map_height_v1,
+        .session_get_map_depth          = &fh_session_get_map_depth_v1,
+        .session_get_map_tile_size      = &fh_session_get_map_tile_size_v1,
+        .session_map_derandomize        = &fh_session_map_derandomize_v1,
+        .session_set_map_render_window  = &fh_session_set_map_render_window_v1,
+        .session_set_map_animation_tick = &fh_session_set_map_animation_tick_v1,
+        .session_map_prepare_render     = &fh_session_map_prepare_render_v1,
+        .session_map_paint              = &fh_session_map_paint_v1,
+        .session_map_paint_region       = &fh_session_map_paint_region_v1,
+        .session_get_map_paint_result   = &fh_session_get_map_paint_result_v1,
+    };
+}
+
+FHEngineHandle fh_engine_create_v1(void)
+{
+    return reinterpret_cast<FHEngineHandle>(new ApiEngineNoexcept);
+}
+
+void fh_engine_destroy_v1(FHEngineHandle engine)
+{
+    return delete toEngine(engine);
+}
+
+FHString fh_engine_get_last_error_v1(FHEngineHandle engine)
+{
+    if (!engine)
+        return nullptr;
+    return toEngine(engine)->getLastError();
+}
+
+FHString fh_engine_get_last_output_v1(FHEngineHandle engine)
+{
+    if (!engine)
+        return nullptr;
+    return toEngine(engine)->getLastOutput();
+}
+
+FHResult fh_engine_init_v1(FHEngineHandle engine, FHString mainResourcePath, FHString userResourcePath)
+{
+    if (!engine)
+        return 0;
+    return toEngine(engine)->init(mainResourcePath, userResourcePath);
+}
+
+FHResult fh_engine_reinit_v1(FHEngineHandle engine)
+{
+    if (!engine)
+        return 0;
+    return toEngine(engine)->reinit();
+}
+
+FHResult fh_engine_convert_lod_v1(FHEngineHandle engine, FHString lodPath)
+{
+    if (!engine)
+        return 0;
+    return toEngine(engine)->convertLoD(lodPath);
+}
+
+FHSessionHandle fh_session_create_v1(FHEngineHandle engine)
+{
+    if (!engine)
+        return nullptr;
+    auto resources = toEngine(engine)->getResources();
+    if (!resources)
+        return nullptr;
+    return reinterpret_cast<FHSessionHandle>(new ApiSessionNoexcept(std::move(resources)));
+}
+
+void fh_session_destroy_v1(FHSessionHandle session)
+{
+    return delete toSession(session);
+}
+
+FHString fh_session_get_last_error_v1(FHSessionHandle session)
+{
+    if (!session)
+        return nullptr;
+    return toSession(session)->getLastError();
+}
+
+FHString fh_session_get_last_output_v1(FHSessionHandle session)
+{
+    if (!session)
+        return nullptr;
+    return toSession(session)->getLastOutput();
+}
+
+FHResult fh_session_map_load_v1(FHSessionHandle session, FHString mapFile)
+{
+    if (!session)
+        return 0;
+    return toSession(session)->loadMap(mapFile);
+}
+
+int fh_session_get_map_version_v1(FHSessionHandle session)
+{
+    if (!session)
+        return 0;
+    return toSession(session)->getMapInfo().m_version;
+}
+
+int fh_session_get_map_width_v1(FHSessionHandle session)
+{
+    if (!session)
+        return 0;
+    return toSession(session)->getMapInfo().m_width;
+}
+
+int fh_session_get_map_height_v1(FHSessionHandle session)
+{
+    if (!session)
+        return 0;
+    return toSession(session)->getMapInfo().m_height;
+}
+
+int fh_session_get_map_depth_v1(FHSessionHandle session)
+{
+    if (!session)
+        return 0;
+    return toSession(session)->getMapInfo().m_depth;
+}
+
+int fh_session_get_map_tile_size_v1(FHSessionHandle session)
+{
+    if (!session)
+        return 0;
+    return toSession(session)->getMapInfo().m_tileSize;
+}
+
+FHResult fh_session_map_derandomize_v1(FHSessionHandle session)
+{
+    if (!session)
+        return 0;
+    return toSession(session)->derandomize();
+}
+
+FHResult fh_session_set_map_render_window_v1(FHSessionHandle session, int x, int y, int z, int width, int height)
+{
+    if (!session)
+        return 0;
+    return toSession(session)->setRenderWindow({ .m_x = x, .m_y = y, .m_z = z, .m_width = width, .m_height = height });
+}
+
+FHResult fh_session_set_map_animation_tick_v1(FHSessionHandle session, int tick)
+{
+    if (!session)
+        return 0;
+    return toSession(session)->setAnimationTick(tick);
+}
+
+FHResult fh_session_map_prepare_render_v1(FHSessionHandle session)
+{
+    if (!session)
+        return 0;
+    return toSession(session)->prepareRender();
+}
+
+FHResult fh_session_map_paint_v1(FHSessionHandle session)
+{
+    if (!session)
+        return 0;
+    return toSession(session)->paint();
+}
+
+FHResult fh_session_map_paint_region_v1(FHSessionHandle session, FHRect* rects, int maxRects, int* rectCount)
+{
+    if (!session)
+        return 0;
+    if (!toSession(session)->paintRegion())
+        return 0;
+
+    copyDirtyRects(toSession(session)->getDirtyRects(), rects, maxRects, rectCount);
+    return 1;
+}
+
+FHBitmap fh_session_get_map_paint_result_v1(FHSessionHandle session)
+{
+    if (!session)
+        return nullptr;
+    return toSession(session)->getRGBA();
+}
+
 void fh_global_create_v1()
 {
     if (g_globalHandle)
@@ -236,6 +471,15 @@ FHBitmap fh_global_get_map_paint_result_v1(void)
     return fh_get_map_paint_result_v1(g_globalHandle);
 }
 
+FHResult fh_global_set_map_animation_tick_v1(int tick)
+{
+    return fh_set_map_animation_tick_v1(g_globalHandle, tick);
+}
+FHResult fh_global_map_paint_region_v1(FHRect* rects, int maxRects, int* rectCount)
+{
+    return fh_map_paint_region_v1(g_globalHandle, rects, maxRects, rectCount);
+}
+
 FHApiPointersGlobal fh_global_get_api_pointers_v1()
 {
     return FHApiPointersGlobal{
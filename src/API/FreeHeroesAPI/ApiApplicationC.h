@@ -34,6 +34,14 @@ typedef void*          FHAppHandle;
 typedef const uint8_t* FHBitmap;
 typedef int            FHResult; // 0 = error, 1 = success
 
+/// Rectangle of paint result, in pixels.
+typedef struct {
+    int x;
+    int y;
+    int width;
+    int height;
+} FHRect;
+
 /// Create FreeHeroes application instance. never fails.
 FREEHEROESAPI_EXPORT FHAppHandle fh_create_v1(void);
 
@@ -90,8 +98,24 @@ FREEHEROESAPI_EXPORT FHResult fh_map_prepare_render_v1(FHAppHandle app);
 FREEHEROESAPI_EXPORT FHResult fh_map_paint_v1(FHAppHandle app);
 
 /// returns NULL if map_paint was not called properly. Otherwise return pointer to array containing width*height*tile_size*tile_size*4 bytes.
+/// Pointer stays the same between paint calls while render window size is not changed, array is not copied on paint.
 FREEHEROESAPI_EXPORT FHBitmap fh_get_map_paint_result_v1(FHAppHandle app);
 
+/**
+ * Methods below are not part of FHApiPointers/FHApiPointersGlobal to keep these structs layout; get them by symbol name.
+ */
+
+/// tick >= 0 - every paint uses the same animation frame 'tick'; tick < 0 - animation frame is taken from clock (default).
+FREEHEROESAPI_EXPORT FHResult fh_set_map_animation_tick_v1(FHAppHandle app, int tick);
+typedef FHResult (*fh_set_map_animation_tick_v1_f)(FHAppHandle, int);
+
+/// Same paint result as map_paint, but if render window was only scrolled since last paint by less than its size,
+/// and animation frame is the same, previous result is shifted and only newly exposed tiles are painted.
+/// Changed areas of paint result are written to rects (up to maxRects); their total number is written to rectCount.
+/// At most 2 rects are produced; rectCount=0 means nothing changed. rects and rectCount can be NULL.
+FREEHEROESAPI_EXPORT FHResult fh_map_paint_region_v1(FHAppHandle app, FHRect* rects, int maxRects, int* rectCount);
+typedef FHResult (*fh_map_paint_region_v1_f)(FHAppHandle, FHRect*, int, int*);
+
 typedef struct {
     FHAppHandle (*create)(void);
     void (*destroy)(FHAppHandle);
@@ -117,6 +141,77 @@ typedef struct {
 FREEHEROESAPI_EXPORT FHApiPointers fh_get_api_pointers_v1(void);
 typedef FHApiPointers (*fh_get_api_pointers_v1_f)(void);
 
+/**
+ * Engine and sessions: resources and game database are loaded once by engine and shared by any number of sessions,
+ * each session holds its own map and paint result. FHAppHandle above is engine with single session.
+ * Threading rules:
+ * engine methods can be called from any thread, calls are serialized;
+ * different sessions can be used from different threads in parallel, one session must not be used from two threads at once;
+ * session keeps engine resources alive: engine reinit or destroy does not affect sessions already created.
+ * Error handling is the same as for FHAppHandle methods.
+ */
+
+typedef void* FHEngineHandle;
+typedef void* FHSessionHandle;
+
+FREEHEROESAPI_EXPORT FHEngineHandle fh_engine_create_v1(void);
+FREEHEROESAPI_EXPORT void           fh_engine_destroy_v1(FHEngineHandle engine);
+FREEHEROESAPI_EXPORT FHString       fh_engine_get_last_error_v1(FHEngineHandle engine);
+FREEHEROESAPI_EXPORT FHString       fh_engine_get_last_output_v1(FHEngineHandle engine);
+FREEHEROESAPI_EXPORT FHResult       fh_engine_init_v1(FHEngineHandle engine, FHString mainResourcePath, FHString userResourcePath);
+FREEHEROESAPI_EXPORT FHResult       fh_engine_reinit_v1(FHEngineHandle engine);
+FREEHEROESAPI_EXPORT FHResult       fh_engine_convert_lod_v1(FHEngineHandle engine, FHString lodPath);
+
+/// returns NULL if engine is NULL or engine_init did not succeed.
+FREEHEROESAPI_EXPORT FHSessionHandle fh_session_create_v1(FHEngineHandle engine);
+FREEHEROESAPI_EXPORT void            fh_session_destroy_v1(FHSessionHandle session);
+FREEHEROESAPI_EXPORT FHString        fh_session_get_last_error_v1(FHSessionHandle session);
+FREEHEROESAPI_EXPORT FHString        fh_session_get_last_output_v1(FHSessionHandle session);
+FREEHEROESAPI_EXPORT FHResult        fh_session_map_load_v1(FHSessionHandle session, FHString mapFile);
+FREEHEROESAPI_EXPORT int             fh_session_get_map_version_v1(FHSessionHandle session);
+FREEHEROESAPI_EXPORT int             fh_session_get_map_width_v1(FHSessionHandle session);
+FREEHEROESAPI_EXPORT int             fh_session_get_map_height_v1(FHSessionHandle session);
+FREEHEROESAPI_EXPORT int             fh_session_get_map_depth_v1(FHSessionHandle session);
+FREEHEROESAPI_EXPORT int             fh_session_get_map_tile_size_v1(FHSessionHandle session);
+FREEHEROESAPI_EXPORT FHResult        fh_session_map_derandomize_v1(FHSessionHandle session);
+FREEHEROESAPI_EXPORT FHResult        fh_session_set_map_render_window_v1(FHSessionHandle session, int x, int y, int z, int width, int height);
+FREEHEROESAPI_EXPORT FHResult        fh_session_set_map_animation_tick_v1(FHSessionHandle session, int tick);
+FREEHEROESAPI_EXPORT FHResult        fh_session_map_prepare_render_v1(FHSessionHandle session);
+FREEHEROESAPI_EXPORT FHResult        fh_session_map_paint_v1(FHSessionHandle session);
+FREEHEROESAPI_EXPORT FHResult        fh_session_map_paint_region_v1(FHSessionHandle session, FHRect* rects, int maxRects, int* rectCount);
+FREEHEROESAPI_EXPORT FHBitmap        fh_session_get_map_paint_result_v1(FHSessionHandle session);
+
+typedef struct {
+    FHEngineHandle (*engine_create)(void);
+    void (*engine_destroy)(FHEngineHandle);
+    FHString (*engine_get_last_error)(FHEngineHandle);
+    FHString (*engine_get_last_output)(FHEngineHandle);
+    FHResult (*engine_init)(FHEngineHandle, FHString, FHString);
+    FHResult (*engine_reinit)(FHEngineHandle);
+    FHResult (*engine_convert_lod)(FHEngineHandle, FHString);
+
+    FHSessionHandle (*session_create)(FHEngineHandle);
+    void (*session_destroy)(FHSessionHandle);
+    FHString (*session_get_last_error)(FHSessionHandle);
+    FHString (*session_get_last_output)(FHSessionHandle);
+    FHResult (*session_map_load)(FHSessionHandle, FHString);
+    int (*session_get_map_version)(FHSessionHandle);
+    int (*session_get_map_width)(FHSessionHandle);
+    int (*session_get_map_height)(FHSessionHandle);
+    int (*session_get_map_depth)(FHSessionHandle);
+    int (*session_get_map_tile_size)(FHSessionHandle);
+    FHResult (*session_map_derandomize)(FHSessionHandle);
+    FHResult (*session_set_map_render_window)(FHSessionHandle, int x, int y, int z, int width, int height);
+    FHResult (*session_set_map_animation_tick)(FHSessionHandle, int);
+    FHResult (*session_map_prepare_render)(FHSessionHandle);
+    FHResult (*session_map_paint)(FHSessionHandle);
+    FHResult (*session_map_paint_region)(FHSessionHandle, FHRect*, int, int*);
+    FHBitmap (*session_get_map_paint_result)(FHSessionHandle);
+} FHEngineApiPointers;
+
+FREEHEROESAPI_EXPORT FHEngineApiPointers fh_get_engine_api_pointers_v1(void);
+typedef FHEngineApiPointers (*fh_get_engine_api_pointers_v1_f)(void);
+
 /**
  * Global counterparts of above methods but without need to pass FHAppHandle everytime.
  */
@@ -141,6 +236,8 @@ FREEHEROESAPI_EXPORT FHResult fh_global_set_map_render_window_v1(int x, int y, i
 FREEHEROESAPI_EXPORT FHResult fh_global_map_prepare_render_v1(void);
 FREEHEROESAPI_EXPORT FHResult fh_global_map_paint_v1(void);
 FREEHEROESAPI_EXPORT FHBitmap fh_global_get_map_paint_result_v1(void);
+FREEHEROESAPI_EXPORT FHResult fh_global_set_map_animation_tick_v1(int tick);
+FREEHEROESAPI_EXPORT FHResult fh_global_map_paint_region_v1(FHRect* rects, int maxRects, int* rectCount);
 
 typedef struct {
     void (*create)(void);
@@ -2,6 +2,8 @@
 #include "ApiApplication.hpp"
 #include "jni.h"
 
+#include <algorithm>
+
 #define APP_PREFIX com_example_freeheroeslwp
 #define DEFAULT_ACTIVITY JniActivity
 #define CONCAT1(prefix, class, function) CONCAT2(prefix, class, function)
@@ -122,6 +124,44 @@ JNI_ACTIVITY_FN(getMapPaintResultV1)(JNIEnv* env, jobject, jlong fhAppHandle, ji
     return byte_array;
 }
 
+// returns null on error; otherwise changed rects of paint result as [x, y, width, height, ...].
+extern "C" JNIEXPORT jintArray JNICALL
+JNI_ACTIVITY_FN(paintRegionV1)(JNIEnv* env, jobject, jlong fhAppHandle)
+{
+    FHRect rects[4];
+    int    rectCount = 0;
+    if (!fh_map_paint_region_v1((FHAppHandle) fhAppHandle, rects, 4, &rectCount))
+        return nullptr;
+
+    rectCount = std::min(rectCount, 4);
+    jint values[4 * 4];
+    for (int i = 0; i < rectCount; ++i) {
+        values[i * 4 + 0] = rects[i].x;
+        values[i * 4 + 1] = rects[i].y;
+        values[i * 4 + 2] = rects[i].width;
+        values[i * 4 + 3] = rects[i].height;
+    }
+    jintArray result = env->NewIntArray(rectCount * 4);
+    env->SetIntArrayRegion(result, 0, rectCount * 4, values);
+    return result;
+}
+
+// direct ByteBuffer over paint result, no copy; valid until render window size changes.
+extern "C" JNIEXPORT jobject JNICALL
+JNI_ACTIVITY_FN(getMapPaintResultDirectV1)(JNIEnv* env, jobject, jlong fhAppHandle, jint visibleArea)
+{
+    FHBitmap bytes = fh_get_map_paint_result_v1((FHAppHandle) fhAppHandle);
+    if (!bytes)
+        return nullptr;
+    return env->NewDirectByteBuffer(const_cast<uint8_t*>(bytes), static_cast<jlong>(visibleArea) * 4);
+}
+
+extern "C" JNIEXPORT jint JNICALL
+JNI_ACTIVITY_FN(setMapAnimationTickV1)(JNIEnv* env, jobject, jlong fhAppHandle, jint tick)
+{
+    return fh_set_map_animation_tick_v1((FHAppHandle) fhAppHandle, (int) tick);
+}
+
 extern "C" JNIEXPORT jint JNICALL
 JNI_ACTIVITY_FN(setMapRenderWindowV1)(JNIEnv* env, jobject, jlong fhAppHandle, jint x, jint y, jint z, jint width, jint height)
 {
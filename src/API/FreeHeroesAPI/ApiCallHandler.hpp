@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+
+#pragma once
+
+#include "MernelPlatform/Profiler.hpp"
+
+#include <string>
+
+namespace FreeHeroes {
+
+// Common part of *Noexcept API classes: turns exceptions into error text, collects object output and profiler data of a call.
+// Profiler data is kept per handler, so objects used from different threads do not mix it.
+struct ApiCallHandler {
+    std::string             m_lastError;
+    std::string             m_lastOutput;
+    Mernel::ProfilerContext m_profileContext;
+
+    void clear() noexcept
+    {
+        m_lastError.clear();
+        m_lastOutput.clear();
+    }
+
+    bool handle(auto& object, const char* scope, auto&& callback)
+    {
+        bool result = true;
+        {
+            Mernel::ProfilerDefaultContextSwitcher switcher(m_profileContext);
+            Mernel::ProfilerScope                  profile(scope);
+            object.clearOutput();
+            m_lastError.clear();
+            try {
+                callback();
+            }
+            catch (std::exception& ex) {
+                m_lastError = ex.what();
+                result      = false;
+            }
+            catch (...) {
+                m_lastError = "non-std exception caught.";
+                result      = false;
+            }
+        }
+        m_lastOutput = object.getLastOutput();
+        object.clearOutput();
+        auto profilerStr = m_profileContext.printToStr();
+        m_profileContext.clearAll();
+        if (result) {
+            m_lastOutput += "Profiler data:\n";
+            m_lastOutput += profilerStr;
+        }
+
+        return result;
+    }
+};
+
+}
@@ -0,0 +1,693 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+
+#include "ApiEngine.hpp"
+#include "ApiCallHandler.hpp"
+
+#include "MernelPlatform/Logger_details.hpp"
+#include "MernelPlatform/Profiler.hpp"
+
+#include "ResourceLibraryFactory.hpp"
+#include "GameDatabaseContainer.hpp"
+#include "RandomGenerator.hpp"
+#include "MapConverter.hpp"
+#include "GraphicsLibrary.hpp"
+
+#include "GameExtract.hpp"
+#include "SpriteMap.hpp"
+#include "ViewSettings.hpp"
+#include "FHMapToSpriteMap.hpp"
+#include "SpriteMapPainterPixmap.hpp"
+#include "Painter.hpp"
+
+#include <cstring>
+#include <mutex>
+#include <string>
+
+namespace FreeHeroes {
+using namespace Mernel;
+
+const uint32_t g_mapAnimationInterval = 160;
+
+namespace {
+// Tiles MapRenderer needs around render window: objects are anchored at bottom-right tile.
+const int g_maxObjectWidth  = 8;
+const int g_maxObjectHeight = 6;
+
+// Logger backend is process-wide; messages go to output of API object current thread is working for.
+thread_local std::string* t_logOutput = nullptr;
+
+// messages from threads without output (database loading jobs, sprite decoders) wait here
+// until API call that started them finishes, see ScopedLogOutput.
+std::mutex  g_detachedLogMutex;
+std::string g_detachedLog;
+
+class LoggerThreadOutput : public AbstractLoggerBackend {
+public:
+    LoggerThreadOutput()
+        : AbstractLoggerBackend(Logger::Info, true, false, true, true)
+    {}
+    void FlushMessageInternal(const std::string& message, int logLevel) const override
+    {
+        if (t_logOutput) {
+            *t_logOutput += message;
+            return;
+        }
+        std::lock_guard<std::mutex> lock(g_detachedLogMutex);
+        g_detachedLog += message;
+    }
+};
+
+// sets LoggerThreadOutput backend while any API object exists.
+class LoggerThreadOutputUser {
+public:
+    LoggerThreadOutputUser()
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (s_users++ == 0)
+            Logger::SetLoggerBackend(std::make_unique<LoggerThreadOutput>());
+    }
+    ~LoggerThreadOutputUser()
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (--s_users == 0)
+            Logger::SetLoggerBackend(nullptr);
+    }
+
+private:
+    static inline std::mutex s_mutex;
+    static inline int        s_users = 0;
+};
+
+// redirects log of current thread to output while in scope; on exit also takes messages of worker threads.
+// When several API calls run concurrently, worker messages go to whichever finishes first.
+class ScopedLogOutput {
+public:
+    ScopedLogOutput(std::string& output)
+        : m_prev(t_logOutput)
+    {
+        t_logOutput = &output;
+    }
+    ~ScopedLogOutput()
+    {
+        {
+            std::lock_guard<std::mutex> lock(g_detachedLogMutex);
+            *t_logOutput += g_detachedLog;
+            g_detachedLog.clear();
+        }
+        t_logOutput = m_prev;
+    }
+
+private:
+    std::string* m_prev;
+};
+
+}
+
+struct ApiEngine::Resources {
+    Mernel::std_path m_appResourcePath;
+    Mernel::std_path m_userResourcePath;
+
+    std::shared_ptr<const Core::IResourceLibrary>       m_resourceLibrary;
+    std::shared_ptr<Core::IRandomGeneratorFactory>      m_randomGeneratorFactory;
+    std::shared_ptr<const Core::IGameDatabaseContainer> m_gameDatabaseContainer;
+    std::shared_ptr<Gui::IGraphicsLibrary>              m_graphicsLibrary;
+};
+
+struct ApiEngine::Impl {
+    LoggerThreadOutputUser m_loggerUser;
+    std::mutex             m_mutex;
+    std::string            m_lastOutput;
+
+    Core::IResourceLibraryFactory::ModOrder m_modOrder = { "sod_res", "hota_res" };
+
+    ResourcesPtr m_resources;
+
+    void load(const Mernel::std_path& appResourcePath, const Mernel::std_path& userResourcePath)
+    {
+        auto resources                = std::make_shared<Resources>();
+        resources->m_appResourcePath  = appResourcePath;
+        resources->m_userResourcePath = userResourcePath;
+
+        // user resources are usually '<appdata>/Resources', keep caches next to them, like CoreApplication does.
+        const Mernel::std_path cacheDir = userResourcePath.empty() ? Mernel::std_path() : userResourcePath.parent_path() / "Cache";
+
+        Core::ResourceLibraryFactory factory(cacheDir.empty() ? cacheDir : cacheDir / "ResourceIndex");
+        {
+            ProfilerScope scope("ResourceLibrary search");
+            factory.scanForMods(appResourcePath);
+            factory.scanForMods(userResourcePath);
+        }
+        {
+            ProfilerScope scope("ResourceLibrary load");
+            factory.scanModSubfolders();
+            resources->m_resourceLibrary = factory.create(m_modOrder);
+        }
+
+        resources->m_randomGeneratorFactory = std::make_shared<Core::RandomGeneratorFactory>();
+
+        {
+            const Mernel::std_path snapshotDir = cacheDir.empty() ? cacheDir : cacheDir / "Database";
+
+            ProfilerScope scope("GameDatabaseContainer load");
+            resources->m_gameDatabaseContainer = std::make_shared<Core::GameDatabaseContainer>(resources->m_resourceLibrary.get(), snapshotDir);
+        }
+        {
+            ProfilerScope scope("GraphicsLibrary");
+            resources->m_graphicsLibrary = std::make_shared<Gui::GraphicsLibrary>(resources->m_resourceLibrary.get());
+        }
+        m_resources = std::move(resources);
+    }
+};
+
+ApiEngine::ApiEngine() noexcept
+    : m_impl(std::make_unique<Impl>())
+{
+}
+
+ApiEngine::~ApiEngine() noexcept = default;
+
+const std::string& ApiEngine::getLastOutput() const noexcept
+{
+    return m_impl->m_lastOutput;
+}
+
+void ApiEngine::clearOutput() noexcept
+{
+    std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+    m_impl->m_lastOutput.clear();
+}
+
+void ApiEngine::init(const std::string& appResourcePath, const std::string& userResourcePath) noexcept(false)
+{
+    std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+    ScopedLogOutput             logOutput(m_impl->m_lastOutput);
+
+    Logger(Logger::Info) << "init - start";
+
+    m_impl->load(string2path(appResourcePath), string2path(userResourcePath));
+
+    Logger(Logger::Info) << "init - end";
+}
+
+void ApiEngine::reinit() noexcept(false)
+{
+    std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+    ScopedLogOutput             logOutput(m_impl->m_lastOutput);
+    if (!m_impl->m_resources)
+        throw std::runtime_error("init() was not called");
+
+    Logger(Logger::Info) << "reinit - start";
+
+    m_impl->load(m_impl->m_resources->m_appResourcePath, m_impl->m_resources->m_userResourcePath);
+
+    Logger(Logger::Info) << "reinit - end";
+}
+
+void ApiEngine::convertLoD(const std::string& lodPath) noexcept(false)
+{
+    std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+    ScopedLogOutput             logOutput(m_impl->m_lastOutput);
+    if (!m_impl->m_resources)
+        throw std::runtime_error("init() was not called");
+
+    const auto& resources = *m_impl->m_resources;
+    const auto  settings  = GameExtract::Settings{
+          .m_appResourcePath    = resources.m_appResourcePath,
+          .m_archiveExtractRoot = resources.m_userResourcePath / "Archives",
+          .m_mainExtractRoot    = resources.m_userResourcePath / "Imported",
+          .m_forceExtract       = false,
+          .m_skipIfFolderExist  = true,
+          .m_needLocalization   = false,
+          .m_onlySections       = { KnownResource::Section::Adventure },
+    };
+
+    GameExtract converter(resources.m_gameDatabaseContainer.get(), settings);
+
+    converter.setMessageCallback([](const std::string& msg, bool) {
+        Mernel::Logger(Mernel::Logger::Info) << msg;
+    });
+    converter.setErrorCallback([](const std::string& msg) {
+        Mernel::Logger(Mernel::Logger::Err) << msg;
+    });
+    converter.setProgressCallback([](int progress, int total) {
+        return false; // return true to cancel operation.
+    });
+    GameExtract::DetectedSources probeInfo;
+    const auto                   filenameLower = Mernel::pathToLower(Mernel::string2path(lodPath).filename());
+    probeInfo.m_hasHota                        = filenameLower == "hota.lod";
+    probeInfo.m_hasSod                         = !probeInfo.m_hasHota;
+
+    probeInfo.m_sources[GameExtract::SourceType::Archive].push_back(GameExtract::DetectedPath{ .m_path = Mernel::string2path(lodPath), .m_isSod = probeInfo.m_hasSod, .m_isHota = probeInfo.m_hasHota });
+    if (probeInfo.isSuccess())
+        converter.run(probeInfo);
+}
+
+ApiEngine::ResourcesPtr ApiEngine::getResources() const noexcept
+{
+    std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+    return m_impl->m_resources;
+}
+
+struct ApiSession::Impl {
+    // tile bounds (inclusive) of map area in m_spriteMap.
+    struct RenderedArea {
+        bool m_valid = false;
+        int  m_z     = 0;
+        int  m_xMin  = 0;
+        int  m_xMax  = 0;
+        int  m_yMin  = 0;
+        int  m_yMax  = 0;
+
+        bool contains(const RenderedArea& area) const
+        {
+            return m_valid && m_z == area.m_z && m_xMin <= area.m_xMin && m_xMax >= area.m_xMax && m_yMin <= area.m_yMin && m_yMax >= area.m_yMax;
+        }
+    };
+
+    LoggerThreadOutputUser  m_loggerUser;
+    ApiEngine::ResourcesPtr m_resources;
+
+    std::string m_lastOutput;
+    ApiMapInfo  m_mapInfo;
+
+    FHMap m_map;
+
+    ScopeTimer      m_timer;
+    SpriteMap       m_spriteMap;
+    RenderedArea    m_renderedArea;
+    ViewSettings    m_viewSettings;
+    ApiRenderWindow m_renderWindow;
+    int             m_animationTick = -1;
+
+    Pixmap           m_frame; // RGBA paint result, getRGBA() returns its pixels.
+    Pixmap           m_strip; // part of m_frame being repainted.
+    bool             m_frameValid = false;
+    ApiRenderWindow  m_frameWindow;
+    uint32_t         m_frameTick = 0;
+    ApiDirtyRectList m_dirtyRects;
+
+    const ApiEngine::Resources& getResources() const
+    {
+        if (!m_resources)
+            throw std::runtime_error("Session is created without initialized engine");
+        return *m_resources;
+    }
+
+    void resetRender()
+    {
+        m_spriteMap    = {};
+        m_renderedArea = {};
+        m_frameValid   = false;
+    }
+
+    uint32_t getAnimationTick() const
+    {
+        if (m_animationTick >= 0)
+            return static_cast<uint32_t>(m_animationTick);
+        return static_cast<uint32_t>(m_timer.elapsedUS() / 1000 / g_mapAnimationInterval);
+    }
+
+    // paints window tiles [x, x + width) x [y, y + height) over transparent background to the same place of m_frame.
+    void paintTiles(uint32_t tick, int x, int y, int width, int height)
+    {
+        const int tileSize = m_mapInfo.m_tileSize;
+        const int mapX     = m_renderWindow.m_x + x;
+        const int mapY     = m_renderWindow.m_y + y;
+
+        const bool whole = width == m_renderWindow.m_width && height == m_renderWindow.m_height;
+        Pixmap&    dest  = whole ? m_frame : m_strip;
+        dest.m_size      = PixmapSize(width * tileSize, height * tileSize);
+        dest.updateSize();
+        dest.fill(PixmapColor());
+
+        SpriteMapPainterPixmap spainter(&(m_viewSettings.m_paintSettings), m_renderWindow.m_z);
+
+        Painter painter(&dest);
+        painter.translate(PixmapPoint(-mapX * tileSize, -mapY * tileSize));
+
+        const SpriteMap::TileWindow window{
+            .m_xMin = mapX,
+            .m_yMin = mapY,
+            .m_xMax = mapX + width - 1,
+            .m_yMax = mapY + height - 1,
+        };
+        spainter.paint(&painter, &m_spriteMap, tick, tick, window);
+
+        if (!whole) {
+            const int frameWidth = m_frame.width();
+            for (int row = 0; row < dest.height(); ++row)
+                std::memcpy(&m_frame.m_pixels[(y * tileSize + row) * frameWidth + x * tileSize], &dest.get(0, row), dest.width() * sizeof(Pixmap::Pixel));
+        }
+
+        m_dirtyRects.push_back(ApiDirtyRect{ .m_x = x * tileSize, .m_y = y * tileSize, .m_width = dest.width(), .m_height = dest.height() });
+    }
+
+    // moves m_frame content by (-dx, -dy) pixels; uncovered pixels are left as is.
+    void shiftFrame(int dx, int dy)
+    {
+        const int width  = m_frame.width();
+        const int height = m_frame.height();
+        const int destX  = std::max(0, -dx);
+        const int count  = width - std::abs(dx);
+
+        Pixmap::Pixel* pixels  = m_frame.m_pixels.data();
+        auto           copyRow = [=](int y) {
+            std::memmove(pixels + y * width + destX, pixels + (y + dy) * width + destX + dx, count * sizeof(Pixmap::Pixel));
+        };
+        if (dy >= 0) {
+            for (int y = 0; y < height - dy; ++y)
+                copyRow(y);
+        } else {
+            for (int y = height - 1; y >= -dy; --y)
+                copyRow(y);
+        }
+        m_frame.resetOpacityRuns();
+    }
+};
+
+ApiSession::ApiSession(ApiEngine::ResourcesPtr resources) noexcept
+    : m_impl(std::make_unique<Impl>())
+{
+    m_impl->m_resources = std::move(resources);
+}
+
+ApiSession::~ApiSession() noexcept = default;
+
+const std::string& ApiSession::getLastOutput() const noexcept
+{
+    return m_impl->m_lastOutput;
+}
+
+void ApiSession::clearOutput() noexcept
+{
+    m_impl->m_lastOutput.clear();
+}
+
+void ApiSession::loadMap(const std::string& mapPath) noexcept(false)
+{
+    ScopedLogOutput logOutput(m_impl->m_lastOutput);
+    const auto&     resources = m_impl->getResources();
+
+    std::ostringstream os;
+    auto               fullpath = Mernel::string2path(mapPath);
+    auto               ext      = fullpath.extension();
+    const bool         isH3M    = Mernel::path2string(ext) == ".h3m";
+
+    MapConverter::Settings sett;
+    if (isH3M)
+        sett.m_inputs = { .m_h3m = { .m_binary = fullpath } };
+    else
+        sett.m_inputs = { .m_fhMap = fullpath };
+
+    try {
+        MapConverter converter(os,
+                               resources.m_gameDatabaseContainer.get(),
+                               resources.m_randomGeneratorFactory.get(),
+                               sett);
+
+        if (isH3M)
+            converter.run(MapConverter::Task::LoadH3M);
+        else
+            converter.run(MapConverter::Task::LoadFH);
+
+        assert(converter.m_mapFH.m_database);
+        m_impl->resetRender();
+        m_impl->m_map                = std::move(converter.m_mapFH);
+        m_impl->m_mapInfo            = { .m_width  = m_impl->m_map.m_tileMap.m_width,
+                                         .m_height = m_impl->m_map.m_tileMap.m_height,
+                                         .m_depth  = m_impl->m_map.m_tileMap.m_depth };
+        m_impl->m_mapInfo.m_tileSize = 32;
+        m_impl->m_mapInfo.m_version  = m_impl->m_map.isSoDMap() ? 1 : (m_impl->m_map.isHotAMap() ? 2 : 0);
+    }
+    catch (std::exception&) {
+        m_impl->m_lastOutput += os.str();
+        throw;
+    }
+}
+
+const ApiMapInfo& ApiSession::getMapInfo() const noexcept
+{
+    m_impl->m_lastOutput.clear();
+    return m_impl->m_mapInfo;
+}
+
+void ApiSession::derandomize()
+{
+    ScopedLogOutput logOutput(m_impl->m_lastOutput);
+
+    auto rng = m_impl->getResources().m_randomGeneratorFactory->create();
+    rng->makeGoodSeed();
+    m_impl->m_map.derandomize(rng.get());
+    m_impl->resetRender();
+}
+
+void ApiSession::setRenderWindow(const ApiRenderWindow& renderWindow) noexcept
+{
+    m_impl->m_lastOutput.clear();
+    m_impl->m_renderWindow = renderWindow;
+}
+
+void ApiSession::setAnimationTick(int tick) noexcept
+{
+    m_impl->m_lastOutput.clear();
+    m_impl->m_animationTick = tick;
+}
+
+void ApiSession::prepareRender()
+{
+    ScopedLogOutput logOutput(m_impl->m_lastOutput);
+
+    const auto&              window = m_impl->m_renderWindow;
+    const Impl::RenderedArea required{
+        .m_valid = true,
+        .m_z     = window.m_z,
+        .m_xMin  = window.m_x - 1,
+        .m_xMax  = window.m_x + window.m_width + g_maxObjectWidth,
+        .m_yMin  = window.m_y - 1,
+        .m_yMax  = window.m_y + window.m_height + g_maxObjectHeight,
+    };
+    if (m_impl->m_renderedArea.contains(required)) {
+        Logger(Logger::Info) << "Render map, window: z=" << required.m_z << ", x=" << required.m_xMin << ".." << required.m_xMax << ", y=" << required.m_yMin << ".." << required.m_yMax << " - already rendered";
+        return;
+    }
+
+    // render one more window size around, so scrolling does not need to render map again.
+    Impl::RenderedArea rendered = required;
+    rendered.m_xMin -= window.m_width;
+    rendered.m_xMax += window.m_width;
+    rendered.m_yMin -= window.m_height;
+    rendered.m_yMax += window.m_height;
+
+    auto& rset             = m_impl->m_viewSettings.m_renderSettings;
+    rset.m_useRenderWindow = true;
+    rset.m_z               = rendered.m_z;
+    rset.m_xMin            = rendered.m_xMin;
+    rset.m_xMax            = rendered.m_xMax;
+    rset.m_yMin            = rendered.m_yMin;
+    rset.m_yMax            = rendered.m_yMax;
+
+    rset.m_showEvents = false; // @todo: configurable?
+    rset.m_showGrail  = false; // @todo: configurable?
+
+    Logger(Logger::Info) << "Render map, window: z=" << rset.m_z << ", x=" << rset.m_xMin << ".." << rset.m_xMax << ", y=" << rset.m_yMin << ".." << rset.m_yMax;
+
+    MapRenderer renderer(rset);
+    assert(m_impl->m_map.m_database);
+    m_impl->m_spriteMap    = renderer.render(m_impl->m_map, m_impl->getResources().m_graphicsLibrary.get());
+    m_impl->m_renderedArea = rendered;
+}
+
+void ApiSession::paint()
+{
+    ScopedLogOutput logOutput(m_impl->m_lastOutput);
+
+    const auto&    window = m_impl->m_renderWindow;
+    const uint32_t tick   = m_impl->getAnimationTick();
+
+    m_impl->m_dirtyRects.clear();
+    m_impl->paintTiles(tick, 0, 0, window.m_width, window.m_height);
+
+    m_impl->m_frameValid  = true;
+    m_impl->m_frameWindow = window;
+    m_impl->m_frameTick   = tick;
+}
+
+void ApiSession::paintRegion()
+{
+    const auto&    window    = m_impl->m_renderWindow;
+    const auto&    prev      = m_impl->m_frameWindow;
+    const uint32_t tick      = m_impl->getAnimationTick();
+    const int      dx        = window.m_x - prev.m_x;
+    const int      dy        = window.m_y - prev.m_y;
+    const bool     canScroll = m_impl->m_frameValid && tick == m_impl->m_frameTick && window.m_z == prev.m_z
+                           && window.m_width == prev.m_width && window.m_height == prev.m_height
+                           && std::abs(dx) < window.m_width && std::abs(dy) < window.m_height;
+    if (!canScroll) {
+        paint();
+        return;
+    }
+
+    ScopedLogOutput logOutput(m_impl->m_lastOutput);
+
+    m_impl->m_dirtyRects.clear();
+    if (dx == 0 && dy == 0)
+        return;
+
+    const int tileSize = m_impl->m_mapInfo.m_tileSize;
+    m_impl->shiftFrame(dx * tileSize, dy * tileSize);
+
+    // exposed rows (whole width), then exposed columns of rows that were kept.
+    const int keptRowBegin = std::max(0, -dy);
+    const int keptRowEnd   = window.m_height - std::max(0, dy);
+    if (dy < 0)
+        m_impl->paintTiles(tick, 0, 0, window.m_width, -dy);
+    if (dy > 0)
+        m_impl->paintTiles(tick, 0, keptRowEnd, window.m_width, dy);
+    if (dx < 0)
+        m_impl->paintTiles(tick, 0, keptRowBegin, -dx, keptRowEnd - keptRowBegin);
+    if (dx > 0)
+        m_impl->paintTiles(tick, window.m_width - dx, keptRowBegin, dx, keptRowEnd - keptRowBegin);
+
+    m_impl->m_frameWindow = window;
+}
+
+const ApiDirtyRectList& ApiSession::getDirtyRects() const noexcept
+{
+    return m_impl->m_dirtyRects;
+}
+
+ApiBitmap ApiSession::getRGBA() const noexcept
+{
+    static_assert(sizeof(Pixmap::Pixel) == 4);
+    return !m_impl->m_frame.isNull() ? reinterpret_cast<ApiBitmap>(m_impl->m_frame.m_pixels.data()) : nullptr;
+}
+
+struct ApiEngineNoexcept::Impl {
+    ApiEngine      m_engine;
+    ApiCallHandler m_handler;
+};
+
+ApiEngineNoexcept::ApiEngineNoexcept() noexcept
+    : m_impl(std::make_unique<Impl>())
+{
+}
+
+ApiEngineNoexcept::~ApiEngineNoexcept() noexcept = default;
+
+const char* ApiEngineNoexcept::getLastError() const noexcept
+{
+    return m_impl->m_handler.m_lastError.c_str();
+}
+
+const char* ApiEngineNoexcept::getLastOutput() const noexcept
+{
+    return m_impl->m_handler.m_lastOutput.c_str();
+}
+
+bool ApiEngineNoexcept::init(const char* appResourcePath, const char* userResourcePath) noexcept
+{
+    return m_impl->m_handler.handle(m_impl->m_engine, "init", [=, this] { m_impl->m_engine.init(appResourcePath, userResourcePath); });
+}
+
+bool ApiEngineNoexcept::reinit() noexcept
+{
+    return m_impl->m_handler.handle(m_impl->m_engine, "reinit", [this] { m_impl->m_engine.reinit(); });
+}
+
+bool ApiEngineNoexcept::convertLoD(const char* lodPath) noexcept
+{
+    return m_impl->m_handler.handle(m_impl->m_engine, "convertLoD", [=, this] { m_impl->m_engine.convertLoD(lodPath); });
+}
+
+ApiEngine::ResourcesPtr ApiEngineNoexcept::getResources() const noexcept
+{
+    return m_impl->m_engine.getResources();
+}
+
+struct ApiSessionNoexcept::Impl {
+    ApiSession     m_session;
+    ApiCallHandler m_handler;
+
+    Impl(ApiEngine::ResourcesPtr resources)
+        : m_session(std::move(resources))
+    {}
+};
+
+ApiSessionNoexcept::ApiSessionNoexcept(ApiEngine::ResourcesPtr resources) noexcept
+    : m_impl(std::make_unique<Impl>(std::move(resources)))
+{
+}
+
+ApiSessionNoexcept::~ApiSessionNoexcept() noexcept = default;
+
+const char* ApiSessionNoexcept::getLastError() const noexcept
+{
+    return m_impl->m_handler.m_lastError.c_str();
+}
+
+const char* ApiSessionNoexcept::getLastOutput() const noexcept
+{
+    return m_impl->m_handler.m_lastOutput.c_str();
+}
+
+bool ApiSessionNoexcept::loadMap(const char* mapPath) noexcept
+{
+    return m_impl->m_handler.handle(m_impl->m_session, "loadMap", [=, this] { m_impl->m_session.loadMap(mapPath); });
+}
+
+const ApiMapInfo& ApiSessionNoexcept::getMapInfo() const noexcept
+{
+    m_impl->m_handler.clear();
+    return m_impl->m_session.getMapInfo();
+}
+
+bool ApiSessionNoexcept::derandomize() noexcept
+{
+    return m_impl->m_handler.handle(m_impl->m_session, "derandomize", [this] { m_impl->m_session.derandomize(); });
+}
+
+bool ApiSessionNoexcept::setRenderWindow(const ApiRenderWindow& renderWindow) noexcept
+{
+    m_impl->m_handler.clear();
+    m_impl->m_session.setRenderWindow(renderWindow);
+    return true;
+}
+
+bool ApiSessionNoexcept::setAnimationTick(int tick) noexcept
+{
+    m_impl->m_handler.clear();
+    m_impl->m_session.setAnimationTick(tick);
+    return true;
+}
+
+bool ApiSessionNoexcept::prepareRender() noexcept
+{
+    return m_impl->m_handler.handle(m_impl->m_session, "prepareRender", [this] { m_impl->m_session.prepareRender(); });
+}
+
+bool ApiSessionNoexcept::paint() noexcept
+{
+    return m_impl->m_handler.handle(m_impl->m_session, "paint", [this] { m_impl->m_session.paint(); });
+}
+
+bool ApiSessionNoexcept::paintRegion() noexcept
+{
+    return m_impl->m_handler.handle(m_impl->m_session, "paintRegion", [this] { m_impl->m_session.paintRegion(); });
+}
+
+const ApiDirtyRectList& ApiSessionNoexcept::getDirtyRects() const noexcept
+{
+    return m_impl->m_session.getDirtyRects();
+}
+
+ApiBitmap ApiSessionNoexcept::getRGBA() const noexcept
+{
+    m_impl->m_handler.clear();
+    return m_impl->m_session.getRGBA();
+}
+
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FreeHeroesAPIExport.hpp"
+
+namespace FreeHeroes {
+
+struct ApiMapInfo {
+    int m_version  = 0;
+    int m_width    = 0;
+    int m_height   = 0;
+    int m_depth    = 0;
+    int m_tileSize = 0;
+};
+struct ApiRenderWindow {
+    int m_x      = 0;
+    int m_y      = 0;
+    int m_z      = 0;
+    int m_width  = 0;
+    int m_height = 0;
+};
+// changed area of paint result, in pixels.
+struct ApiDirtyRect {
+    int m_x      = 0;
+    int m_y      = 0;
+    int m_width  = 0;
+    int m_height = 0;
+};
+using ApiDirtyRectList = std::vector<ApiDirtyRect>;
+using ApiBitmap        = const uint8_t*;
+
+// Resources shared between maps: resource library, game databases and graphics cache.
+// All methods are thread-safe, calls are serialized.
+class FREEHEROESAPI_EXPORT ApiEngine {
+public:
+    struct Resources;
+    using ResourcesPtr = std::shared_ptr<const Resources>;
+
+public:
+    ApiEngine() noexcept;
+    ~ApiEngine() noexcept;
+
+    const std::string& getLastOutput() const noexcept;
+    void               clearOutput() noexcept;
+
+    void init(const std::string& appResourcePath, const std::string& userResourcePath) noexcept(false);
+    void reinit() noexcept(false);
+    void convertLoD(const std::string& lodPath) noexcept(false);
+
+    // null before init(). Sessions keep resources alive, so reinit() and engine destruction do not affect them.
+    ResourcesPtr getResources() const noexcept;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+// Single map with its render state and paint result.
+// Different sessions can be used from different threads in parallel; one session must be used by one thread at a time.
+class FREEHEROESAPI_EXPORT ApiSession {
+public:
+    explicit ApiSession(ApiEngine::ResourcesPtr resources) noexcept;
+    ~ApiSession() noexcept;
+
+    const std::string& getLastOutput() const noexcept;
+    void               clearOutput() noexcept;
+
+    void loadMap(const std::string& mapPath) noexcept(false);
+
+    const ApiMapInfo& getMapInfo() const noexcept;
+
+    void derandomize();
+    void setRenderWindow(const ApiRenderWindow& renderWindow) noexcept;
+    void setAnimationTick(int tick) noexcept; // tick < 0 - take animation frame from clock.
+    void prepareRender();
+
+    void paint();
+    // same result as paint(), but when render window only scrolled since last paint, shifts previous result
+    // and paints newly exposed tiles only.
+    void paintRegion();
+
+    const ApiDirtyRectList& getDirtyRects() const noexcept;
+    ApiBitmap               getRGBA() const noexcept;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+class FREEHEROESAPI_EXPORT ApiEngineNoexcept {
+public:
+    ApiEngineNoexcept() noexcept;
+    ~ApiEngineNoexcept() noexcept;
+
+    const char* getLastError() const noexcept;
+    const char* getLastOutput() const noexcept;
+
+    bool init(const char* appResourcePath, const char* userResourcePath) noexcept;
+    bool reinit() noexcept;
+    bool convertLoD(const char* lodPath) noexcept;
+
+    ApiEngine::ResourcesPtr getResources() const noexcept;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+class FREEHEROESAPI_EXPORT ApiSessionNoexcept {
+public:
+    explicit ApiSessionNoexcept(ApiEngine::ResourcesPtr resources) noexcept;
+    ~ApiSessionNoexcept() noexcept;
+
+    const char* getLastError() const noexcept;
+    const char* getLastOutput() const noexcept;
+
+    bool loadMap(const char* mapPath) noexcept;
+
+    const ApiMapInfo& getMapInfo() const noexcept;
+
+    bool derandomize() noexcept;
+    bool setRenderWindow(const ApiRenderWindow& renderWindow) noexcept;
+    bool setAnimationTick(int tick) noexcept;
+    bool prepareRender() noexcept;
+
+    bool paint() noexcept;
+    bool paintRegion() noexcept;
+
+    const ApiDirtyRectList& getDirtyRects() const noexcept;
+    ApiBitmap               getRGBA() const noexcept;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+}
@@ -12,6 +12,8 @@
 
 #include "ApiApplicationC.h"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <thread>
 
@@ -93,7 +95,7 @@ bool saveBMP(const std::string& path, const uint8_t* rgbapixels, int w, int h)
 int main(int argc, char** argv)
 {
     if (argc < 4) {
-        std::cerr << "Usage: FreeHeroesTest convert|render D:/Games/Heroes3_HotA D:/tmp [plugin/root/]\n";
+        std::cerr << "Usage: FreeHeroesTest convert|render|scroll|parallel D:/Games/Heroes3_HotA D:/tmp [plugin/root/]\n";
         return 1;
     }
 
@@ -228,6 +230,215 @@ int main(int argc, char** argv)
         return 0;
     }
 
+    if (task == "scroll") {
+        // paints the same scroll sequence with map_paint in global app and with map_paint_region in second app, compares results.
+        auto* pointersAddress        = loader.getSymbol("fh_get_api_pointers_v1");
+        auto  paintRegion            = reinterpret_cast<fh_map_paint_region_v1_f>(loader.getSymbol("fh_map_paint_region_v1"));
+        auto  setAnimationTick       = reinterpret_cast<fh_set_map_animation_tick_v1_f>(loader.getSymbol("fh_set_map_animation_tick_v1"));
+        auto  setAnimationTickGlobal = reinterpret_cast<decltype(&fh_global_set_map_animation_tick_v1)>(loader.getSymbol("fh_global_set_map_animation_tick_v1"));
+        if (!pointersAddress || !paintRegion || !setAnimationTick || !setAnimationTickGlobal) {
+            std::cerr << "Failed to find paint region methods\n";
+            return 1;
+        }
+        FHApiPointers apiApp = reinterpret_cast<fh_get_api_pointers_v1_f>(pointersAddress)();
+
+        FHAppHandle regionApp = apiApp.create();
+        MERNEL_SCOPE_EXIT([&] { apiApp.destroy(regionApp); });
+        // quiet counterparts of checkApiCall for calls in a loop.
+        auto checkAppCall = [&apiApp, regionApp](const char* name, FHResult result) -> bool {
+            if (result)
+                return true;
+            std::cerr << "Method app.'" << name << "' failed, error: " << apiApp.get_last_error(regionApp) << ", output: \n"
+                      << apiApp.get_last_output(regionApp) << std::flush;
+            return false;
+        };
+        auto checkGlobalCall = [&api](const char* name, FHResult result) -> bool {
+            if (result)
+                return true;
+            std::cerr << "Method api.'" << name << "' failed, error: " << api.get_last_error() << ", output: \n"
+                      << api.get_last_output() << std::flush;
+            return false;
+        };
+
+        const std::string mapPath = heroesPath + "/Maps/[HotA] Air Supremacy.h3m";
+        if (!checkApiCall("map_load", [&api, mapPath] { return api.map_load(mapPath.c_str()); }))
+            return 1;
+        if (!checkAppCall("init", apiApp.init(regionApp, appPath.c_str(), userPath.c_str())))
+            return 1;
+        if (!checkAppCall("map_load", apiApp.map_load(regionApp, mapPath.c_str())))
+            return 1;
+
+        // no derandomize (it is random) and fixed animation frame, so both apps paint the same.
+        setAnimationTickGlobal(0);
+        setAnimationTick(regionApp, 0);
+
+        const int mapWidth  = api.get_map_width();
+        const int mapHeight = api.get_map_height();
+        const int tileSize  = api.get_map_tile_size();
+        const int width     = std::min(24, mapWidth);
+        const int height    = std::min(16, mapHeight);
+
+        std::vector<std::pair<int, int>> positions{ { 0, 0 } };
+        int                              x = 0, y = 0;
+        for (int i = 0; i < 40 && x + width < mapWidth; ++i)
+            positions.push_back({ ++x, y });
+        for (int i = 0; i < 30 && y + height < mapHeight; ++i)
+            positions.push_back({ x, ++y });
+        for (int i = 0; i < 30 && x >= 2 && y >= 1; ++i)
+            positions.push_back({ x -= 2, --y });
+        positions.push_back({ 0, 0 }); // jump, full repaint.
+
+        const size_t bitmapSize = static_cast<size_t>(width) * height * tileSize * tileSize * 4;
+        int64_t      fullUS = 0, regionUS = 0, dirtyPixels = 0;
+        int          mismatches = 0;
+        for (size_t step = 0; step < positions.size(); ++step) {
+            const auto [posX, posY] = positions[step];
+            if (!checkGlobalCall("set_map_render_window", api.set_map_render_window(posX, posY, 0, width, height))
+                || !checkGlobalCall("map_prepare_render", api.map_prepare_render()))
+                return 1;
+            if (!checkAppCall("set_map_render_window", apiApp.set_map_render_window(regionApp, posX, posY, 0, width, height))
+                || !checkAppCall("map_prepare_render", apiApp.map_prepare_render(regionApp)))
+                return 1;
+            {
+                Mernel::ScopeTimer timer;
+                if (!checkGlobalCall("map_paint", api.map_paint()))
+                    return 1;
+                fullUS += timer.elapsedUS();
+            }
+            FHRect rects[4];
+            int    rectCount = 0;
+            {
+                Mernel::ScopeTimer timer;
+                if (!checkAppCall("map_paint_region", paintRegion(regionApp, rects, 4, &rectCount)))
+                    return 1;
+                regionUS += timer.elapsedUS();
+            }
+            for (int i = 0; i < rectCount && i < 4; ++i)
+                dirtyPixels += static_cast<int64_t>(rects[i].width) * rects[i].height;
+
+            const uint8_t* fullResult   = api.get_map_paint_result();
+            const uint8_t* regionResult = apiApp.get_map_paint_result(regionApp);
+            if (!fullResult || !regionResult || std::memcmp(fullResult, regionResult, bitmapSize) != 0) {
+                if (!mismatches)
+                    std::cerr << "Paint result mismatch on step " << step << ", window: " << posX << "," << posY << "\n";
+                mismatches++;
+            }
+        }
+        const int64_t frames = positions.size();
+        std::cout << "Scroll sequence of " << frames << " frames, window " << width << "x" << height << " tiles:\n";
+        std::cout << "map_paint: " << (fullUS / 1000) << " ms, " << (frames * 1000000 / std::max(int64_t(1), fullUS)) << " fps\n";
+        std::cout << "map_paint_region: " << (regionUS / 1000) << " ms, " << (frames * 1000000 / std::max(int64_t(1), regionUS)) << " fps, painted "
+                  << (dirtyPixels * 100 / (frames * width * height * tileSize * tileSize)) << "% of pixels\n";
+        if (mismatches) {
+            std::cerr << "Paint results differ in " << mismatches << " frames\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    if (task == "parallel") {
+        // renders several maps with sessions of one engine: first one by one, then all at once from different threads; compares results.
+        auto* pointersAddress = loader.getSymbol("fh_get_engine_api_pointers_v1");
+        if (!pointersAddress) {
+            std::cerr << "Failed to find fh_get_engine_api_pointers_v1\n";
+            return 1;
+        }
+        FHEngineApiPointers apiEngine = reinterpret_cast<fh_get_engine_api_pointers_v1_f>(pointersAddress)();
+
+        FHEngineHandle engine = apiEngine.engine_create();
+        MERNEL_SCOPE_EXIT([&] { apiEngine.engine_destroy(engine); });
+        {
+            Mernel::ScopeTimer timer;
+            if (!apiEngine.engine_init(engine, appPath.c_str(), userPath.c_str())) {
+                std::cerr << "Method engine.'init' failed, error: " << apiEngine.engine_get_last_error(engine) << "\n";
+                return 1;
+            }
+            std::cout << "Engine init: " << (timer.elapsedUS() / 1000) << " ms.\n";
+        }
+
+        std::vector<std::string> mapPaths;
+        for (const auto& it : std_fs::directory_iterator(string2path(heroesPath + "/Maps"))) {
+            if (it.is_regular_file() && pathToLower(it.path().extension()) == ".h3m")
+                mapPaths.push_back(path2string(it.path()));
+        }
+        std::sort(mapPaths.begin(), mapPaths.end());
+        if (mapPaths.size() > 8)
+            mapPaths.resize(8);
+        if (mapPaths.empty()) {
+            std::cerr << "No .h3m maps found in " << heroesPath << "/Maps\n";
+            return 1;
+        }
+
+        const int width  = 32;
+        const int height = 24;
+        // returns empty result on failure.
+        auto renderMap = [&apiEngine, engine, width, height](const std::string& mapPath, std::string& error) -> std::vector<uint8_t> {
+            FHSessionHandle session = apiEngine.session_create(engine);
+            if (!session) {
+                error = "session_create failed";
+                return {};
+            }
+            MERNEL_SCOPE_EXIT([&] { apiEngine.session_destroy(session); });
+
+            const bool success = apiEngine.session_map_load(session, mapPath.c_str())
+                                 && apiEngine.session_set_map_render_window(session, 0, 0, 0, width, height)
+                                 && apiEngine.session_set_map_animation_tick(session, 0)
+                                 && apiEngine.session_map_prepare_render(session)
+                                 && apiEngine.session_map_paint(session);
+            const uint8_t* result = apiEngine.session_get_map_paint_result(session);
+            if (!success || !result) {
+                error = apiEngine.session_get_last_error(session);
+                return {};
+            }
+            const int tileSize = apiEngine.session_get_map_tile_size(session);
+            return std::vector<uint8_t>(result, result + static_cast<size_t>(width) * height * tileSize * tileSize * 4);
+        };
+
+        std::vector<std::vector<uint8_t>> references(mapPaths.size());
+        int64_t                           sequentialUS = 0;
+        {
+            Mernel::ScopeTimer timer;
+            for (size_t i = 0; i < mapPaths.size(); ++i) {
+                std::string error;
+                references[i] = renderMap(mapPaths[i], error);
+                if (references[i].empty()) {
+                    std::cerr << "Failed to render " << mapPaths[i] << ": " << error << "\n";
+                    return 1;
+                }
+            }
+            sequentialUS = timer.elapsedUS();
+        }
+
+        std::vector<std::vector<uint8_t>> results(mapPaths.size());
+        std::vector<std::string>          errors(mapPaths.size());
+        int64_t                           parallelUS = 0;
+        {
+            Mernel::ScopeTimer       timer;
+            std::vector<std::thread> threads;
+            for (size_t i = 0; i < mapPaths.size(); ++i)
+                threads.emplace_back([&, i] { results[i] = renderMap(mapPaths[i], errors[i]); });
+            for (auto& thread : threads)
+                thread.join();
+            parallelUS = timer.elapsedUS();
+        }
+
+        int mismatches = 0;
+        for (size_t i = 0; i < mapPaths.size(); ++i) {
+            if (results[i].empty()) {
+                std::cerr << "Failed to render " << mapPaths[i] << " in thread: " << errors[i] << "\n";
+                mismatches++;
+            } else if (results[i] != references[i]) {
+                std::cerr << "Paint result mismatch for " << mapPaths[i] << "\n";
+                mismatches++;
+            }
+        }
+        std::cout << "Rendered " << mapPaths.size() << " maps, window " << width << "x" << height << " tiles:\n";
+        std::cout << "sequential: " << (sequentialUS / 1000) << " ms, parallel: " << (parallelUS / 1000) << " ms, speedup: x"
+                  << (static_cast<double>(sequentialUS) / std::max(int64_t(1), parallelUS)) << "\n";
+
+        return mismatches ? 1 : 0;
+    }
+
     std::cerr << "Unknown task: " << task << "\n";
     return 1;
 }
@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+#include "BattleSimulator.hpp"
+
+#include "AdventureEstimation.hpp"
+#include "BattleManager.hpp"
+#include "IGameDatabase.hpp"
+#include "IRandomGenerator.hpp"
+#include "LibraryArtifact.hpp"
+
+#include "MernelExecution/ParallelExecutor.hpp"
+#include "MernelExecution/TaskQueue.hpp"
+#include "MernelPlatform/Profiler.hpp"
+
+#include <iostream>
+
+namespace FreeHeroes {
+using namespace Core;
+
+namespace {
+
+BattleSimulator::Casualties makeCasualties(const BattleSquad& squad)
+{
+    BattleSimulator::Casualties result;
+    const auto                  loss = squad.estimateLoss();
+    for (const auto& item : loss.units) {
+        result.m_units += item.loss;
+        result.m_stacks += item.isDead;
+    }
+    result.m_hpLoss = loss.totalHpLoss;
+    result.m_value  = loss.totalValueLoss;
+    return result;
+}
+
+}
+
+BattleSimulator::BattleSimulator(const IGameDatabase*           gameDatabase,
+                                 const IRandomGeneratorFactory* rngFactory,
+                                 const AdventureState&          adventureState)
+    : m_gameDatabase(gameDatabase)
+    , m_rngFactory(rngFactory)
+    , m_adventureState(adventureState)
+{
+    if (m_adventureState.m_field.field.width <= 0)
+        m_adventureState.m_field.field = BattleFieldGeometry{ 15, 11 };
+
+    AdventureEstimation(m_gameDatabase).calculateArmy(m_adventureState.m_att, m_adventureState.m_terrain);
+    AdventureEstimation(m_gameDatabase).calculateArmy(m_adventureState.m_def, m_adventureState.m_terrain);
+}
+
+BattleSimulator::Summary BattleSimulator::run(const Settings& settings) const
+{
+    Summary result;
+    result.m_outcomes.resize(settings.m_battles);
+
+    Mernel::ScopeTimer timer;
+    if (settings.m_jobs <= 1) {
+        for (int i = 0; i < settings.m_battles; ++i)
+            result.m_outcomes[i] = runSingle(settings.m_seedStart + i, settings);
+    } else {
+        Mernel::TaskQueue taskQueue;
+        for (int i = 0; i < settings.m_battles; ++i) {
+            taskQueue.addTask([this, i, &settings, &result] {
+                result.m_outcomes[i] = runSingle(settings.m_seedStart + i, settings);
+            });
+        }
+        Mernel::ParallelExecutor executor(settings.m_jobs);
+        executor.execQueue(taskQueue);
+    }
+    result.m_elapsedUS = timer.elapsedUS();
+
+    return result;
+}
+
+BattleSimulator::Outcome BattleSimulator::runSingle(uint64_t seed, const Settings& settings) const
+{
+    AdventureState adventureState = m_adventureState;
+    adventureState.m_seed         = seed;
+
+    BattleArmy att(&adventureState.m_att, BattleStack::Side::Attacker);
+    BattleArmy def(&adventureState.m_def, BattleStack::Side::Defender);
+
+    Outcome outcome;
+    outcome.m_seed = seed;
+    if (att.isEmpty() || def.isEmpty())
+        return outcome;
+
+    for (BattleArmy* army : { &att, &def }) {
+        const auto bmSlot = ArtifactSlotType::BmShoot;
+        if (!army->battleHero.isValid())
+            continue;
+
+        auto shootArt = army->battleHero.adventure->getArtifact(bmSlot);
+        if (!shootArt)
+            continue;
+        const bool isAttacker = army->side == BattleStack::Side::Attacker;
+        if (adventureState.m_field.calcBM(isAttacker, bmSlot).isEmpty())
+            continue;
+
+        auto& armyAdv = isAttacker ? adventureState.m_att : adventureState.m_def;
+
+        AdventureStackMutablePtr bm = armyAdv.squad.addHidden(shootArt->battleMachineUnit, 1);
+        AdventureEstimation(m_gameDatabase).calculateArmySummon(armyAdv, adventureState.m_terrain, bm);
+        army->createMachineShoot(bm);
+    }
+
+    auto rng = m_rngFactory->create();
+    rng->setSeed(seed);
+
+    BattleManager battle(att,
+                         def,
+                         adventureState.m_field,
+                         rng,
+                         m_gameDatabase->gameRules(),
+                         [&adventureState, this](BattleStack::Side side, LibraryUnitConstPtr unit, int count) -> AdventureStackConstPtr {
+                             auto&                    army   = side == BattleStack::Side::Attacker ? adventureState.m_att : adventureState.m_def;
+                             AdventureStackMutablePtr result = army.squad.addHidden(unit, count);
+                             AdventureEstimation(m_gameDatabase).calculateArmySummon(army, adventureState.m_terrain, result);
+                             return result;
+                         });
+    IBattleView&    battleView    = battle;
+    IBattleControl& battleControl = battle;
+
+    battle.start();
+
+    auto aiAtt = battle.makeAI(settings.m_attParams, battleControl);
+    auto aiDef = battle.makeAI(settings.m_defParams, battleControl);
+
+    while (!battleView.isFinished() && outcome.m_steps < settings.m_stepLimit) {
+        IAI& ai = battleView.getCurrentSide() == BattleStack::Side::Attacker ? *aiAtt : *aiDef;
+        ai.runStep();
+        outcome.m_steps++;
+    }
+
+    if (battleView.isFinished()) {
+        const bool attAlive = att.hasAlive();
+        const bool defAlive = def.hasAlive();
+        if (attAlive && !defAlive)
+            outcome.m_winner = Winner::Attacker;
+        else if (defAlive && !attAlive)
+            outcome.m_winner = Winner::Defender;
+    }
+    outcome.m_att       = makeCasualties(*att.squad);
+    outcome.m_def       = makeCasualties(*def.squad);
+    outcome.m_attSearch = aiAtt->getSearchStats();
+    outcome.m_defSearch = aiDef->getSearchStats();
+
+    return outcome;
+}
+
+void BattleSimulator::printSummary(std::ostream& os, const Summary& summary, bool printEachBattle)
+{
+    const auto winnerToString = [](Winner winner) -> const char* {
+        if (winner == Winner::Attacker)
+            return "att";
+        if (winner == Winner::Defender)
+            return "def";
+        return "none";
+    };
+    if (printEachBattle) {
+        for (const Outcome& outcome : summary.m_outcomes) {
+            os << "seed=" << outcome.m_seed
+               << " winner=" << winnerToString(outcome.m_winner)
+               << " steps=" << outcome.m_steps
+               << " attLoss=" << outcome.m_att.m_units
+               << " defLoss=" << outcome.m_def.m_units << "\n";
+        }
+    }
+
+    const size_t count = summary.m_outcomes.size();
+    if (!count)
+        return;
+
+    int                    attWins = 0, defWins = 0, noWinner = 0;
+    int64_t                steps   = 0;
+    Casualties             attTotal, defTotal;
+    Core::IAI::SearchStats attSearch, defSearch;
+    for (const Outcome& outcome : summary.m_outcomes) {
+        attWins += outcome.m_winner == Winner::Attacker;
+        defWins += outcome.m_winner == Winner::Defender;
+        noWinner += outcome.m_winner == Winner::None;
+        steps += outcome.m_steps;
+        for (auto [total, side] : { std::pair{ &attSearch, &outcome.m_attSearch }, std::pair{ &defSearch, &outcome.m_defSearch } }) {
+            total->nodes += side->nodes;
+            total->elapsedUS += side->elapsedUS;
+        }
+        for (auto [total, side] : { std::pair{ &attTotal, &outcome.m_att }, std::pair{ &defTotal, &outcome.m_def } }) {
+            total->m_units += side->m_units;
+            total->m_stacks += side->m_stacks;
+            total->m_hpLoss += side->m_hpLoss;
+            total->m_value += side->m_value;
+        }
+    }
+    const double countF = static_cast<double>(count);
+    auto         pct    = [countF](int value) { return 100.0 * value / countF; };
+
+    os << "Battles: " << count << ", no winner (step limit or draw): " << noWinner << "\n";
+    os << "Attacker win rate: " << pct(attWins) << "%\n";
+    os << "Defender win rate: " << pct(defWins) << "%\n";
+    for (auto [name, total] : { std::pair{ "Attacker", &attTotal }, std::pair{ "Defender", &defTotal } }) {
+        os << name << " avg casualties: units=" << (total->m_units / countF)
+           << ", stacks=" << (total->m_stacks / countF)
+           << ", hp=" << (total->m_hpLoss / countF)
+           << ", value=" << (total->m_value / countF) << "\n";
+    }
+    os << "Avg AI steps per battle: " << (steps / countF) << "\n";
+    for (auto [name, total] : { std::pair{ "Attacker", &attSearch }, std::pair{ "Defender", &defSearch } }) {
+        if (!total->nodes)
+            continue;
+        const double searchSeconds = std::max(int64_t(1), total->elapsedUS) / 1000000.0;
+        os << name << " search AI: " << total->nodes << " nodes, " << static_cast<int64_t>(total->nodes / searchSeconds) << " nodes/sec\n";
+    }
+    const double seconds = std::max(int64_t(1), summary.m_elapsedUS) / 1000000.0;
+    os << "Elapsed: " << seconds << " s., " << (countF / seconds) << " battles/sec\n";
+}
+
+}
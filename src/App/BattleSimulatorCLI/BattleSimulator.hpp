@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+#pragma once
+
+#include "BattleReplay.hpp"
+#include "IAI.hpp"
+
+#include <iosfwd>
+
+namespace FreeHeroes::Core {
+class IGameDatabase;
+class IRandomGeneratorFactory;
+}
+
+namespace FreeHeroes {
+
+// Runs many AI-vs-AI battles of the same armies with different seeds.
+// Every battle gets its own copy of AdventureState, own BattleManager, AIs and random generator;
+// shared between threads are only GameDatabase and RandomGeneratorFactory, which are read-only after load.
+// Lua estimation states are thread-local (see EstimationScriptRuntime), so workers do not contend on them.
+class BattleSimulator {
+public:
+    struct Settings {
+        Core::IAI::AIParams m_attParams;
+        Core::IAI::AIParams m_defParams;
+
+        uint64_t m_seedStart = 0;
+        int      m_battles   = 1;
+        int      m_jobs      = 1;
+        int      m_stepLimit = 1000;
+    };
+
+    enum class Winner
+    {
+        None,
+        Attacker,
+        Defender,
+    };
+
+    struct Casualties {
+        int     m_units   = 0;
+        int64_t m_hpLoss  = 0;
+        int64_t m_value   = 0;
+        int     m_stacks  = 0; // stacks died completely
+    };
+
+    struct Outcome {
+        uint64_t   m_seed   = 0;
+        Winner     m_winner = Winner::None;
+        int        m_steps  = 0;
+        Casualties m_att;
+        Casualties m_def;
+
+        Core::IAI::SearchStats m_attSearch; // empty for one-ply AI.
+        Core::IAI::SearchStats m_defSearch;
+    };
+
+    struct Summary {
+        std::vector<Outcome> m_outcomes; // ordered by seed, independent of number of jobs.
+        int64_t              m_elapsedUS = 0;
+    };
+
+public:
+    BattleSimulator(const Core::IGameDatabase*           gameDatabase,
+                    const Core::IRandomGeneratorFactory* rngFactory,
+                    const Core::AdventureState&          adventureState);
+
+    Summary run(const Settings& settings) const;
+
+    Outcome runSingle(uint64_t seed, const Settings& settings) const;
+
+    static void printSummary(std::ostream& os, const Summary& summary, bool printEachBattle);
+
+private:
+    const Core::IGameDatabase* const           m_gameDatabase;
+    const Core::IRandomGeneratorFactory* const m_rngFactory;
+    Core::AdventureState                       m_adventureState;
+};
+
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+
+#include <iostream>
+#include <map>
+#include <thread>
+
+#include "CoreApplication.hpp"
+#include "AdventureReplay.hpp"
+#include "IGameDatabase.hpp"
+#include "MernelPlatform/CommandLineUtils.hpp"
+
+#include "BattleSimulator.hpp"
+
+using namespace FreeHeroes;
+using namespace Mernel;
+
+namespace {
+
+// Accepts "key=value,key=value" with keys matching IAI::AIParams fields.
+// e.g. "searchDepth=4,searchTimeMs=50,searchThreads=4" plays look-ahead AI against default one-ply AI of other side.
+bool parseAIParams(const std::string& str, Core::IAI::AIParams& params)
+{
+    const std::map<std::string, int64_t*> intFields{
+        { "fullKillsMultiply", &params.fullKillsMultiply },
+        { "mainKillsWeight", &params.mainKillsWeight },
+        { "mainDamageWeight", &params.mainDamageWeight },
+        { "retaliationKillsWeight", &params.retaliationKillsWeight },
+        { "retaliationDamageWeight", &params.retaliationDamageWeight },
+        { "extraKillsMultiply", &params.extraKillsMultiply },
+        { "blockShooterMultiply", &params.blockShooterMultiply },
+    };
+    const std::map<std::string, int*> searchFields{
+        { "searchDepth", &params.searchDepth },
+        { "searchTimeMs", &params.searchTimeMs },
+        { "searchThreads", &params.searchThreads },
+    };
+    size_t start = 0;
+    while (start < str.size()) {
+        size_t end = str.find(',', start);
+        if (end == std::string::npos)
+            end = str.size();
+        const std::string pair = str.substr(start, end - start);
+        start                  = end + 1;
+
+        const size_t eq = pair.find('=');
+        if (eq == std::string::npos) {
+            std::cerr << "Invalid AI param: '" << pair << "', expected key=value\n";
+            return false;
+        }
+        const std::string key   = pair.substr(0, eq);
+        const std::string value = pair.substr(eq + 1);
+        if (key == "useSpells") {
+            params.useSpells = value == "1" || value == "true";
+            continue;
+        }
+        if (auto searchIt = searchFields.find(key); searchIt != searchFields.cend()) {
+            *searchIt->second = std::atoi(value.c_str());
+            continue;
+        }
+        auto it = intFields.find(key);
+        if (it == intFields.cend()) {
+            std::cerr << "Unknown AI param: '" << key << "'\n";
+            return false;
+        }
+        *it->second = std::strtoll(value.c_str(), nullptr, 10);
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    AbstractCommandLine parser({
+                                   "input-replay",
+                                   "db",
+                                   "battles",
+                                   "seed",
+                                   "jobs",
+                                   "deterministic",
+                                   "step-limit",
+                                   "att-ai",
+                                   "def-ai",
+                                   "print-each",
+                                   "logging-level",
+                               },
+                               {});
+    parser.markRequired({ "input-replay" });
+    if (!parser.parseArgs(std::cerr, argc, argv)) {
+        std::cerr << "Battle simulator invocation failed, correct usage is:\n";
+        std::cerr << parser.getHelp();
+        return 1;
+    }
+
+    const std::string dbStr           = parser.getArg("db");
+    const std::string battlesStr      = parser.getArg("battles");
+    const std::string seedStr         = parser.getArg("seed");
+    const std::string jobsStr         = parser.getArg("jobs");
+    const std::string stepLimitStr    = parser.getArg("step-limit");
+    const std::string loggingLevelStr = parser.getArg("logging-level");
+    const bool        deterministic   = parser.getArg("deterministic") == "1";
+    const bool        printEach       = parser.getArg("print-each") == "1" || deterministic;
+
+    const int loggingLevel = loggingLevelStr.empty() ? 2 : std::strtoull(loggingLevelStr.c_str(), nullptr, 10);
+
+    BattleSimulator::Settings settings;
+    settings.m_battles   = battlesStr.empty() ? 100 : std::atoi(battlesStr.c_str());
+    settings.m_stepLimit = stepLimitStr.empty() ? 1000 : std::atoi(stepLimitStr.c_str());
+    // deterministic mode never falls back to hardware_concurrency, so the same command line gives the same schedule everywhere.
+    settings.m_jobs = jobsStr.empty() ? (deterministic ? 1 : static_cast<int>(std::thread::hardware_concurrency())) : std::atoi(jobsStr.c_str());
+    if (!parseAIParams(parser.getArg("att-ai"), settings.m_attParams) || !parseAIParams(parser.getArg("def-ai"), settings.m_defParams))
+        return 1;
+
+    Core::CoreApplication fhCoreApp;
+    fhCoreApp.initLogger(loggingLevel);
+    if (!fhCoreApp.load())
+        return 1;
+
+    const Core::IGameDatabase* gameDatabase = fhCoreApp.getDatabaseContainer()->getDatabase({ dbStr.empty() ? std::string(Core::g_database_HOTA) : dbStr });
+    if (!gameDatabase) {
+        std::cerr << "Failed to load database '" << dbStr << "'\n";
+        return 1;
+    }
+
+    Core::AdventureReplayData replayData;
+    if (!replayData.load(string2path(parser.getArg("input-replay")), gameDatabase)) {
+        std::cerr << "Failed to load replay: " << parser.getArg("input-replay") << "\n";
+        return 1;
+    }
+    settings.m_seedStart = seedStr.empty() ? replayData.m_adv.m_seed : std::strtoull(seedStr.c_str(), nullptr, 10);
+
+    std::cout << "Running " << settings.m_battles << " battles on " << settings.m_jobs << " workers, seeds from " << settings.m_seedStart << "\n";
+
+    BattleSimulator simulator(gameDatabase, fhCoreApp.getRandomGeneratorFactory(), replayData.m_adv);
+    auto            summary = simulator.run(settings);
+    BattleSimulator::printSummary(std::cout, summary, printEach);
+
+    return 0;
+}
@@ -35,6 +35,7 @@ int main(int argc, char** argv)
                                    "prettyJson",
                                    "mergePng",
                                    "transparentKeyColor",
+                                   "jobs",
                                },
                                { "tasks" });
 
@@ -52,6 +53,8 @@ int main(int argc, char** argv)
     const bool                     prettyJson          = parser.getArg("prettyJson") == "1";
     const bool                     mergePng            = parser.getArg("mergePng") == "1";
     const bool                     transparentKeyColor = parser.getArg("transparentKeyColor") == "1";
+    const std::string              jobsStr             = parser.getArg("jobs");
+    const int                      jobs                = jobsStr.empty() ? 0 : std::atoi(jobsStr.c_str());
 
     Core::CoreApplication fhCoreApp;
     fhCoreApp.setLoadAppBinMods(false);
@@ -87,6 +90,7 @@ int main(int argc, char** argv)
                                     .m_prettyJson          = prettyJson,
                                     .m_mergePng            = mergePng,
                                     .m_transparentKeyColor = transparentKeyColor,
+                                    .m_jobs                = jobs,
                                 });
 
     for (const std::string& taskStr : tasksStr) {
@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+#include "MapBatch.hpp"
+
+#include "MernelExecution/ParallelExecutor.hpp"
+#include "MernelExecution/TaskQueue.hpp"
+#include "MernelPlatform/FileFormatJson.hpp"
+#include "MernelPlatform/FileIOUtils.hpp"
+#include "MernelPlatform/Profiler.hpp"
+#include "MernelPlatform/PropertyTree.hpp"
+
+#include <algorithm>
+#include <ostream>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+
+namespace FreeHeroes {
+using namespace Mernel;
+
+namespace {
+
+const char* statusToString(MapBatch::FileResult::Status status)
+{
+    switch (status) {
+        case MapBatch::FileResult::Status::Succeeded:
+            return "succeeded";
+        case MapBatch::FileResult::Status::FailedTrip:
+            return "failedTrip";
+        case MapBatch::FileResult::Status::FatalError:
+            return "fatalError";
+    }
+    return "";
+}
+
+}
+
+MapBatch::MapBatch(const Core::IGameDatabaseContainer*  databaseContainer,
+                   const Core::IRandomGeneratorFactory* rngFactory,
+                   std::vector<MapConverter::Task>      tasks)
+    : m_databaseContainer(databaseContainer)
+    , m_rngFactory(rngFactory)
+    , m_tasks(std::move(tasks))
+{
+}
+
+MapBatch::Report MapBatch::run(const std::vector<MapConverter::Settings>& batch, int jobs, std::ostream& log) const
+{
+    Report report;
+    report.m_files.resize(batch.size());
+
+    Mernel::ScopeTimer timer;
+    if (jobs <= 1 || batch.size() <= 1) {
+        MapConverter converter(log, m_databaseContainer, m_rngFactory, {});
+        for (size_t i = 0; i < batch.size(); ++i) {
+            converter.setSettings(batch[i]);
+            report.m_files[i] = runSingle(converter, batch[i], log);
+        }
+    } else {
+        std::vector<uintmax_t> sizes(batch.size());
+        for (size_t i = 0; i < batch.size(); ++i) {
+            std::error_code ec;
+            sizes[i] = std_fs::file_size(batch[i].m_inputs.m_h3m.m_binary, ec);
+            if (ec)
+                sizes[i] = 0;
+        }
+        std::vector<size_t> order(batch.size());
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::stable_sort(order.begin(), order.end(), [&sizes](size_t l, size_t r) { return sizes[l] > sizes[r]; });
+
+        std::mutex        logMutex;
+        Mernel::TaskQueue taskQueue;
+        for (size_t i : order) {
+            taskQueue.addTask([this, i, &batch, &report, &log, &logMutex] {
+                std::ostringstream fileLog;
+                MapConverter       converter(fileLog, m_databaseContainer, m_rngFactory, batch[i]);
+                report.m_files[i] = runSingle(converter, batch[i], fileLog);
+
+                std::lock_guard lock(logMutex);
+                log << fileLog.str() << std::flush;
+            });
+        }
+        Mernel::ParallelExecutor executor(jobs);
+        executor.execQueue(taskQueue);
+    }
+    report.m_elapsedUS = timer.elapsedUS();
+
+    return report;
+}
+
+MapBatch::FileResult MapBatch::runSingle(MapConverter& converter, const MapConverter::Settings& settings, std::ostream& log) const
+{
+    FileResult result;
+    {
+        std::error_code ec;
+        result.m_sizeBytes = std_fs::file_size(settings.m_inputs.m_h3m.m_binary, ec);
+        if (ec)
+            result.m_sizeBytes = 0;
+    }
+
+    Mernel::ScopeTimer timer;
+    bool               isFailed = false;
+    bool               isFatal  = false;
+    for (const MapConverter::Task task : m_tasks) {
+        try {
+            converter.run(task);
+        }
+        catch (MapConverter::RoundTripException&) {
+            isFailed = true;
+            continue;
+        }
+        catch (std::exception& ex) {
+            log << ex.what() << "\n";
+            isFatal = true;
+            continue;
+        }
+    }
+    result.m_durationUS = timer.elapsedUS();
+
+    if (isFatal)
+        result.m_status = FileResult::Status::FatalError;
+    else if (isFailed)
+        result.m_status = FileResult::Status::FailedTrip;
+    return result;
+}
+
+void MapBatch::printSummary(std::ostream& os, const std::vector<MapConverter::Settings>& batch, const Report& report)
+{
+    auto printStatus = [&os, &batch, &report](FileResult::Status status) {
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (report.m_files[i].m_status == status)
+                os << batch[i].m_inputs.m_h3m.m_binary << "\n";
+        }
+    };
+    os << "Successful runs:\n";
+    printStatus(FileResult::Status::Succeeded);
+    os << "\nFailed round-trip runs:\n";
+    printStatus(FileResult::Status::FailedTrip);
+    os << "\nFatal error runs:\n";
+    printStatus(FileResult::Status::FatalError);
+}
+
+bool MapBatch::writeJson(const Mernel::std_path& path, const std::vector<MapConverter::Settings>& batch, const Report& report)
+{
+    PropertyTree main;
+    main["elapsedUS"]       = PropertyTreeScalar(report.m_elapsedUS);
+    PropertyTree& jsonFiles = main["files"];
+    jsonFiles.convertToList();
+    for (size_t i = 0; i < batch.size(); ++i) {
+        const FileResult& file = report.m_files[i];
+        PropertyTree      jsonFile;
+        jsonFile["path"]   = PropertyTreeScalar(path2string(batch[i].m_inputs.m_h3m.m_binary));
+        jsonFile["status"] = PropertyTreeScalar(std::string(statusToString(file.m_status)));
+        jsonFile["bytes"]  = PropertyTreeScalar(static_cast<int64_t>(file.m_sizeBytes));
+        jsonFile["us"]     = PropertyTreeScalar(file.m_durationUS);
+        jsonFiles.append(std::move(jsonFile));
+    }
+
+    std::string buffer;
+    return writeJsonToBufferNoexcept(buffer, main) && writeFileFromBufferNoexcept(path, buffer);
+}
+
+}
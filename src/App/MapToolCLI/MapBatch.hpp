@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+#pragma once
+
+#include "MapConverter.hpp"
+
+#include <iosfwd>
+#include <vector>
+
+namespace FreeHeroes {
+
+// Runs the same task list for every settings item of the batch.
+// With several jobs every file has own MapConverter and log buffer, log is flushed to output when the file is done;
+// files are started largest-first so the last jobs are short. Report order is always the batch order.
+class MapBatch {
+public:
+    struct FileResult {
+        enum class Status
+        {
+            Succeeded,
+            FailedTrip,
+            FatalError,
+        };
+        Status    m_status     = Status::Succeeded;
+        uintmax_t m_sizeBytes  = 0;
+        int64_t   m_durationUS = 0;
+    };
+
+    struct Report {
+        std::vector<FileResult> m_files; // same order as batch.
+        int64_t                 m_elapsedUS = 0;
+    };
+
+public:
+    MapBatch(const Core::IGameDatabaseContainer*  databaseContainer,
+             const Core::IRandomGeneratorFactory* rngFactory,
+             std::vector<MapConverter::Task>      tasks);
+
+    Report run(const std::vector<MapConverter::Settings>& batch, int jobs, std::ostream& log) const;
+
+    static void printSummary(std::ostream& os, const std::vector<MapConverter::Settings>& batch, const Report& report);
+    static bool writeJson(const Mernel::std_path& path, const std::vector<MapConverter::Settings>& batch, const Report& report);
+
+private:
+    FileResult runSingle(MapConverter& converter, const MapConverter::Settings& settings, std::ostream& log) const;
+
+private:
+    const Core::IGameDatabaseContainer*   m_databaseContainer;
+    const Core::IRandomGeneratorFactory*  m_rngFactory;
+    const std::vector<MapConverter::Task> m_tasks;
+};
+
+}
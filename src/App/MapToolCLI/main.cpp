@@ -4,12 +4,13 @@
  * See LICENSE file for details.
  */
 
+#include <algorithm>
 #include <iostream>
 
 #include "CoreApplication.hpp"
 #include "MernelPlatform/CommandLineUtils.hpp"
 
-#include "MapConverter.hpp"
+#include "MapBatch.hpp"
 
 using namespace FreeHeroes;
 using namespace Mernel;
@@ -34,6 +35,8 @@ int main(int argc, char** argv)
                                    "dump-uncompressed",
                                    "dump-json",
                                    "logging-level",
+                                   "jobs",
+                                   "summary-json",
                                },
                                { "tasks" });
     parser.markRequired({ "tasks" });
@@ -47,6 +50,8 @@ int main(int argc, char** argv)
     const bool        dumpUncompressed = parser.getArg("dump-uncompressed") == "1";
     const bool        dumpJson         = parser.getArg("dump-json") == "1";
     const std::string loggingLevelStr  = parser.getArg("logging-level");
+    const std::string jobsStr          = parser.getArg("jobs");
+    const std::string summaryJson      = parser.getArg("summary-json");
 
     const int loggingLevel = loggingLevelStr.empty() ? 4 : std::strtoull(loggingLevelStr.c_str(), nullptr, 10);
 
@@ -114,55 +119,31 @@ int main(int argc, char** argv)
         batch.push_back(settings);
     }
 
-    MapConverter                        converter(std::cerr,
-                           fhCoreApp.getDatabaseContainer(),
-                           fhCoreApp.getRandomGeneratorFactory(),
-                           settings);
-    std::vector<MapConverter::Settings> batchFailedTrip;
-    std::vector<MapConverter::Settings> batchFatalError;
-    std::vector<MapConverter::Settings> batchSucceeded;
-
-    for (const auto& setting : batch) {
-        converter.setSettings(setting);
-        bool isFailed = false;
-        bool isFatal  = false;
-        for (const std::string& taskStr : tasks) {
-            const MapConverter::Task task = stringToTask(taskStr);
-            if (task == MapConverter::Task::Invalid) {
-                std::cerr << "Unknown task: " << taskStr << "\n";
-                return 1;
-            }
-            try {
-                converter.run(task);
-            }
-            catch (MapConverter::RoundTripException&) {
-                isFailed = true;
-                continue;
-            }
-            catch (std::exception& ex) {
-                std::cerr << ex.what() << "\n";
-                isFatal = true;
-                continue;
-            }
+    std::vector<MapConverter::Task> taskList;
+    for (const std::string& taskStr : tasks) {
+        const MapConverter::Task task = stringToTask(taskStr);
+        if (task == MapConverter::Task::Invalid) {
+            std::cerr << "Unknown task: " << taskStr << "\n";
+            return 1;
         }
-        if (isFatal)
-            batchFatalError.push_back(setting);
-        else if (isFailed)
-            batchFailedTrip.push_back(setting);
-        else
-            batchSucceeded.push_back(setting);
+        taskList.push_back(task);
     }
-    if (batchModeEnabled) {
-        std::cerr << "Successful runs:\n";
-        for (auto& sett : batchSucceeded)
-            std::cerr << sett.m_inputs.m_h3m.m_binary << "\n";
-        std::cerr << "\nFailed round-trip runs:\n";
-        for (auto& sett : batchFailedTrip)
-            std::cerr << sett.m_inputs.m_h3m.m_binary << "\n";
-        std::cerr << "\nFatal error runs:\n";
-        for (auto& sett : batchFatalError)
-            std::cerr << sett.m_inputs.m_h3m.m_binary << "\n";
+
+    // only batch mode has independent files to run in parallel.
+    const int jobs = batchModeEnabled && !jobsStr.empty() ? std::atoi(jobsStr.c_str()) : 1;
+
+    const MapBatch         mapBatch(fhCoreApp.getDatabaseContainer(), fhCoreApp.getRandomGeneratorFactory(), taskList);
+    const MapBatch::Report report = mapBatch.run(batch, jobs, std::cerr);
+    if (batchModeEnabled)
+        MapBatch::printSummary(std::cerr, batch, report);
+
+    if (!summaryJson.empty() && !MapBatch::writeJson(string2path(summaryJson), batch, report)) {
+        std::cerr << "Failed to write summary: " << summaryJson << "\n";
+        return 1;
     }
 
-    return batchFailedTrip.size() + batchFatalError.size() != 0;
+    const bool hasFailures = std::any_of(report.m_files.cbegin(), report.m_files.cend(), [](const MapBatch::FileResult& file) {
+        return file.m_status != MapBatch::FileResult::Status::Succeeded;
+    });
+    return hasFailures;
 }
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+
+#include <iostream>
+
+#include "MernelPlatform/CommandLineUtils.hpp"
+#include "MernelPlatform/Profiler.hpp"
+#include "MernelPlatform/StringUtils.hpp"
+
+#include "ModPack.hpp"
+
+using namespace FreeHeroes;
+using namespace Mernel;
+
+int main(int argc, char** argv)
+{
+    AbstractCommandLine parser({
+                                   "input-folder",
+                                   "output-pack",
+                                   "no-compress",
+                               },
+                               {});
+    parser.markRequired({ "input-folder" });
+    if (!parser.parseArgs(std::cerr, argc, argv)) {
+        std::cerr << "Mod packer invocation failed, correct usage is:\n";
+        std::cerr << parser.getHelp();
+        return 1;
+    }
+
+    const std_path inputFolder = string2path(parser.getArg("input-folder"));
+    std_path       outputPack  = string2path(parser.getArg("output-pack"));
+    const bool     noCompress  = parser.getArg("no-compress") == "1";
+
+    if (!std_fs::is_directory(inputFolder)) {
+        std::cerr << "Input folder does not exist: " << path2string(inputFolder) << "\n";
+        return 1;
+    }
+    if (outputPack.empty()) {
+        // 'sod_res.fhmod' -> 'sod_res.fhpack' near it.
+        auto parts = splitLine(path2string(inputFolder.filename()), '.');
+        outputPack = inputFolder.parent_path() / string2path(parts[0] + std::string(Core::ModPack::s_extension));
+    }
+
+    Core::ModPack::PackSettings settings;
+    if (!noCompress)
+        settings.m_compressExtensions = { ".json" };
+
+    try {
+        ScopeTimer                     timer;
+        const Core::ModPack::PackStats stats = Core::ModPack::pack(inputFolder, outputPack, settings);
+        std::cout << "Packed " << stats.m_files << " files (" << stats.m_compressedFiles << " compressed), "
+                  << stats.m_sourceBytes << " -> " << stats.m_packBytes << " bytes in " << timer.elapsedUS() / 1000 << " ms: "
+                  << path2string(outputPack) << "\n";
+    }
+    catch (std::exception& ex) {
+        std::cerr << ex.what() << "\n";
+        return 1;
+    }
+    if (!Core::ModPack::open(outputPack)) {
+        std::cerr << "Written pack can not be opened: " << path2string(outputPack) << "\n";
+        return 1;
+    }
+    return 0;
+}
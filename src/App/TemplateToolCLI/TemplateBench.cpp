@@ -0,0 +1,332 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+#include "TemplateBench.hpp"
+
+#include "MapConverter.hpp"
+
+#include "MernelExecution/ParallelExecutor.hpp"
+#include "MernelExecution/TaskQueue.hpp"
+#include "MernelPlatform/FileFormatJson.hpp"
+#include "MernelPlatform/FileIOUtils.hpp"
+#include "MernelPlatform/Profiler.hpp"
+#include "MernelPlatform/PropertyTree.hpp"
+
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace FreeHeroes {
+using namespace Mernel;
+
+namespace {
+
+// High-water mark of the whole process since its start: never decreases and includes other runs and jobs.
+int64_t getProcessPeakRssKB()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return static_cast<int64_t>(counters.PeakWorkingSetSize / 1024);
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024; // bytes on macOS
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+std::string csvEscape(const std::string& value)
+{
+    if (value.find_first_of(",\"\n") == std::string::npos)
+        return value;
+    std::string result = "\"";
+    for (char c : value) {
+        if (c == '"')
+            result += '"';
+        result += c;
+    }
+    return result + "\"";
+}
+
+}
+
+TemplateBench::TemplateBench(const Core::IGameDatabaseContainer*  databaseContainer,
+                             const Core::IRandomGeneratorFactory* rngFactory)
+    : m_databaseContainer(databaseContainer)
+    , m_rngFactory(rngFactory)
+{
+}
+
+TemplateBench::Report TemplateBench::run(const Settings& settings) const
+{
+    struct Case {
+        const std_path* m_template = nullptr;
+        int             m_size     = 0;
+        int             m_depth    = 0;
+        uint64_t        m_seed     = 0;
+    };
+    std::vector<Case> cases;
+    for (const auto& templatePath : settings.m_templates) {
+        for (int size : settings.m_sizes) {
+            for (int depth : settings.m_depths) {
+                for (int i = 0; i < settings.m_seeds; ++i)
+                    cases.push_back(Case{ &templatePath, size, depth, settings.m_seedStart + i });
+            }
+        }
+    }
+
+    Report report;
+    report.m_runs.resize(cases.size());
+
+    Mernel::ScopeTimer timer;
+    if (settings.m_jobs <= 1) {
+        for (size_t i = 0; i < cases.size(); ++i)
+            report.m_runs[i] = runSingle(*cases[i].m_template, cases[i].m_size, cases[i].m_depth, cases[i].m_seed, settings.m_zoneJobs);
+    } else {
+        Mernel::TaskQueue taskQueue;
+        for (size_t i = 0; i < cases.size(); ++i) {
+            taskQueue.addTask([this, i, &cases, &settings, &report] {
+                report.m_runs[i] = runSingle(*cases[i].m_template, cases[i].m_size, cases[i].m_depth, cases[i].m_seed, settings.m_zoneJobs);
+            });
+        }
+        Mernel::ParallelExecutor executor(settings.m_jobs);
+        executor.execQueue(taskQueue);
+    }
+    report.m_elapsedUS        = timer.elapsedUS();
+    report.m_processPeakRssKB = getProcessPeakRssKB();
+
+    return report;
+}
+
+TemplateBench::RunResult TemplateBench::runSingle(const Mernel::std_path& templatePath, int size, int depth, uint64_t seed, int zoneJobs) const
+{
+    RunResult result;
+    result.m_template = path2string(templatePath.stem());
+    result.m_size     = size;
+    result.m_depth    = depth;
+    result.m_seed     = seed;
+
+    std::ostringstream log;
+    MapConverter       converter(log, m_databaseContainer, m_rngFactory, MapConverter::Settings{ .m_inputs = { .m_fhTemplate = templatePath } });
+    converter.setTemplateSettings(MapConverter::TemplateSettings{
+        .m_seed     = seed,
+        .m_zoneJobs = zoneJobs,
+        .m_mapSize  = size,
+        .m_depth    = depth,
+        .m_skipSave = true,
+    });
+
+    Mernel::ScopeTimer timer;
+    try {
+        converter.run(MapConverter::Task::GenerateFHMap);
+    }
+    catch (std::exception& ex) {
+        result.m_error = ex.what();
+    }
+    result.m_durationUS = timer.elapsedUS();
+
+    for (const auto& stat : converter.m_generationStats) {
+        result.m_stages.push_back(StageResult{
+            .m_stage      = FHTemplateProcessor::stageToString(stat.m_stage),
+            .m_durationUS = stat.m_durationUS,
+            .m_profile    = stat.m_profile,
+        });
+    }
+    return result;
+}
+
+bool TemplateBench::parseSizes(const std::string& str, std::vector<int>& sizes)
+{
+    const std::map<std::string, int> named{
+        { "S", 36 },
+        { "M", 72 },
+        { "L", 108 },
+        { "XL", 144 },
+        { "H", 180 },
+        { "XH", 216 },
+        { "G", 252 },
+    };
+    sizes.clear();
+    std::istringstream is(str);
+    std::string        token;
+    while (std::getline(is, token, ',')) {
+        if (auto it = named.find(token); it != named.cend()) {
+            sizes.push_back(it->second);
+            continue;
+        }
+        const int size = std::atoi(token.c_str());
+        if (size <= 0) {
+            std::cerr << "Invalid map size: '" << token << "'\n";
+            return false;
+        }
+        sizes.push_back(size);
+    }
+    return !sizes.empty();
+}
+
+void TemplateBench::printSummary(std::ostream& os, const Report& report)
+{
+    int failed = 0;
+    for (const RunResult& run : report.m_runs) {
+        os << run.m_template << " size=" << run.m_size << " depth=" << run.m_depth << " seed=" << run.m_seed
+           << " " << (run.m_error.empty() ? "ok" : "FAILED: " + run.m_error) << " (" << run.m_durationUS << " us.)\n";
+        failed += !run.m_error.empty();
+    }
+    os << "Maps: " << report.m_runs.size() << ", failed: " << failed << ", total time: " << report.m_elapsedUS << " us., process peak RSS: " << report.m_processPeakRssKB << " KB\n";
+}
+
+bool TemplateBench::writeJson(const Mernel::std_path& path, const Report& report)
+{
+    PropertyTree main;
+    main["elapsedUS"]        = PropertyTreeScalar(report.m_elapsedUS);
+    main["processPeakRssKB"] = PropertyTreeScalar(report.m_processPeakRssKB);
+    PropertyTree& jsonRuns = main["runs"];
+    jsonRuns.convertToList();
+    for (const RunResult& run : report.m_runs) {
+        PropertyTree jsonRun;
+        jsonRun["template"] = PropertyTreeScalar(run.m_template);
+        jsonRun["size"]     = PropertyTreeScalar(run.m_size);
+        jsonRun["depth"]    = PropertyTreeScalar(run.m_depth);
+        jsonRun["seed"]     = PropertyTreeScalar(static_cast<int64_t>(run.m_seed));
+        jsonRun["error"]    = PropertyTreeScalar(run.m_error);
+        jsonRun["us"]       = PropertyTreeScalar(run.m_durationUS);
+        PropertyTree& jsonStages = jsonRun["stages"];
+        jsonStages.convertToList();
+        for (const StageResult& stage : run.m_stages) {
+            PropertyTree jsonStage;
+            jsonStage["stage"]   = PropertyTreeScalar(stage.m_stage);
+            jsonStage["us"]      = PropertyTreeScalar(stage.m_durationUS);
+            jsonStage["profile"] = PropertyTreeScalar(stage.m_profile);
+            jsonStages.append(std::move(jsonStage));
+        }
+        jsonRuns.append(std::move(jsonRun));
+    }
+
+    std::string buffer;
+    return writeJsonToBufferNoexcept(buffer, main) && writeFileFromBufferNoexcept(path, buffer);
+}
+
+bool TemplateBench::readJson(const Mernel::std_path& path, Report& report)
+{
+    std::string buffer;
+    if (!readFileIntoBufferNoexcept(path, buffer))
+        return false;
+    PropertyTree main;
+    if (!readJsonFromBufferNoexcept(buffer, main))
+        return false;
+
+    report                    = {};
+    report.m_elapsedUS        = main["elapsedUS"].getScalar().toInt();
+    report.m_processPeakRssKB = main["processPeakRssKB"].getScalar().toInt();
+    if (!main["runs"].isList())
+        return false;
+    for (const PropertyTree& jsonRun : main["runs"].getList()) {
+        RunResult run;
+        run.m_template   = std::string(jsonRun["template"].getScalar().toString());
+        run.m_size       = static_cast<int>(jsonRun["size"].getScalar().toInt());
+        run.m_depth      = static_cast<int>(jsonRun["depth"].getScalar().toInt());
+        run.m_seed       = static_cast<uint64_t>(jsonRun["seed"].getScalar().toInt());
+        run.m_error      = std::string(jsonRun["error"].getScalar().toString());
+        run.m_durationUS = jsonRun["us"].getScalar().toInt();
+        if (jsonRun["stages"].isList()) {
+            for (const PropertyTree& jsonStage : jsonRun["stages"].getList()) {
+                run.m_stages.push_back(StageResult{
+                    .m_stage      = std::string(jsonStage["stage"].getScalar().toString()),
+                    .m_durationUS = jsonStage["us"].getScalar().toInt(),
+                    .m_profile    = std::string(jsonStage["profile"].getScalar().toString()),
+                });
+            }
+        }
+        report.m_runs.push_back(std::move(run));
+    }
+    return true;
+}
+
+bool TemplateBench::writeCsv(const Mernel::std_path& path, const Report& report)
+{
+    std::ostringstream os;
+    os << "template,size,depth,seed,error,stage,us\n";
+    for (const RunResult& run : report.m_runs) {
+        const std::string prefix = csvEscape(run.m_template) + "," + std::to_string(run.m_size) + "," + std::to_string(run.m_depth) + "," + std::to_string(run.m_seed) + "," + csvEscape(run.m_error) + ",";
+        for (const StageResult& stage : run.m_stages)
+            os << prefix << stage.m_stage << "," << stage.m_durationUS << "\n";
+        os << prefix << "Total," << run.m_durationUS << "\n";
+    }
+    return writeFileFromBufferNoexcept(path, os.str());
+}
+
+int TemplateBench::diff(std::ostream& os, const Report& baseline, const Report& current, int thresholdPercent, int64_t minDeltaUS)
+{
+    struct Key {
+        std::string m_template;
+        int         m_size  = 0;
+        int         m_depth = 0;
+        std::string m_stage;
+
+        auto operator<=>(const Key&) const = default;
+    };
+    struct Accumulator {
+        int64_t m_sum   = 0;
+        int64_t m_count = 0;
+
+        int64_t mean() const { return m_count ? m_sum / m_count : 0; }
+    };
+    // failed runs are skipped, their stage set is incomplete.
+    auto aggregate = [](const Report& report) {
+        std::map<Key, Accumulator> result;
+        for (const RunResult& run : report.m_runs) {
+            if (!run.m_error.empty())
+                continue;
+            for (const StageResult& stage : run.m_stages) {
+                auto& acc = result[Key{ run.m_template, run.m_size, run.m_depth, stage.m_stage }];
+                acc.m_sum += stage.m_durationUS;
+                acc.m_count++;
+            }
+            auto& acc = result[Key{ run.m_template, run.m_size, run.m_depth, "Total" }];
+            acc.m_sum += run.m_durationUS;
+            acc.m_count++;
+        }
+        return result;
+    };
+    const auto baselineStats = aggregate(baseline);
+    const auto currentStats  = aggregate(current);
+
+    int regressions = 0;
+    for (const auto& [key, acc] : currentStats) {
+        auto it = baselineStats.find(key);
+        if (it == baselineStats.cend())
+            continue;
+        const int64_t base         = it->second.mean();
+        const int64_t cur          = acc.mean();
+        const int64_t delta        = cur - base;
+        const bool    isRegression = delta > minDeltaUS && delta * 100 > base * thresholdPercent;
+        regressions += isRegression;
+
+        os << (isRegression ? "REGRESSION " : "           ") << key.m_template << " size=" << key.m_size << " depth=" << key.m_depth
+           << " " << key.m_stage << ": " << base << " -> " << cur << " us.";
+        if (base > 0)
+            os << " (" << (delta * 100 / base) << "%)";
+        os << "\n";
+    }
+    os << "Process peak RSS: " << baseline.m_processPeakRssKB << " -> " << current.m_processPeakRssKB << " KB\n";
+    os << "Regressions (over " << thresholdPercent << "% and " << minDeltaUS << " us.): " << regressions << "\n";
+    return regressions;
+}
+
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+#pragma once
+
+#include "MernelPlatform/FsUtils.hpp"
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace FreeHeroes::Core {
+class IGameDatabaseContainer;
+class IRandomGeneratorFactory;
+}
+
+namespace FreeHeroes {
+
+// Generates maps for every combination of template x map size x depth x seed and collects per-stage timings.
+// Runs share only database container and RNG factory (read-only after load); every run has own MapConverter and log.
+// Memory is reported once per report as process-wide peak RSS after all runs: it is a high-water mark since process start,
+// covering database loading and every run and job, so there is no per-run memory figure.
+class TemplateBench {
+public:
+    struct Settings {
+        std::vector<Mernel::std_path> m_templates;
+        std::vector<int>              m_sizes{ 0 };  // 0 = template user settings
+        std::vector<int>              m_depths{ 0 }; // 0 = template depth, 1 = surface only, 2 = with underground
+
+        uint64_t m_seedStart = 1;
+        int      m_seeds     = 1;
+        int      m_jobs      = 1;
+        int      m_zoneJobs  = 0;
+    };
+
+    struct StageResult {
+        std::string m_stage;
+        int64_t     m_durationUS = 0;
+        std::string m_profile;
+    };
+
+    struct RunResult {
+        std::string m_template; // file stem
+        int         m_size  = 0;
+        int         m_depth = 0;
+        uint64_t    m_seed  = 0;
+
+        std::string              m_error; // empty on success
+        int64_t                  m_durationUS = 0;
+        std::vector<StageResult> m_stages;
+    };
+
+    struct Report {
+        std::vector<RunResult> m_runs; // ordered by template, size, depth, seed; independent of number of jobs.
+        int64_t                m_elapsedUS        = 0;
+        int64_t                m_processPeakRssKB = 0; // see class comment
+    };
+
+public:
+    TemplateBench(const Core::IGameDatabaseContainer*  databaseContainer,
+                  const Core::IRandomGeneratorFactory* rngFactory);
+
+    Report run(const Settings& settings) const;
+
+    RunResult runSingle(const Mernel::std_path& templatePath, int size, int depth, uint64_t seed, int zoneJobs) const;
+
+    // "S,M,L,XL,H,XH,G" or plain numbers.
+    static bool parseSizes(const std::string& str, std::vector<int>& sizes);
+
+    static void printSummary(std::ostream& os, const Report& report);
+
+    static bool writeJson(const Mernel::std_path& path, const Report& report);
+    static bool readJson(const Mernel::std_path& path, Report& report);
+    static bool writeCsv(const Mernel::std_path& path, const Report& report);
+
+    // Compares mean stage time per (template, size, depth); stage is a regression when it is slower than baseline
+    // by more than thresholdPercent and minDeltaUS. Returns number of regressions.
+    static int diff(std::ostream& os, const Report& baseline, const Report& current, int thresholdPercent, int64_t minDeltaUS);
+
+private:
+    const Core::IGameDatabaseContainer* const  m_databaseContainer;
+    const Core::IRandomGeneratorFactory* const m_rngFactory;
+};
+
+}
@@ -5,11 +5,13 @@
  */
 
 #include <iostream>
+#include <sstream>
 
 #include "CoreApplication.hpp"
 #include "MernelPlatform/CommandLineUtils.hpp"
 
 #include "MapConverter.hpp"
+#include "TemplateBench.hpp"
 
 using namespace FreeHeroes;
 using namespace Mernel;
@@ -29,19 +31,39 @@ int main(int argc, char** argv)
                                    "stage-show-debug",
                                    "heat-stop-after",
                                    "tile-filter",
+                                   "zone-jobs",
+                                   "bench",
+                                   "bench-templates",
+                                   "bench-sizes",
+                                   "bench-underground",
+                                   "bench-seeds",
+                                   "bench-jobs",
+                                   "bench-report-json",
+                                   "bench-report-csv",
+                                   "bench-baseline",
+                                   "bench-diff",
+                                   "bench-threshold",
+                                   "bench-min-delta",
                                },
                                { "tasks" });
-    parser.markRequired({ "tasks" });
     if (!parser.parseArgs(std::cerr, argc, argv)) {
         std::cerr << "Map utils invocation failed, correct usage is:\n";
         std::cerr << parser.getHelp();
         return 1;
     }
 
-    const auto tasks = parser.getMultiArg("tasks");
+    const auto tasks     = parser.getMultiArg("tasks");
+    const bool benchMode = parser.getArg("bench") == "1";
+    const bool diffMode  = !parser.getArg("bench-diff").empty();
+    if (tasks.empty() && !benchMode && !diffMode) {
+        std::cerr << "Either tasks, --bench 1 or --bench-diff must be provided:\n";
+        std::cerr << parser.getHelp();
+        return 1;
+    }
 
     const std::string seedStr          = parser.getArg("seed");
     const std::string stopAfterHeatStr = parser.getArg("heat-stop-after");
+    const std::string zoneJobsStr      = parser.getArg("zone-jobs");
 
     MapConverter::TemplateSettings templateSettings;
     templateSettings.m_seed            = std::strtoull(seedStr.c_str(), nullptr, 10);
@@ -51,15 +73,95 @@ int main(int argc, char** argv)
     templateSettings.m_showDebugStage  = parser.getArg("stage-show-debug");
     templateSettings.m_tileFilter      = parser.getArg("tile-filter");
     templateSettings.m_rngUserSettings = Mernel::string2path(parser.getArg("rng-settings-file"));
+    templateSettings.m_zoneJobs        = zoneJobsStr.empty() ? 0 : std::atoi(zoneJobsStr.c_str());
 
     const std::string loggingLevelStr = parser.getArg("logging-level");
     const int         loggingLevel    = loggingLevelStr.empty() ? 4 : std::strtoull(loggingLevelStr.c_str(), nullptr, 10);
 
+    const std::string thresholdStr = parser.getArg("bench-threshold");
+    const std::string minDeltaStr  = parser.getArg("bench-min-delta");
+    const int         threshold    = thresholdStr.empty() ? 10 : std::atoi(thresholdStr.c_str());
+    const int64_t     minDeltaUS   = minDeltaStr.empty() ? 1000 : std::strtoll(minDeltaStr.c_str(), nullptr, 10);
+
+    // returns 2 when regressions found, so scripts can tell them from invocation errors.
+    auto diffWithFile = [threshold, minDeltaUS](const std::string& baselineFile, const TemplateBench::Report& current) -> int {
+        TemplateBench::Report baseline;
+        if (!TemplateBench::readJson(string2path(baselineFile), baseline)) {
+            std::cerr << "Failed to read report: " << baselineFile << "\n";
+            return 1;
+        }
+        return TemplateBench::diff(std::cout, baseline, current, threshold, minDeltaUS) > 0 ? 2 : 0;
+    };
+
+    if (diffMode) {
+        // --bench-diff baseline.json,current.json
+        const std::string diffStr = parser.getArg("bench-diff");
+        const size_t      comma   = diffStr.find(',');
+        if (comma == std::string::npos) {
+            std::cerr << "--bench-diff expects two comma-separated report files\n";
+            return 1;
+        }
+        TemplateBench::Report current;
+        if (!TemplateBench::readJson(string2path(diffStr.substr(comma + 1)), current)) {
+            std::cerr << "Failed to read report: " << diffStr.substr(comma + 1) << "\n";
+            return 1;
+        }
+        return diffWithFile(diffStr.substr(0, comma), current);
+    }
+
     Core::CoreApplication fhCoreApp;
     fhCoreApp.initLogger(loggingLevel);
     if (!fhCoreApp.load())
         return 1;
 
+    if (benchMode) {
+        TemplateBench::Settings benchSettings;
+        const std::string       templatesStr = parser.getArg("bench-templates");
+        const std::string       seedsStr     = parser.getArg("bench-seeds");
+        const std::string       jobsStr      = parser.getArg("bench-jobs");
+        std::istringstream      templatesIs(templatesStr.empty() ? parser.getArg("input-fhTpl") : templatesStr);
+        for (std::string templatePath; std::getline(templatesIs, templatePath, ',');)
+            benchSettings.m_templates.push_back(string2path(templatePath));
+        if (benchSettings.m_templates.empty()) {
+            std::cerr << "No templates provided for benchmark (--bench-templates or --input-fhTpl)\n";
+            return 1;
+        }
+        if (!parser.getArg("bench-sizes").empty() && !TemplateBench::parseSizes(parser.getArg("bench-sizes"), benchSettings.m_sizes))
+            return 1;
+        const std::string undergroundStr = parser.getArg("bench-underground");
+        if (!undergroundStr.empty()) {
+            // "0", "1" or "0,1"
+            benchSettings.m_depths.clear();
+            for (char c : undergroundStr) {
+                if (c == '0' || c == '1')
+                    benchSettings.m_depths.push_back(1 + (c == '1'));
+            }
+        }
+        benchSettings.m_seedStart = seedStr.empty() ? 1 : templateSettings.m_seed;
+        benchSettings.m_seeds     = seedsStr.empty() ? 10 : std::atoi(seedsStr.c_str());
+        benchSettings.m_jobs      = jobsStr.empty() ? 1 : std::atoi(jobsStr.c_str());
+        benchSettings.m_zoneJobs  = templateSettings.m_zoneJobs;
+
+        TemplateBench bench(fhCoreApp.getDatabaseContainer(), fhCoreApp.getRandomGeneratorFactory());
+        auto          report = bench.run(benchSettings);
+        TemplateBench::printSummary(std::cout, report);
+
+        const std::string jsonFile = parser.getArg("bench-report-json");
+        const std::string csvFile  = parser.getArg("bench-report-csv");
+        if (!jsonFile.empty() && !TemplateBench::writeJson(string2path(jsonFile), report)) {
+            std::cerr << "Failed to write report: " << jsonFile << "\n";
+            return 1;
+        }
+        if (!csvFile.empty() && !TemplateBench::writeCsv(string2path(csvFile), report)) {
+            std::cerr << "Failed to write report: " << csvFile << "\n";
+            return 1;
+        }
+        const std::string baselineFile = parser.getArg("bench-baseline");
+        if (!baselineFile.empty())
+            return diffWithFile(baselineFile, report);
+        return 0;
+    }
+
     auto makePaths = [&parser](const std::string& prefix) -> MapConverter::PathsSet {
         const std::string fhMap      = parser.getArg(prefix + "fhMap");
         const std::string fhTemplate = parser.getArg(prefix + "fhTpl");
@@ -51,7 +51,7 @@ bool CoreApplication::load()
 
     ProfilerScope scopeAll("CoreApplication::load");
 
-    ResourceLibraryFactory factory;
+    ResourceLibraryFactory factory(m_useResourceIndexCache ? m_appDataRoot / "Cache" / "ResourceIndex" : Mernel::std_path());
     {
         ProfilerScope scope("ResourceLibrary search");
         if (m_loadUserMods)
@@ -70,7 +70,7 @@ bool CoreApplication::load()
 
     {
         ProfilerScope scope("GameDatabaseContainer load");
-        m_gameDatabaseContainer = std::make_shared<GameDatabaseContainer>(m_resourceLibrary.get());
+        m_gameDatabaseContainer = std::make_shared<GameDatabaseContainer>(m_resourceLibrary.get(), m_useDatabaseSnapshots ? m_appDataRoot / "Cache" / "Database" : Mernel::std_path());
     }
 
     Logger(Logger::Info) << "CoreApplication::load - end";
@@ -30,6 +30,8 @@ public:
     void setLoadAppBinMods(bool load) { m_loadAppBinMods = load; }
     void setLoadUserMods(bool load) { m_loadUserMods = load; }
     void setLoadUserModSequence(std::vector<std::string> order) { m_customLoadSeqence = std::move(order); }
+    void setUseDatabaseSnapshots(bool use) { m_useDatabaseSnapshots = use; }
+    void setUseResourceIndexCache(bool use) { m_useResourceIndexCache = use; }
 
     bool load();
 
@@ -62,8 +64,10 @@ private:
     Mernel::std_path m_userResources;
     Mernel::std_path m_appResources;
 
-    bool                     m_loadAppBinMods = true;
-    bool                     m_loadUserMods   = false;
+    bool                     m_loadAppBinMods        = true;
+    bool                     m_loadUserMods          = false;
+    bool                     m_useDatabaseSnapshots  = true;
+    bool                     m_useResourceIndexCache = true;
     std::vector<std::string> m_customLoadSeqence;
 };
 
@@ -6,6 +6,7 @@
 #include "BattleManager.hpp"
 
 #include "AI.hpp"
+#include "SearchAI.hpp"
 
 #include "IBattleNotify.hpp"
 #include "IRandomGenerator.hpp"
@@ -34,6 +35,22 @@ static std::ostream& operator<<(std::ostream& os, const FreeHeroes::Core::Battle
 namespace {
 const int rangedLimit = 10;
 
+bool isInRoundQueue(BattleStackConstPtr stack)
+{
+    return stack->count > 0 && !stack->roundState.finishedTurn && stack->current.canDoAnything;
+}
+
+// Non-waited stacks have their turn according to base order (speed, side, index).
+// But waited stack have reverse order, so fastest stack will go last.
+bool turnsBefore(BattleStackConstPtr left, BattleStackConstPtr right)
+{
+    if (left->roundState.waited != right->roundState.waited)
+        return right->roundState.waited;
+    if (left->roundState.waited)
+        return left->turnOrder() > right->turnOrder();
+    return left->turnOrder() < right->turnOrder();
+}
+
 }
 
 class BattleManager::BattleNotifyEach : public IBattleNotify {
@@ -134,12 +151,17 @@ BattleManager::BattleManager(BattleArmy&                              attArmy,
     , m_def(defArmy)
     , m_obstacles(fieldPreset.obstacles)
     , m_field(fieldPreset.field)
+    , m_fieldMasks(fieldPreset.field)
+    , m_fieldLayout(fieldPreset.layout)
     , m_roundIndex(0)
     , m_notifiers(new BattleNotifyEach)
     , m_randomGenerator(randomGenerator)
     , m_rules(rules)
     , m_battleCallbackSummon(std::move(battleCallbackSummon))
 {
+    for (auto pos : m_obstacles)
+        m_fieldMasks.addPosition(m_obstacleCells, pos);
+
     makePositions(fieldPreset);
 
     initialParams();
@@ -611,8 +633,12 @@ bool BattleManager::doMoveAttack(BattlePlanMoveParams moveParams, BattlePlanAtta
     if (!plan.m_walkPath.empty())
         m_notifiers->beforeMove(current, plan.m_walkPath);
 
+    markNeighboursDirty(current);
     current->pos.setMainPos(plan.m_moveTo.mainPos());
     current->roundState.finishedTurn = true;
+    updateStackCells(current);
+    markDirty(current);
+    markNeighboursDirty(current);
 
     if (plan.m_attackMode == BattlePlanMove::Attack::Melee || plan.m_attackMode == BattlePlanMove::Attack::Ranged) {
         assert(m_field.isValid(plan.m_attackTarget));
@@ -680,6 +706,7 @@ bool BattleManager::doWait()
     m_notifiers->beforeWait(current);
 
     current->roundState.waited = true;
+    markDirty(current);
 
     m_current = nullptr;
     updateState();
@@ -733,6 +760,7 @@ bool BattleManager::doCast(BattlePlanCastParams planParams)
         caster.unit                        = m_current;
         m_current->roundState.finishedTurn = true;
         m_current->castsDone++;
+        markDirty(m_current);
     }
 
     IBattleNotify::AffectedMagic affected;
@@ -794,6 +822,7 @@ bool BattleManager::doCast(BattlePlanCastParams planParams)
         stack->pos.setSight(stack->side == BattleStack::Side::Attacker ? BattlePositionExtended::Sight::ToRight : BattlePositionExtended::Sight::ToLeft);
 
         recalcStack(stack);
+        markNeighboursDirty(stack);
         m_notifiers->onSummon(caster, plan.m_spell, stack);
     } else {
         assert(!"Unsupported");
@@ -817,9 +846,137 @@ bool BattleManager::doCast(BattlePlanCastParams planParams)
 
 std::unique_ptr<IAI> BattleManager::makeAI(const IAI::AIParams& params, IBattleControl& battleControl)
 {
+    if (params.searchDepth > 0)
+        return std::make_unique<SearchAI>(params, battleControl, *this, m_field);
     return std::make_unique<AI>(params, battleControl, *this, m_field);
 }
 
+// =================================== Snapshots ===================================
+
+void BattleManager::saveState(BattleState& state) const
+{
+    auto indexOf = [this](BattleStackConstPtr stack) -> uint8_t {
+        return static_cast<uint8_t>(std::find(m_all.cbegin(), m_all.cend(), stack) - m_all.cbegin());
+    };
+    assert(m_all.size() < 256);
+
+    state.stacks.resize(m_all.size());
+    for (size_t i = 0; i < m_all.size(); ++i) {
+        const BattleStack&   stack = *m_all[i];
+        BattleState::Stack& saved = state.stacks[i];
+        saved.adventure           = stack.adventure;
+        saved.side                = stack.side;
+        saved.count               = stack.count;
+        saved.health              = stack.health;
+        saved.remainingShoots     = stack.remainingShoots;
+        saved.castsDone           = stack.castsDone;
+        saved.speedOrder          = stack.speedOrder;
+        saved.sameSpeedOrder      = stack.sameSpeedOrder;
+        saved.roundState          = stack.roundState;
+        saved.pos                 = stack.pos;
+        saved.appliedEffects      = stack.appliedEffects;
+        saved.current             = stack.current;
+        saved.cells               = i < m_stackCells.size() ? m_stackCells[i] : BattleFieldBitboard{};
+    }
+    state.alive.clear();
+    for (auto* stack : m_alive)
+        state.alive.push_back(indexOf(stack));
+    state.roundQueue.clear();
+    for (auto* stack : m_roundQueue)
+        state.roundQueue.push_back(indexOf(stack));
+    state.dirty.clear();
+    for (auto* stack : m_dirty)
+        state.dirty.push_back(indexOf(stack));
+    state.current    = m_current ? indexOf(m_current) : -1;
+    state.fullUpdate = m_fullUpdate;
+
+    for (const BattleArmy* army : { &m_att, &m_def }) {
+        auto& hero         = state.heroes[army == &m_att ? 0 : 1];
+        hero.mana          = army->battleHero.mana;
+        hero.castedInRound = army->battleHero.castedInRound;
+    }
+
+    state.roundIndex           = m_roundIndex;
+    state.battleFinished       = m_battleFinished;
+    state.attackerHadFirstTurn = m_attackerHadFirstTurn;
+    state.defenderHadFirstTurn = m_defenderHadFirstTurn;
+    state.rng                  = m_randomGenerator->serialize();
+}
+
+void BattleManager::restoreState(const BattleState& state)
+{
+    // summoned after the snapshot was made; summons are appended to m_all and to army deque in the same order.
+    while (m_all.size() > state.stacks.size()) {
+        BattleArmy& army = m_all.back()->side == BattleStack::Side::Attacker ? m_att : m_def;
+        assert(!army.stacksSummon.empty() && &army.stacksSummon.back() == m_all.back());
+        army.stacksSummon.pop_back();
+        m_all.pop_back();
+    }
+    while (m_all.size() < state.stacks.size()) {
+        const BattleState::Stack& saved = state.stacks[m_all.size()];
+        BattleArmy&               army  = saved.side == BattleStack::Side::Attacker ? m_att : m_def;
+        BattleStackMutablePtr     stack = army.summon(saved.adventure);
+        BattleEstimation(m_rules).calculateArmySummon(army, saved.side == BattleStack::Side::Attacker ? m_def : m_att, m_env, stack);
+        m_all.push_back(stack);
+    }
+    m_stackCells.resize(m_all.size());
+
+    for (size_t i = 0; i < m_all.size(); ++i) {
+        BattleStack&              stack = *m_all[i];
+        const BattleState::Stack& saved = state.stacks[i];
+        assert(stack.adventure == saved.adventure);
+        stack.count           = saved.count;
+        stack.health          = saved.health;
+        stack.remainingShoots = saved.remainingShoots;
+        stack.castsDone       = saved.castsDone;
+        stack.speedOrder      = saved.speedOrder;
+        stack.sameSpeedOrder  = saved.sameSpeedOrder;
+        stack.roundState      = saved.roundState;
+        stack.pos             = saved.pos;
+        stack.appliedEffects  = saved.appliedEffects;
+        stack.current         = saved.current;
+        m_stackCells[i]       = saved.cells;
+    }
+    m_alive.clear();
+    for (uint8_t index : state.alive)
+        m_alive.push_back(m_all[index]);
+    m_roundQueue.clear();
+    for (uint8_t index : state.roundQueue)
+        m_roundQueue.push_back(m_all[index]);
+    m_dirty.clear();
+    for (uint8_t index : state.dirty)
+        m_dirty.push_back(m_all[index]);
+    m_current    = state.current >= 0 ? m_all[state.current] : nullptr;
+    m_fullUpdate = state.fullUpdate;
+
+    for (BattleArmy* army : { &m_att, &m_def }) {
+        const auto& hero               = state.heroes[army == &m_att ? 0 : 1];
+        army->battleHero.mana          = hero.mana;
+        army->battleHero.castedInRound = hero.castedInRound;
+    }
+
+    m_roundIndex           = state.roundIndex;
+    m_battleFinished       = state.battleFinished;
+    m_attackerHadFirstTurn = state.attackerHadFirstTurn;
+    m_defenderHadFirstTurn = state.defenderHadFirstTurn;
+    m_randomGenerator->deserialize(state.rng);
+}
+
+bool BattleManager::applyAction(const BattleReplayData::EventRecord& action)
+{
+    // clang-format off
+    switch (action.type) {
+        case BattleReplayData::EventRecord::Type::Guard      : return doGuard();
+        case BattleReplayData::EventRecord::Type::Wait       : return doWait();
+        case BattleReplayData::EventRecord::Type::MoveAttack : return doMoveAttack(action.moveParams, action.attackParams);
+        case BattleReplayData::EventRecord::Type::Cast       : return doCast(action.castParams);
+        default:
+            break;
+    }
+    // clang-format on
+    return false;
+}
+
 // =================================== Internal ===================================
 BattleHeroConstPtr BattleManager::currentHero() const
 {
@@ -1187,40 +1344,26 @@ DamageResult::Loss BattleManager::risingLoss(BattleStackConstPtr target, int hea
     return loss;
 }
 
-BattlePositionSet BattleManager::getObstaclePositions(BattleStackConstPtr excludeStack,
-                                                      const bool          mirrored,
-                                                      const bool          large) const
+BattleFieldBitboard BattleManager::getObstacleCells(BattleStackConstPtr excludeStack,
+                                                   const bool          mirrored,
+                                                   const bool          large) const
 {
-    BattlePositionSet           finderObstacles;
-    std::vector<BattlePosition> battleObstacles = this->m_obstacles;
-    for (auto* stackAlive : m_alive) {
-        if (stackAlive != excludeStack) {
-            battleObstacles.push_back(stackAlive->pos.leftPos());
-            battleObstacles.push_back(stackAlive->pos.rightPos());
-        }
-    }
-    for (auto pos : battleObstacles) {
-        finderObstacles.insert(pos);
-        if (!large)
-            continue;
-        finderObstacles.insert({ mirrored ? pos.x + 1 : pos.x - 1, pos.y });
-    }
-    if (large) {
-        for (int h = 0; h < m_field.height; ++h)
-            finderObstacles.insert({ mirrored ? 0 : m_field.width - 1, h });
+    BattleFieldBitboard cells = m_obstacleCells;
+    for (size_t i = 0; i < m_stackCells.size(); ++i) {
+        if (m_all[i] != excludeStack)
+            cells |= m_stackCells[i];
     }
-    return finderObstacles;
+    return large ? m_fieldMasks.widenForLarge(cells, mirrored) : cells;
 }
 
 BattleFieldPathFinder BattleManager::setupFinder(BattleStackConstPtr stack) const
 {
-    BattleFieldPathFinder finder(m_field);
+    BattleFieldPathFinder finder(m_fieldMasks);
     finder.setGoThroughObstacles(stack->library->traits.fly || stack->library->traits.teleport);
     const bool mirrored = stack->side == BattleStack::Side::Defender;
     const bool large    = stack->library->traits.large;
 
-    const BattlePositionSet finderObstacles = getObstaclePositions(stack, mirrored, large);
-    finder.setObstacles(finderObstacles);
+    finder.setObstacleCells(getObstacleCells(stack, mirrored, large));
     finder.floodFill(stack->pos.mainPos());
     return finder;
 }
@@ -1257,14 +1400,14 @@ BattlePositionSet BattleManager::getSpellArea(BattlePosition pos, LibrarySpell::
 
 BattlePositionSet BattleManager::getSummonArea(BattleStack::Side side, bool large) const
 {
-    const BattlePositionSet finderObstacles   = getObstaclePositions(nullptr, side == BattleStack::Side::Defender, large);
-    const int               maxSummonDistance = 7;
+    const BattleFieldBitboard obstacleCells     = getObstacleCells(nullptr, side == BattleStack::Side::Defender, large);
+    const int                 maxSummonDistance = 7;
 
     BattlePositionSet result;
 
-    auto fillColumn = [&result, &finderObstacles, this](int x) {
+    auto fillColumn = [&result, &obstacleCells, this](int x) {
         for (int y = 0; y < m_field.height; ++y) {
-            if (finderObstacles.contains({ x, y }))
+            if (obstacleCells.test(m_fieldMasks.toIndex({ x, y })))
                 continue;
 
             result.insert({ x, y });
@@ -1377,10 +1520,32 @@ void BattleManager::initialParams()
     }
 }
 
+void BattleManager::updateStackCells(size_t index)
+{
+    const BattleStackConstPtr stack = m_all[index];
+    BattleFieldBitboard&      cells = m_stackCells[index];
+    cells                           = {};
+    if (stack->count <= 0)
+        return;
+    m_fieldMasks.addPosition(cells, stack->pos.leftPos());
+    m_fieldMasks.addPosition(cells, stack->pos.rightPos());
+}
+
+void BattleManager::updateStackCells(BattleStackConstPtr stack)
+{
+    auto it = std::find(m_all.cbegin(), m_all.cend(), stack);
+    const size_t index = it - m_all.cbegin();
+    if (index < m_stackCells.size())
+        updateStackCells(index);
+}
+
 void BattleManager::updateState()
 {
     m_alive.clear();
     std::copy_if(m_all.begin(), m_all.end(), std::back_inserter(m_alive), [](auto* stack) { return stack->count > 0; });
+    m_stackCells.resize(m_all.size());
+    for (size_t i = 0; i < m_all.size(); ++i)
+        updateStackCells(i);
 
     {
         int attackerAlive = 0;
@@ -1403,37 +1568,29 @@ void BattleManager::updateState()
             return endGame(BattleResult::Result::AttackerWon);
     }
 
-    {
-        std::map<BattleStack::Side, std::map<int, int>> bySpeed;
-        for (auto* stack : m_alive) {
-            recalcStack(stack);
-            int& order            = bySpeed[stack->side][stack->current.primary.battleSpeed];
-            stack->sameSpeedOrder = order++;
-            stack->speedOrder     = -stack->current.primary.battleSpeed;
+    // stacks not touched since the last update keep their stats and relative queue order.
+    const bool incremental = !m_fullUpdate && m_updateMode != UpdateMode::Full;
+    if (incremental) {
+        for (auto* stack : m_dirty) {
+            if (stack->count > 0)
+                recalcStackStats(stack);
         }
+    } else {
+        for (auto* stack : m_alive)
+            recalcStackStats(stack);
     }
+    updateSpeedOrder();
+    if (incremental)
+        updateRoundQueue();
+    else
+        sortRoundQueue();
 
-    std::vector<BattleStackMutablePtr> roundQueue, roundQueueWaited, roundQueueNonWaited;
-    std::copy_if(m_alive.begin(), m_alive.end(), std::back_inserter(roundQueue), [](auto* stack) {
-        return !stack->roundState.finishedTurn && stack->current.canDoAnything;
-    });
-    for (auto stack : roundQueue)
-        if (stack->roundState.waited)
-            roundQueueWaited.push_back(stack);
-        else
-            roundQueueNonWaited.push_back(stack);
-
-    // Non-waited stacks have their turn according to base order (speed, side, index).
-    // But waited stack have reverse order, so fastest stack will go last.
+    if (incremental && m_updateMode == UpdateMode::Verify && !verifyIncremental())
+        m_verifyFailures++;
 
-    std::sort(roundQueueNonWaited.begin(), roundQueueNonWaited.end(), [](auto left, auto right) {
-        return left->turnOrder() < right->turnOrder();
-    });
-    std::sort(roundQueueWaited.begin(), roundQueueWaited.end(), [](auto left, auto right) {
-        return left->turnOrder() > right->turnOrder();
-    });
-    m_roundQueue = roundQueueNonWaited;
-    m_roundQueue.insert(m_roundQueue.end(), roundQueueWaited.cbegin(), roundQueueWaited.cend());
+    // stacks changed by beforeCurrentActive() are handled in the next update.
+    m_dirty.clear();
+    m_fullUpdate = false;
 
     if (m_roundQueue.empty()) {
         // @note: Long recursion in calls when a lot of units skip turns every round is a small concern, we have not so much data on the stack.
@@ -1450,12 +1607,81 @@ void BattleManager::updateState()
     m_notifiers->onStateChanged();
 }
 
+void BattleManager::updateSpeedOrder()
+{
+    // same speed stacks of one side keep creation order.
+    for (size_t i = 0; i < m_alive.size(); ++i) {
+        BattleStackMutablePtr stack = m_alive[i];
+        const int             speed = stack->current.primary.battleSpeed;
+        stack->speedOrder           = -speed;
+        stack->sameSpeedOrder       = 0;
+        for (size_t j = 0; j < i; ++j) {
+            if (m_alive[j]->side == stack->side && m_alive[j]->current.primary.battleSpeed == speed)
+                stack->sameSpeedOrder++;
+        }
+    }
+}
+
+void BattleManager::sortRoundQueue()
+{
+    m_roundQueue.clear();
+    std::copy_if(m_alive.begin(), m_alive.end(), std::back_inserter(m_roundQueue), isInRoundQueue);
+    std::sort(m_roundQueue.begin(), m_roundQueue.end(), turnsBefore);
+}
+
+void BattleManager::updateRoundQueue()
+{
+    // renumbering sameSpeedOrder keeps relative order of the same speed stacks, so unchanged stacks stay sorted.
+    std::erase_if(m_roundQueue, [this](BattleStackConstPtr stack) {
+        return !isInRoundQueue(stack) || std::find(m_dirty.cbegin(), m_dirty.cend(), stack) != m_dirty.cend();
+    });
+    for (auto* stack : m_dirty) {
+        if (isInRoundQueue(stack))
+            m_roundQueue.insert(std::upper_bound(m_roundQueue.begin(), m_roundQueue.end(), stack, turnsBefore), stack);
+    }
+}
+
+bool BattleManager::verifyIncremental()
+{
+    struct Estimated {
+        BattleStack::EstimatedParams current;
+        int                          speedOrder     = 0;
+        int                          sameSpeedOrder = 0;
+    };
+    std::vector<Estimated> incremental;
+    for (auto* stack : m_alive)
+        incremental.push_back({ stack->current, stack->speedOrder, stack->sameSpeedOrder });
+    const std::vector<BattleStackMutablePtr> incrementalQueue = m_roundQueue;
+
+    // state is left as the full update made it.
+    for (auto* stack : m_alive)
+        recalcStackStats(stack);
+    updateSpeedOrder();
+    sortRoundQueue();
+
+    bool result = true;
+    for (size_t i = 0; i < m_alive.size(); ++i) {
+        const BattleStackConstPtr stack = m_alive[i];
+        const Estimated&          inc   = incremental[i];
+        if (inc.current == stack->current && inc.speedOrder == stack->speedOrder && inc.sameSpeedOrder == stack->sameSpeedOrder)
+            continue;
+        Logger(Logger::Err) << "Incremental update mismatch for " << stack->library->id << " at round " << m_roundIndex;
+        result = false;
+    }
+    if (incrementalQueue != m_roundQueue) {
+        Logger(Logger::Err) << "Incremental round queue mismatch at round " << m_roundIndex;
+        result = false;
+    }
+    return result;
+}
+
 void BattleManager::startNewRound()
 {
     BattleEstimation(m_rules).calculateArmyOnRoundStart(m_def);
     BattleEstimation(m_rules).calculateArmyOnRoundStart(m_att);
 
     m_roundIndex++;
+    m_fullUpdate = true; // effects expired, round state reset for all stacks.
 
     m_notifiers->onStartRound(m_roundIndex);
 
@@ -1580,6 +1806,12 @@ BattleManager::LuckRoll BattleManager::makeLuckRoll(BattleStackConstPtr attacker
 }
 
 void BattleManager::recalcStack(BattleStackMutablePtr stack)
+{
+    markDirty(stack);
+    recalcStackStats(stack);
+}
+
+void BattleManager::recalcStackStats(BattleStackMutablePtr stack)
 {
     BattleEstimation(m_rules).calculateUnitStats(*stack);
 
@@ -1594,6 +1826,30 @@ void BattleManager::recalcStack(BattleStackMutablePtr stack)
     }
 }
 
+void BattleManager::markDirty(BattleStackMutablePtr stack)
+{
+    if (std::find(m_dirty.cbegin(), m_dirty.cend(), stack) == m_dirty.cend())
+        m_dirty.push_back(stack);
+}
+
+void BattleManager::markNeighboursDirty(BattleStackConstPtr stack)
+{
+    // stack positions are used directly, m_alive and m_stackCells are not updated in the middle of an action.
+    BattleFieldBitboard around;
+    m_fieldMasks.addPosition(around, stack->pos.leftPos());
+    m_fieldMasks.addPosition(around, stack->pos.rightPos());
+    around = m_fieldMasks.neighbours(around);
+    for (auto* other : m_all) {
+        if (other->side == stack->side || other->count <= 0)
+            continue;
+        BattleFieldBitboard cells;
+        m_fieldMasks.addPosition(cells, other->pos.leftPos());
+        m_fieldMasks.addPosition(cells, other->pos.rightPos());
+        if ((cells & around).any())
+            markDirty(other);
+    }
+}
+
 void BattleManager::applyLoss(BattleStackMutablePtr stack, const DamageResult::Loss& loss, bool isRising)
 {
     stack->count  = loss.remainCount;
@@ -1614,6 +1870,7 @@ void BattleManager::applyLoss(BattleStackMutablePtr stack, const DamageResult::L
     }
 
     recalcStack(stack);
+    markNeighboursDirty(stack); // killed or risen stack changes blocking of adjacent shooters.
 
     if (!isRising)
         stack->current.retaliationPower = retaliationPower;
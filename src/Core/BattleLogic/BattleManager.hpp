@@ -13,13 +13,15 @@
 #include "IAIFactory.hpp"
 
 #include "BattleField.hpp"
+#include "BattleFieldPathFinder.hpp"
+#include "BattleState.hpp"
+#include "BattleReplay.hpp"
 #include "BattleArmy.hpp"
 #include "BattleEnvironment.hpp"
 #include "GeneralEstimation.hpp"
 
 namespace FreeHeroes::Core {
 
-class BattleFieldPathFinder;
 class IBattleNotify;
 class IRandomGenerator;
 
@@ -73,6 +75,23 @@ protected:
 public:
     std::unique_ptr<IAI> makeAI(const IAI::AIParams& params, IBattleControl& battleControl) override;
 
+    // Snapshots for look-ahead (see BattleSandbox)
+public:
+    void saveState(BattleState& state) const;
+    void restoreState(const BattleState& state);
+    bool applyAction(const BattleReplayData::EventRecord& action); // same as replaying it, with the same checks.
+
+    // State update after each action
+public:
+    enum class UpdateMode
+    {
+        Full,        // recalculate every alive stack and sort the round queue.
+        Incremental, // recalculate only stacks changed by the action, reinsert them into the round queue.
+        Verify,      // incremental, then compare with the full update and count mismatches.
+    };
+    void   setUpdateMode(UpdateMode mode) { m_updateMode = mode; }
+    size_t getVerifyFailures() const { return m_verifyFailures; }
+
     // Internal
 private:
     BattleHeroConstPtr   currentHero() const;
@@ -117,9 +136,9 @@ private:
     DamageResult::Loss damageLoss(BattleStackConstPtr defender, int damage) const;
     DamageResult::Loss risingLoss(BattleStackConstPtr target, int health) const;
 
-    BattlePositionSet     getObstaclePositions(BattleStackConstPtr excludeStack,
-                                               const bool          mirrored,
-                                               const bool          large) const;
+    BattleFieldBitboard   getObstacleCells(BattleStackConstPtr excludeStack,
+                                           const bool          mirrored,
+                                           const bool          large) const;
     BattleFieldPathFinder setupFinder(BattleStackConstPtr stack) const;
     BattlePositionSet     getSpellArea(BattlePosition pos, LibrarySpell::Range range) const;
     BattlePositionSet     getSummonArea(BattleStack::Side side, bool large) const;
@@ -132,6 +151,10 @@ private:
     void makePositions(const BattleFieldPreset& fieldPreset);
     void initialParams();
     void updateState();
+    void updateSpeedOrder();
+    void sortRoundQueue();
+    void updateRoundQueue();
+    bool verifyIncremental();
 
     void startNewRound();
 
@@ -148,6 +171,11 @@ private:
     LuckRoll makeLuckRoll(BattleStackConstPtr attacker);
 
     void recalcStack(BattleStackMutablePtr stack);
+    void recalcStackStats(BattleStackMutablePtr stack);
+    void markDirty(BattleStackMutablePtr stack);
+    void markNeighboursDirty(BattleStackConstPtr stack);
+    void updateStackCells(size_t index);
+    void updateStackCells(BattleStackConstPtr stack);
     void applyLoss(BattleStackMutablePtr stack, const DamageResult::Loss& loss, bool isRising = false);
 
 private:
@@ -156,11 +184,20 @@ private:
     BattleEnvironment                  m_env;
     std::vector<BattlePosition>        m_obstacles;
     const BattleFieldGeometry          m_field;
+    const BattleFieldMasks             m_fieldMasks;
+    const FieldLayout                  m_fieldLayout;
+    BattleFieldBitboard                m_obstacleCells;
     std::vector<BattleStackMutablePtr> m_all;
+    std::vector<BattleFieldBitboard>   m_stackCells; // cells occupied by m_all stacks; rebuilt with m_alive in updateState().
     std::vector<BattleStackMutablePtr> m_alive;
     std::vector<BattleStackMutablePtr> m_roundQueue;
+    std::vector<BattleStackMutablePtr> m_dirty; // changed since the last updateState(), only these are recalculated.
     BattleStackMutablePtr              m_current = nullptr;
 
+    bool       m_fullUpdate     = true; // battle start or new round: every stack changed.
+    UpdateMode m_updateMode     = UpdateMode::Incremental;
+    size_t     m_verifyFailures = 0;
+
     int  m_roundIndex           = 0;
     bool m_battleFinished       = false;
     bool m_attackerHadFirstTurn = false;
@@ -172,6 +209,8 @@ private:
     LibraryGameRulesConstPtr          m_rules = nullptr;
     BattleCallbackSummon              m_battleCallbackSummon;
 
+    friend class BattleSandbox;
+
     struct ControlGuard {
         ControlGuard(BattleManager* parent);
         ~ControlGuard();
@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+#include "BattleSandbox.hpp"
+
+#include "IRandomGenerator.hpp"
+
+#include <cassert>
+
+namespace FreeHeroes::Core {
+
+BattleSandbox::BattleSandbox(const BattleManager& source)
+    : m_att(source.m_att.adventure, BattleStack::Side::Attacker)
+    , m_def(source.m_def.adventure, BattleStack::Side::Defender)
+    , m_rng(source.m_randomGenerator->clone())
+{
+    // battle machines are created by the caller before BattleManager, mirror that.
+    if (source.m_att.machineShoot)
+        m_att.createMachineShoot(source.m_att.machineShoot->adventure);
+    if (source.m_def.machineShoot)
+        m_def.createMachineShoot(source.m_def.machineShoot->adventure);
+
+    const BattleFieldPreset preset{ .obstacles = source.m_obstacles, .field = source.m_field, .layout = source.m_fieldLayout };
+
+    m_manager = std::make_unique<BattleManager>(m_att, m_def, preset, m_rng, source.m_rules, [](BattleStack::Side, LibraryUnitConstPtr, int) -> AdventureStackConstPtr {
+        assert(!"Summon casting is not expected in a sandbox");
+        return nullptr;
+    });
+
+    BattleState state;
+    source.saveState(state);
+    m_manager->restoreState(state);
+}
+
+BattleSandbox::~BattleSandbox() = default;
+
+}
@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+#pragma once
+
+#include "BattleLogicExport.hpp"
+
+#include "BattleManager.hpp"
+
+#include <memory>
+
+namespace FreeHeroes::Core {
+
+// Independent copy of a running battle for look-ahead: own armies, own BattleManager and random generator,
+// sharing only read-only adventure armies and game rules with the source. No notifiers are attached.
+// Stack statistics are estimated once on creation; restoreState() then copies only variable data.
+class BATTLELOGIC_EXPORT BattleSandbox {
+public:
+    explicit BattleSandbox(const BattleManager& source);
+    ~BattleSandbox();
+
+    BattleManager&    manager() noexcept { return *m_manager; }
+    IBattleView&      view() noexcept { return *m_manager; }
+    IRandomGenerator& rng() noexcept { return *m_rng; }
+
+private:
+    BattleArmy                        m_att;
+    BattleArmy                        m_def;
+    std::shared_ptr<IRandomGenerator> m_rng;
+    std::unique_ptr<BattleManager>    m_manager;
+};
+
+}
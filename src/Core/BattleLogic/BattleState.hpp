@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+#pragma once
+
+#include "BattleFieldPathFinder.hpp"
+#include "BattleStack.hpp"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace FreeHeroes::Core {
+
+// Value snapshot of everything BattleManager changes during the battle.
+// Stacks are stored in BattleManager creation order (squad stacks, battle machine, then summons),
+// other stacks are referenced by that index; static data (library, estimatedOnStart, obstacles) is not copied.
+struct BattleState {
+    struct Stack {
+        AdventureStackConstPtr adventure = nullptr; // to recreate summoned stacks.
+        BattleStack::Side      side      = BattleStack::Side::Attacker;
+
+        int                          count           = 0;
+        int                          health          = 0;
+        int                          remainingShoots = 0;
+        int                          castsDone       = 0;
+        int                          speedOrder      = 0;
+        int                          sameSpeedOrder  = 0;
+        BattleStack::RoundState      roundState;
+        BattlePositionExtended       pos;
+        BattleStack::EffectList      appliedEffects;
+        BattleStack::EstimatedParams current;
+        BattleFieldBitboard          cells;
+    };
+    struct Hero {
+        int  mana          = 0;
+        bool castedInRound = false;
+    };
+
+    std::vector<Stack>   stacks;
+    std::vector<uint8_t> alive;
+    std::vector<uint8_t> roundQueue;
+    std::vector<uint8_t> dirty; // changed after the last state update, see BattleManager::markDirty().
+    int                  current    = -1;
+    bool                 fullUpdate = false;
+
+    std::array<Hero, 2> heroes; // attacker, defender
+
+    int  roundIndex           = 0;
+    bool battleFinished       = false;
+    bool attackerHadFirstTurn = false;
+    bool defenderHadFirstTurn = false;
+
+    std::vector<uint8_t> rng; // IRandomGenerator::serialize()
+};
+
+}
@@ -0,0 +1,360 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+#include "SearchAI.hpp"
+
+#include "BattleManager.hpp"
+#include "BattleSandbox.hpp"
+#include "IRandomGenerator.hpp"
+
+#include "MernelExecution/ParallelExecutor.hpp"
+#include "MernelExecution/TaskQueue.hpp"
+#include "MernelPlatform/Logger.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <set>
+#include <sstream>
+
+namespace FreeHeroes::Core {
+using namespace Mernel;
+
+namespace {
+constexpr int64_t  g_valueMin   = std::numeric_limits<int64_t>::min() / 2;
+constexpr int64_t  g_valueMax   = std::numeric_limits<int64_t>::max() / 2;
+constexpr int64_t  g_valueScale = 100; // keeps fractional hp of valuable units.
+constexpr uint64_t g_seedBase   = 0x5EA2C4ULL;
+}
+
+struct SearchAI::Worker {
+    explicit Worker(const BattleManager& source)
+        : sandbox(source)
+    {}
+
+    BattleSandbox sandbox;
+    BattleState   root;
+
+    std::vector<BattleState>         states;  // per remaining depth
+    std::vector<std::vector<Action>> actions; // per remaining depth
+
+    int64_t nodes   = 0;
+    bool    aborted = false;
+};
+
+SearchAI::SearchAI(const AIParams& params, IBattleControl& battleControl, const BattleManager& battle, BattleFieldGeometry geometry)
+    : m_params(params)
+    , m_battleControl(battleControl)
+    , m_battle(battle)
+    , m_field(geometry)
+{
+    if (m_params.searchThreads > 1)
+        m_executor = std::make_unique<ParallelExecutor>(m_params.searchThreads);
+}
+
+SearchAI::~SearchAI() = default;
+
+int SearchAI::run(int stepLimit)
+{
+    const IBattleView& view = m_battle;
+    while (!view.isFinished() && stepLimit-- > 0) {
+        runStep();
+    }
+    return stepLimit;
+}
+
+void SearchAI::runStep()
+{
+    ProfilerDefaultContextSwitcher switcher(m_profileContext);
+    ProfilerScope                  mainScope("search step");
+    ScopeTimer                     timer;
+
+    const IBattleView& view = m_battle;
+    if (view.isFinished() || !view.getActiveStack())
+        return;
+
+    m_rootSide = view.getActiveStack()->side;
+    m_deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_params.searchTimeMs);
+
+    const size_t threads = std::max(1, m_params.searchThreads);
+    const int    depth   = std::max(1, m_params.searchDepth);
+    {
+        ProfilerScope scope("sandbox");
+        while (m_workers.size() < threads)
+            m_workers.push_back(std::make_unique<Worker>(m_battle));
+
+        BattleState root;
+        m_battle.saveState(root);
+        // look-ahead must not know real future rolls.
+        const uint64_t seed = g_seedBase + m_stepIndex++;
+        for (auto& worker : m_workers) {
+            BattleManager& manager = worker->sandbox.manager();
+            manager.restoreState(root);
+            worker->sandbox.rng().setSeed(seed);
+            manager.saveState(worker->root);
+            worker->states.resize(depth + 1);
+            worker->actions.resize(depth + 1);
+            worker->aborted = false;
+        }
+    }
+
+    std::vector<RootMove> moves;
+    {
+        std::vector<Action> actions;
+        generateActions(m_workers[0]->sandbox.view(), actions);
+        for (auto& action : actions)
+            moves.push_back({ action, 0 });
+    }
+
+    if (moves.size() > 1) {
+        ProfilerScope scope("search");
+        for (int iterationDepth = 1; iterationDepth <= depth; ++iterationDepth) {
+            std::vector<RootMove> iterationMoves = moves;
+            const size_t          stride         = std::min(threads, iterationMoves.size());
+            if (stride == 1) {
+                searchRoot(*m_workers[0], iterationMoves, 0, stride, iterationDepth);
+            } else {
+                TaskQueue taskQueue;
+                for (size_t t = 0; t < stride; ++t)
+                    taskQueue.addTask([this, t, stride, iterationDepth, &iterationMoves] { searchRoot(*m_workers[t], iterationMoves, t, stride, iterationDepth); });
+                m_executor->execQueue(taskQueue);
+            }
+
+            // the first iteration never checks time, so there is always some complete result.
+            const bool aborted = std::any_of(m_workers.cbegin(), m_workers.cend(), [](const auto& worker) { return worker->aborted; });
+            if (aborted)
+                break;
+
+            // best first for the next iteration, original generation order for equal values.
+            moves = std::move(iterationMoves);
+            std::stable_sort(moves.begin(), moves.end(), [](const RootMove& l, const RootMove& r) { return l.value > r.value; });
+            if (timeIsOver())
+                break;
+        }
+    }
+    for (auto& worker : m_workers) {
+        m_stats.nodes += worker->nodes;
+        worker->nodes = 0;
+    }
+
+    if (moves.empty()) {
+        m_battleControl.doGuard();
+    } else {
+        const Action& best = moves.front().action;
+        Logger() << "search AI: " << moves.size() << " actions, best value=" << moves.front().value;
+        // clang-format off
+        switch (best.type) {
+            case Action::Type::Wait       : m_battleControl.doWait(); break;
+            case Action::Type::MoveAttack : m_battleControl.doMoveAttack(best.moveParams, best.attackParams); break;
+            default                       : m_battleControl.doGuard(); break;
+        }
+        // clang-format on
+    }
+    m_stats.elapsedUS += timer.elapsedUS();
+}
+
+std::string SearchAI::getProfiling() const
+{
+    std::ostringstream os;
+    os << m_profileContext.printToStr();
+    os << "search nodes: " << m_stats.nodes << ", time: " << m_stats.elapsedUS << " us\n";
+    return os.str();
+}
+
+void SearchAI::clearProfiling()
+{
+    m_profileContext.clearAll();
+    m_stats = {};
+}
+
+IAI::SearchStats SearchAI::getSearchStats() const
+{
+    return m_stats;
+}
+
+void SearchAI::searchRoot(Worker& worker, std::vector<RootMove>& moves, size_t first, size_t stride, int depth) const
+{
+    BattleManager& manager = worker.sandbox.manager();
+    // root side is maximizing; moves searched by the same thread share alpha.
+    int64_t alpha = g_valueMin;
+    for (size_t i = first; i < moves.size(); i += stride) {
+        manager.restoreState(worker.root);
+        worker.nodes++;
+        if (!manager.applyAction(moves[i].action)) {
+            moves[i].value = g_valueMin;
+            continue;
+        }
+        moves[i].value = search(worker, depth - 1, alpha, g_valueMax);
+        if (worker.aborted)
+            return;
+        alpha = std::max(alpha, moves[i].value);
+    }
+}
+
+int64_t SearchAI::search(Worker& worker, int depth, int64_t alpha, int64_t beta) const
+{
+    worker.nodes++;
+    BattleManager&     manager = worker.sandbox.manager();
+    const IBattleView& view    = worker.sandbox.view();
+    if (depth == 0 || view.isFinished() || !view.getActiveStack())
+        return evaluate(view);
+
+    if (timeIsOver()) {
+        worker.aborted = true;
+        return 0;
+    }
+
+    // sides do not alternate strictly, each node decides by its active stack.
+    const bool maximize = view.getActiveStack()->side == m_rootSide;
+
+    std::vector<Action>& actions = worker.actions[depth];
+    BattleState&         state   = worker.states[depth];
+    generateActions(view, actions);
+    manager.saveState(state);
+
+    int64_t best    = maximize ? g_valueMin : g_valueMax;
+    bool    applied = false;
+    for (size_t i = 0; i < actions.size(); ++i) {
+        if (i > 0)
+            manager.restoreState(state);
+        if (!manager.applyAction(actions[i]))
+            continue;
+        applied = true;
+
+        const int64_t value = search(worker, depth - 1, alpha, beta);
+        if (worker.aborted)
+            return 0;
+        if (maximize) {
+            best  = std::max(best, value);
+            alpha = std::max(alpha, best);
+        } else {
+            best = std::min(best, value);
+            beta = std::min(beta, best);
+        }
+        if (alpha >= beta)
+            break;
+    }
+    if (!applied) {
+        manager.restoreState(state);
+        return evaluate(view);
+    }
+    return best;
+}
+
+void SearchAI::generateActions(const IBattleView& view, std::vector<Action>& actions) const
+{
+    actions.clear();
+    BattleStackConstPtr current = view.getActiveStack();
+    if (!current)
+        return;
+
+    const auto availableActions = view.getAvailableActions();
+
+    auto makeMoveAttack = [current](BattlePositionExtended moveTo, BattlePlanAttackParams attackParams) {
+        Action action;
+        action.type         = Action::Type::MoveAttack;
+        action.moveParams   = { moveTo, current->pos };
+        action.attackParams = attackParams;
+        return action;
+    };
+
+    std::vector<BattleStackConstPtr> opponents;
+    for (auto stack : view.getAllStacks(true)) {
+        if (stack->side != current->side)
+            opponents.push_back(stack);
+    }
+
+    if (availableActions.rangeAttack) {
+        for (auto opp : opponents) {
+            Action action = makeMoveAttack(current->pos, { opp->pos.mainPos() });
+            if (view.findPlanMove(action.moveParams, action.attackParams).isValid())
+                actions.push_back(action);
+        }
+    } else if (availableActions.move || availableActions.meleeAttack) {
+        const bool                      isWide   = current->library->traits.large;
+        const int                       speed    = current->current.primary.battleSpeed;
+        const BattlePositionDistanceMap reachNow = view.findDistances(current, speed);
+        BattlePositionDistanceMap       reachAtAll;
+
+        std::set<std::pair<BattlePosition, BattleStackConstPtr>> used;
+        std::set<BattlePosition>                                 usedMoves;
+        for (auto opp : opponents) {
+            bool                   canAttackNow = false;
+            int                    closestCells = -1;
+            BattlePositionExtended closestPos;
+            for (const auto& attackVariant : BattlePositionExtended::getAttackSuggestions(isWide, opp->library->traits.large)) {
+                BattlePlanAttackParams attackParams;
+                attackParams.m_attackTarget    = opp->pos.specificPos(attackVariant.second);
+                attackParams.m_attackDirection = attackVariant.first;
+
+                const auto attackFromPos = m_field.suggestPositionForAttack(current->pos, opp->pos, opp->pos.getPosSub(attackVariant.second), attackParams.m_attackDirection);
+                if (attackFromPos.isEmpty())
+                    continue;
+                const bool stayHere = attackFromPos == current->pos;
+                if (stayHere || reachNow.contains(attackFromPos.mainPos())) {
+                    if (!used.insert({ attackFromPos.mainPos(), opp }).second)
+                        continue;
+                    Action action = makeMoveAttack(attackFromPos, attackParams);
+                    if (!view.findPlanMove(action.moveParams, action.attackParams).isValid())
+                        continue;
+                    actions.push_back(action);
+                    canAttackNow = true;
+                    continue;
+                }
+                if (canAttackNow || !availableActions.move)
+                    continue;
+                if (reachAtAll.empty())
+                    reachAtAll = view.findDistances(current, -1);
+                auto it = reachAtAll.find(attackFromPos.mainPos());
+                if (it != reachAtAll.cend() && (closestCells < 0 || it->second < closestCells)) {
+                    closestCells = it->second;
+                    closestPos   = attackFromPos;
+                }
+            }
+            if (canAttackNow || closestCells < 0)
+                continue;
+
+            // approach: the farthest cell of the full path we can reach this turn.
+            BattlePlanMoveParams unlimitedParams{ closestPos, current->pos };
+            unlimitedParams.m_calculateUnlimitedPath = true;
+            const BattlePositionPath path            = view.findPlanMove(unlimitedParams, {}).m_walkPath;
+            for (int i = std::min(speed, static_cast<int>(path.size()) - 1); i >= 0; --i) {
+                const BattlePositionExtended moveTo = current->pos.moveMainTo(path[i]);
+                Action                       action = makeMoveAttack(moveTo, {});
+                if (!view.findPlanMove(action.moveParams, {}).isValid())
+                    continue;
+                if (usedMoves.insert(path[i]).second)
+                    actions.push_back(action);
+                break;
+            }
+        }
+    }
+    if (availableActions.wait && !current->roundState.waited) {
+        Action action;
+        action.type = Action::Type::Wait;
+        actions.push_back(action);
+    }
+    Action guard;
+    guard.type = Action::Type::Guard;
+    actions.push_back(guard);
+}
+
+int64_t SearchAI::evaluate(const IBattleView& view) const
+{
+    int64_t result = 0;
+    for (auto stack : view.getAllStacks(true)) {
+        const int64_t maxHealth = std::max(1, stack->current.primary.maxHealth);
+        const int64_t health    = (stack->count - 1) * maxHealth + stack->health;
+        const int64_t value     = stack->library->value * health * g_valueScale / maxHealth;
+        result += stack->side == m_rootSide ? value : -value;
+    }
+    return result;
+}
+
+bool SearchAI::timeIsOver() const
+{
+    return m_params.searchTimeMs > 0 && std::chrono::steady_clock::now() > m_deadline;
+}
+
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+#pragma once
+
+#include "IAI.hpp"
+#include "IBattleControl.hpp"
+#include "BattleField.hpp"
+#include "BattleReplay.hpp"
+#include "BattleState.hpp"
+
+#include "MernelPlatform/Profiler.hpp"
+
+#include <chrono>
+#include <memory>
+
+namespace Mernel {
+class ParallelExecutor;
+}
+
+namespace FreeHeroes::Core {
+
+class BattleManager;
+class IBattleView;
+
+// Depth-limited alpha-beta over BattleSandbox copies of the battle.
+// Chance (damage rolls, morale, luck) is determinized: every step is searched with its own fixed seed,
+// so look-ahead never sees real future rolls. Evaluation is remaining hp weighted by unit value.
+class SearchAI : public IAI {
+public:
+    SearchAI(const AIParams& params, IBattleControl& battleControl, const BattleManager& battle, BattleFieldGeometry geometry);
+    ~SearchAI();
+
+    int         run(int stepLimit) override;
+    void        runStep() override;
+    std::string getProfiling() const override;
+    void        clearProfiling() override;
+    SearchStats getSearchStats() const override;
+
+private:
+    using Action = BattleReplayData::EventRecord;
+    struct Worker;
+    struct RootMove {
+        Action  action;
+        int64_t value = 0;
+    };
+
+    void    searchRoot(Worker& worker, std::vector<RootMove>& moves, size_t first, size_t stride, int depth) const;
+    int64_t search(Worker& worker, int depth, int64_t alpha, int64_t beta) const;
+    void    generateActions(const IBattleView& view, std::vector<Action>& actions) const;
+    int64_t evaluate(const IBattleView& view) const;
+    bool    timeIsOver() const;
+
+private:
+    const AIParams m_params;
+
+    IBattleControl&           m_battleControl;
+    const BattleManager&      m_battle;
+    const BattleFieldGeometry m_field;
+
+    std::vector<std::unique_ptr<Worker>>      m_workers;
+    std::unique_ptr<Mernel::ParallelExecutor> m_executor; // created once, reused by every iteration of every step.
+    BattleStack::Side                         m_rootSide = BattleStack::Side::Attacker;
+    std::chrono::steady_clock::time_point     m_deadline;
+    uint64_t                                  m_stepIndex = 0;
+
+    SearchStats             m_stats;
+    Mernel::ProfilerContext m_profileContext;
+};
+
+}
@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+
+#include "Benchmarks.hpp"
+
+#include "IRandomGenerator.hpp"
+
+#include "RmgUtil/AstarGenerator.hpp"
+#include "RmgUtil/MapTileContainer.hpp"
+#include "RmgUtil/TemplateUtils.hpp"
+
+#include "MernelPlatform/Profiler.hpp"
+
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+
+namespace FreeHeroes::Benchmarks {
+
+namespace {
+
+// Previous AstarGenerator implementation (linear scan over open set), kept as a reference for timing and path identity.
+MapTilePtrList referenceFindPath(MapTilePtr source, MapTilePtr target, const MapTileRegion& nonCollision, bool useDiag, bool& success)
+{
+    struct Node {
+        uint64_t   m_G = 0, m_H = 0;
+        MapTilePtr m_pos    = nullptr;
+        Node*      m_parent = nullptr;
+
+        uint64_t getScore() const { return m_G + m_H; }
+    };
+    struct NodeSet {
+        using Vec = std::vector<std::shared_ptr<Node>>;
+        Vec                                   m_data;
+        std::unordered_map<MapTilePtr, Node*> m_used;
+
+        void add(std::shared_ptr<Node> node)
+        {
+            m_data.push_back(node);
+            m_used[node->m_pos] = node.get();
+        }
+        void erase(const Vec::iterator& it)
+        {
+            m_used.erase(it->get()->m_pos);
+            m_data.erase(it);
+        }
+        Node* find(MapTilePtr pos) const
+        {
+            auto it = m_used.find(pos);
+            return it == m_used.cend() ? nullptr : it->second;
+        }
+    };
+
+    success = false;
+    std::shared_ptr<Node> current;
+    NodeSet               openSet, closedSet;
+    openSet.add(std::make_shared<Node>(Node{ .m_pos = source }));
+
+    while (!openSet.m_data.empty()) {
+        auto current_it = openSet.m_data.begin();
+        current         = *current_it;
+        for (auto it = openSet.m_data.begin(); it != openSet.m_data.end(); it++) {
+            if ((*it)->getScore() <= current->getScore()) {
+                current    = *it;
+                current_it = it;
+            }
+        }
+        if (current->m_pos == target) {
+            success = true;
+            break;
+        }
+        closedSet.add(current);
+        openSet.erase(current_it);
+        Node* currentRaw = current.get();
+
+        auto applyCandidate = [&](uint64_t cost, MapTilePtr newCoordinates) {
+            if (!nonCollision.contains(newCoordinates) || closedSet.find(newCoordinates))
+                return;
+
+            const uint64_t totalCost    = currentRaw->m_G + cost;
+            Node*          successorRaw = openSet.find(newCoordinates);
+            if (successorRaw == nullptr) {
+                openSet.add(std::make_shared<Node>(Node{
+                    .m_G      = totalCost,
+                    .m_H      = static_cast<uint64_t>(posDistance(newCoordinates->m_pos, target->m_pos) * 10),
+                    .m_pos    = newCoordinates,
+                    .m_parent = currentRaw,
+                }));
+            } else if (totalCost < successorRaw->m_G) {
+                successorRaw->m_parent = currentRaw;
+                successorRaw->m_G      = totalCost;
+            }
+        };
+        for (MapTilePtr newCoordinates : currentRaw->m_pos->m_orthogonalNeighbours)
+            applyCandidate(10, newCoordinates);
+        if (useDiag) {
+            for (MapTilePtr newCoordinates : currentRaw->m_pos->m_diagNeighbours)
+                applyCandidate(14, newCoordinates);
+        }
+    }
+
+    MapTilePtrList path;
+    for (Node* node = current.get(); node != nullptr; node = node->m_parent)
+        path.push_back(node->m_pos);
+    return path;
+}
+
+}
+
+int benchmarkAstar(const BenchmarkContext& context)
+{
+    const int mapSize    = 252; // XL map
+    const int iterations = context.m_iterations > 0 ? context.m_iterations : 20;
+
+    MapTileContainer tileContainer;
+    tileContainer.init(mapSize, mapSize, 1);
+
+    auto rng = context.m_rngFactory->create();
+    rng->setSeed(42);
+
+    struct Query {
+        MapTilePtr    m_from = nullptr;
+        MapTilePtr    m_to   = nullptr;
+        MapTileRegion m_nonCollision;
+        bool          m_useDiag = true;
+    };
+    std::vector<Query> queries(iterations);
+    for (int i = 0; i < iterations; ++i) {
+        Query&        query       = queries[i];
+        const uint8_t obstaclePct = static_cast<uint8_t>(5 + (i % 4) * 10);
+        for (MapTilePtr tile : tileContainer.m_all) {
+            if (rng->genSmall(99) >= obstaclePct)
+                query.m_nonCollision.insert(tile);
+        }
+        query.m_from    = tileContainer.tileByIndex(rng->gen(tileContainer.getTileCount() - 1));
+        query.m_to      = tileContainer.tileByIndex(rng->gen(tileContainer.getTileCount() - 1));
+        query.m_useDiag = i % 3 != 0;
+        query.m_nonCollision.insert(query.m_from);
+        query.m_nonCollision.insert(query.m_to);
+    }
+
+    std::vector<MapTilePtrList> referencePaths(iterations), paths(iterations);
+    std::vector<bool>           referenceSuccess(iterations), success(iterations);
+
+    Mernel::ScopeTimer referenceTimer;
+    for (int i = 0; i < iterations; ++i) {
+        bool found          = false;
+        referencePaths[i]   = referenceFindPath(queries[i].m_from, queries[i].m_to, queries[i].m_nonCollision, queries[i].m_useDiag, found);
+        referenceSuccess[i] = found;
+    }
+    const int64_t referenceUS = std::max(int64_t(1), static_cast<int64_t>(referenceTimer.elapsedUS()));
+
+    Mernel::ScopeTimer timer;
+    for (int i = 0; i < iterations; ++i) {
+        AstarGenerator generator(queries[i].m_useDiag);
+        generator.setPoints(queries[i].m_from, queries[i].m_to);
+        generator.setNonCollision(queries[i].m_nonCollision);
+        paths[i]   = generator.findPath();
+        success[i] = generator.isSuccess();
+    }
+    const int64_t currentUS = std::max(int64_t(1), static_cast<int64_t>(timer.elapsedUS()));
+
+    int mismatches = 0, found = 0;
+    for (int i = 0; i < iterations; ++i) {
+        found += success[i];
+        if (paths[i] != referencePaths[i] || success[i] != referenceSuccess[i])
+            mismatches++;
+    }
+
+    context.m_output << "map: " << mapSize << "x" << mapSize << ", queries: " << iterations << ", found: " << found << "\n";
+    context.m_output << "reference (linear open set): " << referenceUS << " us.\n";
+    context.m_output << "current (binary heap): " << currentUS << " us.\n";
+    context.m_output << "speedup: x" << (static_cast<double>(referenceUS) / currentUS) << "\n";
+    if (mismatches) {
+        context.m_output << "Path mismatch in " << mismatches << " queries\n";
+        return 1;
+    }
+    return 0;
+}
+
+}
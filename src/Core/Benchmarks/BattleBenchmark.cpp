@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+
+#include "Benchmarks.hpp"
+
+#include "AdventureArmy.hpp"
+#include "AdventureEstimation.hpp"
+#include "BattleFieldPathFinder.hpp"
+#include "BattleManager.hpp"
+#include "IAI.hpp"
+
+#include "IGameDatabase.hpp"
+#include "IRandomGenerator.hpp"
+#include "LibraryTerrain.hpp"
+#include "LibraryUnit.hpp"
+
+#include "MernelPlatform/Profiler.hpp"
+
+#include <iostream>
+#include <random>
+
+namespace FreeHeroes::Benchmarks {
+using namespace Core;
+
+namespace {
+
+void fillSquad(AdventureSquad& squad, const std::vector<LibraryUnitConstPtr>& units, size_t offset)
+{
+    squad.stacks.clear();
+    for (size_t i = 0; i < 7 && offset + i < units.size(); ++i)
+        squad.stacks.push_back(AdventureStack(units[offset + i], 10 + static_cast<int>(i)));
+}
+
+int benchmarkFloodFill(const BenchmarkContext& context, const BattleFieldGeometry& geometry)
+{
+    const int iterations = context.m_iterations > 0 ? context.m_iterations * 100 : 100000;
+
+    // pregenerated fields so only the path finder is timed.
+    std::mt19937                   rng(0);
+    const BattlePositionSet        all = geometry.getAllPositions();
+    std::vector<BattlePositionSet> obstacleSets(64);
+    for (auto& obstacles : obstacleSets) {
+        for (auto pos : all) {
+            if (rng() % 5 == 0)
+                obstacles.insert(pos);
+        }
+    }
+
+    const BattleFieldMasks masks(geometry);
+    BattleFieldPathFinder  finder(masks);
+    int64_t                checksum = 0;
+    Mernel::ScopeTimer     timer;
+    for (int iter = 0; iter < iterations; ++iter) {
+        const BattlePosition start{ iter % geometry.width, (iter / geometry.width) % geometry.height };
+        finder.setObstacles(obstacleSets[iter % obstacleSets.size()]);
+        finder.floodFill(start);
+        checksum += finder.distanceTo({ geometry.width - 1 - start.x, geometry.height - 1 - start.y });
+        if (iter % 16 == 0)
+            checksum += finder.fromStartTo({ 0, 0 }).size();
+    }
+    const int64_t us = std::max(int64_t(1), static_cast<int64_t>(timer.elapsedUS()));
+    context.m_output << "flood fills: " << iterations << ", " << (iterations * 1000000LL / us) << " fills/sec (checksum " << checksum << ")\n";
+    return 0;
+}
+
+}
+
+int benchmarkBattle(const BenchmarkContext& context)
+{
+    const IGameDatabase* database = context.m_database;
+    BattleFieldPreset    fieldPreset;
+    fieldPreset.field = BattleFieldGeometry{ 15, 11 };
+
+    if (benchmarkFloodFill(context, fieldPreset.field))
+        return 1;
+
+    std::vector<LibraryUnitConstPtr> units;
+    for (auto* unit : database->units()->records()) {
+        if (!unit->battleMachineArtifact)
+            units.push_back(unit);
+    }
+    if (units.empty()) {
+        context.m_output << "No units in database\n";
+        return 1;
+    }
+    LibraryTerrainConstPtr terrain = database->terrains()->records()[0];
+
+    const int battles    = context.m_iterations > 0 ? context.m_iterations : 20;
+    const int stepLimit  = 1000;
+    int64_t   stepsTotal = 0;
+
+    Mernel::ScopeTimer timer;
+    for (int i = 0; i < battles; ++i) {
+        AdventureArmy attAdv, defAdv;
+        fillSquad(attAdv.squad, units, (i * 7) % units.size());
+        fillSquad(defAdv.squad, units, (units.size() / 2 + i * 7) % units.size());
+        AdventureEstimation(database).calculateArmy(attAdv, terrain);
+        AdventureEstimation(database).calculateArmy(defAdv, terrain);
+
+        BattleArmy att(&attAdv, BattleStack::Side::Attacker);
+        BattleArmy def(&defAdv, BattleStack::Side::Defender);
+
+        auto rng = context.m_rngFactory->create();
+        rng->setSeed(i);
+
+        BattleManager battle(att,
+                             def,
+                             fieldPreset,
+                             rng,
+                             database->gameRules(),
+                             [&attAdv, &defAdv, database, terrain](BattleStack::Side side, LibraryUnitConstPtr unit, int count) -> AdventureStackConstPtr {
+                                 auto&                    army   = side == BattleStack::Side::Attacker ? attAdv : defAdv;
+                                 AdventureStackMutablePtr result = army.squad.addHidden(unit, count);
+                                 AdventureEstimation(database).calculateArmySummon(army, terrain, result);
+                                 return result;
+                             });
+        IBattleView& battleView = battle;
+        battle.start();
+
+        auto aiAtt = battle.makeAI(IAI::AIParams{}, battle);
+        auto aiDef = battle.makeAI(IAI::AIParams{}, battle);
+        for (int step = 0; step < stepLimit && !battleView.isFinished(); ++step) {
+            IAI& ai = battleView.getCurrentSide() == BattleStack::Side::Attacker ? *aiAtt : *aiDef;
+            ai.runStep();
+            stepsTotal++;
+        }
+    }
+    const int64_t us = std::max(int64_t(1), static_cast<int64_t>(timer.elapsedUS()));
+    context.m_output << "battles: " << battles << ", AI steps: " << stepsTotal << ", " << (stepsTotal * 1000000LL / us) << " steps/sec\n";
+    return 0;
+}
+
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+
+#include "Benchmarks.hpp"
+
+#include "AdventureEstimation.hpp"
+#include "AdventureReplay.hpp"
+#include "BattleManager.hpp"
+#include "IAI.hpp"
+
+#include "IGameDatabase.hpp"
+#include "IRandomGenerator.hpp"
+#include "LibraryTerrain.hpp"
+#include "LibraryUnit.hpp"
+
+#include "MernelPlatform/Profiler.hpp"
+
+#include <iostream>
+
+namespace FreeHeroes::Benchmarks {
+using namespace Core;
+
+namespace {
+
+void fillSquad(AdventureSquad& squad, const std::vector<LibraryUnitConstPtr>& units, size_t offset)
+{
+    squad.stacks.clear();
+    for (size_t i = 0; i < 7 && offset + i < units.size(); ++i)
+        squad.stacks.push_back(AdventureStack(units[offset + i], 10 + static_cast<int>(i)));
+}
+
+// Battle created from adventure state copy, so the same game can be played many times.
+class GameSession {
+public:
+    GameSession(const BenchmarkContext& context, const AdventureState& source)
+        : m_adv(source)
+    {
+        const IGameDatabase* database = context.m_database;
+        AdventureEstimation(database).calculateArmy(m_adv.m_att, m_adv.m_terrain);
+        AdventureEstimation(database).calculateArmy(m_adv.m_def, m_adv.m_terrain);
+        m_att = std::make_unique<BattleArmy>(&m_adv.m_att, BattleStack::Side::Attacker);
+        m_def = std::make_unique<BattleArmy>(&m_adv.m_def, BattleStack::Side::Defender);
+
+        auto rng = context.m_rngFactory->create();
+        rng->setSeed(m_adv.m_seed);
+
+        m_battle = std::make_unique<BattleManager>(*m_att,
+                                                   *m_def,
+                                                   m_adv.m_field,
+                                                   rng,
+                                                   database->gameRules(),
+                                                   [this, database](BattleStack::Side side, LibraryUnitConstPtr unit, int count) -> AdventureStackConstPtr {
+                                                       auto&                    army   = side == BattleStack::Side::Attacker ? m_adv.m_att : m_adv.m_def;
+                                                       AdventureStackMutablePtr result = army.squad.addHidden(unit, count);
+                                                       AdventureEstimation(database).calculateArmySummon(army, m_adv.m_terrain, result);
+                                                       return result;
+                                                   });
+    }
+
+    BattleManager& battle() { return *m_battle; }
+
+private:
+    AdventureState                 m_adv;
+    std::unique_ptr<BattleArmy>    m_att;
+    std::unique_ptr<BattleArmy>    m_def;
+    std::unique_ptr<BattleManager> m_battle;
+};
+
+void recordGame(const BenchmarkContext& context, AdventureReplayData& game)
+{
+    const int stepLimit = 1000;
+
+    GameSession          session(context, game.m_adv);
+    BattleManager&       battle     = session.battle();
+    const IBattleView&   battleView = battle;
+    BattleReplayRecorder recorder(battle, game.m_bat);
+    battle.start();
+
+    auto aiAtt = battle.makeAI(IAI::AIParams{}, recorder);
+    auto aiDef = battle.makeAI(IAI::AIParams{}, recorder);
+    for (int step = 0; step < stepLimit && !battleView.isFinished(); ++step) {
+        IAI& ai = battleView.getCurrentSide() == BattleStack::Side::Attacker ? *aiAtt : *aiDef;
+        ai.runStep();
+    }
+}
+
+int64_t replayGame(const BenchmarkContext& context, AdventureReplayData& game, BattleManager::UpdateMode mode, size_t& verifyFailures)
+{
+    GameSession    session(context, game.m_adv);
+    BattleManager& battle = session.battle();
+    battle.setUpdateMode(mode);
+    battle.start();
+
+    int64_t            actions = 0;
+    BattleReplayPlayer player(battle, game.m_bat);
+    while (player.executeCurrent())
+        actions++;
+    verifyFailures += battle.getVerifyFailures();
+    return actions;
+}
+
+}
+
+int benchmarkBattleReplay(const BenchmarkContext& context)
+{
+    const IGameDatabase*             database = context.m_database;
+    std::vector<AdventureReplayData> games;
+    if (!context.m_input.empty()) {
+        games.resize(1);
+        if (!games[0].load(context.m_input, database)) {
+            context.m_output << "Failed to load replay: " << Mernel::path2string(context.m_input) << "\n";
+            return 1;
+        }
+    } else {
+        std::vector<LibraryUnitConstPtr> units;
+        for (auto* unit : database->units()->records()) {
+            if (!unit->battleMachineArtifact)
+                units.push_back(unit);
+        }
+        if (units.empty()) {
+            context.m_output << "No units in database\n";
+            return 1;
+        }
+        games.resize(10);
+        for (size_t i = 0; i < games.size(); ++i) {
+            AdventureState& adv = games[i].m_adv;
+            fillSquad(adv.m_att.squad, units, (i * 7) % units.size());
+            fillSquad(adv.m_def.squad, units, (units.size() / 2 + i * 7) % units.size());
+            adv.m_terrain     = database->terrains()->records()[0];
+            adv.m_seed        = i;
+            adv.m_field.field = BattleFieldGeometry{ 15, 11 };
+            recordGame(context, games[i]);
+        }
+    }
+
+    // cross-check is not timed: it does the full update anyway.
+    size_t verifyFailures = 0;
+    for (auto& game : games)
+        replayGame(context, game, BattleManager::UpdateMode::Verify, verifyFailures);
+    context.m_output << "games: " << games.size() << ", incremental update mismatches: " << verifyFailures << "\n";
+
+    const int iterations = context.m_iterations > 0 ? context.m_iterations : 5;
+    for (auto mode : { BattleManager::UpdateMode::Full, BattleManager::UpdateMode::Incremental }) {
+        int64_t            actionsTotal = 0;
+        Mernel::ScopeTimer timer;
+        for (int iter = 0; iter < iterations; ++iter) {
+            for (auto& game : games)
+                actionsTotal += replayGame(context, game, mode, verifyFailures);
+        }
+        const int64_t us = std::max(int64_t(1), static_cast<int64_t>(timer.elapsedUS()));
+        context.m_output << (mode == BattleManager::UpdateMode::Full ? "full update: " : "incremental update: ")
+                         << actionsTotal << " actions, " << (actionsTotal * 1000000LL / us) << " actions/sec\n";
+    }
+    return verifyFailures ? 1 : 0;
+}
+
+}
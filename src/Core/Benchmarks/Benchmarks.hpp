@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+#pragma once
+
+#include "MernelPlatform/FsUtils.hpp"
+
+#include <iosfwd>
+
+namespace FreeHeroes::Core {
+class IGameDatabaseContainer;
+class IGameDatabase;
+class IRandomGeneratorFactory;
+class IResourceLibrary;
+}
+
+namespace FreeHeroes::Benchmarks {
+
+struct BenchmarkContext {
+    const Core::IGameDatabaseContainer*  m_databaseContainer = nullptr;
+    const Core::IGameDatabase*           m_database          = nullptr;
+    const Core::IRandomGeneratorFactory* m_rngFactory        = nullptr;
+    const Core::IResourceLibrary*        m_resourceLibrary   = nullptr;
+
+    Mernel::std_path m_input;
+    int              m_iterations = 0;
+    std::ostream&    m_output;
+};
+
+int benchmarkEstimation(const BenchmarkContext& context);
+int benchmarkAstar(const BenchmarkContext& context);
+int benchmarkDistances(const BenchmarkContext& context);
+int benchmarkKMeans(const BenchmarkContext& context);
+int benchmarkDatabase(const BenchmarkContext& context);
+int benchmarkBattle(const BenchmarkContext& context);
+int benchmarkBattleReplay(const BenchmarkContext& context);
+int benchmarkSearch(const BenchmarkContext& context);
+
+}
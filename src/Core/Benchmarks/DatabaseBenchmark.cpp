@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+
+#include "Benchmarks.hpp"
+
+#include "GameDatabaseContainer.hpp"
+#include "GameDatabasePropertyWriter.hpp"
+#include "LibraryReflection.hpp"
+
+#include "MernelPlatform/Profiler.hpp"
+#include "MernelPlatform/PropertyTree.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+namespace FreeHeroes::Benchmarks {
+using namespace Core;
+
+namespace {
+
+template<class T>
+int countMismatches(const IGameDatabase* expected, const IGameDatabase* actual)
+{
+    const auto& expectedRecords = expected->container<T>()->records();
+    const auto& actualRecords   = actual->container<T>()->records();
+    if (expectedRecords.size() != actualRecords.size())
+        return 1;
+
+    int mismatches = 0;
+    for (size_t i = 0; i < expectedRecords.size(); ++i) {
+        Mernel::PropertyTree       expectedJson, actualJson;
+        PropertyTreeWriterDatabase writer;
+        writer.valueToJson(*expectedRecords[i], expectedJson);
+        writer.valueToJson(*actualRecords[i], actualJson);
+        if (expectedRecords[i]->id != actualRecords[i]->id || !(expectedJson == actualJson))
+            mismatches++;
+    }
+    return mismatches;
+}
+
+int countMismatches(const IGameDatabase* expected, const IGameDatabase* actual)
+{
+    return countMismatches<LibraryArtifact>(expected, actual)
+           + countMismatches<LibraryBuilding>(expected, actual)
+           + countMismatches<LibraryDwelling>(expected, actual)
+           + countMismatches<LibraryFaction>(expected, actual)
+           + countMismatches<LibraryHero>(expected, actual)
+           + countMismatches<LibraryHeroSpec>(expected, actual)
+           + countMismatches<LibraryMapBank>(expected, actual)
+           + countMismatches<LibraryMapObstacle>(expected, actual)
+           + countMismatches<LibraryMapVisitable>(expected, actual)
+           + countMismatches<LibraryObjectDef>(expected, actual)
+           + countMismatches<LibraryPlayer>(expected, actual)
+           + countMismatches<LibraryResource>(expected, actual)
+           + countMismatches<LibrarySecondarySkill>(expected, actual)
+           + countMismatches<LibrarySpell>(expected, actual)
+           + countMismatches<LibraryTerrain>(expected, actual)
+           + countMismatches<LibraryUnit>(expected, actual);
+}
+
+}
+
+int benchmarkDatabase(const BenchmarkContext& context)
+{
+    const int iterations = context.m_iterations > 0 ? context.m_iterations : 5;
+    const int jobs       = std::max(2, static_cast<int>(std::thread::hardware_concurrency()));
+
+    // Snapshot is warmed up first, so timings below are mostly records deserialization, not JSON parsing.
+    const Mernel::std_path snapshotDir = Mernel::std_fs::temp_directory_path() / "FreeHeroesBenchmarks" / "DatabaseSnapshot";
+
+    int result = 0;
+    for (GameVersion version : { GameVersion::SOD, GameVersion::HOTA }) {
+        const char* name = version == GameVersion::SOD ? "SOD" : "HOTA";
+        {
+            GameDatabaseContainer warmup(context.m_resourceLibrary, snapshotDir);
+            if (!warmup.getDatabase(version)) {
+                context.m_output << "Failed to load " << name << " database\n";
+                return 1;
+            }
+        }
+
+        int64_t sequentialUS = 0, parallelUS = 0;
+        int     mismatches = 0;
+        for (int i = 0; i < iterations; ++i) {
+            GameDatabaseContainer sequentialContainer(context.m_resourceLibrary, snapshotDir, 1);
+            GameDatabaseContainer parallelContainer(context.m_resourceLibrary, snapshotDir, jobs);
+
+            Mernel::ScopeTimer   sequentialTimer;
+            const IGameDatabase* sequentialDb = sequentialContainer.getDatabase(version);
+            sequentialUS += static_cast<int64_t>(sequentialTimer.elapsedUS());
+
+            Mernel::ScopeTimer   parallelTimer;
+            const IGameDatabase* parallelDb = parallelContainer.getDatabase(version);
+            parallelUS += static_cast<int64_t>(parallelTimer.elapsedUS());
+
+            if (!sequentialDb || !parallelDb || countMismatches(sequentialDb, parallelDb))
+                mismatches++;
+        }
+        sequentialUS = std::max(int64_t(1), sequentialUS / iterations);
+        parallelUS   = std::max(int64_t(1), parallelUS / iterations);
+
+        context.m_output << name << ", loads: " << iterations << "\n";
+        context.m_output << "  sequential: " << sequentialUS << " us.\n";
+        context.m_output << "  parallel (" << jobs << " jobs): " << parallelUS << " us.\n";
+        context.m_output << "  speedup: x" << (static_cast<double>(sequentialUS) / parallelUS) << "\n";
+        if (mismatches) {
+            context.m_output << "  Records mismatch in " << mismatches << " loads\n";
+            result = 1;
+        }
+    }
+    return result;
+}
+
+}
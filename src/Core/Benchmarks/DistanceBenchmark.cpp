@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+
+#include "Benchmarks.hpp"
+
+#include "IRandomGenerator.hpp"
+
+#include "FHTemplateProcessor.hpp"
+#include "MapConverter.hpp"
+
+#include "MernelPlatform/AppLocations.hpp"
+#include "MernelPlatform/Profiler.hpp"
+
+#include <iostream>
+#include <set>
+#include <sstream>
+
+namespace FreeHeroes::Benchmarks {
+
+namespace {
+
+using ReferenceCosts = std::map<MapTilePtr, int>;
+
+// Previous TileZone::makeMoveCosts/computeDistances implementation (ordered map as priority queue, std::set for visited tiles),
+// kept as a reference for timing and result identity.
+ReferenceCosts referenceMoveCosts(const TileZone& tileZone, bool onlyUsable)
+{
+    ReferenceCosts costs;
+    auto&          area = onlyUsable ? tileZone.m_innerAreaUsable.m_innerArea : tileZone.m_area.m_innerArea;
+    for (auto tile : area)
+        costs[tile] = 100;
+    for (const auto& [level, rarea] : tileZone.m_roads.m_byLevel) {
+        int cost = 80;
+        if (level == FHRoadType::Cobblestone)
+            cost = 20;
+        if (level == FHRoadType::Gravel)
+            cost = 40;
+        if (level == FHRoadType::Dirt)
+            cost = 60;
+        for (auto* tile : rarea)
+            costs[tile] = cost;
+    }
+    return costs;
+}
+
+TileZone::WeightTileMap referenceComputeDistances(const ReferenceCosts& costs, std::set<MapTilePtr> completed, std::set<MapTilePtr> remaining, int maxCost)
+{
+    std::set<MapTilePtr>    edgeSet = completed;
+    ReferenceCosts          resultDistance;
+    TileZone::WeightTileMap edge;
+    for (auto tile : completed)
+        edge[0].push_back(tile);
+
+    auto calcCost = [&costs](MapTilePtr one, MapTilePtr two, bool diag) -> int {
+        const int cost = std::max(costs.at(one), costs.at(two));
+        return diag ? cost * 141 / 100 : cost;
+    };
+
+    for (int i = 0; i < 10000 && !edge.empty(); ++i) {
+        const int            lowestCost      = edge.begin()->first;
+        const MapTilePtrList lowestCostTiles = edge.begin()->second;
+        edge.erase(edge.begin());
+        if (maxCost > 0 && lowestCost > maxCost)
+            continue;
+
+        for (auto tile : lowestCostTiles) {
+            resultDistance[tile] = lowestCost;
+            completed.insert(tile);
+            edgeSet.erase(tile);
+            remaining.erase(tile);
+        }
+        for (bool diag : { false, true }) {
+            for (auto tile : lowestCostTiles) {
+                auto& nlist = diag ? tile->m_diagNeighbours : tile->m_orthogonalNeighbours;
+                for (auto ntile : nlist) {
+                    if (completed.contains(ntile) || edgeSet.contains(ntile) || !remaining.contains(ntile))
+                        continue;
+                    const int cost = calcCost(tile, ntile, diag) + lowestCost;
+                    edgeSet.insert(ntile);
+                    edge[cost].push_back(ntile);
+                }
+            }
+        }
+    }
+
+    TileZone::WeightTileMap resultByDistance;
+    for (const auto& [tile, w] : resultDistance)
+        resultByDistance[w].push_back(tile);
+    return resultByDistance;
+}
+
+// Same inputs SegmentHelper::makeBorders and SegmentHelper::makeHeatMap pass.
+struct Query {
+    const TileZone* m_zone       = nullptr;
+    bool            m_onlyUsable = false;
+    MapTileRegion   m_completed;
+    MapTileRegion   m_remaining;
+    int             m_maxCost = -1;
+};
+
+}
+
+int benchmarkDistances(const BenchmarkContext& context)
+{
+    const int          iterations   = context.m_iterations > 0 ? context.m_iterations : 20;
+    const auto         templatePath = !context.m_input.empty() ? context.m_input : Mernel::AppLocations("FreeHeroes").getBinDir() / "gameResources" / "templates" / "jebus_balanced.json";
+    std::ostringstream log;
+
+    MapConverter converter(log, context.m_databaseContainer, context.m_rngFactory, MapConverter::Settings{ .m_inputs = { .m_fhTemplate = templatePath } });
+    try {
+        converter.run(MapConverter::Task::LoadFHTpl);
+    }
+    catch (std::exception& ex) {
+        context.m_output << "Failed to load template " << Mernel::path2string(templatePath) << ": " << ex.what() << "\n";
+        return 1;
+    }
+    FHMap& map     = converter.m_mapFH;
+    map.m_database = context.m_database;
+    map.rescaleToUserSize();
+
+    auto rng = context.m_rngFactory->create();
+    rng->setSeed(map.m_seed ? map.m_seed : 42);
+
+    FHTemplateProcessor processor(map, rng.get(), log, "HeatMap", "", "", 1000, false);
+    processor.run();
+
+    std::vector<Query> queries;
+    for (const TileZone& tileZone : processor.getTileZones()) {
+        queries.push_back(Query{
+            .m_zone       = &tileZone,
+            .m_onlyUsable = false,
+            .m_completed  = tileZone.m_protectionBorder,
+            .m_remaining  = tileZone.m_area.m_innerArea,
+            .m_maxCost    = 200,
+        });
+
+        MapTileRegion completed = tileZone.m_nodes.m_byLevel.contains(RoadLevel::Towns) ? tileZone.m_nodes.m_byLevel.at(RoadLevel::Towns) : MapTileRegion{};
+        completed.insert(tileZone.m_midTownNodes);
+        if (completed.empty() && tileZone.m_nodes.m_byLevel.contains(RoadLevel::Exits))
+            completed.insert(tileZone.m_nodes.m_byLevel.at(RoadLevel::Exits));
+        if (completed.empty())
+            completed.insert(tileZone.m_centroid);
+        queries.push_back(Query{
+            .m_zone       = &tileZone,
+            .m_onlyUsable = true,
+            .m_completed  = completed,
+            .m_remaining  = tileZone.m_innerAreaUsable.m_innerArea.diffWith(completed),
+        });
+    }
+
+    std::vector<TileZone::WeightTileMap> referenceResults(queries.size()), results(queries.size());
+
+    Mernel::ScopeTimer referenceTimer;
+    for (int i = 0; i < iterations; ++i) {
+        for (size_t q = 0; q < queries.size(); ++q) {
+            const Query& query = queries[q];
+            referenceResults[q] = referenceComputeDistances(referenceMoveCosts(*query.m_zone, query.m_onlyUsable),
+                                                            std::set<MapTilePtr>(query.m_completed.begin(), query.m_completed.end()),
+                                                            std::set<MapTilePtr>(query.m_remaining.begin(), query.m_remaining.end()),
+                                                            query.m_maxCost);
+        }
+    }
+    const int64_t referenceUS = std::max(int64_t(1), static_cast<int64_t>(referenceTimer.elapsedUS()));
+
+    Mernel::ScopeTimer timer;
+    for (int i = 0; i < iterations; ++i) {
+        for (size_t q = 0; q < queries.size(); ++q) {
+            const Query& query = queries[q];
+            results[q]         = TileZone::computeDistances(query.m_zone->makeMoveCosts(query.m_onlyUsable), query.m_completed, query.m_remaining, query.m_maxCost);
+        }
+    }
+    const int64_t currentUS = std::max(int64_t(1), static_cast<int64_t>(timer.elapsedUS()));
+
+    int mismatches = 0;
+    for (size_t q = 0; q < queries.size(); ++q) {
+        if (results[q] != referenceResults[q])
+            mismatches++;
+    }
+
+    context.m_output << "template: " << Mernel::path2string(templatePath) << ", zones: " << processor.getTileZones().size() << ", queries: " << queries.size() << " x " << iterations << "\n";
+    context.m_output << "reference (map queue, std::set): " << referenceUS << " us.\n";
+    context.m_output << "current (bucket queue, bitsets): " << currentUS << " us.\n";
+    context.m_output << "speedup: x" << (static_cast<double>(referenceUS) / currentUS) << "\n";
+    if (mismatches) {
+        context.m_output << "Distance mismatch in " << mismatches << " queries\n";
+        return 1;
+    }
+    return 0;
+}
+
+}
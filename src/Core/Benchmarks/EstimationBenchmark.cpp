@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+
+#include "Benchmarks.hpp"
+
+#include "AdventureEstimation.hpp"
+#include "AdventureReplay.hpp"
+#include "BattleEstimation.hpp"
+#include "EstimationScriptRuntime.hpp"
+
+#include "IGameDatabase.hpp"
+#include "LibraryGameRules.hpp"
+#include "LibrarySpell.hpp"
+#include "LibraryTerrain.hpp"
+
+#include "MernelPlatform/Profiler.hpp"
+
+#include <iostream>
+
+namespace FreeHeroes::Benchmarks {
+using namespace Core;
+
+namespace {
+
+void fillSquad(AdventureSquad& squad, const std::vector<LibraryUnitConstPtr>& units, size_t offset)
+{
+    squad.stacks.clear();
+    for (size_t i = 0; i < 7 && offset + i < units.size(); ++i)
+        squad.stacks.push_back(AdventureStack(units[offset + i], 10 + static_cast<int>(i)));
+}
+
+}
+
+int benchmarkEstimation(const BenchmarkContext& context)
+{
+    const IGameDatabase* database = context.m_database;
+
+    AdventureReplayData replayData;
+    if (!context.m_input.empty()) {
+        if (!replayData.load(context.m_input, database)) {
+            context.m_output << "Failed to load replay: " << Mernel::path2string(context.m_input) << "\n";
+            return 1;
+        }
+    } else {
+        std::vector<LibraryUnitConstPtr> units;
+        for (auto* unit : database->units()->records()) {
+            if (!unit->battleMachineArtifact)
+                units.push_back(unit);
+        }
+        fillSquad(replayData.m_adv.m_att.squad, units, 0);
+        fillSquad(replayData.m_adv.m_def.squad, units, units.size() / 2);
+        replayData.m_adv.m_terrain = database->terrains()->records()[0];
+    }
+    AdventureEstimation(database).calculateArmy(replayData.m_adv.m_att, replayData.m_adv.m_terrain);
+    AdventureEstimation(database).calculateArmy(replayData.m_adv.m_def, replayData.m_adv.m_terrain);
+
+    BattleArmy        att(&replayData.m_adv.m_att, BattleStack::Side::Attacker);
+    BattleArmy        def(&replayData.m_adv.m_def, BattleStack::Side::Defender);
+    BattleEnvironment env;
+    BattleEstimation  estimation(database->gameRules());
+    estimation.calculateEnvironmentOnBattleStart(env, att, def);
+    estimation.calculateArmyOnBattleStart(def, att, env);
+    estimation.calculateArmyOnBattleStart(att, def, env);
+
+    // buffs and debuffs make calculateUnitStats actually run scripts.
+    std::vector<LibrarySpellConstPtr> effectSpells;
+    for (auto* spell : database->spells()->records()) {
+        if (spell->qualify != LibrarySpell::Qualify::None && !spell->calcScript.empty() && spell->hasEndCondition(LibrarySpell::EndCondition::Time))
+            effectSpells.push_back(spell);
+    }
+
+    std::vector<BattleStack*> stacks;
+    for (BattleArmy* army : { &att, &def }) {
+        for (auto& stack : army->squad->stacks)
+            stacks.push_back(&stack);
+    }
+    for (size_t i = 0; i < stacks.size() && !effectSpells.empty(); ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            SpellCastParams params;
+            params.spell      = effectSpells[(i * 3 + j) % effectSpells.size()];
+            params.skillLevel = static_cast<int>(j);
+            stacks[i]->appliedEffects.push_back(BattleStack::Effect(params, 3));
+        }
+    }
+    if (stacks.empty()) {
+        context.m_output << "No stacks to estimate\n";
+        return 1;
+    }
+
+    const int iterations = context.m_iterations > 0 ? context.m_iterations : 2000;
+
+    auto runMode = [&](EstimationScriptRuntime::Mode mode, int64_t& checksum) -> double {
+        EstimationScriptRuntime::setMode(mode);
+        checksum = 0;
+        Mernel::ScopeTimer timer;
+        for (int iter = 0; iter < iterations; ++iter) {
+            for (BattleStack* stack : stacks) {
+                estimation.calculateUnitStats(*stack);
+                const auto& primary = stack->current.primary;
+                checksum += primary.ad.attack + primary.ad.defense + primary.battleSpeed + primary.maxHealth;
+            }
+        }
+        const int64_t us = std::max(int64_t(1), static_cast<int64_t>(timer.elapsedUS()));
+        return static_cast<double>(iterations) * stacks.size() * 1000000.0 / us;
+    };
+
+    int64_t      checksumUncached = 0, checksumCached = 0;
+    const double rateUncached = runMode(EstimationScriptRuntime::Mode::Uncached, checksumUncached);
+    const double rateCached   = runMode(EstimationScriptRuntime::Mode::Cached, checksumCached);
+    EstimationScriptRuntime::setMode(EstimationScriptRuntime::Mode::Cached);
+
+    context.m_output << "stacks: " << stacks.size() << ", effect spells: " << effectSpells.size() << ", iterations: " << iterations << "\n";
+    context.m_output << "uncached (new state per call): " << static_cast<int64_t>(rateUncached) << " recalcs/sec\n";
+    context.m_output << "cached (thread state, compiled scripts): " << static_cast<int64_t>(rateCached) << " recalcs/sec\n";
+    context.m_output << "speedup: x" << (rateCached / rateUncached) << "\n";
+    if (checksumCached != checksumUncached) {
+        context.m_output << "Result mismatch between modes: " << checksumUncached << " != " << checksumCached << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+}
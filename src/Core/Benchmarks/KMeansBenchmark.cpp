@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+
+#include "Benchmarks.hpp"
+
+#include "IRandomGenerator.hpp"
+
+#include "RmgUtil/MapTileContainer.hpp"
+#include "RmgUtil/MapTileRegionSegmentation.hpp"
+#include "RmgUtil/TemplateUtils.hpp"
+
+#include "MernelPlatform/Profiler.hpp"
+
+#include <iostream>
+#include <set>
+
+namespace FreeHeroes::Benchmarks {
+
+namespace {
+
+// Previous MapTileRegionSegmentation::splitByKExt implementation (cluster loop for every tile, intSqrt for every tile/cluster pair),
+// kept as a reference for timing and result identity.
+MapTileRegionList referenceSplitByKExt(const MapTileRegion& region, const KMeansSegmentationSettings& settingsList, size_t iterLimit)
+{
+    struct Cluster {
+        KMeansSegmentationSettings::Item m_settings;
+
+        FHPos                m_extraMassPoint;
+        FHPos                m_centroid;
+        FHPos                m_centerMass;
+        MapTilePtrSortedList m_points;
+        size_t               m_pointsCount    = 0;
+        int64_t              m_radiusPromille = 0;
+
+        int64_t distanceTo(MapTilePtr point) const
+        {
+            const auto    dx                      = int64_t(m_centroid.m_x - point->m_pos.m_x) * 1000;
+            const auto    dy                      = int64_t(m_centroid.m_y - point->m_pos.m_y) * 1000;
+            const int64_t linearDistancePromille  = intSqrt(dx * dx + dy * dy);
+            const int64_t distanceToCircumference = linearDistancePromille - m_radiusPromille;
+            const bool    isInside                = (distanceToCircumference <= 0);
+            const int64_t innerDistance           = isInside ? linearDistancePromille : m_radiusPromille;
+            const int64_t outerDistance           = isInside ? 0 : distanceToCircumference;
+            return innerDistance * m_settings.m_insideWeight + outerDistance * m_settings.m_outsideWeight;
+        }
+    };
+
+    if (region.empty())
+        return {};
+    const size_t K = settingsList.m_items.size();
+    if (K == 1)
+        return { region };
+
+    const MapTileContainer* container = region[0]->m_container;
+    std::vector<Cluster>    clusters(K);
+    for (size_t i = 0; i < K; i++) {
+        const auto& setting = settingsList.m_items[i];
+        Cluster&    cluster = clusters[i];
+        cluster.m_settings  = setting;
+        if (setting.m_extraMassPoint)
+            cluster.m_extraMassPoint = setting.m_extraMassPoint->m_pos;
+        cluster.m_centroid       = setting.m_initialCentroid->m_pos;
+        cluster.m_radiusPromille = MapTileRegionSegmentation::getRadiusPromille(setting.m_areaHint) / 2;
+    }
+
+    std::vector<size_t> nearestIndex(region.size(), size_t(-1));
+    for (size_t iter = 0; iter < iterLimit; ++iter) {
+        const bool last = iter == iterLimit - 1;
+
+        // fix repeated centroids
+        bool            hasIntersections = false;
+        std::set<FHPos> used;
+        for (const Cluster& cluster : clusters) {
+            if (!used.insert(cluster.m_centroid).second || !region.contains(container->at(cluster.m_centroid))) {
+                hasIntersections = true;
+                break;
+            }
+        }
+        if (hasIntersections) {
+            MapTileRegion rest = region;
+            for (Cluster& cluster : clusters) {
+                MapTilePtr tile = rest.findClosestPoint(cluster.m_centroid);
+                rest.erase(tile);
+                cluster.m_centroid = tile->m_pos;
+            }
+        }
+
+        bool done = true;
+        for (size_t i = 0; MapTilePtr tile : region) {
+            int64_t minDist = clusters[0].distanceTo(tile);
+            size_t  nearest = 0;
+            for (size_t k = 1; k < K; k++) {
+                const int64_t dist = clusters[k].distanceTo(tile);
+                if (dist < minDist) {
+                    minDist = dist;
+                    nearest = k;
+                }
+            }
+            done              = done && nearestIndex[i] == nearest;
+            nearestIndex[i++] = nearest;
+        }
+
+        for (Cluster& cluster : clusters) {
+            cluster.m_centerMass.m_x = cluster.m_settings.m_extraMassWeight * cluster.m_extraMassPoint.m_x;
+            cluster.m_centerMass.m_y = cluster.m_settings.m_extraMassWeight * cluster.m_extraMassPoint.m_y;
+            cluster.m_pointsCount    = cluster.m_settings.m_extraMassWeight;
+            cluster.m_points.clear();
+        }
+        for (size_t i = 0; MapTilePtr tile : region) {
+            Cluster& cluster = clusters[nearestIndex[i++]];
+            cluster.m_centerMass.m_x += tile->m_pos.m_x;
+            cluster.m_centerMass.m_y += tile->m_pos.m_y;
+            cluster.m_pointsCount++;
+            if (done || last)
+                cluster.m_points.push_back(tile);
+        }
+        for (Cluster& cluster : clusters) {
+            if (!cluster.m_pointsCount)
+                throw std::runtime_error("no points");
+            cluster.m_centerMass.m_x /= cluster.m_pointsCount;
+            cluster.m_centerMass.m_y /= cluster.m_pointsCount;
+            cluster.m_centerMass.m_z = cluster.m_centroid.m_z;
+            cluster.m_centroid       = cluster.m_centerMass;
+        }
+        if (done)
+            break;
+    }
+
+    MapTileRegionList result(K);
+    for (size_t i = 0; i < K; i++)
+        result[i] = MapTileRegion(clusters[i].m_points);
+    return result;
+}
+
+}
+
+int benchmarkKMeans(const BenchmarkContext& context)
+{
+    const int mapSize    = 144; // L map
+    const int iterations = context.m_iterations > 0 ? context.m_iterations : 50;
+
+    MapTileContainer tileContainer;
+    tileContainer.init(mapSize, mapSize, 1);
+
+    auto rng = context.m_rngFactory->create();
+    rng->setSeed(42);
+
+    // zone-sized regions split into segments, as zone placement does.
+    struct Query {
+        MapTileRegion              m_region;
+        KMeansSegmentationSettings m_settings;
+    };
+    std::vector<Query> queries(iterations);
+    for (int i = 0; i < iterations; ++i) {
+        Query&        query   = queries[i];
+        const int     width   = 30 + rng->genSmall(40);
+        const int     height  = 30 + rng->genSmall(40);
+        const int     x0      = rng->genSmall(static_cast<uint8_t>(mapSize - width));
+        const int     y0      = rng->genSmall(static_cast<uint8_t>(mapSize - height));
+        const uint8_t density = static_cast<uint8_t>(60 + (i % 5) * 10);
+        for (MapTilePtr tile : tileContainer.m_all) {
+            const FHPos& pos = tile->m_pos;
+            if (pos.m_x >= x0 && pos.m_x < x0 + width && pos.m_y >= y0 && pos.m_y < y0 + height && rng->genSmall(99) < density)
+                query.m_region.insert(tile);
+        }
+        const size_t k = 4 + rng->genSmall(12);
+        query.m_settings.m_items.resize(k);
+        for (size_t j = 0; j < k; ++j) {
+            query.m_settings.m_items[j].m_initialCentroid = query.m_region[j * query.m_region.size() / k];
+            query.m_settings.m_items[j].m_areaHint        = query.m_region.size() / k;
+        }
+    }
+
+    std::vector<MapTileRegionList> referenceResults(iterations), results(iterations);
+    std::vector<bool>              referenceFailed(iterations), failed(iterations);
+
+    Mernel::ScopeTimer referenceTimer;
+    for (int i = 0; i < iterations; ++i) {
+        try {
+            referenceResults[i] = referenceSplitByKExt(queries[i].m_region, queries[i].m_settings, 100);
+        }
+        catch (std::exception&) {
+            referenceFailed[i] = true;
+        }
+    }
+    const int64_t referenceUS = std::max(int64_t(1), static_cast<int64_t>(referenceTimer.elapsedUS()));
+
+    Mernel::ScopeTimer timer;
+    for (int i = 0; i < iterations; ++i) {
+        try {
+            results[i] = MapTileRegionSegmentation::splitByKExt(queries[i].m_region, queries[i].m_settings, 100);
+        }
+        catch (std::exception&) {
+            failed[i] = true;
+        }
+    }
+    const int64_t currentUS = std::max(int64_t(1), static_cast<int64_t>(timer.elapsedUS()));
+
+    int mismatches = 0;
+    for (int i = 0; i < iterations; ++i) {
+        if (results[i] != referenceResults[i] || failed[i] != referenceFailed[i])
+            mismatches++;
+    }
+
+    context.m_output << "map: " << mapSize << "x" << mapSize << ", regions: " << iterations << "\n";
+    context.m_output << "reference (per-tile cluster loop): " << referenceUS << " us.\n";
+    context.m_output << "current (SoA kernel, sqrt table): " << currentUS << " us.\n";
+    context.m_output << "speedup: x" << (static_cast<double>(referenceUS) / currentUS) << "\n";
+    if (mismatches) {
+        context.m_output << "Segmentation mismatch in " << mismatches << " regions\n";
+        return 1;
+    }
+    return 0;
+}
+
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+
+#include "Benchmarks.hpp"
+
+#include "AdventureArmy.hpp"
+#include "AdventureEstimation.hpp"
+#include "BattleManager.hpp"
+#include "IAI.hpp"
+
+#include "IGameDatabase.hpp"
+#include "IRandomGenerator.hpp"
+#include "LibraryTerrain.hpp"
+#include "LibraryUnit.hpp"
+
+#include "MernelPlatform/Profiler.hpp"
+
+#include <iostream>
+
+namespace FreeHeroes::Benchmarks {
+using namespace Core;
+
+namespace {
+
+void fillSquad(AdventureSquad& squad, const std::vector<LibraryUnitConstPtr>& units, size_t offset)
+{
+    squad.stacks.clear();
+    for (size_t i = 0; i < 7; ++i)
+        squad.stacks.push_back(AdventureStack(units[(offset + i) % units.size()], 10 + static_cast<int>(i)));
+}
+
+struct MatchResult {
+    bool    finished     = false;
+    bool    searchWon    = false;
+    int64_t nodes        = 0;
+    int64_t searchUS     = 0;
+    int64_t defaultUS    = 0;
+    int     searchSteps  = 0;
+    int     defaultSteps = 0;
+};
+
+MatchResult playMatch(const BenchmarkContext& context, const std::vector<LibraryUnitConstPtr>& units, LibraryTerrainConstPtr terrain, int index, BattleStack::Side searchSide)
+{
+    const IGameDatabase* database = context.m_database;
+    BattleFieldPreset    fieldPreset;
+    fieldPreset.field = BattleFieldGeometry{ 15, 11 };
+
+    AdventureArmy attAdv, defAdv;
+    fillSquad(attAdv.squad, units, (index * 7) % units.size());
+    fillSquad(defAdv.squad, units, (units.size() / 2 + index * 7) % units.size());
+    AdventureEstimation(database).calculateArmy(attAdv, terrain);
+    AdventureEstimation(database).calculateArmy(defAdv, terrain);
+
+    BattleArmy att(&attAdv, BattleStack::Side::Attacker);
+    BattleArmy def(&defAdv, BattleStack::Side::Defender);
+
+    auto rng = context.m_rngFactory->create();
+    rng->setSeed(index);
+
+    BattleManager battle(att,
+                         def,
+                         fieldPreset,
+                         rng,
+                         database->gameRules(),
+                         [&attAdv, &defAdv, database, terrain](BattleStack::Side side, LibraryUnitConstPtr unit, int count) -> AdventureStackConstPtr {
+                             auto&                    army   = side == BattleStack::Side::Attacker ? attAdv : defAdv;
+                             AdventureStackMutablePtr result = army.squad.addHidden(unit, count);
+                             AdventureEstimation(database).calculateArmySummon(army, terrain, result);
+                             return result;
+                         });
+    IBattleView& battleView = battle;
+    battle.start();
+
+    IAI::AIParams searchParams;
+    searchParams.searchDepth  = 3;
+    searchParams.searchTimeMs = 100;
+    auto aiSearch             = battle.makeAI(searchParams, battle);
+    auto aiDefault            = battle.makeAI(IAI::AIParams{}, battle);
+
+    MatchResult result;
+    for (int step = 0; step < 1000 && !battleView.isFinished(); ++step) {
+        const bool         searchTurn = battleView.getCurrentSide() == searchSide;
+        Mernel::ScopeTimer timer;
+        (searchTurn ? aiSearch : aiDefault)->runStep();
+        (searchTurn ? result.searchUS : result.defaultUS) += static_cast<int64_t>(timer.elapsedUS());
+        (searchTurn ? result.searchSteps : result.defaultSteps)++;
+    }
+    result.finished = battleView.isFinished();
+    for (auto stack : battleView.getAllStacks(true)) {
+        if (stack->side == searchSide)
+            result.searchWon = true;
+    }
+    result.searchWon = result.finished && result.searchWon;
+    result.nodes     = aiSearch->getSearchStats().nodes;
+    return result;
+}
+
+}
+
+int benchmarkSearch(const BenchmarkContext& context)
+{
+    const IGameDatabase* database = context.m_database;
+
+    std::vector<LibraryUnitConstPtr> units;
+    for (auto* unit : database->units()->records()) {
+        if (!unit->battleMachineArtifact)
+            units.push_back(unit);
+    }
+    if (units.empty()) {
+        context.m_output << "No units in database\n";
+        return 1;
+    }
+    LibraryTerrainConstPtr terrain = database->terrains()->records()[0];
+
+    // every army pair is played twice with search AI on each side, so equal strength gives 50%.
+    const int   battles = context.m_iterations > 0 ? context.m_iterations : 10;
+    int         wins = 0, losses = 0, unfinished = 0;
+    MatchResult total;
+    for (int i = 0; i < battles; ++i) {
+        for (auto side : { BattleStack::Side::Attacker, BattleStack::Side::Defender }) {
+            const MatchResult match = playMatch(context, units, terrain, i, side);
+            if (!match.finished)
+                unfinished++;
+            else if (match.searchWon)
+                wins++;
+            else
+                losses++;
+            total.nodes += match.nodes;
+            total.searchUS += match.searchUS;
+            total.defaultUS += match.defaultUS;
+            total.searchSteps += match.searchSteps;
+            total.defaultSteps += match.defaultSteps;
+        }
+    }
+    const int     games    = battles * 2;
+    const int64_t searchUS = std::max(int64_t(1), total.searchUS);
+    context.m_output << "search AI vs default AI: " << games << " battles, won " << wins << ", lost " << losses << ", unfinished " << unfinished
+                     << " (win rate " << (wins * 100 / games) << "%)\n";
+    context.m_output << "search nodes: " << total.nodes << ", " << (total.nodes * 1000000LL / searchUS) << " nodes/sec\n";
+    context.m_output << "step time: search " << (total.searchUS / std::max(1, total.searchSteps)) << " us, default "
+                     << (total.defaultUS / std::max(1, total.defaultSteps)) << " us\n";
+    return 0;
+}
+
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+
+#include "Benchmarks.hpp"
+
+#include "CoreApplication.hpp"
+#include "IGameDatabase.hpp"
+
+#include "MernelPlatform/CommandLineUtils.hpp"
+
+#include <iostream>
+#include <map>
+
+using namespace FreeHeroes;
+using namespace Mernel;
+
+int main(int argc, char** argv)
+{
+    using BenchmarkFunc = int (*)(const Benchmarks::BenchmarkContext&);
+
+    const std::map<std::string, BenchmarkFunc> benchmarks{
+        { "astar", &Benchmarks::benchmarkAstar },
+        { "battle", &Benchmarks::benchmarkBattle },
+        { "database", &Benchmarks::benchmarkDatabase },
+        { "distances", &Benchmarks::benchmarkDistances },
+        { "estimation", &Benchmarks::benchmarkEstimation },
+        { "kmeans", &Benchmarks::benchmarkKMeans },
+        { "replay", &Benchmarks::benchmarkBattleReplay },
+        { "search", &Benchmarks::benchmarkSearch },
+    };
+
+    AbstractCommandLine parser({
+                                   "db",
+                                   "input",
+                                   "iterations",
+                                   "logging-level",
+                               },
+                               { "benchmarks" });
+    parser.markRequired({ "benchmarks" });
+    if (!parser.parseArgs(std::cerr, argc, argv)) {
+        std::cerr << "Benchmarks invocation failed, correct usage is:\n";
+        std::cerr << parser.getHelp();
+        std::cerr << "Available benchmarks:";
+        for (const auto& [name, func] : benchmarks)
+            std::cerr << " " << name;
+        std::cerr << "\n";
+        return 1;
+    }
+
+    const std::string dbStr           = parser.getArg("db");
+    const std::string iterationsStr   = parser.getArg("iterations");
+    const std::string loggingLevelStr = parser.getArg("logging-level");
+    const int         loggingLevel    = loggingLevelStr.empty() ? 3 : std::strtoull(loggingLevelStr.c_str(), nullptr, 10);
+
+    Core::CoreApplication fhCoreApp;
+    fhCoreApp.initLogger(loggingLevel);
+    if (!fhCoreApp.load())
+        return 1;
+
+    const Core::IGameDatabase* database = fhCoreApp.getDatabaseContainer()->getDatabase({ dbStr.empty() ? std::string(Core::g_database_HOTA) : dbStr });
+    if (!database) {
+        std::cerr << "Failed to load database '" << dbStr << "'\n";
+        return 1;
+    }
+
+    Benchmarks::BenchmarkContext context{
+        .m_databaseContainer = fhCoreApp.getDatabaseContainer(),
+        .m_database          = database,
+        .m_rngFactory        = fhCoreApp.getRandomGeneratorFactory(),
+        .m_resourceLibrary   = fhCoreApp.getResourceLibrary(),
+        .m_input             = string2path(parser.getArg("input")),
+        .m_iterations        = iterationsStr.empty() ? 0 : std::atoi(iterationsStr.c_str()),
+        .m_output            = std::cout,
+    };
+
+    int result = 0;
+    for (const std::string& name : parser.getMultiArg("benchmarks")) {
+        auto it = benchmarks.find(name);
+        if (it == benchmarks.cend()) {
+            std::cerr << "Unknown benchmark: " << name << "\n";
+            return 1;
+        }
+        std::cout << "== " << name << "\n";
+        result = it->second(context) || result;
+    }
+
+    return result;
+}
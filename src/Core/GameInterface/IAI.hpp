@@ -5,6 +5,7 @@
  */
 #pragma once
 
+#include <cstdint>
 #include <string>
 
 namespace FreeHeroes::Core {
@@ -21,6 +22,16 @@ public:
         int64_t retaliationDamageWeight = -1;
         int64_t extraKillsMultiply      = 2;
         int64_t blockShooterMultiply    = 3;
+
+        // searchDepth > 0 selects alpha-beta look-ahead on battle copies instead of one-ply evaluation;
+        // iterative deepening stops at searchDepth actions or when searchTimeMs per step is spent (0 = no limit).
+        int searchDepth   = 0;
+        int searchTimeMs  = 0;
+        int searchThreads = 1; // root actions are split between threads, each with own battle copy.
+    };
+    struct SearchStats {
+        int64_t nodes     = 0;
+        int64_t elapsedUS = 0;
     };
 
     virtual int  run(int stepLimit) = 0;
@@ -28,6 +39,8 @@ public:
 
     virtual std::string getProfiling() const = 0;
     virtual void        clearProfiling()     = 0;
+
+    virtual SearchStats getSearchStats() const { return {}; }
 };
 
 }
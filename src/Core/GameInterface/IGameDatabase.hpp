@@ -128,7 +128,8 @@ public:
     // load these and only these.
     using DbOrder = std::vector<std::string>;
 
-    [[nodiscard]] virtual const IGameDatabase* getDatabase(const DbOrder& dbIndexFilesList, const Mernel::PropertyTree& customSegmentData) const noexcept = 0;
+    // database with customSegmentData merged on top; shared between callers with equal patch and released with the last owner.
+    [[nodiscard]] virtual std::shared_ptr<const IGameDatabase> getDatabase(const DbOrder& dbIndexFilesList, const Mernel::PropertyTree& customSegmentData) const noexcept = 0;
 
     [[nodiscard]] virtual const IGameDatabase* getDatabase(const DbOrder& dbIndexFilesList) const noexcept = 0;
 
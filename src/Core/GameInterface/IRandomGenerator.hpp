@@ -26,6 +26,9 @@ public:
 
     virtual void deserialize(const std::vector<uint8_t>& state) = 0;
 
+    // independent generator with the same seed and state.
+    virtual std::shared_ptr<IRandomGenerator> clone() const = 0;
+
     virtual uint64_t              gen(uint64_t max)                      = 0;
     virtual uint64_t              genSumN(size_t n, uint64_t max)        = 0;
     virtual std::vector<uint64_t> genSequence(size_t size, uint64_t max) = 0;
@@ -7,6 +7,9 @@
 
 #include "MernelPlatform/FsUtils.hpp"
 
+#include <cstdint>
+#include <memory>
+#include <span>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -24,13 +27,32 @@ enum class ResourceType
     DbIndex,
 };
 
+// Resource file content: view into a mapped mod pack, or own buffer for loose and compressed files.
+struct ResourceData {
+    std::span<const uint8_t>    m_data;
+    std::shared_ptr<const void> m_owner; // keeps m_data valid.
+
+    bool isValid() const noexcept { return m_owner != nullptr; }
+
+    std::string toString() const { return std::string(reinterpret_cast<const char*>(m_data.data()), m_data.size()); }
+};
+
 class IResourceLibrary {
 public:
     virtual ~IResourceLibrary() = default;
 
-    virtual bool             contains(ResourceType type, const std::string& id) const noexcept   = 0;
-    virtual bool             fileExists(ResourceType type, const std::string& id) const noexcept = 0;
-    virtual Mernel::std_path get(ResourceType type, const std::string& id) const noexcept        = 0;
+    virtual bool contains(ResourceType type, const std::string& id) const noexcept   = 0;
+    virtual bool fileExists(ResourceType type, const std::string& id) const noexcept = 0;
+
+    // Path of the loose file; packed resources have a virtual path inside the pack, use getData() for them.
+    virtual Mernel::std_path get(ResourceType type, const std::string& id) const noexcept = 0;
+
+    // File that changes together with the resource: the loose file itself or the whole pack.
+    virtual Mernel::std_path getStoragePath(ResourceType type, const std::string& id) const noexcept = 0;
+
+    // Content of the resource file, or of the file near it with the same base name and siblingExt extension (e.g. ".png" for sprite).
+    // Invalid data if resource or file does not exist.
+    virtual ResourceData getData(ResourceType type, const std::string& id, std::string_view siblingExt = {}) const noexcept = 0;
 
     using ConstPtr = std::shared_ptr<const IResourceLibrary>;
 };
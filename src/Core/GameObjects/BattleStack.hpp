@@ -77,6 +77,8 @@ struct BattleStack {
         bool canAttackRanged      = false;
         bool canAttackFreeSplash  = false;
         bool rangeAttackIsBlocked = false;
+
+        bool operator==(const EstimatedParams&) const noexcept = default;
     };
     EstimatedParams estimatedOnStart; // adventure->estimated + land bonus/castle bonus + hero.rngParamsOppBonus + environment
 
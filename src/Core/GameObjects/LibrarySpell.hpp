@@ -105,6 +105,8 @@ struct SpellCastParams {
 
     // reference only
     LibraryArtifactConstPtr art = nullptr;
+
+    bool operator==(const SpellCastParams&) const noexcept = default;
 };
 using SpellCastParamsList = std::vector<SpellCastParams>;
 
@@ -335,6 +337,8 @@ struct ImmunitiesParams {
     {
         return determine(positive).contains(school);
     }
+
+    bool operator==(const ImmunitiesParams&) const noexcept = default;
 };
 
 }
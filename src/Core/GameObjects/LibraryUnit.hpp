@@ -47,11 +47,15 @@ struct LibraryUnit {
             bool            melee  = true;
             bool            ranged = true;
             BonusRatio      chance{ 1, 1 };
+
+            bool operator==(const CastOnHit&) const noexcept = default;
         };
         using CastsOnHit = std::vector<CastOnHit>;
         struct FixedCast {
             SpellCastParams params;
             int             count = 0;
+
+            bool operator==(const FixedCast&) const noexcept = default;
         };
 
         UnitType          type          = UnitType::Living;
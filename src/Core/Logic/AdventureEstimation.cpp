@@ -5,6 +5,7 @@
  */
 #include "AdventureEstimation.hpp"
 #include "GeneralEstimation.hpp"
+#include "EstimationScriptRuntime.hpp"
 
 #include "LibrarySecondarySkill.hpp"
 #include "LibraryHeroSpec.hpp"
@@ -67,7 +68,6 @@ LibrarySecondarySkillConstPtr selectKeyFromWeightMap(const AdventureHero::Estima
 
 void AdventureEstimation::bindTypes(sol::state& lua)
 {
-    GeneralEstimation(m_rules).bindTypes(lua);
     // clang-format off
     lua.new_usertype<AdventureHero::EstimatedParams>( "AdventureHeroEstimatedParams",
         "meleeAttack"           , &AdventureHero::EstimatedParams::meleeAttack,
@@ -356,10 +356,8 @@ void AdventureEstimation::calculateHeroStats(AdventureHero& hero)
     for (auto* resId : m_gameDatabase->resources()->records())
         hero.estimated.dayIncome.data[resId] = 0;
 
-    sol::state lua;
-
-    // bindings
-    bindTypes(lua);
+    EstimationScriptRuntime::Session session;
+    sol::state&                      lua = session.lua();
 
     // Skills
     {
@@ -375,7 +373,7 @@ void AdventureEstimation::calculateHeroStats(AdventureHero& hero)
                 lua["skillLevel"] = level;
                 lua["isSpec"]     = hero.library->spec->type == LibraryHeroSpec::Type::Skill && hero.library->spec->skill == skill;
                 for (const auto& calc : skill->calc)
-                    lua.script(calc);
+                    session.run(calc);
             }
         }
         hero.estimated                      = lua["h"];
@@ -434,7 +432,7 @@ void AdventureEstimation::calculateHeroStats(AdventureHero& hero)
 
         for (auto* art : usedForCalculation) {
             for (const auto& calc : art->calc)
-                lua.script(calc);
+                session.run(calc);
         }
         hero.estimated = lua["h"];
         SpellCastParamsList extraCasts;
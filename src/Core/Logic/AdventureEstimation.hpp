@@ -42,8 +42,9 @@ public:
     LevelUpResult calculateHeroLevelUp(AdventureHero& hero, IRandomGenerator& rng);
     void          applyLevelUpChoice(AdventureHero& hero, LibrarySecondarySkillConstPtr skill);
 
+    static void bindTypes(sol::state& lua);
+
 private:
-    void bindTypes(sol::state& lua);
     void calculateHeroStats(AdventureHero& hero);
     void calculateHeroStatsAfterSquad(AdventureHero& hero, const AdventureSquad& squad);
     void calculateSquad(AdventureSquad& squad, bool reduceExtraFactionsPenalty, LibraryTerrainConstPtr terrain);
@@ -5,6 +5,7 @@
  */
 #include "BattleEstimation.hpp"
 #include "GeneralEstimation.hpp"
+#include "EstimationScriptRuntime.hpp"
 
 #include "LibraryGameRules.hpp"
 
@@ -14,8 +15,6 @@ namespace FreeHeroes::Core {
 
 void BattleEstimation::bindTypes(sol::state& lua)
 {
-    GeneralEstimation(m_rules).bindTypes(lua);
-
     // clang-format off
     lua.new_usertype<BattleStack::EstimatedParams>( "BattleUnitEstimatedParams",
        "primary"      , &BattleStack::EstimatedParams::primary,
@@ -53,8 +52,6 @@ void BattleEstimation::calculateUnitStats(BattleStack& unit)
     if (unit.current.fixedCast.count > 0)
         unit.current.fixedCast.count -= unit.castsDone;
 
-    sol::state lua;
-
     bool hasBuff   = false;
     bool hasDebuff = false;
 
@@ -63,9 +60,6 @@ void BattleEstimation::calculateUnitStats(BattleStack& unit)
     cur.canAttackMelee  = !unit.library->battleMachineArtifact;
     cur.canAttackRanged = unit.library->traits.rangeAttack && unit.remainingShoots > 0;
 
-    // bindings
-    bindTypes(lua);
-
     BattleStack::EffectList effectsTmp;
 
     // remove outdated;
@@ -108,26 +102,32 @@ void BattleEstimation::calculateUnitStats(BattleStack& unit)
         unit.appliedEffects = effectsTmp;
     }
     cur.primary.ad.defense += unit.roundState.guardBonus;
-    lua["u"] = cur;
-
-    for (auto& effect : unit.appliedEffects) {
-        const bool isBuff      = effect.power.spell->qualify == LibrarySpell::Qualify::Good;
-        const bool isDebuff    = effect.power.spell->qualify == LibrarySpell::Qualify::Bad;
-        const bool isSomething = isBuff || isDebuff;
-        assert(isSomething);
-        if (!isSomething)
-            continue;
-        hasBuff          = hasBuff || isBuff;
-        hasDebuff        = hasDebuff || isDebuff;
-        lua["level"]     = effect.power.skillLevel;
-        lua["isSpec"]    = effect.power.heroSpecLevel != -1;
-        lua["unitLevel"] = unit.library->level / 10;
-        lua["heroLevel"] = effect.power.heroSpecLevel;
-
-        for (const auto& calc : effect.power.spell->calcScript)
-            lua.script(calc);
+
+    // without effects scripts would not change anything, skip Lua round-trip (most calls during battle and AI look-ahead).
+    if (!unit.appliedEffects.empty()) {
+        EstimationScriptRuntime::Session session;
+        sol::state&                      lua = session.lua();
+        lua["u"]                             = cur;
+
+        for (auto& effect : unit.appliedEffects) {
+            const bool isBuff      = effect.power.spell->qualify == LibrarySpell::Qualify::Good;
+            const bool isDebuff    = effect.power.spell->qualify == LibrarySpell::Qualify::Bad;
+            const bool isSomething = isBuff || isDebuff;
+            assert(isSomething);
+            if (!isSomething)
+                continue;
+            hasBuff          = hasBuff || isBuff;
+            hasDebuff        = hasDebuff || isDebuff;
+            lua["level"]     = effect.power.skillLevel;
+            lua["isSpec"]    = effect.power.heroSpecLevel != -1;
+            lua["unitLevel"] = unit.library->level / 10;
+            lua["heroLevel"] = effect.power.heroSpecLevel;
+
+            for (const auto& calc : effect.power.spell->calcScript)
+                session.run(calc);
+        }
+        cur = lua["u"];
     }
-    cur = lua["u"];
 
     cur.hasBuff   = hasBuff;
     cur.hasDebuff = hasDebuff;
@@ -150,16 +150,15 @@ bool BattleEstimation::checkSpellTarget(const BattleStack& possibleTarget, Libra
     if (possibleTarget.current.immunities.immuneTo(spell))
         return false;
 
-    sol::state lua;
-
-    bindTypes(lua);
+    EstimationScriptRuntime::Session session;
+    sol::state&                      lua = session.lua();
 
     lua["result"]        = true;
     lua["type"]          = possibleTarget.library->abilities.type;
     lua["nonLivingType"] = possibleTarget.library->abilities.nonLivingType;
 
     for (const auto& calc : spell->filterScript)
-        lua.script(calc);
+        session.run(calc);
 
     bool result = lua["result"];
     if (spell->type == LibrarySpell::Type::Rising) {
@@ -36,8 +36,9 @@ public:
 
     void calculateArmySummon(const BattleArmy& army, const BattleArmy& opponent, const BattleEnvironment& battleEnvironment, BattleStackMutablePtr stack);
 
+    static void bindTypes(sol::state& lua);
+
 private:
-    void bindTypes(sol::state& lua);
     void calculateUnitStatsStartBattle(BattleStack& unit, const BattleSquad& squad, const BattleArmy& opponent, const BattleEnvironment& battleEnvironment);
     void calculateHeroStatsStartBattle(BattleHero& hero, const BattleSquad& squad, const BattleArmy& opponent, const BattleEnvironment& battleEnvironment);
 
@@ -8,7 +8,6 @@
 #include "MernelPlatform/Profiler.hpp"
 
 #include <algorithm>
-#include <unordered_set>
 
 #include <cassert>
 
@@ -16,76 +15,127 @@ namespace FreeHeroes::Core {
 
 namespace {
 
-bool pathFindDirectionOrder(const BattleDirection left, const BattleDirection right)
+// Same order as BattleFieldGeometry::getAdjacent() result.
+constexpr std::array<BattleDirection, 6> g_adjacentOrder{
+    BattleDirection::TR,
+    BattleDirection::R,
+    BattleDirection::BR,
+    BattleDirection::BL,
+    BattleDirection::L,
+    BattleDirection::TL,
+};
+
+// priority when several neighbours have equal distance: BR, R, TR, TL, L, BL. Indexed by BattleDirection.
+constexpr std::array<int, 6> g_pathFindDirectionPriority{
+    2, // TR
+    1, // R
+    0, // BR
+    5, // BL
+    4, // L
+    3, // TL
+};
+
+}
+
+BattleFieldMasks::BattleFieldMasks(const BattleFieldGeometry& field)
+    : field(field)
 {
-    static const std::vector<BattleDirection> priorities{
-        BattleDirection::BR,
-        BattleDirection::R,
-        BattleDirection::TR,
-        BattleDirection::TL,
-        BattleDirection::L,
-        BattleDirection::BL,
-    };
-    auto leftIt  = std::find(priorities.cbegin(), priorities.cend(), left);
-    auto rightIt = std::find(priorities.cbegin(), priorities.cend(), right);
+    assert(field.width > 0 && field.height > 0 && field.width * field.height <= BattleFieldBitboard::maxCells);
+    assert(field.width < 63);
+    for (int y = 0; y < field.height; ++y) {
+        for (int x = 0; x < field.width; ++x) {
+            const int index = toIndex({ x, y });
+            valid.set(index);
+            if (x == 0)
+                firstColumn.set(index);
+            if (x == field.width - 1)
+                lastColumn.set(index);
+            if (y % 2 == 0)
+                evenRows.set(index);
+        }
+    }
+}
 
-    return leftIt < rightIt;
+BattleFieldBitboard BattleFieldMasks::fromPositions(const BattlePositionSet& positions) const noexcept
+{
+    BattleFieldBitboard result;
+    for (auto pos : positions)
+        addPosition(result, pos);
+    return result;
+}
+
+void BattleFieldMasks::addPosition(BattleFieldBitboard& cells, const BattlePosition pos) const noexcept
+{
+    if (field.isValid(pos))
+        cells.set(toIndex(pos));
+}
+
+BattleFieldBitboard BattleFieldMasks::neighbours(const BattleFieldBitboard& cells) const noexcept
+{
+    // even rows are shifted half a cell right relative to odd rows (see BattleFieldGeometry::neighbour):
+    // cell above/below has the same x for TL/BL on even rows and for TR/BR on odd rows;
+    // TR/BR on even rows have x + 1, TL/BL on odd rows have x - 1.
+    const int           w        = field.width;
+    BattleFieldBitboard notFirst = cells;
+    BattleFieldBitboard notLast  = cells;
+    notFirst.andNot(firstColumn);
+    notLast.andNot(lastColumn);
+    const BattleFieldBitboard evenNotLast = notLast & evenRows;
+    BattleFieldBitboard       oddNotFirst = notFirst;
+    oddNotFirst.andNot(evenRows);
+
+    BattleFieldBitboard result = notLast.shifted(1);
+    result |= notFirst.shifted(-1);
+    result |= cells.shifted(-w);
+    result |= cells.shifted(w);
+    result |= evenNotLast.shifted(-w + 1);
+    result |= evenNotLast.shifted(w + 1);
+    result |= oddNotFirst.shifted(-w - 1);
+    result |= oddNotFirst.shifted(w - 1);
+    return result & valid;
 }
 
+BattleFieldBitboard BattleFieldMasks::widenForLarge(const BattleFieldBitboard& obstacles, bool mirrored) const noexcept
+{
+    BattleFieldBitboard result = obstacles;
+    BattleFieldBitboard moved  = obstacles;
+    if (mirrored) {
+        moved.andNot(lastColumn);
+        result |= moved.shifted(1);
+        result |= firstColumn;
+    } else {
+        moved.andNot(firstColumn);
+        result |= moved.shifted(-1);
+        result |= lastColumn;
+    }
+    return result;
 }
 
 void BattleFieldPathFinder::floodFill(const BattlePosition start)
 {
     //ProfilerScope scope("BF::floodFill");
-    assert(field.isValid(start));
+    assert(masks.field.isValid(start));
 
     matrix.fill(valEmpty);
 
-    matrix.set(start, 0);
-
-    Matrix remainPositions(matrix.width, matrix.height);
-    remainPositions.fill(1);
+    const int startIndex = masks.toIndex(start);
+    matrix[startIndex]   = 0;
 
-    remainPositions.set(start, 0);
-    if (!goThroughObstacles) {
-        for (auto ob : obstacles)
-            remainPositions.setChecked(ob, 0);
-    }
+    BattleFieldBitboard remain = masks.valid;
+    if (!goThroughObstacles)
+        remain.andNot(obstacles);
+    remain.reset(startIndex);
 
-    BattlePositionSet edgeTmp = field.getAdjacentSet(start);
-    BattlePositionSet edge;
-    for (auto pos : edgeTmp) {
-        if (1 == remainPositions.get(pos))
-            edge.insert(pos);
-    }
-    BattlePositionSet nextEdge;
-    int               step = 0;
-    BattlePosition    pos;
-    while (!edge.empty()) {
+    BattleFieldBitboard edge;
+    edge.set(startIndex);
+    value_t step = 0;
+    while (true) {
+        edge = masks.neighbours(edge) & remain;
+        if (!edge.any())
+            break;
         ++step;
-        nextEdge.clear();
-        //ProfilerScope scope("outer");
-        for (const auto edgePos : edge) {
-            remainPositions.set(edgePos, 0);
-        }
-        for (const auto edgePos : edge) {
-            //ProfilerScope scope("inner");
-
-            matrix.set(edgePos, step);
-
-            // all this stuff is ugly way to make it as fast as possible in debug mode.
-            // sets, unordered sets - all too slow when testing AI (AI calling findPAth a lot).
-            // please do not change anything without uncommenting Mernel::ProfilerScope :)
-            // clang-format off
-            if (1 == remainPositions.getChecked(pos = field.neighbour(edgePos, BattleDirection::TR)) ) nextEdge.insert(pos);
-            if (1 == remainPositions.getChecked(pos = field.neighbour(edgePos, BattleDirection::R )) ) nextEdge.insert(pos);
-            if (1 == remainPositions.getChecked(pos = field.neighbour(edgePos, BattleDirection::BR)) ) nextEdge.insert(pos);
-            if (1 == remainPositions.getChecked(pos = field.neighbour(edgePos, BattleDirection::TL)) ) nextEdge.insert(pos);
-            if (1 == remainPositions.getChecked(pos = field.neighbour(edgePos, BattleDirection::L )) ) nextEdge.insert(pos);
-            if (1 == remainPositions.getChecked(pos = field.neighbour(edgePos, BattleDirection::BL)) ) nextEdge.insert(pos);
-            // clang-format on
-        }
-        edge = nextEdge;
+        remain.andNot(edge);
+        edge.forEach([this, step](int index) { matrix[index] = step; });
     }
 }
 
@@ -93,44 +143,55 @@ BattlePositionPath BattleFieldPathFinder::fromStartTo(const BattlePosition end,
 {
     //ProfilerScope scope("BF::fromStartTo");
     BattlePositionPath result;
-    assert(field.isValid(end));
-    const int endVal = matrix.get(end);
-    if (endVal < 0 || obstacles.contains(end) || (limit != -1 && endVal > limit))
+    assert(masks.field.isValid(end));
+    const int endVal = matrix[masks.toIndex(end)];
+    if (endVal < 0 || obstacles.test(masks.toIndex(end)) || (limit != -1 && endVal > limit))
         return result;
 
     BattlePosition current = end;
     result.push_back(current);
-    BattlePositionSet                visited;
-    BattleFieldGeometry::AdjacentMap edge;
+    BattleFieldBitboard excluded;
+    if (!goThroughObstacles)
+        excluded = obstacles;
+
+    // returns true if left neighbour is better step to path start than right.
+    auto isBetter = [](value_t valLeft, BattleDirection left, value_t valRight, BattleDirection right) {
+        if (valLeft < 0)
+            return false;
+        if (valRight < 0)
+            return true;
+        if (valRight != valLeft)
+            return valLeft < valRight;
+        // now we have equal gradient values. let's decide specific walk order for that depending on direction.
+        return g_pathFindDirectionPriority[static_cast<int>(left)] < g_pathFindDirectionPriority[static_cast<int>(right)];
+    };
+
     while (true) {
-        edge = field.getAdjacent(current);
-        for (auto i = edge.begin(), last = edge.end(); i != last;) {
-            if (visited.count(i->second) > 0 || (!goThroughObstacles && obstacles.contains(i->second)))
-                i = edge.erase(i);
-            else
-                ++i;
+        BattlePosition  best;
+        BattleDirection bestDirection = BattleDirection::None;
+        value_t         bestVal       = valEmpty;
+        for (auto direction : g_adjacentOrder) {
+            const BattlePosition pos = masks.field.neighbour(current, direction);
+            if (!masks.field.isValid(pos))
+                continue;
+            const int index = masks.toIndex(pos);
+            if (excluded.test(index))
+                continue;
+
+            const value_t val = matrix[index];
+            if (bestDirection == BattleDirection::None || isBetter(val, direction, bestVal, bestDirection)) {
+                best          = pos;
+                bestDirection = direction;
+                bestVal       = val;
+            }
         }
-        if (edge.empty())
+        if (bestDirection == BattleDirection::None)
             break;
 
-        auto minIt = std::min_element(edge.cbegin(), edge.cend(), [this](const auto left, const auto right) {
-            const int valLeft  = matrix.get(left.second);
-            const int valRight = matrix.get(right.second);
-            if (valLeft < 0 && valRight < 0)
-                return false;
-            if (valLeft < 0)
-                return false;
-            if (valRight < 0)
-                return true;
-            if (valRight != valLeft)
-                return valLeft < valRight;
-            // now we have equal gradient values. let's decide specific walk order for that depending on direction.
-            return pathFindDirectionOrder(left.first, right.first);
-        });
-        current    = minIt->second;
+        current = best;
         result.push_back(current);
-        visited.insert(current);
-        if (matrix.get(current) == 0)
+        excluded.set(masks.toIndex(current));
+        if (bestVal == 0)
             break;
     }
     std::reverse(result.begin(), result.end());
@@ -145,17 +206,18 @@ BattlePositionSet BattleFieldPathFinder::findAvailable(int limit) const
     if (limit == 0)
         return result;
 
-    for (int w = 0; w < field.width; ++w) {
-        for (int h = 0; h < field.height; ++h) {
-            int distance = matrix.get({ w, h });
+    for (int w = 0; w < masks.field.width; ++w) {
+        for (int h = 0; h < masks.field.height; ++h) {
+            const int index    = masks.toIndex({ w, h });
+            const int distance = matrix[index];
             if (distance <= 0)
                 continue;
             if (limit != -1 && distance > limit)
                 continue;
-            if (obstacles.contains({ w, h }))
+            if (obstacles.test(index))
                 continue;
 
-            result.insert({ w, h });
+            result.insert(result.end(), BattlePosition{ w, h });
         }
     }
     return result;
@@ -166,14 +228,15 @@ BattlePositionDistanceMap BattleFieldPathFinder::findDistances(int limit) const
     BattlePositionDistanceMap result;
     if (limit == 0)
         return result;
-    for (int w = 0; w < field.width; ++w) {
-        for (int h = 0; h < field.height; ++h) {
-            int distance = matrix.get({ w, h });
+    for (int w = 0; w < masks.field.width; ++w) {
+        for (int h = 0; h < masks.field.height; ++h) {
+            const int index    = masks.toIndex({ w, h });
+            const int distance = matrix[index];
             if (distance <= 0)
                 continue;
             if (limit != -1 && distance > limit)
                 continue;
-            if (obstacles.contains({ w, h }))
+            if (obstacles.test(index))
                 continue;
 
             result[{ w, h }] = distance;
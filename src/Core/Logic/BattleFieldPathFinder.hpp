@@ -9,63 +9,127 @@
 
 #include "CoreLogicExport.hpp"
 
+#include <bit>
+
 namespace FreeHeroes::Core {
 
-class CORELOGIC_EXPORT BattleFieldPathFinder {
-    struct Matrix {
-        using value_t = std::int_fast16_t;
-        std::vector<value_t> data;
-        const int            width;
-        const int            height;
-        Matrix(int width, int height)
-            : width(width)
-            , height(height)
-        {
-            data.resize(width * height);
-        }
-        void set(const BattlePosition pos, value_t val)
-        {
-            data[pos.y * width + pos.x] = val;
-        }
-        void setChecked(const BattlePosition pos, value_t val)
-        {
-            if (pos.x < 0 || pos.x >= width || pos.y < 0 || pos.y >= height)
-                return;
-            data[pos.y * width + pos.x] = val;
-        }
+// One bit per field cell, cell index is (y * width + x).
+struct BattleFieldBitboard {
+    static constexpr int wordCount = 3;
+    static constexpr int maxCells  = wordCount * 64;
 
-        value_t get(const BattlePosition pos) const
-        {
-            return data[pos.y * width + pos.x];
-        }
-        value_t getChecked(const BattlePosition pos) const
-        {
-            if (pos.x < 0 || pos.x >= width || pos.y < 0 || pos.y >= height)
-                return -1;
-            return data[pos.y * width + pos.x];
+    std::array<uint64_t, wordCount> words{};
+
+    void set(int index) noexcept { words[index / 64] |= uint64_t(1) << (index % 64); }
+    void reset(int index) noexcept { words[index / 64] &= ~(uint64_t(1) << (index % 64)); }
+    bool test(int index) const noexcept { return words[index / 64] & (uint64_t(1) << (index % 64)); }
+
+    bool any() const noexcept { return words[0] | words[1] | words[2]; }
+
+    // bit at 'index' moves to 'index + offset'; bits moved out of [0, maxCells) are lost. |offset| < 64.
+    BattleFieldBitboard shifted(int offset) const noexcept
+    {
+        BattleFieldBitboard result;
+        if (offset > 0) {
+            result.words[2] = (words[2] << offset) | (words[1] >> (64 - offset));
+            result.words[1] = (words[1] << offset) | (words[0] >> (64 - offset));
+            result.words[0] = words[0] << offset;
+        } else if (offset < 0) {
+            offset          = -offset;
+            result.words[0] = (words[0] >> offset) | (words[1] << (64 - offset));
+            result.words[1] = (words[1] >> offset) | (words[2] << (64 - offset));
+            result.words[2] = words[2] >> offset;
+        } else {
+            result = *this;
         }
-        void fill(value_t val)
-        {
-            std::fill(data.begin(), data.end(), val);
+        return result;
+    }
+
+    // calls f(index) for every set bit, in increasing index order.
+    template<class F>
+    void forEach(F&& f) const
+    {
+        for (int w = 0; w < wordCount; ++w) {
+            for (uint64_t bits = words[w]; bits; bits &= bits - 1)
+                f(w * 64 + std::countr_zero(bits));
         }
-    };
-    const BattleFieldGeometry          field;
-    Matrix                             matrix;
-    bool                               goThroughObstacles = false;
-    static constexpr std::int_fast16_t valEmpty           = -1;
-    BattlePositionSet                  obstacles;
+    }
+
+    BattleFieldBitboard& operator|=(const BattleFieldBitboard& rh) noexcept
+    {
+        for (int w = 0; w < wordCount; ++w)
+            words[w] |= rh.words[w];
+        return *this;
+    }
+    BattleFieldBitboard& operator&=(const BattleFieldBitboard& rh) noexcept
+    {
+        for (int w = 0; w < wordCount; ++w)
+            words[w] &= rh.words[w];
+        return *this;
+    }
+    BattleFieldBitboard& andNot(const BattleFieldBitboard& rh) noexcept
+    {
+        for (int w = 0; w < wordCount; ++w)
+            words[w] &= ~rh.words[w];
+        return *this;
+    }
+    friend BattleFieldBitboard operator|(BattleFieldBitboard lh, const BattleFieldBitboard& rh) noexcept { return lh |= rh; }
+    friend BattleFieldBitboard operator&(BattleFieldBitboard lh, const BattleFieldBitboard& rh) noexcept { return lh &= rh; }
+
+    friend bool operator==(const BattleFieldBitboard& lh, const BattleFieldBitboard& rh) noexcept { return lh.words == rh.words; }
+    friend bool operator!=(const BattleFieldBitboard& lh, const BattleFieldBitboard& rh) noexcept { return lh.words != rh.words; }
+};
+
+// Bitboards depending on field size; neighbour calculation for a whole set of cells at once.
+struct CORELOGIC_EXPORT BattleFieldMasks {
+    BattleFieldGeometry field;
+    BattleFieldBitboard valid;
+    BattleFieldBitboard firstColumn;
+    BattleFieldBitboard lastColumn;
+    BattleFieldBitboard evenRows;
+
+    explicit BattleFieldMasks(const BattleFieldGeometry& field);
+
+    int            toIndex(const BattlePosition pos) const noexcept { return pos.y * field.width + pos.x; }
+    BattlePosition toPosition(int index) const noexcept { return { index % field.width, index / field.width }; }
+
+    // invalid positions are skipped.
+    BattleFieldBitboard fromPositions(const BattlePositionSet& positions) const noexcept;
+    void                addPosition(BattleFieldBitboard& cells, const BattlePosition pos) const noexcept;
+
+    // all valid cells adjacent to any of cells.
+    BattleFieldBitboard neighbours(const BattleFieldBitboard& cells) const noexcept;
+
+    // obstacles for large creature standing with main position: it also can not stand right before obstacle
+    // (left for mirrored) and at the last column (first for mirrored).
+    BattleFieldBitboard widenForLarge(const BattleFieldBitboard& obstacles, bool mirrored) const noexcept;
+};
+
+class CORELOGIC_EXPORT BattleFieldPathFinder {
+    using value_t = std::int_fast16_t;
+
+    const BattleFieldMasks                             masks;
+    std::array<value_t, BattleFieldBitboard::maxCells> matrix;
+    bool                                               goThroughObstacles = false;
+    static constexpr value_t                           valEmpty           = -1;
+    BattleFieldBitboard                                obstacles;
 
 public:
     BattleFieldPathFinder(const BattleFieldGeometry& field)
-        : field(field)
-        , matrix(field.width, field.height)
+        : BattleFieldPathFinder(BattleFieldMasks(field))
+    {
+    }
+    BattleFieldPathFinder(const BattleFieldMasks& masks)
+        : masks(masks)
     {
+        matrix.fill(valEmpty);
     }
-    void setObstacles(BattlePositionSet ob) { obstacles = std::move(ob); }
+    void setObstacles(const BattlePositionSet& ob) { obstacles = masks.fromPositions(ob); }
+    void setObstacleCells(const BattleFieldBitboard& ob) { obstacles = ob & masks.valid; }
     void setGoThroughObstacles(bool goThrough) { goThroughObstacles = goThrough; }
     void floodFill(const BattlePosition start);
 
-    [[nodiscard]] int         distanceTo(const BattlePosition end) const { return matrix.get(end); }
+    [[nodiscard]] int         distanceTo(const BattlePosition end) const { return matrix[masks.toIndex(end)]; }
     BattlePositionPath        fromStartTo(const BattlePosition end, int limit = -1) const;
     BattlePositionSet         findAvailable(int limit = -1) const;
     BattlePositionDistanceMap findDistances(int limit = -1) const;
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+#include "EstimationScriptRuntime.hpp"
+
+#include "GeneralEstimation.hpp"
+#include "BattleEstimation.hpp"
+#include "AdventureEstimation.hpp"
+
+#include <sol/sol.hpp>
+
+#include <atomic>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace FreeHeroes::Core {
+
+namespace {
+std::atomic<EstimationScriptRuntime::Mode> g_mode{ EstimationScriptRuntime::Mode::Cached };
+}
+
+struct EstimationScriptRuntime::Session::ThreadState {
+    ThreadState()
+    {
+        EstimationScriptRuntime::bindAllTypes(lua);
+        for (const auto& [key, value] : lua.globals()) {
+            if (key.get_type() == sol::type::string)
+                bindings.insert(key.as<std::string>());
+        }
+    }
+
+    sol::state                                               lua;
+    std::unordered_map<std::string, sol::protected_function> compiled; // must be destroyed before lua.
+    std::unordered_set<std::string>                          bindings; // globals present after bindAllTypes.
+    bool                                                     busy = false;
+
+    static ThreadState& get()
+    {
+        thread_local ThreadState state;
+        return state;
+    }
+};
+
+void EstimationScriptRuntime::setMode(Mode mode)
+{
+    g_mode = mode;
+}
+
+EstimationScriptRuntime::Mode EstimationScriptRuntime::getMode()
+{
+    return g_mode;
+}
+
+void EstimationScriptRuntime::bindAllTypes(sol::state& lua)
+{
+    GeneralEstimation::bindTypes(lua);
+    BattleEstimation::bindTypes(lua);
+    AdventureEstimation::bindTypes(lua);
+}
+
+EstimationScriptRuntime::Session::Session()
+{
+    if (g_mode == Mode::Cached) {
+        ThreadState& threadState = ThreadState::get();
+        // nested estimation on the same thread (should not happen normally) gets its own state.
+        if (!threadState.busy) {
+            threadState.busy = true;
+            m_threadState    = &threadState;
+            m_lua            = &threadState.lua;
+            return;
+        }
+    }
+    m_ownedState = std::make_unique<sol::state>();
+    bindAllTypes(*m_ownedState);
+    m_lua = m_ownedState.get();
+}
+
+EstimationScriptRuntime::Session::~Session()
+{
+    if (!m_threadState)
+        return;
+
+    // scripts may set any global, not only ones estimation code passes in.
+    sol::table               globals = m_lua->globals();
+    std::vector<sol::object> added;
+    for (const auto& [key, value] : globals) {
+        if (key.get_type() != sol::type::string || !m_threadState->bindings.contains(key.as<std::string>()))
+            added.push_back(key);
+    }
+    for (const sol::object& key : added)
+        globals.raw_set(key, sol::lua_nil);
+
+    m_threadState->busy = false;
+}
+
+void EstimationScriptRuntime::Session::run(const std::string& script)
+{
+    if (!m_threadState) {
+        m_lua->script(script);
+        return;
+    }
+
+    auto& compiled = m_threadState->compiled;
+    auto  it       = compiled.find(script);
+    if (it == compiled.end()) {
+        sol::load_result loaded = m_lua->load(script);
+        if (!loaded.valid()) {
+            sol::error err = loaded;
+            throw err;
+        }
+        it = compiled.emplace(script, loaded.get<sol::protected_function>()).first;
+    }
+
+    sol::protected_function_result result = it->second();
+    if (!result.valid()) {
+        sol::error err = result;
+        throw err;
+    }
+}
+
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+#pragma once
+
+#include "CoreLogicExport.hpp"
+
+#include <memory>
+#include <string>
+
+namespace sol {
+class state;
+}
+
+namespace FreeHeroes::Core {
+
+// Lua runtime shared by all estimation code (GeneralEstimation, BattleEstimation, AdventureEstimation).
+// In Cached mode every thread owns one Lua state with all usertypes registered once,
+// and every script line from the database is compiled once into a function kept in per-thread cache.
+// Uncached mode reproduces old behaviour (new state and bindings for every call) and is kept for comparison.
+class CORELOGIC_EXPORT EstimationScriptRuntime {
+public:
+    enum class Mode
+    {
+        Cached,
+        Uncached,
+    };
+
+    static void setMode(Mode mode);
+    static Mode getMode();
+
+    static void bindAllTypes(sol::state& lua);
+
+    // Lease of Lua state for one estimation call.
+    // All globals added since type binding are reset to nil on destruction, so reused state looks like a fresh one for the next call.
+    class CORELOGIC_EXPORT Session {
+    public:
+        Session();
+        ~Session();
+
+        Session(const Session&)            = delete;
+        Session& operator=(const Session&) = delete;
+
+        sol::state& lua() noexcept { return *m_lua; }
+
+        void run(const std::string& script);
+
+    private:
+        struct ThreadState;
+        ThreadState*                m_threadState = nullptr;
+        std::unique_ptr<sol::state> m_ownedState;
+        sol::state*                 m_lua = nullptr;
+    };
+};
+
+}
@@ -25,10 +25,15 @@
 
 #include "LibrarySerialize.hpp"
 
+#include "MernelExecution/ParallelExecutor.hpp"
+#include "MernelExecution/TaskQueue.hpp"
 #include "MernelPlatform/Logger.hpp"
 #include "MernelPlatform/Profiler.hpp"
 
+#include <algorithm>
 #include <deque>
+#include <functional>
+#include <thread>
 #include <unordered_map>
 #include <cstddef>
 #include <stdexcept>
@@ -351,7 +356,7 @@ LibraryGameRulesConstPtr GameDatabase::gameRules() const
     return &m_impl->m_gameRules;
 }
 
-GameDatabase::GameDatabase(const Mernel::PropertyTree& recordObjectMaps)
+GameDatabase::GameDatabase(const Mernel::PropertyTree& recordObjectMaps, int loadJobs)
     : m_impl(std::make_unique<Impl>())
 {
     Mernel::ProfilerScope scope("GameDatabase::GameDatabase");
@@ -374,24 +379,63 @@ GameDatabase::GameDatabase(const Mernel::PropertyTree& recordObjectMaps)
     m_impl->m_units          .prepareObjectKeys(recordObjectMaps);
     // clang-format on
 
+    // containers link to each other only through pointers already created by prepareObjectKeys,
+    // so records of different containers can be deserialized concurrently.
+    auto loadRecords = [this, &recordObjectMaps](auto& container) -> std::function<void()> {
+        return [this, &recordObjectMaps, &container] { container.loadRecordList(this, recordObjectMaps); };
+    };
     // clang-format off
-    m_impl->m_artifacts      .loadRecordList(this, recordObjectMaps);
-    m_impl->m_buildings      .loadRecordList(this, recordObjectMaps);
-    m_impl->m_dwellings      .loadRecordList(this, recordObjectMaps);
-    m_impl->m_factions       .loadRecordList(this, recordObjectMaps);
-    m_impl->m_heroSpecs      .loadRecordList(this, recordObjectMaps);
-    m_impl->m_heroes         .loadRecordList(this, recordObjectMaps);
-    m_impl->m_mapBanks       .loadRecordList(this, recordObjectMaps);
-    m_impl->m_mapObstacles   .loadRecordList(this, recordObjectMaps);
-    m_impl->m_mapVisitables  .loadRecordList(this, recordObjectMaps);
-    m_impl->m_objectDefs     .loadRecordList(this, recordObjectMaps);
-    m_impl->m_players        .loadRecordList(this, recordObjectMaps);
-    m_impl->m_resources      .loadRecordList(this, recordObjectMaps);
-    m_impl->m_skills         .loadRecordList(this, recordObjectMaps);
-    m_impl->m_spells         .loadRecordList(this, recordObjectMaps);
-    m_impl->m_terrains       .loadRecordList(this, recordObjectMaps);
-    m_impl->m_units          .loadRecordList(this, recordObjectMaps);
+    const std::vector<std::function<void()>> loaders{
+        loadRecords(m_impl->m_artifacts      ),
+        loadRecords(m_impl->m_buildings      ),
+        loadRecords(m_impl->m_dwellings      ),
+        loadRecords(m_impl->m_factions       ),
+        loadRecords(m_impl->m_heroSpecs      ),
+        loadRecords(m_impl->m_heroes         ),
+        loadRecords(m_impl->m_mapBanks       ),
+        loadRecords(m_impl->m_mapObstacles   ),
+        loadRecords(m_impl->m_mapVisitables  ),
+        loadRecords(m_impl->m_objectDefs     ),
+        loadRecords(m_impl->m_players        ),
+        loadRecords(m_impl->m_resources      ),
+        loadRecords(m_impl->m_skills         ),
+        loadRecords(m_impl->m_spells         ),
+        loadRecords(m_impl->m_terrains       ),
+        loadRecords(m_impl->m_units          ),
+    };
     // clang-format on
+    if (loadJobs <= 0)
+        loadJobs = std::max(1U, std::thread::hardware_concurrency());
+    loadJobs = std::min(loadJobs, static_cast<int>(loaders.size()));
+
+    if (loadJobs == 1) {
+        for (const auto& loader : loaders)
+            loader();
+    } else {
+        std::vector<std::exception_ptr> errors(loaders.size());
+
+        Mernel::TaskQueue taskQueue;
+        for (size_t i = 0; i < loaders.size(); ++i) {
+            taskQueue.addTask([&loader = loaders[i], &error = errors[i]] {
+                Mernel::ProfilerContext                profileContext;
+                Mernel::ProfilerDefaultContextSwitcher switcher(profileContext);
+                try {
+                    loader();
+                }
+                catch (...) {
+                    error = std::current_exception();
+                }
+            });
+        }
+        Mernel::ParallelExecutor executor(loadJobs);
+        executor.execQueue(taskQueue);
+
+        // first error in container order, so it does not depend on scheduling.
+        for (const auto& error : errors) {
+            if (error)
+                std::rethrow_exception(error);
+        }
+    }
 
     deserialize(this, m_impl->m_gameRules, recordObjectMaps["gameRules"][""]);
 
@@ -15,7 +15,8 @@ namespace FreeHeroes::Core {
 class GameDatabase : public IGameDatabase {
 public:
 public:
-    GameDatabase(const Mernel::PropertyTree& recordObjectMaps);
+    // loadJobs - threads for records deserialization, 0 = hardware concurrency, 1 = sequential.
+    GameDatabase(const Mernel::PropertyTree& recordObjectMaps, int loadJobs = 0);
     ~GameDatabase();
 
     LibraryArtifactContainerPtr       artifacts() const override;
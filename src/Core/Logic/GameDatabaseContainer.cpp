@@ -6,6 +6,7 @@
 #include "GameDatabaseContainer.hpp"
 
 #include "GameDatabase.hpp"
+#include "GameDatabaseSnapshot.hpp"
 
 #include "JsonHelper.hpp"
 #include "MernelPlatform/Logger.hpp"
@@ -15,7 +16,10 @@
 #include "MernelPlatform/FileIOUtils.hpp"
 
 #include "IResourceLibrary.hpp"
-#include <list>
+
+#include <chrono>
+#include <cstdio>
+#include <mutex>
 
 namespace FreeHeroes::Core {
 using namespace Mernel;
@@ -26,9 +30,13 @@ struct Resource {
 
 struct GameDatabaseContainer::Impl {
     const IResourceLibrary* const m_resourceLibrary = nullptr;
+    const Mernel::std_path        m_snapshotDir;
+    const int                     m_loadJobs = 0;
 
-    Impl(const IResourceLibrary* resourceLibrary)
+    Impl(const IResourceLibrary* resourceLibrary, Mernel::std_path snapshotDir, int loadJobs)
         : m_resourceLibrary(resourceLibrary)
+        , m_snapshotDir(std::move(snapshotDir))
+        , m_loadJobs(loadJobs)
     {}
 
     struct DbSegmentRecord {
@@ -53,9 +61,15 @@ struct GameDatabaseContainer::Impl {
 
     std::map<IGameDatabaseContainer::DbOrder, DbObjectRecord> m_dbObjects;
 
-    // @todo: well, that's a bit of leak. Probably need a cleanup strategy for those.
-    // hash(PropertyTree) ???
-    std::list<std::shared_ptr<const IGameDatabase>> m_patchedStorage;
+    // patched databases are owned by callers; cache only lets callers with equal patch share one.
+    struct PatchedDbRecord {
+        std::string                        m_patchBuffer; // serialized patch, to tell hash collisions apart.
+        std::weak_ptr<const IGameDatabase> m_db;
+    };
+
+    std::map<std::pair<IGameDatabaseContainer::DbOrder, uint64_t>, PatchedDbRecord> m_patchedDbs;
+
+    std::mutex m_mutex; // databases are loaded lazily, getDatabase() may be called from several threads.
 
     bool loadDbSegmentFile(const std::string& dbSegmentId, bool optional = false) noexcept
     {
@@ -65,15 +79,16 @@ struct GameDatabaseContainer::Impl {
             return rec.m_isValid;
 
         try {
-            auto path = m_resourceLibrary->get(ResourceType::DbSegment, dbSegmentId);
-            if (path.empty()) {
+            if (!m_resourceLibrary->contains(ResourceType::DbSegment, dbSegmentId)) {
                 if (!optional)
                     Logger(Logger::Err) << "Non-existent DB index id '" << dbSegmentId << "': ";
                 return false;
             }
-            ProfilerScope scope("read+parse json");
-            const auto    fileBuffer = readFileIntoBuffer(path);
-            const auto    jsonData   = readJsonFromBuffer(fileBuffer);
+            ProfilerScope      scope("read+parse json");
+            const ResourceData data = m_resourceLibrary->getData(ResourceType::DbSegment, dbSegmentId);
+            if (!data.isValid())
+                throw std::runtime_error("failed to read file");
+            const auto jsonData = readJsonFromBuffer(data.toString());
 
             rec.m_data = jsonData;
         }
@@ -94,13 +109,14 @@ struct GameDatabaseContainer::Impl {
             return rec.m_isValid;
 
         try {
-            auto path = m_resourceLibrary->get(ResourceType::DbIndex, dbIndexId);
-            if (path.empty()) {
+            if (!m_resourceLibrary->contains(ResourceType::DbIndex, dbIndexId)) {
                 Logger(Logger::Err) << "Non-existent DB index id '" << dbIndexId << "': ";
                 return false;
             }
-            const auto fileBuffer = readFileIntoBuffer(path);
-            const auto jsonData   = readJsonFromBuffer(fileBuffer);
+            const ResourceData data = m_resourceLibrary->getData(ResourceType::DbIndex, dbIndexId);
+            if (!data.isValid())
+                throw std::runtime_error("failed to read file");
+            const auto jsonData = readJsonFromBuffer(data.toString());
             for (const auto& item : jsonData["segments"].getList()) {
                 const std::string segmentId = item.getScalar().toString();
                 if (!loadDbSegmentFile(segmentId))
@@ -133,6 +149,95 @@ struct GameDatabaseContainer::Impl {
         return true;
     }
 
+    // hash of every file the merged database for key is built from (loose file or whole pack): path, size and modification time.
+    bool makeSourceHash(const IGameDatabaseContainer::DbOrder& key, uint64_t& hash) const noexcept
+    {
+        auto addFile = [&hash](const Mernel::std_path& path) {
+            std::error_code ec;
+            const auto      size  = std_fs::file_size(path, ec);
+            const auto      mtime = std_fs::last_write_time(path, ec);
+            if (ec)
+                return false;
+            hash = GameDatabaseSnapshot::hashCombine(hash, path2string(path));
+            hash = GameDatabaseSnapshot::hashCombine(hash, static_cast<int64_t>(size));
+            hash = GameDatabaseSnapshot::hashCombine(hash, static_cast<int64_t>(mtime.time_since_epoch().count()));
+            return true;
+        };
+
+        hash = GameDatabaseSnapshot::s_hashSeed;
+        try {
+            for (const std::string& dbIndexId : key) {
+                const auto indexPath = m_resourceLibrary->getStoragePath(ResourceType::DbIndex, dbIndexId);
+                hash                 = GameDatabaseSnapshot::hashCombine(hash, dbIndexId);
+                if (indexPath.empty() || !addFile(indexPath))
+                    return false;
+
+                const ResourceData indexData = m_resourceLibrary->getData(ResourceType::DbIndex, dbIndexId);
+                if (!indexData.isValid())
+                    return false;
+                const auto jsonData = readJsonFromBuffer(indexData.toString());
+                for (const char* listName : { "segments", "optional" }) {
+                    hash = GameDatabaseSnapshot::hashCombine(hash, std::string(listName));
+                    for (const auto& item : jsonData[listName].getList()) {
+                        const std::string segmentId   = std::string(item.getScalar().toString());
+                        const auto        segmentPath = m_resourceLibrary->getStoragePath(ResourceType::DbSegment, segmentId);
+                        hash                          = GameDatabaseSnapshot::hashCombine(hash, segmentId);
+                        if (segmentPath.empty())
+                            continue; // non-optional missing segment fails later in loadDbIndexFile.
+                        if (!addFile(segmentPath))
+                            return false;
+                    }
+                }
+            }
+        }
+        catch (std::exception& ex) {
+            Logger(Logger::Warning) << "Failed to check database snapshot sources '" << key << "': " << ex.what();
+            return false;
+        }
+        return true;
+    }
+
+    Mernel::std_path getSnapshotPath(uint64_t sourceHash) const
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "db_%016llx.fhdbsnap", static_cast<unsigned long long>(sourceHash));
+        return m_snapshotDir / name;
+    }
+
+    bool loadSnapshot(uint64_t sourceHash, PropertyTree& data) const noexcept
+    {
+        ProfilerScope scope("read snapshot");
+        std::string   buffer;
+        if (!readFileIntoBufferNoexcept(getSnapshotPath(sourceHash), buffer))
+            return false;
+        return GameDatabaseSnapshot::deserialize(buffer, sourceHash, data);
+    }
+
+    void saveSnapshot(uint64_t sourceHash, const PropertyTree& data) const noexcept
+    {
+        ProfilerScope scope("write snapshot");
+        // other processes may read or write the same snapshot, so write to temporary file and rename it.
+        const auto      path    = getSnapshotPath(sourceHash);
+        const auto      tmpPath = m_snapshotDir / (path2string(path.filename()) + "." + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".tmp");
+        std::error_code ec;
+        std_fs::create_directories(m_snapshotDir, ec);
+        try {
+            if (!writeFileFromBufferNoexcept(tmpPath, GameDatabaseSnapshot::serialize(data, sourceHash))) {
+                Logger(Logger::Warning) << "Failed to write database snapshot " << path2string(tmpPath);
+                return;
+            }
+        }
+        catch (std::exception& ex) {
+            Logger(Logger::Warning) << "Failed to write database snapshot: " << ex.what();
+            return;
+        }
+        std_fs::rename(tmpPath, path, ec);
+        if (ec) {
+            Logger(Logger::Warning) << "Failed to write database snapshot " << path2string(path) << ": " << ec.message();
+            std_fs::remove(tmpPath, ec);
+        }
+    }
+
     const IGameDatabase* getDb(const IGameDatabaseContainer::DbOrder& key) noexcept
     {
         const bool      isInCache = m_dbObjects.contains(key);
@@ -141,16 +246,26 @@ struct GameDatabaseContainer::Impl {
             return rec.m_isValid ? rec.m_db.get() : nullptr;
 
         try {
-            for (const std::string& dbIndexId : key) {
-                if (!loadDbIndexFile(dbIndexId))
-                    return nullptr;
-                auto& indexJson = m_dbIndexFiles[dbIndexId].m_data;
-
-                ProfilerScope scope("mergePatch");
-                PropertyTree::mergePatch(rec.m_data, indexJson);
+            uint64_t   sourceHash      = 0;
+            const bool useSnapshot     = !m_snapshotDir.empty() && makeSourceHash(key, sourceHash);
+            const bool snapshotIsValid = useSnapshot && loadSnapshot(sourceHash, rec.m_data);
+            if (snapshotIsValid) {
+                Logger() << "Database '" << key << "' loaded from snapshot";
+            } else {
+                rec.m_data = {};
+                for (const std::string& dbIndexId : key) {
+                    if (!loadDbIndexFile(dbIndexId))
+                        return nullptr;
+                    auto& indexJson = m_dbIndexFiles[dbIndexId].m_data;
+
+                    ProfilerScope scope("mergePatch");
+                    PropertyTree::mergePatch(rec.m_data, indexJson);
+                }
+                if (useSnapshot)
+                    saveSnapshot(sourceHash, rec.m_data);
             }
 
-            rec.m_db = std::make_shared<GameDatabase>(rec.m_data);
+            rec.m_db = std::make_shared<GameDatabase>(rec.m_data, m_loadJobs);
         }
         catch (std::exception& ex) {
             Logger(Logger::Err) << "error while loading database seqence '" << key << "': " << ex.what();
@@ -160,30 +275,42 @@ struct GameDatabaseContainer::Impl {
         return rec.m_db.get();
     }
 
-    const IGameDatabase* getDbWithPatch(const IGameDatabaseContainer::DbOrder& key, const PropertyTree& patch) noexcept
+    std::shared_ptr<const IGameDatabase> getDbWithPatch(const IGameDatabaseContainer::DbOrder& key, const PropertyTree& patch) noexcept
     {
+        if (!getDb(key))
+            return nullptr;
+
+        const DbObjectRecord& baseRec = m_dbObjects[key];
         try {
-            PropertyTree data;
-            for (const std::string& dbIndexId : key) {
-                if (!loadDbIndexFile(dbIndexId))
-                    return nullptr;
-                auto& indexJson = m_dbIndexFiles[dbIndexId].m_data;
+            std::erase_if(m_patchedDbs, [](const auto& it) { return it.second.m_db.expired(); });
+
+            std::string      patchBuffer = GameDatabaseSnapshot::serialize(patch, 0);
+            const uint64_t   patchHash   = GameDatabaseSnapshot::hashCombine(GameDatabaseSnapshot::s_hashSeed, patchBuffer);
+            PatchedDbRecord& rec         = m_patchedDbs[{ key, patchHash }];
+            if (auto db = rec.m_db.lock(); db && rec.m_patchBuffer == patchBuffer)
+                return db;
 
-                PropertyTree::mergePatch(data, indexJson);
+            PropertyTree data = baseRec.m_data;
+            {
+                ProfilerScope scope("mergePatch");
+                PropertyTree::mergePatch(data, patch);
             }
-            PropertyTree::mergePatch(data, patch);
-            m_patchedStorage.push_back(std::make_shared<GameDatabase>(data));
-            return m_patchedStorage.back().get();
+            std::shared_ptr<const IGameDatabase> db = std::make_shared<GameDatabase>(data, m_loadJobs);
+            if (rec.m_db.expired()) {
+                rec.m_patchBuffer = std::move(patchBuffer);
+                rec.m_db          = db;
+            }
+            return db;
         }
         catch (std::exception& ex) {
-            Logger(Logger::Err) << "error while loading database seqence '" << key << "': " << ex.what();
+            Logger(Logger::Err) << "error while loading database seqence '" << key << "' with patch: " << ex.what();
             return nullptr;
         }
     }
 };
 
-GameDatabaseContainer::GameDatabaseContainer(const IResourceLibrary* resourceLibrary)
-    : m_impl(std::make_unique<Impl>(resourceLibrary))
+GameDatabaseContainer::GameDatabaseContainer(const IResourceLibrary* resourceLibrary, Mernel::std_path snapshotDir, int loadJobs)
+    : m_impl(std::make_unique<Impl>(resourceLibrary, std::move(snapshotDir), loadJobs))
 {
 }
 
@@ -191,13 +318,15 @@ GameDatabaseContainer::~GameDatabaseContainer() = default;
 
 const IGameDatabase* GameDatabaseContainer::getDatabase(const DbOrder& dbIndexFilesList) const noexcept
 {
-    ProfilerScope scope("getDatabase");
+    ProfilerScope               scope("getDatabase");
+    std::lock_guard<std::mutex> lock(m_impl->m_mutex);
     return m_impl->getDb(dbIndexFilesList);
 }
 
-const IGameDatabase* GameDatabaseContainer::getDatabase(const DbOrder& dbIndexFilesList, const PropertyTree& customSegmentData) const noexcept
+std::shared_ptr<const IGameDatabase> GameDatabaseContainer::getDatabase(const DbOrder& dbIndexFilesList, const PropertyTree& customSegmentData) const noexcept
 {
-    ProfilerScope scope("getDatabase");
+    ProfilerScope               scope("getDatabase");
+    std::lock_guard<std::mutex> lock(m_impl->m_mutex);
     return m_impl->getDbWithPatch(dbIndexFilesList, customSegmentData);
 }
 
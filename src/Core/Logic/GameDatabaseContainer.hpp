@@ -9,17 +9,23 @@
 
 #include "CoreLogicExport.hpp"
 
+#include "MernelPlatform/FsUtils.hpp"
+
 namespace FreeHeroes::Core {
 class IResourceLibrary;
 
 class CORELOGIC_EXPORT GameDatabaseContainer : public IGameDatabaseContainer {
 public:
-    GameDatabaseContainer(const IResourceLibrary* resourceLibrary);
+    // snapshotDir - where to keep binary snapshots of merged database (see GameDatabaseSnapshot); empty to disable.
+    // loadJobs - threads for GameDatabase records deserialization, 0 = hardware concurrency.
+    GameDatabaseContainer(const IResourceLibrary* resourceLibrary, Mernel::std_path snapshotDir = {}, int loadJobs = 0);
     ~GameDatabaseContainer();
 
+    using IGameDatabaseContainer::getDatabase;
+
     const IGameDatabase* getDatabase(const DbOrder& dbIndexFilesList) const noexcept override;
 
-    const IGameDatabase* getDatabase(const DbOrder& dbIndexFilesList, const Mernel::PropertyTree& customSegmentData) const noexcept override;
+    std::shared_ptr<const IGameDatabase> getDatabase(const DbOrder& dbIndexFilesList, const Mernel::PropertyTree& customSegmentData) const noexcept override;
 
 private:
     struct Impl;
@@ -0,0 +1,262 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+#include "GameDatabaseSnapshot.hpp"
+
+#include "MernelPlatform/Logger.hpp"
+#include "MernelPlatform/PropertyTree.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace FreeHeroes::Core {
+using namespace Mernel;
+
+namespace {
+
+constexpr const char     s_magic[8]     = { 'F', 'H', 'D', 'B', 'S', 'N', 'A', 'P' };
+constexpr const uint32_t s_version      = 1;
+constexpr const uint32_t s_endianMarker = 0x01020304U;
+constexpr const int      s_maxDepth     = 256;
+
+enum class Tag : uint8_t
+{
+    Null,
+    False,
+    True,
+    Int,
+    Double,
+    String,
+    List,
+    Map,
+};
+
+class Writer {
+public:
+    std::string m_buffer;
+
+    void writeRaw(const void* data, size_t size) { m_buffer.append(static_cast<const char*>(data), size); }
+
+    template<class T>
+    void writePod(T value)
+    {
+        writeRaw(&value, sizeof(T));
+    }
+
+    void writeSize(uint64_t value)
+    {
+        while (value >= 0x80) {
+            writePod(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        writePod(static_cast<uint8_t>(value));
+    }
+
+    void writeString(std::string_view str)
+    {
+        writeSize(str.size());
+        writeRaw(str.data(), str.size());
+    }
+
+    void writeTree(const PropertyTree& tree)
+    {
+        if (tree.isNull()) {
+            writePod(Tag::Null);
+        } else if (tree.isScalar()) {
+            const PropertyTreeScalar& scalar = tree.getScalar();
+            if (scalar.isBool()) {
+                writePod(scalar.toBool() ? Tag::True : Tag::False);
+            } else if (scalar.isInt()) {
+                writePod(Tag::Int);
+                writePod(static_cast<int64_t>(scalar.toInt()));
+            } else if (scalar.isDouble()) {
+                writePod(Tag::Double);
+                writePod(scalar.toDouble());
+            } else if (scalar.isString()) {
+                writePod(Tag::String);
+                writeString(scalar.toString());
+            } else {
+                writePod(Tag::Null);
+            }
+        } else if (tree.isList()) {
+            const auto& list = tree.getList();
+            writePod(Tag::List);
+            writeSize(list.size());
+            for (const auto& child : list)
+                writeTree(child);
+        } else {
+            const auto& map = tree.getMap();
+            writePod(Tag::Map);
+            writeSize(map.size());
+            for (const auto& [key, child] : map) {
+                writeString(key);
+                writeTree(child);
+            }
+        }
+    }
+};
+
+class Reader {
+public:
+    Reader(const std::string& buffer)
+        : m_data(buffer.data())
+        , m_end(buffer.data() + buffer.size())
+    {}
+
+    void readRaw(void* data, size_t size)
+    {
+        if (static_cast<size_t>(m_end - m_data) < size)
+            throw std::runtime_error("unexpected end of snapshot");
+        std::memcpy(data, m_data, size);
+        m_data += size;
+    }
+
+    template<class T>
+    T readPod()
+    {
+        T value;
+        readRaw(&value, sizeof(T));
+        return value;
+    }
+
+    uint64_t readSize()
+    {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const uint8_t byte = readPod<uint8_t>();
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                return value;
+        }
+        throw std::runtime_error("invalid size in snapshot");
+    }
+
+    std::string readString()
+    {
+        const uint64_t size = readSize();
+        if (static_cast<uint64_t>(m_end - m_data) < size)
+            throw std::runtime_error("unexpected end of snapshot");
+        std::string result(m_data, size);
+        m_data += size;
+        return result;
+    }
+
+    void readTree(PropertyTree& tree, int depth)
+    {
+        if (depth > s_maxDepth)
+            throw std::runtime_error("snapshot nesting is too deep");
+
+        const Tag tag = readPod<Tag>();
+        switch (tag) {
+            case Tag::Null:
+                return;
+            case Tag::False:
+            case Tag::True:
+                tree = PropertyTreeScalar(tag == Tag::True);
+                return;
+            case Tag::Int:
+                tree = PropertyTreeScalar(readPod<int64_t>());
+                return;
+            case Tag::Double:
+                tree = PropertyTreeScalar(readPod<double>());
+                return;
+            case Tag::String:
+                tree = PropertyTreeScalar(readString());
+                return;
+            case Tag::List:
+            {
+                const uint64_t size = readSize();
+                tree.convertToList();
+                for (uint64_t i = 0; i < size; ++i) {
+                    PropertyTree child;
+                    readTree(child, depth + 1);
+                    tree.append(std::move(child));
+                }
+                return;
+            }
+            case Tag::Map:
+            {
+                const uint64_t size = readSize();
+                tree.convertToMap();
+                auto& map = tree.getMap();
+                for (uint64_t i = 0; i < size; ++i) {
+                    std::string key = readString();
+                    readTree(map[std::move(key)], depth + 1);
+                }
+                return;
+            }
+        }
+        throw std::runtime_error("invalid tag in snapshot");
+    }
+
+    bool atEnd() const { return m_data == m_end; }
+
+private:
+    const char*       m_data;
+    const char* const m_end;
+};
+
+}
+
+std::string GameDatabaseSnapshot::serialize(const PropertyTree& data, uint64_t sourceHash)
+{
+    Writer writer;
+    writer.writeRaw(s_magic, sizeof(s_magic));
+    writer.writePod(s_version);
+    writer.writePod(s_endianMarker);
+    writer.writePod(sourceHash);
+    writer.writeTree(data);
+    return std::move(writer.m_buffer);
+}
+
+bool GameDatabaseSnapshot::deserialize(const std::string& buffer, uint64_t sourceHash, PropertyTree& data) noexcept
+{
+    try {
+        Reader reader(buffer);
+        char   magic[sizeof(s_magic)];
+        reader.readRaw(magic, sizeof(magic));
+        if (std::memcmp(magic, s_magic, sizeof(s_magic)) != 0)
+            return false;
+        if (reader.readPod<uint32_t>() != s_version || reader.readPod<uint32_t>() != s_endianMarker)
+            return false;
+        if (reader.readPod<uint64_t>() != sourceHash)
+            return false;
+
+        PropertyTree result;
+        reader.readTree(result, 0);
+        if (!reader.atEnd())
+            return false;
+
+        data = std::move(result);
+        return true;
+    }
+    catch (std::exception& ex) {
+        Logger(Logger::Warning) << "Database snapshot is corrupted: " << ex.what();
+        return false;
+    }
+}
+
+uint64_t GameDatabaseSnapshot::hashCombine(uint64_t hash, const void* data, size_t size) noexcept
+{
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+uint64_t GameDatabaseSnapshot::hashCombine(uint64_t hash, const std::string& str) noexcept
+{
+    hash = hashCombine(hash, static_cast<int64_t>(str.size()));
+    return hashCombine(hash, str.data(), str.size());
+}
+
+uint64_t GameDatabaseSnapshot::hashCombine(uint64_t hash, int64_t value) noexcept
+{
+    return hashCombine(hash, &value, sizeof(value));
+}
+
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+#pragma once
+
+#include "CoreLogicExport.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace Mernel {
+class PropertyTree;
+}
+
+namespace FreeHeroes::Core {
+
+// Compact binary form of merged database PropertyTree, so warm start does not need to parse JSON segments.
+// Snapshot is bound to sourceHash (hash of index/segment files it was built from) and to format version;
+// any mismatch or corruption makes deserialize() fail, and caller should use JSON files instead.
+class CORELOGIC_EXPORT GameDatabaseSnapshot {
+public:
+    static std::string serialize(const Mernel::PropertyTree& data, uint64_t sourceHash);
+
+    static bool deserialize(const std::string& buffer, uint64_t sourceHash, Mernel::PropertyTree& data) noexcept;
+
+    // FNV-1a, for building sourceHash.
+    static uint64_t hashCombine(uint64_t hash, const void* data, size_t size) noexcept;
+    static uint64_t hashCombine(uint64_t hash, const std::string& str) noexcept;
+    static uint64_t hashCombine(uint64_t hash, int64_t value) noexcept;
+
+    static constexpr const uint64_t s_hashSeed = 14695981039346656037ULL;
+};
+
+}
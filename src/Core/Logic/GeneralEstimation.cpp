@@ -4,6 +4,7 @@
  * See LICENSE file for details.
  */
 #include "GeneralEstimation.hpp"
+#include "EstimationScriptRuntime.hpp"
 
 #include "LibraryUnit.hpp"
 #include "LibraryGameRules.hpp"
@@ -213,9 +214,8 @@ BonusRatio GeneralEstimation::estimateLuckRoll(int luckValue, const RngChanceMul
 
 int GeneralEstimation::spellBaseDamage(int targetUnitLevel, const SpellCastParams& castParams, int targetIndex, bool isUnitCast)
 {
-    sol::state lua;
-
-    bindTypes(lua);
+    EstimationScriptRuntime::Session session;
+    sol::state&                      lua = session.lua();
 
     lua["damage"]     = 0;
     lua["spellPower"] = castParams.spellPower;
@@ -227,7 +227,7 @@ int GeneralEstimation::spellBaseDamage(int targetUnitLevel, const SpellCastParam
     lua["index"]      = targetIndex;
 
     for (const auto& calc : castParams.spell->calcScript)
-        lua.script(calc);
+        session.run(calc);
 
     int damage = lua["damage"];
     return damage;
@@ -27,7 +27,7 @@ struct CORELOGIC_EXPORT GeneralEstimation {
         : m_rules(rules)
     {}
 
-    void bindTypes(sol::state& lua);
+    static void bindTypes(sol::state& lua);
 
     int spellBaseDamage(int targetUnitLevel, const SpellCastParams& castParams, int targetIndex, bool isUnitCast);
 
@@ -676,6 +676,36 @@ struct MAPUTIL_EXPORT FHMap {
                 m_unknownObjects);
         }
 
+        auto getAllContainers() noexcept
+        {
+            return std::tie(
+                m_resources,
+                m_resourcesRandom,
+                m_artifacts,
+                m_artifactsRandom,
+                m_monsters,
+                m_dwellings,
+                m_randomDwellings,
+                m_banks,
+                m_obstacles,
+                m_visitables,
+                m_controlledVisitables,
+                m_mines,
+                m_abandonedMines,
+                m_pandoras,
+                m_shrines,
+                m_skillHuts,
+                m_scholars,
+                m_questHuts,
+                m_questGuards,
+                m_localEvents,
+                m_signs,
+                m_garisons,
+                m_heroPlaceholders,
+                m_grails,
+                m_unknownObjects);
+        }
+
         std::vector<const FHCommonObject*> getAllObjects() const noexcept
         {
             std::vector<const FHCommonObject*> result;
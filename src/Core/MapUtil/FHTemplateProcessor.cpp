@@ -7,6 +7,8 @@
 
 #include "MernelReflection/EnumTraitsMacro.hpp"
 #include "MernelPlatform/Profiler.hpp"
+#include "MernelExecution/ParallelExecutor.hpp"
+#include "MernelExecution/TaskQueue.hpp"
 
 #include "LibraryDwelling.hpp"
 #include "LibraryMapBank.hpp"
@@ -25,6 +27,7 @@
 #include <functional>
 #include <stdexcept>
 #include <iostream>
+#include <sstream>
 
 namespace Mernel::Reflection {
 
@@ -63,6 +66,24 @@ FHTemplateProcessor::Stage stringToStage(const std::string& str)
     return result;
 }
 
+// splitmix64 finalizer: independent stream for each (seed, stage, zone).
+uint64_t makeZoneSeed(uint64_t mapSeed, FHTemplateProcessor::Stage stage, size_t zoneIndex)
+{
+    uint64_t z = mapSeed ^ (static_cast<uint64_t>(stage) << 56) ^ ((zoneIndex + 1) * 0x9E3779B97F4A7C15ULL);
+    z          = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z          = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void appendObjects(FHMap::Objects& dest, const FHMap::Objects& src)
+{
+    auto destContainers = dest.getAllContainers();
+    auto srcContainers  = src.getAllContainers();
+    [&destContainers, &srcContainers]<size_t... I>(std::index_sequence<I...>) {
+        (..., std::get<I>(destContainers).insert(std::get<I>(destContainers).end(), std::get<I>(srcContainers).cbegin(), std::get<I>(srcContainers).cend()));
+    }(std::make_index_sequence<std::tuple_size_v<decltype(srcContainers)>>{});
+}
+
 struct DistanceRecord {
     TileZone* m_zoneIndex  = nullptr;
     int64_t   m_distance   = 0;
@@ -117,6 +138,12 @@ FHTemplateProcessor::FHTemplateProcessor(FHMap&                  map,
     }
 }
 
+void FHTemplateProcessor::setParallelZones(const Core::IRandomGeneratorFactory* rngFactory, int jobs)
+{
+    m_rngFactory   = rngFactory;
+    m_parallelJobs = rngFactory ? std::max(jobs, 0) : 0;
+}
+
 std::string FHTemplateProcessor::stageToString(Stage stage)
 {
     auto str = Mernel::Reflection::EnumTraits::enumToString(stage);
@@ -127,6 +154,7 @@ void FHTemplateProcessor::run()
 {
     std::string baseIndent = "      ";
     m_indent               = baseIndent + "  ";
+    m_stageStats.clear();
 
     const int regionCount = m_map.m_template.m_zones.size();
     if (regionCount <= 1)
@@ -263,6 +291,7 @@ void FHTemplateProcessor::run()
         Mernel::ScopeTimer timer;
         m_logOutput << baseIndent << "Start stage: " << stageToString(m_currentStage) << "\n";
         runCurrentStage();
+        m_stageStats.push_back(StageStat{ .m_stage = m_currentStage });
         {
             auto profilerStr = profileContext.printToStr();
             profileContext.clearAll();
@@ -276,8 +305,10 @@ void FHTemplateProcessor::run()
             if (!profilerStr.empty())
                 m_logOutput << baseIndent << "Profiler data:\n"
                             << m_indent << profilerStr2;
+            m_stageStats.back().m_profile = std::move(profilerStr);
         }
-        m_logOutput << baseIndent << "End stage: " << stageToString(m_currentStage) << " (" << timer.elapsedUS() << " us.)\n";
+        m_stageStats.back().m_durationUS = timer.elapsedUS();
+        m_logOutput << baseIndent << "End stage: " << stageToString(m_currentStage) << " (" << m_stageStats.back().m_durationUS << " us.)\n";
 
         if (m_currentStage == m_stopAfter) {
             m_logOutput << baseIndent << "stopping further generation, as 'stopAfter' was provided.\n";
@@ -337,7 +368,7 @@ void FHTemplateProcessor::runZoneCenterPlacement()
                 newPos.m_x = w - newPos.m_x - 1;
             if (vertical)
                 newPos.m_y = h - newPos.m_y - 1;
-            tileZone.m_startTile = m_tileContainer.m_tileIndex.at(newPos);
+            tileZone.m_startTile = m_tileContainer.at(newPos);
         }
     }
     if (m_map.m_template.m_rotationDegreeDispersion) {
@@ -345,7 +376,7 @@ void FHTemplateProcessor::runZoneCenterPlacement()
         m_logOutput << m_indent << "starting rotation of zones to " << rotationDegree << " degrees\n";
         for (auto& tileZone : m_tileZones) {
             auto newPos          = rotateChebyshev(tileZone.m_startTile->m_pos, rotationDegree, w, h);
-            tileZone.m_startTile = m_tileContainer.m_tileIndex.at(newPos);
+            tileZone.m_startTile = m_tileContainer.at(newPos);
         }
     }
 }
@@ -448,8 +479,8 @@ void FHTemplateProcessor::runTownsPlacement()
                 auto townTilePos = pos;
                 townTilePos.m_x -= x;
                 townTilePos.m_y -= y;
-                if (m_tileContainer.m_tileIndex.contains(townTilePos))
-                    townArea.m_innerArea.insert(m_tileContainer.m_tileIndex[townTilePos]);
+                if (m_tileContainer.contains(townTilePos))
+                    townArea.m_innerArea.insert(m_tileContainer.at(townTilePos));
             }
         }
         townArea.makeEdgeFromInnerArea();
@@ -581,28 +612,74 @@ void FHTemplateProcessor::runTownsPlacement()
     }
 }
 
-void FHTemplateProcessor::runCellSegmentation()
+void FHTemplateProcessor::runForEachZone(const ZoneCallback& callback)
 {
-    SegmentHelper segmentHelper(m_map, m_tileContainer, m_rng, m_logOutput, m_extraLogging);
+    if (!m_parallelJobs) {
+        for (auto& tileZone : m_tileZones) {
+            if (isFilteredOut(tileZone))
+                continue;
+
+            callback(tileZone, m_rng, m_logOutput);
+        }
+        return;
+    }
+
+    struct ZoneTask {
+        Core::IRandomGeneratorPtr m_rng;
+        std::ostringstream        m_log;
+        std::exception_ptr        m_error;
+    };
+    std::vector<ZoneTask> zoneTasks(m_tileZones.size());
 
+    Mernel::TaskQueue taskQueue;
     for (auto& tileZone : m_tileZones) {
         if (isFilteredOut(tileZone))
             continue;
 
-        segmentHelper.makeSegments(tileZone);
+        ZoneTask& zoneTask = zoneTasks[tileZone.m_index];
+        zoneTask.m_rng     = m_rngFactory->create();
+        zoneTask.m_rng->setSeed(makeZoneSeed(m_map.m_seed, m_currentStage, tileZone.m_index));
+
+        taskQueue.addTask([&tileZone, &zoneTask, &callback] {
+            Mernel::ProfilerContext                profileContext;
+            Mernel::ProfilerDefaultContextSwitcher switcher(profileContext);
+            try {
+                callback(tileZone, zoneTask.m_rng.get(), zoneTask.m_log);
+            }
+            catch (...) {
+                zoneTask.m_error = std::current_exception();
+            }
+        });
     }
+    Mernel::ParallelExecutor executor(m_parallelJobs);
+    executor.execQueue(taskQueue);
+
+    for (ZoneTask& zoneTask : zoneTasks) {
+        m_logOutput << zoneTask.m_log.str();
+        if (zoneTask.m_error)
+            std::rethrow_exception(zoneTask.m_error);
+    }
+}
+
+void FHTemplateProcessor::runCellSegmentation()
+{
+    runForEachZone([this](TileZone& tileZone, Core::IRandomGenerator* rng, std::ostream& logOutput) {
+        SegmentHelper segmentHelper(m_map, m_tileContainer, rng, logOutput, m_extraLogging);
+        segmentHelper.makeSegments(tileZone);
+    });
 }
 
 void FHTemplateProcessor::runRoadsPlacement()
 {
-    RoadHelper roadHelper(m_map, m_tileContainer, m_rng, m_logOutput, m_extraLogging);
+    runForEachZone([this](TileZone& tileZone, Core::IRandomGenerator* rng, std::ostream& logOutput) {
+        RoadHelper roadHelper(m_map, m_tileContainer, rng, logOutput, m_extraLogging);
+        roadHelper.placeRoads(tileZone);
+    });
 
     for (auto& tileZone : m_tileZones) {
         if (isFilteredOut(tileZone))
             continue;
 
-        roadHelper.placeRoads(tileZone);
-
         for (const auto& [level, region] : tileZone.m_roads.m_byLevel) {
             for (auto* cell : region)
                 m_map.m_tileMap.get(cell->m_pos).m_roadType = level;
@@ -612,26 +689,18 @@ void FHTemplateProcessor::runRoadsPlacement()
 
 void FHTemplateProcessor::runSegmentationRefinement()
 {
-    SegmentHelper segmentHelper(m_map, m_tileContainer, m_rng, m_logOutput, m_extraLogging);
-
-    for (auto& tileZone : m_tileZones) {
-        if (isFilteredOut(tileZone))
-            continue;
-
+    runForEachZone([this](TileZone& tileZone, Core::IRandomGenerator* rng, std::ostream& logOutput) {
+        SegmentHelper segmentHelper(m_map, m_tileContainer, rng, logOutput, m_extraLogging);
         segmentHelper.refineSegments(tileZone);
-    }
+    });
 }
 
 void FHTemplateProcessor::runHeatMap()
 {
-    SegmentHelper segmentHelper(m_map, m_tileContainer, m_rng, m_logOutput, m_extraLogging);
-
-    for (auto& tileZone : m_tileZones) {
-        if (isFilteredOut(tileZone))
-            continue;
-
+    runForEachZone([this](TileZone& tileZone, Core::IRandomGenerator* rng, std::ostream& logOutput) {
+        SegmentHelper segmentHelper(m_map, m_tileContainer, rng, logOutput, m_extraLogging);
         segmentHelper.makeHeatMap(tileZone);
-    }
+    });
 }
 
 void FHTemplateProcessor::runRewards()
@@ -644,94 +713,126 @@ void FHTemplateProcessor::runRewards()
 
     m_logOutput << m_indent << "armyPercent=" << armyPercent << ", goldPercent=" << goldPercent << "\n";
 
-    const ObjectGenerator gen(m_map, m_database, m_rng, m_logOutput);
-
-    const ZoneObjectDistributor objectDistributor(m_map, m_rng, m_tileContainer, m_logOutput);
+    // in parallel mode every zone places objects into own scratch map, which is merged afterwards.
+    const bool                deferred = m_parallelJobs > 0;
+    std::vector<FHMap>        zoneMaps(deferred ? m_tileZones.size() : 0);
+    std::vector<MapGuardList> zoneGuards(m_tileZones.size());
 
-    for (auto& tileZone : m_tileZones) {
+    runForEachZone([&](TileZone& tileZone, Core::IRandomGenerator* rng, std::ostream& logOutput) {
         if (tileZone.m_rngZoneSettings.m_scoreTargets.empty())
-            continue;
+            return;
+
+        FHMap* targetMap = &m_map;
+        if (deferred) {
+            targetMap                      = &zoneMaps[tileZone.m_index];
+            targetMap->m_isWaterMap        = m_map.m_isWaterMap;
+            targetMap->m_disabledHeroes    = m_map.m_disabledHeroes;
+            targetMap->m_disabledArtifacts = m_map.m_disabledArtifacts;
+            targetMap->m_disabledSpells    = m_map.m_disabledSpells;
+            targetMap->m_disabledSkills    = m_map.m_disabledSkills;
+            targetMap->m_disabledBanks     = m_map.m_disabledBanks;
+        }
+        placeZoneRewards(tileZone, *targetMap, zoneGuards[tileZone.m_index], rng, logOutput, armyPercent, goldPercent);
+    });
 
-        if (isFilteredOut(tileZone))
-            continue;
+    for (size_t i = 0; i < m_tileZones.size(); ++i) {
+        if (deferred) {
+            appendObjects(m_map.m_objects, zoneMaps[i].m_objects);
+            m_map.m_debugTiles.insert(m_map.m_debugTiles.end(), zoneMaps[i].m_debugTiles.cbegin(), zoneMaps[i].m_debugTiles.cend());
+        }
+        for (auto& guard : zoneGuards[i])
+            m_guards.push_back(std::move(guard));
+    }
 
-        ZoneObjectDistributor::DistributionResult distributionResultCopy;
-        distributionResultCopy.init(tileZone);
-        distributionResultCopy.m_stopAfterHeat = m_stopAfterHeat;
-
-        auto      objects       = m_map.m_objects;
-        auto      needBeBlocked = tileZone.m_needPlaceObstacles;
-        const int maxAttempts   = 3;
-        for (int i = 1; i <= maxAttempts; ++i) {
-            m_logOutput << m_indent << " --- generate : " << tileZone.m_id << " [attempt " << i << " / " << maxAttempts << "] --- \n";
-            auto zoneObjectGeneration = gen.generate(tileZone.m_rngZoneSettings,
-                                                     tileZone.m_rewardsFaction,
-                                                     tileZone.m_dwellFaction,
-                                                     tileZone.m_terrain,
-                                                     armyPercent,
-                                                     goldPercent);
-
-            auto distributionResult = distributionResultCopy;
-
-            if (objectDistributor.makeInitialDistribution(distributionResult, zoneObjectGeneration)) {
-                objectDistributor.doPlaceDistribution(distributionResult);
-                distributionResultCopy = distributionResult;
-                if (m_showDebug == Stage::Rewards) {
-                    for (auto& seg : distributionResult.m_segments) {
-                        for (auto* object : seg.m_successNormal) {
-                            int paletteSize = distributionResult.m_maxHeat;
-
-                            m_map.m_debugTiles.push_back(FHDebugTile{
-                                .m_pos         = object->m_absPos->m_pos,
-                                .m_penColor    = object->m_preferredHeat + 1, // heatLevel is 0-based
-                                .m_penAlpha    = 120,
-                                .m_penPalette  = paletteSize,
-                                .m_shape       = 1,
-                                .m_shapeRadius = 4,
-                            });
-                            m_map.m_debugTiles.push_back(FHDebugTile{
-                                .m_pos         = object->m_absPos->m_pos,
-                                .m_penColor    = object->m_placedHeat + 1, // heatLevel is 0-based
-                                .m_penAlpha    = 120,
-                                .m_penPalette  = paletteSize,
-                                .m_shape       = 1,
-                                .m_shapeRadius = 1,
-                            });
-                        }
+    m_logOutput << m_indent << "RNG TEST B:" << m_rng->gen(1000000) << "\n";
+}
+
+void FHTemplateProcessor::placeZoneRewards(TileZone&               tileZone,
+                                           FHMap&                  targetMap,
+                                           MapGuardList&           guards,
+                                           Core::IRandomGenerator* rng,
+                                           std::ostream&           logOutput,
+                                           int64_t                 armyPercent,
+                                           int64_t                 goldPercent)
+{
+    const ObjectGenerator gen(targetMap, m_database, rng, logOutput);
+
+    const ZoneObjectDistributor objectDistributor(targetMap, rng, m_tileContainer, logOutput);
+
+    ZoneObjectDistributor::DistributionResult distributionResultCopy;
+    distributionResultCopy.init(tileZone);
+    distributionResultCopy.m_stopAfterHeat = m_stopAfterHeat;
+
+    auto      objects       = targetMap.m_objects;
+    auto      needBeBlocked = tileZone.m_needPlaceObstacles;
+    const int maxAttempts   = 3;
+    for (int i = 1; i <= maxAttempts; ++i) {
+        logOutput << m_indent << " --- generate : " << tileZone.m_id << " [attempt " << i << " / " << maxAttempts << "] --- \n";
+        auto zoneObjectGeneration = gen.generate(tileZone.m_rngZoneSettings,
+                                                 tileZone.m_rewardsFaction,
+                                                 tileZone.m_dwellFaction,
+                                                 tileZone.m_terrain,
+                                                 armyPercent,
+                                                 goldPercent);
+
+        auto distributionResult = distributionResultCopy;
+
+        if (objectDistributor.makeInitialDistribution(distributionResult, zoneObjectGeneration)) {
+            objectDistributor.doPlaceDistribution(distributionResult);
+            distributionResultCopy = distributionResult;
+            if (m_showDebug == Stage::Rewards) {
+                for (auto& seg : distributionResult.m_segments) {
+                    for (auto* object : seg.m_successNormal) {
+                        int paletteSize = distributionResult.m_maxHeat;
+
+                        targetMap.m_debugTiles.push_back(FHDebugTile{
+                            .m_pos         = object->m_absPos->m_pos,
+                            .m_penColor    = object->m_preferredHeat + 1, // heatLevel is 0-based
+                            .m_penAlpha    = 120,
+                            .m_penPalette  = paletteSize,
+                            .m_shape       = 1,
+                            .m_shapeRadius = 4,
+                        });
+                        targetMap.m_debugTiles.push_back(FHDebugTile{
+                            .m_pos         = object->m_absPos->m_pos,
+                            .m_penColor    = object->m_placedHeat + 1, // heatLevel is 0-based
+                            .m_penAlpha    = 120,
+                            .m_penPalette  = paletteSize,
+                            .m_shape       = 1,
+                            .m_shapeRadius = 1,
+                        });
                     }
                 }
-                break;
             }
-
-            if (i == maxAttempts)
-                throw std::runtime_error("Failed to fit some objects into zone '" + tileZone.m_id + "'");
-            m_logOutput << m_indent << "Failed to fit some objects into zone '" + tileZone.m_id + "', retry"
-                        << "\n";
-            m_map.m_objects = objects; // restore map data and try again.
-            m_map.m_debugTiles.clear();
-            tileZone.m_needPlaceObstacles = needBeBlocked;
-        }
-
-        for (auto& guard : distributionResultCopy.m_guards) {
-            guard.m_zone     = &tileZone;
-            guard.m_joinable = true;
-            m_guards.push_back(std::move(guard));
+            break;
         }
 
-        tileZone.m_needPlaceObstacles.insert(distributionResultCopy.m_needBlock);
+        if (i == maxAttempts)
+            throw std::runtime_error("Failed to fit some objects into zone '" + tileZone.m_id + "'");
+        logOutput << m_indent << "Failed to fit some objects into zone '" + tileZone.m_id + "', retry"
+                  << "\n";
+        targetMap.m_objects = objects; // restore map data and try again.
+        targetMap.m_debugTiles.clear();
+        tileZone.m_needPlaceObstacles = needBeBlocked;
+    }
 
-        //for (auto* cell : bundleSet.m_consumeResult.m_centroidsALL) {
-        //    m_map.m_debugTiles.push_back(FHDebugTile{ .m_pos = cell->m_pos, .m_valueA = tileZone.m_index, .m_valueB = 1 }); // red
-        //}
+    for (auto& guard : distributionResultCopy.m_guards) {
+        guard.m_zone     = &tileZone;
+        guard.m_joinable = true;
+        guards.push_back(std::move(guard));
     }
 
-    m_logOutput << m_indent << "RNG TEST B:" << m_rng->gen(1000000) << "\n";
+    tileZone.m_needPlaceObstacles.insert(distributionResultCopy.m_needBlock);
+
+    //for (auto* cell : bundleSet.m_consumeResult.m_centroidsALL) {
+    //    m_map.m_debugTiles.push_back(FHDebugTile{ .m_pos = cell->m_pos, .m_valueA = tileZone.m_index, .m_valueB = 1 }); // red
+    //}
 }
 
 void FHTemplateProcessor::runCorrectObjectTerrains()
 {
     auto correctObjIndexPos = [this](const std::string& id, Core::ObjectDefIndex& defIndex, const Core::ObjectDefMappings& defMapping, FHPos pos) {
-        Core::LibraryTerrainConstPtr requiredTerrain = m_tileContainer.m_tileIndex.at(pos)->m_zone->m_terrain;
+        Core::LibraryTerrainConstPtr requiredTerrain = m_tileContainer.at(pos)->m_zone->m_terrain;
         auto                         old             = defIndex;
         defIndex.substitution                        = "!!";
         defIndex.variant                             = "!!";
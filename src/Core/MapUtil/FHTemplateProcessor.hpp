@@ -50,8 +50,26 @@ public:
     };
     static std::string stageToString(Stage stage);
 
+    // Opt-in parallel mode: per-zone stages (cell segmentation, roads, refinement, heat map, rewards) run as tasks on 'jobs' threads.
+    // Every zone gets own RNG seeded from map seed, stage and zone index; shared map writes and logs are merged in zone order.
+    // Result is reproducible for a seed regardless of 'jobs', but differs from sequential mode (jobs=0, default).
+    void setParallelZones(const Core::IRandomGeneratorFactory* rngFactory, int jobs);
+
     void run();
 
+    struct StageStat {
+        Stage       m_stage      = Stage::Invalid;
+        int64_t     m_durationUS = 0;
+        std::string m_profile; // ProfilerContext output collected during stage.
+    };
+    using StageStats = std::vector<StageStat>;
+
+    // timings of stages executed by the last run().
+    const StageStats& getStageStats() const { return m_stageStats; }
+
+    // zones state after the last run stage, for benchmarks and diagnostics.
+    const std::vector<TileZone>& getTileZones() const { return m_tileZones; }
+
 private:
     void runCurrentStage();
     void runZoneCenterPlacement();
@@ -68,6 +86,17 @@ private:
     void runGuards();
     void runPlayerInfo();
 
+    using ZoneCallback = std::function<void(TileZone& tileZone, Core::IRandomGenerator* rng, std::ostream& logOutput)>;
+    void runForEachZone(const ZoneCallback& callback);
+
+    void placeZoneRewards(TileZone&               tileZone,
+                          FHMap&                  targetMap,
+                          MapGuardList&           guards,
+                          Core::IRandomGenerator* rng,
+                          std::ostream&           logOutput,
+                          int64_t                 armyPercent,
+                          int64_t                 goldPercent);
+
     void placeTerrainZones();
     void placeDebugInfo();
 
@@ -107,11 +136,16 @@ private:
     const int                        m_stopAfterHeat;
     const bool                       m_extraLogging;
 
+    const Core::IRandomGeneratorFactory* m_rngFactory   = nullptr;
+    int                                  m_parallelJobs = 0;
+
 private:
     MapTileContainer       m_tileContainer;
     std::vector<TileZone>  m_tileZones;
     std::vector<TileZone*> m_tileZonesPtrs;
 
+    StageStats m_stageStats;
+
     Stage m_currentStage  = Stage::Invalid;
     bool  m_terrainPlaced = false;
 
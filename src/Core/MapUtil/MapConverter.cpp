@@ -575,7 +575,8 @@ void MapConverter::run(Task task, int recurse) noexcept(false)
 
                 runMember(generateFHMapFromFHTpl);
 
-                run(Task::SaveFH, recurse + 1);
+                if (!m_templateSettings.m_skipSave)
+                    run(Task::SaveFH, recurse + 1);
             } break;
 
             // utilities
@@ -925,6 +926,10 @@ void MapConverter::generateFHMapFromFHTpl()
 
         m_mapFH.applyRngUserSettings(settingsJson);
     }
+    if (m_templateSettings.m_mapSize > 0)
+        m_mapFH.m_template.m_userSettings.m_mapSize = m_templateSettings.m_mapSize;
+    if (m_templateSettings.m_depth > 0)
+        m_mapFH.m_tileMap.m_depth = m_templateSettings.m_depth;
     m_mapFH.rescaleToUserSize();
 
     rng->setSeed(m_mapFH.m_seed);
@@ -937,7 +942,11 @@ void MapConverter::generateFHMapFromFHTpl()
                                   m_templateSettings.m_tileFilter,
                                   m_templateSettings.m_stopAfterHeat,
                                   m_templateSettings.m_extraLogging);
+    if (m_templateSettings.m_zoneJobs > 0)
+        converter.setParallelZones(m_rngFactory, m_templateSettings.m_zoneJobs);
+    m_generationStats.clear();
     converter.run();
+    m_generationStats = converter.getStageStats();
 }
 
 void MapConverter::checkBinaryInputOutputEquality()
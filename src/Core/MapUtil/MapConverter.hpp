@@ -12,6 +12,7 @@
 #include "H3MMap.hpp"
 #include "H3CCampaign.hpp"
 #include "FHMap.hpp"
+#include "FHTemplateProcessor.hpp"
 #include "H3Template.hpp"
 
 #include "MapConverterFile.hpp"
@@ -67,6 +68,10 @@ public:
         std::string      m_showDebugStage;
         std::string      m_tileFilter;
         int              m_stopAfterHeat = 1000;
+        int              m_zoneJobs      = 0; // >0 enables parallel per-zone generation
+        int              m_mapSize       = 0; // >0 overrides user settings map size
+        int              m_depth         = 0; // >0 overrides template depth (2 for underground)
+        bool             m_skipSave      = false; // GenerateFHMap keeps the map in memory only (benchmarks)
     };
 
     enum class Task
@@ -150,6 +155,8 @@ public: // todo:
     MapConverterFile   m_mainFile;
     MapConverterFolder m_folder;
 
+    FHTemplateProcessor::StageStats m_generationStats; // filled by GenerateFHMap
+
 private:
     using MemberProc = void (MapConverter::*)(void);
     void run(MemberProc member, const char* descr, int recurse) noexcept(false);
@@ -5,91 +5,207 @@
  */
 #include "AstarGenerator.hpp"
 
+#include "MapTileContainer.hpp"
 #include "TemplateUtils.hpp"
 
 namespace FreeHeroes {
 
-AstarGenerator::Node::Node(MapTilePtr pos, AstarGenerator::Node* parent)
+namespace {
+
+constexpr uint32_t g_noParent = uint32_t(-1);
+
+enum class NodeState : uint8_t
 {
-    m_parent = parent;
-    m_pos    = pos;
+    Unvisited,
+    Open,
+    Closed,
+};
+
+struct NodeData {
+    uint64_t  m_G       = 0;
+    uint64_t  m_score   = 0;
+    uint32_t  m_parent  = g_noParent;
+    uint32_t  m_seq     = 0; // order of adding to open set, used for tie-breaking.
+    uint32_t  m_heapPos = 0;
+    uint32_t  m_epoch   = 0;
+    NodeState m_state   = NodeState::Unvisited;
+};
+
+// Per-thread storage reused between findPath() calls; epoch counter makes clearing O(1).
+struct Workspace {
+    std::vector<NodeData> m_nodes;
+    std::vector<uint32_t> m_heap;
+    uint32_t              m_epoch = 0;
+
+    void prepare(size_t tileCount)
+    {
+        if (m_nodes.size() < tileCount)
+            m_nodes.resize(tileCount);
+        if (++m_epoch == 0) {
+            for (auto& node : m_nodes)
+                node.m_epoch = 0;
+            m_epoch = 1;
+        }
+        m_heap.clear();
+    }
+
+    NodeData& node(uint32_t index)
+    {
+        NodeData& data = m_nodes[index];
+        if (data.m_epoch != m_epoch) {
+            data         = NodeData{};
+            data.m_epoch = m_epoch;
+        }
+        return data;
+    }
+
+    // heap top is the node with lowest score; on equal score - with highest sequence number.
+    bool less(uint32_t l, uint32_t r) const
+    {
+        const NodeData& ld = m_nodes[l];
+        const NodeData& rd = m_nodes[r];
+        if (ld.m_score != rd.m_score)
+            return ld.m_score < rd.m_score;
+        return ld.m_seq > rd.m_seq;
+    }
+
+    void place(size_t pos, uint32_t index)
+    {
+        m_heap[pos]              = index;
+        m_nodes[index].m_heapPos = static_cast<uint32_t>(pos);
+    }
+
+    void siftUp(size_t pos)
+    {
+        const uint32_t index = m_heap[pos];
+        while (pos > 0) {
+            const size_t parent = (pos - 1) / 2;
+            if (!less(index, m_heap[parent]))
+                break;
+            place(pos, m_heap[parent]);
+            pos = parent;
+        }
+        place(pos, index);
+    }
+
+    void siftDown(size_t pos)
+    {
+        const uint32_t index = m_heap[pos];
+        const size_t   size  = m_heap.size();
+        while (true) {
+            size_t child = pos * 2 + 1;
+            if (child >= size)
+                break;
+            if (child + 1 < size && less(m_heap[child + 1], m_heap[child]))
+                child++;
+            if (!less(m_heap[child], index))
+                break;
+            place(pos, m_heap[child]);
+            pos = child;
+        }
+        place(pos, index);
+    }
+
+    void push(uint32_t index)
+    {
+        m_heap.push_back(index);
+        siftUp(m_heap.size() - 1);
+    }
+
+    uint32_t pop()
+    {
+        const uint32_t top  = m_heap[0];
+        const uint32_t last = m_heap.back();
+        m_heap.pop_back();
+        if (!m_heap.empty()) {
+            place(0, last);
+            siftDown(0);
+        }
+        return top;
+    }
+};
+
+Workspace& threadWorkspace()
+{
+    thread_local Workspace workspace;
+    return workspace;
+}
+
 }
 
-uint64_t AstarGenerator::Node::getScore()
+void AstarGenerator::setNonCollision(const MapTileRegion& nonCollision)
 {
-    return m_G + m_H;
+    m_nonCollision = nonCollision.empty() ? MapTileRegionBitset() : MapTileRegionBitset(nonCollision[0]->m_container, nonCollision);
 }
 
 MapTilePtrList AstarGenerator::findPath()
 {
     m_success = false;
 
-    std::shared_ptr<Node> current;
-    NodeSet               openSet, closedSet;
-    openSet.m_data.reserve(100);
-    closedSet.m_data.reserve(100);
-    openSet.add(std::make_shared<Node>(m_source));
-
-    while (!openSet.m_data.empty()) {
-        auto current_it = openSet.m_data.begin();
-        current         = *current_it;
-
-        {
-            for (auto it = openSet.m_data.begin(); it != openSet.m_data.end(); it++) {
-                auto node = *it;
-                if (node->getScore() <= current->getScore()) {
-                    current    = node;
-                    current_it = it;
-                }
-            }
-        }
+    MapTileContainer* container = m_source->m_container;
+    Workspace&        ws        = threadWorkspace();
+    ws.prepare(container->getTileCount());
+
+    uint32_t seq = 0;
+
+    const uint32_t sourceIndex = static_cast<uint32_t>(m_source->m_index);
+    {
+        NodeData& source = ws.node(sourceIndex);
+        source.m_state   = NodeState::Open;
+        source.m_seq     = seq++;
+        ws.push(sourceIndex);
+    }
 
-        if (current->m_pos == m_target) {
+    uint32_t current = sourceIndex;
+    while (!ws.m_heap.empty()) {
+        current = ws.pop();
+        if (container->tileByIndex(current) == m_target) {
             m_success = true;
             break;
         }
 
-        {
-            closedSet.add(current);
-            openSet.erase(current_it);
-        }
-        Node* currentRaw = current.get();
+        NodeData& currentData   = ws.m_nodes[current];
+        currentData.m_state     = NodeState::Closed;
+        const uint64_t currentG = currentData.m_G;
 
-        auto applyCandidate = [this, currentRaw, &openSet, &closedSet](uint64_t cost, MapTilePtr newCoordinates) {
-            if (!m_nonCollision.contains(newCoordinates) || closedSet.find(newCoordinates)) {
+        auto applyCandidate = [this, &ws, &seq, current, currentG](uint64_t cost, MapTilePtr newCoordinates) {
+            if (!m_nonCollision.contains(newCoordinates))
+                return;
+            const uint32_t index     = static_cast<uint32_t>(newCoordinates->m_index);
+            NodeData&      successor = ws.node(index);
+            if (successor.m_state == NodeState::Closed)
                 return;
-            }
 
-            uint64_t totalCost = currentRaw->m_G + cost;
-
-            Node* successorRaw = openSet.find(newCoordinates);
-            if (successorRaw == nullptr) {
-                auto successor = std::make_shared<Node>(newCoordinates, currentRaw);
-                successor->m_G = totalCost;
-                successor->m_H = posDistance(successor->m_pos->m_pos, m_target->m_pos) * 10;
-                openSet.add(successor);
-            } else if (totalCost < successorRaw->m_G) {
-                successorRaw->m_parent = currentRaw;
-                successorRaw->m_G      = totalCost;
+            const uint64_t totalCost = currentG + cost;
+            if (successor.m_state == NodeState::Unvisited) {
+                successor.m_parent = current;
+                successor.m_G      = totalCost;
+                successor.m_score  = totalCost + posDistance(newCoordinates->m_pos, m_target->m_pos) * 10;
+                successor.m_state  = NodeState::Open;
+                successor.m_seq    = seq++;
+                ws.push(index);
+            } else if (totalCost < successor.m_G) {
+                successor.m_score -= successor.m_G - totalCost;
+                successor.m_parent = current;
+                successor.m_G      = totalCost;
+                ws.siftUp(successor.m_heapPos);
             }
         };
 
-        for (MapTilePtr newCoordinates : currentRaw->m_pos->m_orthogonalNeighbours) {
+        const MapTilePtr currentTile = container->tileByIndex(current);
+        for (MapTilePtr newCoordinates : currentTile->m_orthogonalNeighbours) {
             applyCandidate(10, newCoordinates);
         }
         if (m_useDiag) {
-            for (MapTilePtr newCoordinates : currentRaw->m_pos->m_diagNeighbours) {
+            for (MapTilePtr newCoordinates : currentTile->m_diagNeighbours) {
                 applyCandidate(14, newCoordinates);
             }
         }
     }
 
     MapTilePtrList path;
-    Node*          currentRaw = current.get();
-    while (currentRaw != nullptr) {
-        path.push_back(currentRaw->m_pos);
-        currentRaw = currentRaw->m_parent;
-    }
+    for (uint32_t index = current; index != g_noParent; index = ws.m_nodes[index].m_parent)
+        path.push_back(container->tileByIndex(index));
 
     return path;
 }
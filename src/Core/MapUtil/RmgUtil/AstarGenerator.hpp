@@ -7,47 +7,19 @@
 
 #include <cstdint>
 #include <vector>
-#include <memory>
-#include <set>
-#include <unordered_set>
 
-#include "MapTileRegionWithEdge.hpp"
+#include "MapTileRegionBitset.hpp"
 
-namespace FreeHeroes {
-
-class AstarGenerator {
-public:
-    struct Node {
-        uint64_t   m_G = 0, m_H = 0;
-        MapTilePtr m_pos    = nullptr;
-        Node*      m_parent = nullptr;
+#include "MapUtilExport.hpp"
 
-        Node(MapTilePtr pos, Node* parent = nullptr);
-        uint64_t getScore();
-    };
-
-    struct NodeSet {
-        using Vec = std::vector<std::shared_ptr<Node>>;
-        Vec                                   m_data;
-        std::unordered_map<MapTilePtr, Node*> m_used;
-
-        void add(std::shared_ptr<Node> node)
-        {
-            m_data.push_back(node);
-            m_used[node->m_pos] = node.get();
-        }
-        void erase(const Vec::iterator& it)
-        {
-            m_used.erase(it->get()->m_pos);
-            m_data.erase(it);
-        }
-        Node* find(MapTilePtr pos) const
-        {
-            auto it = m_used.find(pos);
-            return it == m_used.cend() ? nullptr : it->second;
-        }
-    };
+namespace FreeHeroes {
 
+// A* over MapTile graph.
+// Open set is an indexed binary heap, per-tile G/parent/state are kept in dense arrays indexed by MapTile::m_index
+// (reused between calls on the same thread), passability is a MapTileRegionBitset.
+// Tie-breaking matches the original linear-scan implementation:
+// among nodes with equal score the most recently opened one is expanded first.
+class MAPUTIL_EXPORT AstarGenerator {
 public:
     AstarGenerator(bool useDiag = true)
         : m_useDiag(useDiag)
@@ -62,11 +34,11 @@ public:
 
     bool isSuccess() const { return m_success; }
 
-    void setNonCollision(MapTileRegion nonCollision) { m_nonCollision = std::move(nonCollision); }
+    void setNonCollision(const MapTileRegion& nonCollision);
 
 private:
-    const bool    m_useDiag;
-    MapTileRegion m_nonCollision;
+    const bool          m_useDiag;
+    MapTileRegionBitset m_nonCollision;
 
     MapTilePtr m_source = nullptr;
     MapTilePtr m_target = nullptr;
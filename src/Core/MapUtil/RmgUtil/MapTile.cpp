@@ -66,9 +66,7 @@ MapTilePtr MapTile::neighbourByOffset(FHPos offset) const noexcept
         }
     }
 
-    const auto pos = m_pos + offset;
-    auto       it  = m_container->m_tileIndex.find(pos);
-    return it == m_container->m_tileIndex.cend() ? nullptr : it->second;
+    return m_container->find(m_pos + offset);
 }
 
 MapTilePtrList MapTile::neighboursByOffsets(const std::vector<FHPos>& offsets, const Transform& transform) const noexcept
@@ -32,6 +32,7 @@ struct MAPUTIL_EXPORT MapTile {
     FHPos m_pos;
 
     MapTileContainer* m_container     = nullptr;
+    size_t            m_index         = 0; // dense index inside container, [0, getTileCount())
     TileZone*         m_zone          = nullptr;
     MapTileSegment*   m_segmentMedium = nullptr;
 
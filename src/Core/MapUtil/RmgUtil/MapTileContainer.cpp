@@ -21,10 +21,9 @@ void MapTileContainer::init(int width, int height, int depth)
         for (int y = 0; y < height; ++y) {
             for (int x = 0; x < width; ++x) {
                 MapTilePtr tile = &m_tiles[index++];
-                FHPos      p{ x, y, z };
-                m_tileIndex[p]    = tile;
-                tile->m_pos       = p;
+                tile->m_pos       = FHPos{ x, y, z };
                 tile->m_container = this;
+                tile->m_index     = index - 1;
             }
         }
     }
@@ -34,19 +33,19 @@ void MapTileContainer::init(int width, int height, int depth)
             for (int x = 0; x < width; ++x) {
                 MapTilePtr tile = &m_tiles[index++];
                 if (x > 0) {
-                    tile->m_neighborL = m_tileIndex.at({ x - 1, y, z });
+                    tile->m_neighborL = at({ x - 1, y, z });
                     tile->m_orthogonalNeighbours.push_back(tile->m_neighborL);
                 }
                 if (y > 0) {
-                    tile->m_neighborT = m_tileIndex.at({ x, y - 1, z });
+                    tile->m_neighborT = at({ x, y - 1, z });
                     tile->m_orthogonalNeighbours.push_back(tile->m_neighborT);
                 }
                 if (x < width - 1) {
-                    tile->m_neighborR = m_tileIndex.at({ x + 1, y, z });
+                    tile->m_neighborR = at({ x + 1, y, z });
                     tile->m_orthogonalNeighbours.push_back(tile->m_neighborR);
                 }
                 if (y < height - 1) {
-                    tile->m_neighborB = m_tileIndex.at({ x, y + 1, z });
+                    tile->m_neighborB = at({ x, y + 1, z });
                     tile->m_orthogonalNeighbours.push_back(tile->m_neighborB);
                 }
                 tile->m_allNeighboursWithDiag = tile->m_orthogonalNeighbours;
@@ -98,7 +97,7 @@ void MapTileContainer::init(int width, int height, int depth)
         std::sort(cell.m_allNeighboursWithDiag.begin(), cell.m_allNeighboursWithDiag.end());
     }
 
-    m_centerTile = m_tileIndex[FHPos{ width / 2, height / 2, 0 }];
+    m_centerTile = at(FHPos{ width / 2, height / 2, 0 });
 }
 
 }
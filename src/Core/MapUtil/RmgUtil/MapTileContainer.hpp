@@ -11,6 +11,7 @@
 #include "MapUtilExport.hpp"
 
 #include <set>
+#include <stdexcept>
 #include <unordered_map>
 
 namespace FreeHeroes {
@@ -24,17 +25,36 @@ public:
     MapTileRegion m_all;
     MapTileRegion m_innerEdge;
 
-    std::unordered_map<FHPos, MapTilePtr> m_tileIndex;
-    MapTilePtr                            m_centerTile = nullptr;
+    MapTilePtr m_centerTile = nullptr;
 
     void init(int width, int height, int depth);
 
+    bool contains(FHPos pos) const noexcept
+    {
+        return pos.m_x >= 0 && pos.m_x < m_width
+               && pos.m_y >= 0 && pos.m_y < m_height
+               && pos.m_z >= 0 && pos.m_z < m_depth;
+    }
+
+    // tiles are stored in z, y, x order, so position maps to dense index directly.
     MapTilePtr find(FHPos pos) const noexcept
     {
-        auto it = m_tileIndex.find(pos);
-        return it == m_tileIndex.cend() ? nullptr : it->second;
+        if (!contains(pos))
+            return nullptr;
+        return const_cast<MapTilePtr>(&m_tiles[(size_t(pos.m_z) * m_height + pos.m_y) * m_width + pos.m_x]);
     }
 
+    MapTilePtr at(FHPos pos) const
+    {
+        MapTilePtr tile = find(pos);
+        if (!tile)
+            throw std::out_of_range("Tile position is out of map bounds: " + pos.toPrintableString());
+        return tile;
+    }
+
+    size_t     getTileCount() const noexcept { return m_tiles.size(); }
+    MapTilePtr tileByIndex(size_t index) noexcept { return &m_tiles[index]; }
+
 private:
     std::vector<MapTile> m_tiles;
 };
@@ -5,8 +5,10 @@
  */
 #include "MapTileRegion.hpp"
 #include "MapTileContainer.hpp"
+#include "MapTileRegionBitset.hpp"
 #include "MapTileRegionSegmentation.hpp"
 
+#include <algorithm>
 #include <iostream>
 
 namespace FreeHeroes {
@@ -55,7 +57,7 @@ MapTilePtr MapTileRegion::makeCentroid(bool ensureInbounds) const
     sumX /= size;
     sumY /= size;
     const auto pos      = FHPos{ static_cast<int>(sumX), static_cast<int>(sumY), z };
-    MapTilePtr centroid = tileContainer->m_tileIndex.at(pos);
+    MapTilePtr centroid = tileContainer->at(pos);
     if (ensureInbounds && !region.contains(centroid))
         centroid = findClosestPoint(centroid->m_pos);
 
@@ -112,35 +114,40 @@ MapTileRegion MapTileRegion::makeOuterEdge(bool useDiag) const
 EdgeSegmentationResults MapTileRegion::makeInnerAndOuterEdge(EdgeSegmentationParams params) const
 {
     //Mernel::ProfilerScope scope("makeInnerAndOuterEdge");
-    const int64_t           diameter       = intSqrt(static_cast<int64_t>(size()));
-    const size_t            perimeterInner = diameter * 4;
-    const size_t            perimeterOuter = (diameter + 2) * 4;
     EdgeSegmentationResults result;
+    if (empty())
+        return result;
+
+    const int64_t diameter       = intSqrt(static_cast<int64_t>(size()));
+    const size_t  perimeterInner = diameter * 4;
     if (params.m_makeInner)
         result.m_inner.reserve(perimeterInner);
-    if (params.m_makeOuter)
-        result.m_outer.reserve(perimeterOuter);
     if (params.m_makeCenter)
         result.m_center.reserve(size());
+
+    // bounding box bitsets: edges are built for small zone parts many times per generation, whole-map words cost too much there.
+    MapTileRegionBitset self  = MapTileRegionBitset::makeBoundingBox(*this);
+    MapTileRegionBitset outer = self;
+    self.insert(*this);
     for (MapTilePtr cell : *this) {
         if (params.m_useDiag) {
-            if (contains(cell->m_neighborB)
-                && contains(cell->m_neighborT)
-                && contains(cell->m_neighborR)
-                && contains(cell->m_neighborL)
-                && contains(cell->m_neighborTL)
-                && contains(cell->m_neighborTR)
-                && contains(cell->m_neighborBL)
-                && contains(cell->m_neighborBR)) {
+            if (self.contains(cell->m_neighborB)
+                && self.contains(cell->m_neighborT)
+                && self.contains(cell->m_neighborR)
+                && self.contains(cell->m_neighborL)
+                && self.contains(cell->m_neighborTL)
+                && self.contains(cell->m_neighborTR)
+                && self.contains(cell->m_neighborBL)
+                && self.contains(cell->m_neighborBR)) {
                 if (params.m_makeCenter)
                     result.m_center.insert(cell);
                 continue;
             }
         } else {
-            if (contains(cell->m_neighborB)
-                && contains(cell->m_neighborT)
-                && contains(cell->m_neighborR)
-                && contains(cell->m_neighborL)) {
+            if (self.contains(cell->m_neighborB)
+                && self.contains(cell->m_neighborT)
+                && self.contains(cell->m_neighborR)
+                && self.contains(cell->m_neighborL)) {
                 if (params.m_makeCenter)
                     result.m_center.insert(cell);
                 continue;
@@ -150,11 +157,13 @@ EdgeSegmentationResults MapTileRegion::makeInnerAndOuterEdge(EdgeSegmentationPar
             result.m_inner.insert(cell);
         if (params.m_makeOuter) {
             for (auto* ncell : cell->neighboursList(params.m_useDiag)) {
-                if (!contains(ncell))
-                    result.m_outer.insert(ncell);
+                if (!self.contains(ncell))
+                    outer.insert(ncell);
             }
         }
     }
+    if (params.m_makeOuter)
+        result.m_outer = outer.toRegion();
 
     return result;
 }
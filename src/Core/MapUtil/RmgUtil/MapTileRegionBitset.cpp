@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+#include "MapTileRegionBitset.hpp"
+
+#include "MapTileContainer.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace FreeHeroes {
+
+MapTileRegionBitset::MapTileRegionBitset(MapTileContainer* container)
+    : m_container(container)
+    , m_width(container->m_width)
+    , m_height(container->m_height)
+    , m_depth(container->m_depth)
+    , m_words((container->getTileCount() + 63) / 64)
+{
+}
+
+MapTileRegionBitset::MapTileRegionBitset(MapTileContainer* container, const MapTileRegion& region)
+    : MapTileRegionBitset(container)
+{
+    insert(region);
+}
+
+MapTileRegionBitset MapTileRegionBitset::makeBoundingBox(const MapTileRegion& region, int margin)
+{
+    assert(!region.empty());
+    FHPos minPos = region[0]->m_pos;
+    FHPos maxPos = minPos;
+    for (MapTilePtr tile : region) {
+        minPos.m_x = std::min(minPos.m_x, tile->m_pos.m_x);
+        minPos.m_y = std::min(minPos.m_y, tile->m_pos.m_y);
+        minPos.m_z = std::min(minPos.m_z, tile->m_pos.m_z);
+        maxPos.m_x = std::max(maxPos.m_x, tile->m_pos.m_x);
+        maxPos.m_y = std::max(maxPos.m_y, tile->m_pos.m_y);
+        maxPos.m_z = std::max(maxPos.m_z, tile->m_pos.m_z);
+    }
+    MapTileRegionBitset result;
+    result.m_container = region[0]->m_container;
+    result.m_wholeMap  = false;
+    result.m_origin    = FHPos{ minPos.m_x - margin, minPos.m_y - margin, minPos.m_z };
+    result.m_width     = maxPos.m_x - minPos.m_x + 1 + 2 * margin;
+    result.m_height    = maxPos.m_y - minPos.m_y + 1 + 2 * margin;
+    result.m_depth     = maxPos.m_z - minPos.m_z + 1;
+    result.m_words.resize((static_cast<size_t>(result.m_width) * result.m_height * result.m_depth + 63) / 64);
+    return result;
+}
+
+void MapTileRegionBitset::insert(const MapTileRegion& region) noexcept
+{
+    for (MapTilePtr tile : region)
+        insert(tile);
+}
+
+void MapTileRegionBitset::erase(const MapTileRegion& region) noexcept
+{
+    for (MapTilePtr tile : region)
+        erase(tile);
+}
+
+void MapTileRegionBitset::clear() noexcept
+{
+    std::fill(m_words.begin(), m_words.end(), 0);
+}
+
+bool MapTileRegionBitset::empty() const noexcept
+{
+    return std::all_of(m_words.cbegin(), m_words.cend(), [](uint64_t word) { return word == 0; });
+}
+
+size_t MapTileRegionBitset::size() const noexcept
+{
+    size_t result = 0;
+    for (uint64_t word : m_words)
+        result += std::popcount(word);
+    return result;
+}
+
+MapTilePtr MapTileRegionBitset::first() const noexcept
+{
+    size_t wordHint = 0;
+    return first(wordHint);
+}
+
+MapTilePtr MapTileRegionBitset::first(size_t& wordHint) const noexcept
+{
+    for (; wordHint < m_words.size(); ++wordHint) {
+        if (m_words[wordHint])
+            return tileByIndex(wordHint * 64 + std::countr_zero(m_words[wordHint]));
+    }
+    return nullptr;
+}
+
+MapTileRegionBitset& MapTileRegionBitset::operator|=(const MapTileRegionBitset& other) noexcept
+{
+    assert(m_wholeMap == other.m_wholeMap && m_origin == other.m_origin && m_width == other.m_width && m_height == other.m_height);
+    const size_t count = std::min(m_words.size(), other.m_words.size());
+    for (size_t i = 0; i < count; ++i)
+        m_words[i] |= other.m_words[i];
+    return *this;
+}
+
+MapTileRegionBitset& MapTileRegionBitset::operator&=(const MapTileRegionBitset& other) noexcept
+{
+    assert(m_wholeMap == other.m_wholeMap && m_origin == other.m_origin && m_width == other.m_width && m_height == other.m_height);
+    const size_t count = std::min(m_words.size(), other.m_words.size());
+    for (size_t i = 0; i < count; ++i)
+        m_words[i] &= other.m_words[i];
+    std::fill(m_words.begin() + count, m_words.end(), 0);
+    return *this;
+}
+
+MapTileRegionBitset& MapTileRegionBitset::operator-=(const MapTileRegionBitset& other) noexcept
+{
+    assert(m_wholeMap == other.m_wholeMap && m_origin == other.m_origin && m_width == other.m_width && m_height == other.m_height);
+    const size_t count = std::min(m_words.size(), other.m_words.size());
+    for (size_t i = 0; i < count; ++i)
+        m_words[i] &= ~other.m_words[i];
+    return *this;
+}
+
+MapTileRegion MapTileRegionBitset::toRegion() const
+{
+    MapTilePtrSortedList list;
+    list.reserve(size());
+    forEach([&list](MapTilePtr tile) { list.push_back(tile); });
+    return MapTileRegion(std::move(list));
+}
+
+MapTilePtr MapTileRegionBitset::tileByIndex(size_t index) const noexcept
+{
+    if (m_wholeMap)
+        return m_container->tileByIndex(index);
+
+    const int x = static_cast<int>(index % m_width);
+    const int y = static_cast<int>(index / m_width % m_height);
+    const int z = static_cast<int>(index / m_width / m_height);
+    return m_container->find(FHPos{ m_origin.m_x + x, m_origin.m_y + y, m_origin.m_z + z });
+}
+
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+#pragma once
+
+#include "MapTile.hpp"
+#include "MapTileRegion.hpp"
+
+#include "MapUtilExport.hpp"
+
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+namespace FreeHeroes {
+
+// Alternative MapTileRegion representation: one bit per tile of a box, tiles in z, y, x order like MapTile::m_index.
+// The box is either the whole container (bit index is MapTile::m_index) or a region bounding box, for small regions
+// on a big map where whole-map words would cost more than the work itself. Set operations need the same box on both sides.
+// Membership is O(1), set operations are word-wise loops (compiler vectorizes them).
+// Tile index order equals pointer order, so iteration and toRegion() give the same order as MapTileRegion.
+class MAPUTIL_EXPORT MapTileRegionBitset {
+public:
+    MapTileRegionBitset() = default;
+    explicit MapTileRegionBitset(MapTileContainer* container);
+    MapTileRegionBitset(MapTileContainer* container, const MapTileRegion& region);
+
+    // empty bitset over region bounding box grown by margin tiles in x and y, so it can hold region neighbours too.
+    static MapTileRegionBitset makeBoundingBox(const MapTileRegion& region, int margin = 1);
+
+    bool operator==(const MapTileRegionBitset&) const = default;
+
+    MapTileContainer* getContainer() const noexcept { return m_container; }
+
+    bool contains(MapTilePtr tile) const noexcept
+    {
+        if (!tile)
+            return false;
+        if (m_wholeMap) {
+            const size_t word = tile->m_index / 64;
+            return word < m_words.size() && (m_words[word] >> (tile->m_index % 64)) & 1U;
+        }
+        if (!inBox(tile->m_pos))
+            return false;
+        const size_t index = boxIndex(tile->m_pos);
+        return (m_words[index / 64] >> (index % 64)) & 1U;
+    }
+
+    // tile must be inside the box.
+    void insert(MapTilePtr tile) noexcept
+    {
+        const size_t index = bitIndex(tile);
+        m_words[index / 64] |= uint64_t(1) << (index % 64);
+    }
+    void erase(MapTilePtr tile) noexcept
+    {
+        const size_t index = bitIndex(tile);
+        m_words[index / 64] &= ~(uint64_t(1) << (index % 64));
+    }
+
+    void insert(const MapTileRegion& region) noexcept;
+    void erase(const MapTileRegion& region) noexcept;
+
+    void clear() noexcept;
+
+    bool   empty() const noexcept;
+    size_t size() const noexcept;
+
+    // tile with lowest index, or nullptr if empty.
+    MapTilePtr first() const noexcept;
+    // same, but scan starts from wordHint, which is updated to the found word.
+    // Resuming from previous result is valid while only erase() is called in between.
+    MapTilePtr first(size_t& wordHint) const noexcept;
+
+    MapTileRegionBitset& operator|=(const MapTileRegionBitset& other) noexcept;
+    MapTileRegionBitset& operator&=(const MapTileRegionBitset& other) noexcept;
+    MapTileRegionBitset& operator-=(const MapTileRegionBitset& other) noexcept;
+
+    MapTileRegionBitset unionWith(const MapTileRegionBitset& other) const { return MapTileRegionBitset(*this) |= other; }
+    MapTileRegionBitset intersectWith(const MapTileRegionBitset& other) const { return MapTileRegionBitset(*this) &= other; }
+    MapTileRegionBitset diffWith(const MapTileRegionBitset& other) const { return MapTileRegionBitset(*this) -= other; }
+
+    MapTileRegion toRegion() const;
+
+    // calls callback(MapTilePtr) in ascending index order.
+    void forEach(auto&& callback) const
+    {
+        for (size_t word = 0; word < m_words.size(); ++word) {
+            uint64_t bits = m_words[word];
+            while (bits) {
+                const size_t bit = std::countr_zero(bits);
+                bits &= bits - 1;
+                callback(tileByIndex(word * 64 + bit));
+            }
+        }
+    }
+
+private:
+    bool inBox(const FHPos& pos) const noexcept
+    {
+        // negative offsets wrap to large unsigned values.
+        return static_cast<unsigned>(pos.m_x - m_origin.m_x) < static_cast<unsigned>(m_width)
+               && static_cast<unsigned>(pos.m_y - m_origin.m_y) < static_cast<unsigned>(m_height)
+               && static_cast<unsigned>(pos.m_z - m_origin.m_z) < static_cast<unsigned>(m_depth);
+    }
+    size_t boxIndex(const FHPos& pos) const noexcept
+    {
+        return (static_cast<size_t>(pos.m_z - m_origin.m_z) * m_height + (pos.m_y - m_origin.m_y)) * m_width + (pos.m_x - m_origin.m_x);
+    }
+    size_t bitIndex(MapTilePtr tile) const noexcept { return m_wholeMap ? tile->m_index : boxIndex(tile->m_pos); }
+
+    MapTilePtr tileByIndex(size_t index) const noexcept;
+
+private:
+    MapTileContainer*     m_container = nullptr;
+    bool                  m_wholeMap  = true;
+    FHPos                 m_origin;
+    int                   m_width  = 0;
+    int                   m_height = 0;
+    int                   m_depth  = 0;
+    std::vector<uint64_t> m_words;
+};
+
+}
@@ -1,9 +1,11 @@
 #include "MapTileRegionSegmentation.hpp"
 
 #include "MapTileContainer.hpp"
+#include "MapTileRegionBitset.hpp"
 
 #include "BonusRatio.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 
@@ -38,27 +40,6 @@ struct KMeansData {
                    + " points: " + toPrintableStringPoints() + "}";
         }
 
-        int64_t distanceTo(MapTilePtr point) const
-        {
-            const auto dx = int64_t(m_centroid.m_x - point->m_pos.m_x) * 1000; // max 20bit
-            const auto dy = int64_t(m_centroid.m_y - point->m_pos.m_y) * 1000;
-
-            // prevent branching as much as possible
-            const auto arg = dx * dx + dy * dy; // max 40bit
-
-            const int64_t linearDistancePromille  = intSqrt(arg);
-            const int64_t distanceToCircumference = linearDistancePromille - m_radiusPromille;
-            const bool    isInside                = (distanceToCircumference <= 0);
-            const bool    isOutside               = !isInside;
-            const int64_t innerDistance           = isInside * linearDistancePromille + isOutside * m_radiusPromille;
-            const int64_t outerDistance           = isOutside * distanceToCircumference;
-
-            const int64_t innerWeighted = innerDistance * m_settings.m_insideWeight;
-            const int64_t outerWeighted = outerDistance * m_settings.m_outsideWeight;
-
-            return innerWeighted + outerWeighted;
-        }
-
         void updateCentroid()
         {
             m_centerMass.m_z = m_centroid.m_z;
@@ -72,9 +53,10 @@ struct KMeansData {
             m_pointsCount    = m_settings.m_extraMassWeight;
             m_points.clear();
         }
-        void addToMass(FHPos pos)
+        void addToMass(int x, int y)
         {
-            m_centerMass = m_centerMass + pos;
+            m_centerMass.m_x += x;
+            m_centerMass.m_y += y;
             m_pointsCount++;
         }
         void finalizeMass()
@@ -96,13 +78,11 @@ struct KMeansData {
     }
     void assignPoints(bool isDone)
     {
-        for (size_t i = 0; MapTilePtr tile : *m_region) {
-            const size_t clusterId = m_nearestIndex[i];
-            m_clusters[clusterId].addToMass(tile->m_pos);
-            if (isDone) {
-                m_clusters[clusterId].m_points.push_back(tile);
-            }
-            i++;
+        for (size_t i = 0; i < m_nearestIndex.size(); i++)
+            m_clusters[m_nearestIndex[i]].addToMass(m_x[i], m_y[i]);
+        if (isDone) {
+            for (size_t i = 0; MapTilePtr tile : *m_region)
+                m_clusters[m_nearestIndex[i++]].m_points.push_back(tile);
         }
     }
     void finalizeMass()
@@ -126,7 +106,7 @@ struct KMeansData {
                 hasIntersections = true;
                 break;
             }
-            if (!m_region->contains(m_container->m_tileIndex.at(cluster.m_centroid))) {
+            if (!m_region->contains(m_container->at(cluster.m_centroid))) {
                 hasIntersections = true;
                 break;
             }
@@ -144,20 +124,72 @@ struct KMeansData {
         }
     }
 
-    size_t getNearestClusterId(MapTilePtr point) const
+    void initPoints()
     {
-        auto   minDist          = m_clusters[0].distanceTo(point);
-        size_t nearestClusterId = 0;
-
-        for (size_t i = 1; i < m_clusters.size(); i++) {
-            const auto dist = m_clusters[i].distanceTo(point);
-            if (dist < minDist) {
-                minDist          = dist;
-                nearestClusterId = i;
-            }
+        m_x.resize(m_region->size());
+        m_y.resize(m_region->size());
+        m_nearestIndex.resize(m_region->size(), uint32_t(-1));
+        m_minDistance.resize(m_region->size());
+        for (size_t i = 0; MapTilePtr tile : *m_region) {
+            m_x[i] = tile->m_pos.m_x;
+            m_y[i] = tile->m_pos.m_y;
+            i++;
         }
+        m_minX = *std::min_element(m_x.cbegin(), m_x.cend());
+        m_maxX = *std::max_element(m_x.cbegin(), m_x.cend());
+        m_minY = *std::min_element(m_y.cbegin(), m_y.cend());
+        m_maxY = *std::max_element(m_y.cbegin(), m_y.cend());
+    }
 
-        return nearestClusterId;
+    // Squared distances between tiles are small integers (bounded by region boundary and centroids),
+    // so intSqrt(d2 * 1000^2) is tabulated once instead of being called for every tile/cluster pair.
+    void ensureSqrtTable()
+    {
+        int minX = m_minX, maxX = m_maxX, minY = m_minY, maxY = m_maxY;
+        for (const auto& cluster : m_clusters) {
+            minX = std::min(minX, cluster.m_centroid.m_x);
+            maxX = std::max(maxX, cluster.m_centroid.m_x);
+            minY = std::min(minY, cluster.m_centroid.m_y);
+            maxY = std::max(maxY, cluster.m_centroid.m_y);
+        }
+        const size_t maxD2 = size_t(maxX - minX) * (maxX - minX) + size_t(maxY - minY) * (maxY - minY);
+        for (size_t d2 = m_sqrtPromille.size(); d2 <= maxD2; ++d2)
+            m_sqrtPromille.push_back(intSqrt(int64_t(d2) * 1'000'000)); // max 40bit
+    }
+
+    // Structure-of-arrays kernel: cluster loop outside, contiguous tile coordinates inside,
+    // branchless body so compiler can vectorize it. Same tie-break as scalar search: lowest cluster index wins.
+    void computeNearest(uint32_t clusterId, bool first)
+    {
+        const Cluster& cluster       = m_clusters[clusterId];
+        const int32_t  cx            = cluster.m_centroid.m_x;
+        const int32_t  cy            = cluster.m_centroid.m_y;
+        const int64_t  radius        = cluster.m_radiusPromille;
+        const int64_t  insideWeight  = cluster.m_settings.m_insideWeight;
+        const int64_t  outsideWeight = cluster.m_settings.m_outsideWeight;
+
+        const int32_t* xs      = m_x.data();
+        const int32_t* ys      = m_y.data();
+        const int64_t* sqrtPm  = m_sqrtPromille.data();
+        int64_t*       minDist = m_minDistance.data();
+        uint32_t*      nearest = m_candidateIndex.data();
+        const size_t   count   = m_x.size();
+
+        for (size_t i = 0; i < count; ++i) {
+            const int32_t dx = cx - xs[i];
+            const int32_t dy = cy - ys[i];
+
+            const int64_t linearDistancePromille  = sqrtPm[dx * dx + dy * dy];
+            const int64_t distanceToCircumference = linearDistancePromille - radius;
+            const bool    isInside                = (distanceToCircumference <= 0);
+            const int64_t innerDistance           = isInside ? linearDistancePromille : radius;
+            const int64_t outerDistance           = isInside ? 0 : distanceToCircumference;
+
+            const int64_t dist   = innerDistance * insideWeight + outerDistance * outsideWeight;
+            const bool    better = first || dist < minDist[i];
+            minDist[i]           = better ? dist : minDist[i];
+            nearest[i]           = better ? clusterId : nearest[i];
+        }
     }
 
     bool runIter(bool last)
@@ -170,16 +202,13 @@ struct KMeansData {
         {
             Mernel::ProfilerScope scope("getNearestClusterId");
             // Add all points to their nearest cluster
-            for (size_t i = 0; MapTilePtr tile : *m_region) {
-                size_t&      currentClusterId = m_nearestIndex[i];
-                const size_t nearestClusterId = getNearestClusterId(tile);
+            ensureSqrtTable();
+            m_candidateIndex.resize(m_nearestIndex.size());
+            for (uint32_t clusterId = 0; clusterId < m_clusters.size(); clusterId++)
+                computeNearest(clusterId, clusterId == 0);
 
-                if (currentClusterId != nearestClusterId) {
-                    currentClusterId = nearestClusterId;
-                    done             = false;
-                }
-                i++;
-            }
+            done = m_candidateIndex == m_nearestIndex;
+            m_nearestIndex.swap(m_candidateIndex);
         }
 
         // clear all existing clusters
@@ -198,8 +227,17 @@ struct KMeansData {
 
     const MapTileContainer* m_container = nullptr;
     const MapTileRegion*    m_region    = nullptr;
-    std::vector<size_t>     m_nearestIndex;
     std::vector<Cluster>    m_clusters;
+
+    // per-tile data, in region order.
+    std::vector<int32_t>  m_x;
+    std::vector<int32_t>  m_y;
+    std::vector<uint32_t> m_nearestIndex;
+    std::vector<uint32_t> m_candidateIndex;
+    std::vector<int64_t>  m_minDistance;
+    int                   m_minX = 0, m_maxX = 0, m_minY = 0, m_maxY = 0;
+
+    std::vector<int64_t> m_sqrtPromille; // intSqrt(d2 * 1000^2) for d2 = dx^2 + dy^2
 };
 
 MapTileRegionList MapTileRegionSegmentation::splitByFloodFill(const MapTileRegion& region, bool useDiag, MapTilePtr hint)
@@ -210,25 +248,29 @@ MapTileRegionList MapTileRegionSegmentation::splitByFloodFill(const MapTileRegio
     MapTileRegionList result;
     MapTilePtrList    currentBuffer;
 
-    MapTileRegion  visited;
+    // region neighbours are inside bounding box grown by one, so no whole-map bitsets needed.
+    MapTileRegionBitset regionBits = MapTileRegionBitset::makeBoundingBox(region);
+    MapTileRegionBitset visited    = regionBits;
+    regionBits.insert(region);
     MapTilePtrList currentEdge;
-    auto           addToCurrent = [&currentBuffer, &visited, &currentEdge, &region](MapTilePtr cell) {
+    auto           addToCurrent = [&currentBuffer, &visited, &currentEdge, &regionBits](MapTilePtr cell) {
         if (visited.contains(cell))
             return;
-        if (!region.contains(cell))
+        if (!regionBits.contains(cell))
             return;
         visited.insert(cell);
         currentBuffer.push_back(cell);
         currentEdge.push_back(cell);
     };
-    MapTileRegion remain = region;
+    MapTileRegionBitset remain = regionBits;
     if (hint) {
         if (!remain.contains(hint))
             throw std::runtime_error("Invalid tile hint provided");
     }
 
-    while (!remain.empty()) {
-        MapTilePtr startCell = hint ? hint : *remain.begin();
+    size_t remainWord = 0; // remain only shrinks, so search for next component resumes where the previous one was found.
+    while (MapTilePtr firstRemain = remain.first(remainWord)) {
+        MapTilePtr startCell = hint ? hint : firstRemain;
         hint                 = nullptr;
         addToCurrent(startCell);
 
@@ -243,9 +285,10 @@ MapTileRegionList MapTileRegionSegmentation::splitByFloodFill(const MapTileRegio
                 }
             }
         }
+        for (MapTilePtr cell : currentBuffer)
+            remain.erase(cell);
         MapTileRegion current = MapTileRegion(currentBuffer);
         currentBuffer.clear();
-        remain.erase(current);
         result.push_back(std::move(current));
     }
 
@@ -307,7 +350,7 @@ MapTileRegionList MapTileRegionSegmentation::splitByKExt(const MapTileRegion& re
     kmeans.m_clusters.resize(K);
     kmeans.m_region    = &region;
     kmeans.m_container = region[0]->m_container;
-    kmeans.m_nearestIndex.resize(region.size());
+    kmeans.initPoints();
     for (size_t i = 0; i < K; i++) {
         auto& c       = kmeans.m_clusters[i];
         auto& setting = settingsList.m_items[i];
@@ -326,10 +369,6 @@ MapTileRegionList MapTileRegionSegmentation::splitByKExt(const MapTileRegion& re
         c.m_points.reserve(region.size() / K);
     }
 
-    for (size_t i = 0; i < kmeans.m_nearestIndex.size(); i++) {
-        kmeans.m_nearestIndex[i] = size_t(-1);
-    }
-
     for (size_t iter = 0; iter < iterLimit; ++iter) {
         //        std::cout << "clusters:\n";
         //        for (size_t i = 0; i < K; i++) {
@@ -598,7 +637,7 @@ int64_t MapTileRegionSegmentation::getArea(int64_t radiusPromille)
 
 void MergedRegion::initFromTileContainer(const MapTileContainer* tileContainer, int z)
 {
-    m_topLeft = tileContainer->m_tileIndex.at(FHPos{ 0, 0, z });
+    m_topLeft = tileContainer->at(FHPos{ 0, 0, z });
     m_width   = tileContainer->m_width;
     m_height  = tileContainer->m_height;
 }
@@ -228,10 +228,10 @@ void ObstacleHelper::placeObstacles(size_t minSuitable)
                     FHPos objPos = mapPos;
                     objPos.m_x += def->blockMapPlanar.m_width - 1;
                     objPos.m_y += def->blockMapPlanar.m_height - 1;
-                    if (!m_tileContainer.m_tileIndex.contains(objPos))
+                    if (!m_tileContainer.contains(objPos))
                         continue;
 
-                    Core::LibraryTerrainConstPtr requiredTerrain = m_tileContainer.m_tileIndex.at(objPos)->m_zone->m_terrain;
+                    Core::LibraryTerrainConstPtr requiredTerrain = m_tileContainer.at(objPos)->m_zone->m_terrain;
 
                     if (def->terrainsSoftCache.contains(requiredTerrain)) {
                         suitable.push_back(obst);
@@ -268,7 +268,7 @@ void ObstacleHelper::placeObstacles(size_t minSuitable)
                     if (py < mapMask.m_height && px < mapMask.m_width) {
                         if (mapMask.m_rows[py][px] == 1)
                             mapMask.m_rows[py][px] = 2;
-                        auto* cell = m_tileContainer.m_tileIndex.at(maskBitPos);
+                        auto* cell = m_tileContainer.at(maskBitPos);
                         hasBlocked.insert(cell);
                     }
                     //m_map.m_debugTiles.push_back(FHDebugTile{ .m_pos = pos, .m_valueA = 0, .m_valueB = 3 });
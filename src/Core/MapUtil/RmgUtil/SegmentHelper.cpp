@@ -208,19 +208,11 @@ MapGuardList SegmentHelper::makeBorders(std::vector<TileZone>& tileZones)
         tileZone.m_protectionBorder   = tileZone.m_area.m_innerArea.makeInnerEdge(true).intersectWith(allBorderNet);
         tileZone.m_needPlaceObstacles = tileZone.m_protectionBorder;
 
-        const TileZone::TileIntMapping costs = tileZone.makeMoveCosts(false);
+        const TileZone::TileCostArray costs = tileZone.makeMoveCosts(false);
 
-        std::set<MapTilePtr> remaining, completed;
-
-        for (auto tile : tileZone.m_protectionBorder)
-            completed.insert(tile);
-
-        for (auto tile : tileZone.m_area.m_innerArea) {
-            remaining.insert(tile);
-        }
         const int borderRadius = 2;
 
-        auto resultByDistance = TileZone::computeDistances(costs, completed, remaining, borderRadius * 100);
+        auto resultByDistance = TileZone::computeDistances(costs, tileZone.m_protectionBorder, tileZone.m_area.m_innerArea, borderRadius * 100);
 
         MapTilePtrList roadTiles;
         MapTilePtrList segmentTiles;
@@ -390,11 +382,10 @@ void SegmentHelper::makeSegments(TileZone& tileZone)
                 neighAreaBorders.insert(std::pair<bool, MapTileSegment*>{ false, nullptr }); // map border
             }
 
-            MapTileSegment* neighbourSegIndex = neighbour->m_segmentMedium;
+            // segment of another zone is never read: it can be updated concurrently in parallel mode.
             TileZone*       neightZone        = neighbour->m_zone;
             bool            selfZone          = neightZone == &tileZone;
-            if (!selfZone)
-                neighbourSegIndex = nullptr;
+            MapTileSegment* neighbourSegIndex = selfZone ? neighbour->m_segmentMedium : nullptr;
 
             neighAreaBorders.insert({ selfZone, neighbourSegIndex });
         }
@@ -519,25 +510,18 @@ void SegmentHelper::refineSegments(TileZone& tileZone)
 
 void SegmentHelper::makeHeatMap(TileZone& tileZone)
 {
-    const TileZone::TileIntMapping costs = tileZone.makeMoveCosts();
+    const TileZone::TileCostArray costs = tileZone.makeMoveCosts();
 
-    std::set<MapTilePtr> remaining, completed;
+    MapTileRegion completed;
 
-    for (auto tile : tileZone.m_nodes.m_byLevel[RoadLevel::Towns])
-        completed.insert(tile);
-    for (auto tile : tileZone.m_midTownNodes)
-        completed.insert(tile);
-    if (completed.empty()) {
-        for (auto tile : tileZone.m_nodes.m_byLevel[RoadLevel::Exits])
-            completed.insert(tile);
-    }
+    completed.insert(tileZone.m_nodes.m_byLevel[RoadLevel::Towns]);
+    completed.insert(tileZone.m_midTownNodes);
+    if (completed.empty())
+        completed.insert(tileZone.m_nodes.m_byLevel[RoadLevel::Exits]);
     if (completed.empty())
         completed.insert(tileZone.m_centroid);
 
-    for (auto tile : tileZone.m_innerAreaUsable.m_innerArea) {
-        if (!completed.contains(tile))
-            remaining.insert(tile);
-    }
+    const MapTileRegion remaining = tileZone.m_innerAreaUsable.m_innerArea.diffWith(completed);
 
     auto resultByDistance = TileZone::computeDistances(costs, completed, remaining);
 
@@ -5,10 +5,14 @@
  */
 #include "TileZone.hpp"
 
+#include "MapTileRegionBitset.hpp"
 #include "TemplateUtils.hpp"
 
 #include "MernelPlatform/Profiler.hpp"
 
+#include <algorithm>
+#include <stdexcept>
+
 namespace FreeHeroes {
 
 void TileZone::setSegments(MapTileRegionWithEdgeList list)
@@ -43,12 +47,12 @@ void TileZone::updateSegmentIndex()
     }
 }
 
-TileZone::TileIntMapping TileZone::makeMoveCosts(bool onlyUsable) const
+TileZone::TileCostArray TileZone::makeMoveCosts(bool onlyUsable) const
 {
-    TileIntMapping costs;
-    auto&          area = onlyUsable ? m_innerAreaUsable.m_innerArea : m_area.m_innerArea;
+    TileCostArray costs(m_tileContainer->getTileCount(), 0);
+    auto&         area = onlyUsable ? m_innerAreaUsable.m_innerArea : m_area.m_innerArea;
     for (auto tile : area)
-        costs[tile] = 100;
+        costs[tile->m_index] = 100;
     for (const auto& [level, rarea] : m_roads.m_byLevel) {
         // we are making arbitrary weight here unrelated to actual hero speed on roads.
         int cost = 80;
@@ -59,71 +63,72 @@ TileZone::TileIntMapping TileZone::makeMoveCosts(bool onlyUsable) const
         if (level == FHRoadType::Dirt)
             cost = 60;
         for (auto* tile : rarea)
-            costs[tile] = cost;
+            costs[tile->m_index] = cost;
     }
     return costs;
 }
 
-TileZone::WeightTileMap TileZone::computeDistances(const TileIntMapping& costs, std::set<MapTilePtr> completed, std::set<MapTilePtr> remaining, int maxCost, int iters)
+TileZone::WeightTileMap TileZone::computeDistances(const TileCostArray& costs, const MapTileRegion& completed, const MapTileRegion& remaining, int maxCost, int iters)
 {
-    std::set<MapTilePtr> edgeSet = completed;
-
-    TileZone::TileIntMapping resultDistance;
+    WeightTileMap resultByDistance;
+    if (completed.empty())
+        return resultByDistance;
 
-    WeightTileMap edge;
-    for (auto tile : completed)
-        edge[0].push_back(tile);
+    MapTileContainer* tileContainer = completed[0]->m_container;
 
-    auto calcCost = [&costs](MapTilePtr one, MapTilePtr two, bool diag) -> int {
-        const int costOne = costs.at(one);
-        const int costTwo = costs.at(two);
-        const int cost    = std::max(costOne, costTwo);
+    auto tileCost = [&costs](MapTilePtr tile) -> int {
+        const int cost = costs[tile->m_index];
+        if (cost <= 0)
+            throw std::out_of_range("No move cost for tile " + tile->toPrintableString());
+        return cost;
+    };
+    auto calcCost = [&tileCost](MapTilePtr one, MapTilePtr two, bool diag) -> int {
+        const int cost = std::max(tileCost(one), tileCost(two));
         return diag ? cost * 141 / 100 : cost;
     };
 
-    auto consumePrevEdge = [maxCost, &edge, &edgeSet, &resultDistance, &remaining, &completed, &calcCost]() -> bool {
-        if (edge.empty())
-            return false;
+    // max single step cost bounds the distance between lowest and highest pending bucket.
+    const int maxStep = std::max(1, *std::max_element(costs.cbegin(), costs.cend()) * 141 / 100);
 
-        const int            lowestCost      = edge.begin()->first;
-        const MapTilePtrList lowestCostTiles = edge.begin()->second;
-        edge.erase(edge.begin());
+    std::vector<MapTilePtrList> buckets(maxStep + 1);
+    size_t                      pending = completed.size();
+    buckets[0]                          = MapTilePtrList(completed.begin(), completed.end());
 
+    // tile is either pending in some bucket or completed.
+    MapTileRegionBitset touched(tileContainer, completed);
+    MapTileRegionBitset remainingBits(tileContainer, remaining);
+
+    MapTilePtrList lowestCostTiles;
+    for (int lowestCost = 0, i = 0; pending && i < iters; ++lowestCost) {
+        MapTilePtrList& bucket = buckets[lowestCost % buckets.size()];
+        if (bucket.empty())
+            continue;
+        ++i;
         if (maxCost > 0 && lowestCost > maxCost)
-            return true;
+            break;
+
+        lowestCostTiles.swap(bucket);
+        bucket.clear();
+        pending -= lowestCostTiles.size();
 
-        for (auto tile : lowestCostTiles) {
-            resultDistance[tile] = lowestCost;
-            completed.insert(tile);
-            edgeSet.erase(tile);
-            remaining.erase(tile);
-        }
         for (bool diag : { false, true }) {
             for (auto tile : lowestCostTiles) {
                 auto& nlist = diag ? tile->m_diagNeighbours : tile->m_orthogonalNeighbours;
                 for (auto ntile : nlist) {
-                    if (completed.contains(ntile) || edgeSet.contains(ntile) || !remaining.contains(ntile))
+                    if (touched.contains(ntile) || !remainingBits.contains(ntile))
                         continue;
                     const int cost = calcCost(tile, ntile, diag) + lowestCost;
-                    edgeSet.insert(ntile);
-                    edge[cost].push_back(ntile);
+                    touched.insert(ntile);
+                    buckets[cost % buckets.size()].push_back(ntile);
+                    pending++;
                 }
             }
         }
 
-        return true;
-    };
-
-    for (int i = 0; i < iters; ++i) {
-        if (!consumePrevEdge())
-            break;
+        std::sort(lowestCostTiles.begin(), lowestCostTiles.end());
+        resultByDistance.emplace_hint(resultByDistance.end(), lowestCost, lowestCostTiles);
     }
 
-    WeightTileMap resultByDistance;
-
-    for (const auto& [tile, w] : resultDistance)
-        resultByDistance[w].push_back(tile);
-
     return resultByDistance;
 }
 
@@ -155,12 +155,15 @@ struct TileZone {
     MapTileRegionWithEdgeList getSegments() const;
     void                      updateSegmentIndex();
 
-    using TileIntMapping = std::map<MapTilePtr, int>;
-    using WeightTileMap  = std::map<int, MapTilePtrList>;
+    using TileCostArray = std::vector<int>; // indexed by MapTile::m_index, 0 for tiles without cost.
+    using WeightTileMap = std::map<int, MapTilePtrList>;
 
-    TileIntMapping makeMoveCosts(bool onlyUsable = true) const;
+    TileCostArray makeMoveCosts(bool onlyUsable = true) const;
 
-    static WeightTileMap computeDistances(const TileIntMapping& costs, std::set<MapTilePtr> completed, std::set<MapTilePtr> remaining, int maxCost = -1, int iters = 10000);
+    // Wave propagation from 'completed' over 'remaining'; tile gets distance of the first wave reached it (no relaxation).
+    // Frontier is a circular bucket queue (costs are small positive integers), visited flags are bitsets.
+    // Tiles in each distance group are sorted by index.
+    static WeightTileMap computeDistances(const TileCostArray& costs, const MapTileRegion& completed, const MapTileRegion& remaining, int maxCost = -1, int iters = 10000);
 };
 
 }
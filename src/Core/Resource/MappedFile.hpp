@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+#pragma once
+
+#include "MernelPlatform/FsUtils.hpp"
+
+#include "CoreResourceExport.hpp"
+
+#include <cstdint>
+#include <span>
+
+namespace FreeHeroes::Core {
+
+// Read-only memory mapping of a whole file; pages are loaded by OS on first access.
+class CORERESOURCE_EXPORT MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const Mernel::std_path& path) noexcept;
+    void close() noexcept;
+
+    bool isOpen() const noexcept { return m_isOpen; }
+
+    const uint8_t* data() const noexcept { return m_data; }
+    size_t         size() const noexcept { return m_size; }
+
+    std::span<const uint8_t> span() const noexcept { return { m_data, m_size }; }
+
+private:
+    const uint8_t* m_data   = nullptr;
+    size_t         m_size   = 0;
+    bool           m_isOpen = false;
+#ifdef _WIN32
+    void* m_file    = nullptr;
+    void* m_mapping = nullptr;
+#endif
+};
+
+}
@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+#include "ModPack.hpp"
+
+#include "MernelPlatform/Compression.hpp"
+#include "MernelPlatform/FileIOUtils.hpp"
+#include "MernelPlatform/Logger.hpp"
+#include "MernelPlatform/StringUtils.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+
+namespace FreeHeroes::Core {
+using namespace Mernel;
+
+namespace {
+constexpr const std::array<char, 8> g_packMagic{ { 'F', 'H', 'M', 'O', 'D', 'P', 'K', '\0' } };
+
+static_assert(std::is_trivially_copyable_v<ModPack::Header> && sizeof(ModPack::Header) == 40);
+static_assert(std::is_trivially_copyable_v<ModPack::Entry> && sizeof(ModPack::Entry) == 40);
+static_assert(sizeof(ModPack::Header) <= ModPack::s_alignment);
+
+uint64_t alignUp(uint64_t value)
+{
+    return (value + ModPack::s_alignment - 1) / ModPack::s_alignment * ModPack::s_alignment;
+}
+
+bool entryLess(const ModPack::Entry& l, std::string_view lName, const ModPack::Entry& r, std::string_view rName)
+{
+    return std::tie(l.m_hash, lName) < std::tie(r.m_hash, rName);
+}
+
+}
+
+ModPack::ConstPtr ModPack::open(const Mernel::std_path& path) noexcept
+{
+    std::shared_ptr<ModPack> result(new ModPack());
+    std::string              error;
+    if (!result->load(path, error)) {
+        Logger(Logger::Err) << "Failed to open mod pack '" << path2string(path) << "': " << error;
+        return nullptr;
+    }
+    return result;
+}
+
+bool ModPack::load(const Mernel::std_path& path, std::string& error) noexcept
+{
+    m_path = path;
+    if (!m_file.open(path)) {
+        error = "can not map file";
+        return false;
+    }
+    const uint64_t fileSize = m_file.size();
+
+    Header header;
+    if (fileSize < sizeof(Header)) {
+        error = "file is too small";
+        return false;
+    }
+    std::memcpy(&header, m_file.data(), sizeof(Header));
+    if (header.m_magic != g_packMagic) {
+        error = "wrong signature";
+        return false;
+    }
+    if (header.m_version != s_version) {
+        error = "unsupported version " + std::to_string(header.m_version);
+        return false;
+    }
+    const uint64_t indexSize = uint64_t(header.m_entryCount) * sizeof(Entry);
+    if (header.m_indexOffset % alignof(Entry) != 0 || header.m_indexOffset > fileSize || indexSize > fileSize - header.m_indexOffset
+        || header.m_namesOffset > fileSize || header.m_namesSize > fileSize - header.m_namesOffset) {
+        error = "index is out of file bounds";
+        return false;
+    }
+
+    // mapping is page-aligned and index offset is checked above, so entries are used in place.
+    m_entries    = reinterpret_cast<const Entry*>(m_file.data() + header.m_indexOffset);
+    m_entryCount = header.m_entryCount;
+    m_names      = reinterpret_cast<const char*>(m_file.data() + header.m_namesOffset);
+
+    for (size_t i = 0; i < m_entryCount; ++i) {
+        const Entry& entry = m_entries[i];
+        if (uint64_t(entry.m_nameOffset) + entry.m_nameLength > header.m_namesSize
+            || entry.m_offset > fileSize || entry.m_storedSize > fileSize - entry.m_offset
+            || (entry.m_compression != Compression::None && entry.m_compression != Compression::Zlib)
+            || (entry.m_compression == Compression::None && entry.m_storedSize != entry.m_size)) {
+            error = "entry " + std::to_string(i) + " is corrupted";
+            return false;
+        }
+        if (i > 0 && !entryLess(m_entries[i - 1], getName(i - 1), entry, getName(i))) {
+            error = "index is not sorted";
+            return false;
+        }
+    }
+    return true;
+}
+
+ModPack::PackStats ModPack::pack(const Mernel::std_path& folder, const Mernel::std_path& packPath, const PackSettings& settings)
+{
+    struct Item {
+        std::string m_name;
+        std_path    m_path;
+        Entry       m_entry;
+    };
+    std::vector<Item> items;
+    for (const auto& it : std_fs::recursive_directory_iterator(folder)) {
+        if (!it.is_regular_file())
+            continue;
+        const std::string ext = strToLower(path2string(it.path().extension()));
+        if (isPathOnlyExtension(ext) || settings.m_skipExtensions.contains(ext))
+            continue;
+
+        std::string name = path2string(it.path().lexically_relative(folder));
+        std::replace(name.begin(), name.end(), '\\', '/');
+        if (name.size() > std::numeric_limits<uint16_t>::max())
+            throw std::runtime_error("Too long file name: " + name);
+
+        Item item{ .m_name = std::move(name), .m_path = it.path() };
+        item.m_entry.m_hash = hashName(item.m_name);
+        items.push_back(std::move(item));
+    }
+    std::sort(items.begin(), items.end(), [](const Item& l, const Item& r) { return entryLess(l.m_entry, l.m_name, r.m_entry, r.m_name); });
+
+    std_fs::create_directories(packPath.parent_path());
+    std::ofstream ofs(packPath, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    if (!ofs)
+        throw std::runtime_error("Failed to open for write: " + path2string(packPath));
+
+    PackStats stats;
+    uint64_t  offset = alignUp(sizeof(Header));
+    auto      padTo  = [&ofs](uint64_t from, uint64_t to) {
+        static const std::array<char, s_alignment> zeroes{};
+        ofs.write(zeroes.data(), static_cast<std::streamsize>(to - from));
+    };
+    padTo(0, offset);
+
+    std::string names;
+    for (Item& item : items) {
+        ByteArrayHolder data = readFileIntoHolder(item.m_path);
+        Entry&          entry = item.m_entry;
+        entry.m_size          = data.size();
+        entry.m_nameOffset    = static_cast<uint32_t>(names.size());
+        entry.m_nameLength    = static_cast<uint16_t>(item.m_name.size());
+        names += item.m_name;
+
+        const std::string ext = strToLower(path2string(item.m_path.extension()));
+        if (settings.m_compressExtensions.contains(ext) && data.size() > 0) {
+            ByteArrayHolder comp;
+            compressDataBuffer(data, comp, { .m_type = CompressionType::Zlib, .m_skipCRC = false });
+            if (comp.size() < data.size()) {
+                data                = std::move(comp);
+                entry.m_compression = Compression::Zlib;
+                stats.m_compressedFiles++;
+            }
+        }
+        entry.m_storedSize = data.size();
+        entry.m_offset     = offset;
+
+        ofs.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        const uint64_t next = alignUp(offset + data.size());
+        padTo(offset + data.size(), next);
+        offset = next;
+
+        stats.m_files++;
+        stats.m_sourceBytes += entry.m_size;
+    }
+
+    Header header;
+    header.m_magic       = g_packMagic;
+    header.m_version     = s_version;
+    header.m_entryCount  = static_cast<uint32_t>(items.size());
+    header.m_indexOffset = offset;
+    for (const Item& item : items)
+        ofs.write(reinterpret_cast<const char*>(&item.m_entry), sizeof(Entry));
+    header.m_namesOffset = offset + items.size() * sizeof(Entry);
+    header.m_namesSize   = names.size();
+    ofs.write(names.data(), static_cast<std::streamsize>(names.size()));
+
+    ofs.seekp(0);
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    ofs.close();
+    if (!ofs)
+        throw std::runtime_error("Failed to write: " + path2string(packPath));
+
+    stats.m_packBytes = header.m_namesOffset + header.m_namesSize;
+    return stats;
+}
+
+uint64_t ModPack::hashName(std::string_view name) noexcept
+{
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (const char c : name) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+bool ModPack::isPathOnlyExtension(std::string_view extWithDot) noexcept
+{
+    return extWithDot == ".wav" || extWithDot == ".mp3" || extWithDot == ".webp";
+}
+
+std::string_view ModPack::getName(size_t index) const noexcept
+{
+    const Entry& entry = m_entries[index];
+    return { m_names + entry.m_nameOffset, entry.m_nameLength };
+}
+
+size_t ModPack::find(std::string_view name) const noexcept
+{
+    const uint64_t hash  = hashName(name);
+    const Entry*   begin = m_entries;
+    const Entry*   end   = m_entries + m_entryCount;
+    const Entry*   it    = std::lower_bound(begin, end, hash, [](const Entry& entry, uint64_t hash) { return entry.m_hash < hash; });
+    for (; it != end && it->m_hash == hash; ++it) {
+        const size_t index = it - begin;
+        if (getName(index) == name)
+            return index;
+    }
+    return s_notFound;
+}
+
+std::span<const uint8_t> ModPack::view(size_t index) const noexcept
+{
+    const Entry& entry = m_entries[index];
+    if (entry.m_compression != Compression::None || !entry.m_storedSize)
+        return {};
+    return { m_file.data() + entry.m_offset, entry.m_storedSize };
+}
+
+Mernel::ByteArrayHolder ModPack::read(size_t index) const
+{
+    const Entry&    entry = m_entries[index];
+    ByteArrayHolder stored;
+    stored.resize(entry.m_storedSize);
+    if (entry.m_storedSize)
+        std::memcpy(stored.data(), m_file.data() + entry.m_offset, entry.m_storedSize);
+    if (entry.m_compression == Compression::None)
+        return stored;
+
+    ByteArrayHolder result;
+    uncompressDataBuffer(stored, result, { .m_type = CompressionType::Zlib, .m_skipCRC = false });
+    if (result.size() != entry.m_size)
+        throw std::runtime_error("Size mismatch after uncompression for '" + std::string(getName(index)) + "'");
+    return result;
+}
+
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+#pragma once
+
+#include "MappedFile.hpp"
+
+#include "MernelPlatform/ByteBuffer.hpp"
+
+#include <array>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+
+namespace FreeHeroes::Core {
+
+// Single-file container of a whole mod folder ('<modId>.fhpack' near or instead of '<modId>.fhmod').
+// Opened with one mmap: entries are looked up in a sorted hash index, uncompressed ones are used in place.
+// Layout, all numbers little-endian:
+//   Header, padded to s_alignment;
+//   entry data, each entry starts at s_alignment boundary;
+//   Entry index sorted by (m_hash, name);
+//   names, concatenated without separators.
+class CORERESOURCE_EXPORT ModPack : public std::enable_shared_from_this<ModPack> {
+public:
+    enum class Compression : uint16_t
+    {
+        None,
+        Zlib,
+    };
+
+    struct Header {
+        std::array<char, 8> m_magic{};
+        uint32_t            m_version     = 0;
+        uint32_t            m_entryCount  = 0;
+        uint64_t            m_indexOffset = 0;
+        uint64_t            m_namesOffset = 0;
+        uint64_t            m_namesSize   = 0;
+    };
+
+    struct Entry {
+        uint64_t    m_hash        = 0; // hashName() of the name.
+        uint64_t    m_offset      = 0;
+        uint64_t    m_storedSize  = 0;
+        uint64_t    m_size        = 0; // size after uncompression.
+        uint32_t    m_nameOffset  = 0;
+        uint16_t    m_nameLength  = 0;
+        Compression m_compression = Compression::None;
+    };
+
+    struct PackSettings {
+        std::set<std::string> m_compressExtensions; // lowercase last extension with dot, e.g. ".json".
+        std::set<std::string> m_skipExtensions;     // skipped in addition to isPathOnlyExtension() ones.
+    };
+
+    struct PackStats {
+        size_t   m_files           = 0;
+        size_t   m_compressedFiles = 0;
+        uint64_t m_sourceBytes     = 0;
+        uint64_t m_packBytes       = 0;
+    };
+
+    using ConstPtr = std::shared_ptr<const ModPack>;
+
+    static constexpr const uint32_t         s_version   = 1;
+    static constexpr const uint32_t         s_alignment = 64;
+    static constexpr const size_t           s_notFound  = size_t(-1);
+    static constexpr const std::string_view s_extension{ ".fhpack" };
+
+public:
+    // returns nullptr and logs an error if file is not a valid pack.
+    static ConstPtr open(const Mernel::std_path& path) noexcept;
+
+    // Packs every regular file under folder except path-only ones; names are paths relative to the folder with '/' separator.
+    // Throws on i/o errors.
+    static PackStats pack(const Mernel::std_path& folder, const Mernel::std_path& packPath, const PackSettings& settings);
+
+    static uint64_t hashName(std::string_view name) noexcept;
+
+    // Sounds, music and videos are played by Qt Multimedia from a file path, so they must stay loose files.
+    static bool isPathOnlyExtension(std::string_view extWithDot) noexcept;
+
+    const Mernel::std_path& getPath() const noexcept { return m_path; }
+
+    size_t           size() const noexcept { return m_entryCount; }
+    std::string_view getName(size_t index) const noexcept;
+    const Entry&     getEntry(size_t index) const noexcept { return m_entries[index]; }
+
+    size_t find(std::string_view name) const noexcept;
+
+    // Stored bytes of uncompressed entry, pointing into the mapped file; empty span for compressed one.
+    std::span<const uint8_t> view(size_t index) const noexcept;
+
+    // Entry content, uncompressed if needed. Throws on corrupted compressed data.
+    Mernel::ByteArrayHolder read(size_t index) const;
+
+    ModPack(const ModPack&)            = delete;
+    ModPack& operator=(const ModPack&) = delete;
+
+private:
+    ModPack() = default;
+
+    bool load(const Mernel::std_path& path, std::string& error) noexcept;
+
+private:
+    Mernel::std_path m_path;
+    MappedFile       m_file;
+    const Entry*     m_entries    = nullptr;
+    size_t           m_entryCount = 0;
+    const char*      m_names      = nullptr;
+};
+
+}
@@ -0,0 +1,408 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+#include "ModScanIndex.hpp"
+
+#include "MernelPlatform/FileIOUtils.hpp"
+#include "MernelPlatform/Logger.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+
+namespace FreeHeroes::Core {
+using namespace Mernel;
+
+namespace {
+
+constexpr const char     s_magic[8]      = { 'F', 'H', 'S', 'C', 'A', 'N', 'I', 'X' };
+constexpr const uint32_t s_version       = 1;
+constexpr const uint32_t s_endianMarker  = 0x01020304U;
+constexpr const size_t   s_payloadOffset = sizeof(s_magic) + 2 * sizeof(uint32_t) + sizeof(uint64_t); // after the checksum.
+
+static_assert(std::is_trivially_copyable_v<ModScanIndex::Directory> && sizeof(ModScanIndex::Directory) == 24);
+static_assert(std::is_trivially_copyable_v<ModScanIndex::Record> && sizeof(ModScanIndex::Record) == 20);
+
+const std::map<std::string, ResourceType, std::less<>> g_knownTypes{
+    { ".fhsprite.json", ResourceType::Sprite },
+    { ".wav", ResourceType::Sound },
+    { ".mp3", ResourceType::Music },
+    { ".webp", ResourceType::Video },
+    { ".fhdb.json", ResourceType::DbSegment },
+    { ".fhdbindex.json", ResourceType::DbIndex },
+};
+
+int64_t toTicks(std_fs::file_time_type time)
+{
+    return time.time_since_epoch().count();
+}
+
+// Directory changed within this interval before the scan may change again within the same mtime tick
+// (coarse filesystem timestamps), so it is not trusted on the next start.
+int64_t racyInterval()
+{
+    return std::chrono::duration_cast<std_fs::file_time_type::duration>(std::chrono::seconds(2)).count();
+}
+
+class Writer {
+public:
+    std::string m_buffer;
+
+    void writeRaw(const void* data, size_t size) { m_buffer.append(static_cast<const char*>(data), size); }
+
+    template<class T>
+    void writePod(T value)
+    {
+        writeRaw(&value, sizeof(T));
+    }
+};
+
+class Reader {
+public:
+    Reader(const std::string& buffer)
+        : m_data(buffer.data())
+        , m_end(buffer.data() + buffer.size())
+    {}
+
+    void readRaw(void* data, size_t size)
+    {
+        if (static_cast<size_t>(m_end - m_data) < size)
+            throw std::runtime_error("unexpected end of scan index");
+        if (size)
+            std::memcpy(data, m_data, size);
+        m_data += size;
+    }
+
+    template<class T>
+    T readPod()
+    {
+        T value;
+        readRaw(&value, sizeof(T));
+        return value;
+    }
+
+    bool atEnd() const { return m_data == m_end; }
+
+private:
+    const char*       m_data;
+    const char* const m_end;
+};
+
+}
+
+struct ModScanIndex::Scanner {
+    ModScanIndex&       m_index;
+    const ModScanIndex* m_cached = nullptr;
+
+    std::unordered_map<std::string_view, uint32_t> m_cachedDirs; // relative path -> cached directory.
+    std::vector<std::vector<uint32_t>>             m_cachedChildren;
+    std::vector<std::vector<uint32_t>>             m_cachedRecords;
+    int64_t                                        m_trustedBefore = 0;
+
+    Scanner(ModScanIndex& index, const ModScanIndex* cached)
+        : m_index(index)
+        , m_cached(cached)
+    {
+        if (!m_cached)
+            return;
+
+        m_trustedBefore = m_cached->m_scanTime - racyInterval();
+        m_cachedChildren.resize(m_cached->m_dirs.size());
+        m_cachedRecords.resize(m_cached->m_dirs.size());
+        for (uint32_t i = 0; i < m_cached->m_dirs.size(); ++i) {
+            const Directory& dir = m_cached->m_dirs[i];
+            m_cachedDirs[m_cached->getString(dir.m_path, dir.m_pathLength)] = i;
+            if (i > 0)
+                m_cachedChildren[dir.m_parent].push_back(i);
+        }
+        for (uint32_t i = 0; i < m_cached->m_records.size(); ++i)
+            m_cachedRecords[m_cached->m_records[i].m_dir].push_back(i);
+    }
+
+    void visit(const std_path& path, std::string_view relPath, uint32_t parent)
+    {
+        std::error_code ec;
+        const auto      mtime = std_fs::last_write_time(path, ec);
+        if (ec)
+            return; // removed while scanning.
+
+        const int64_t ticks = toTicks(mtime);
+        if (m_cached) {
+            auto it = m_cachedDirs.find(relPath);
+            if (it != m_cachedDirs.cend()) {
+                const int64_t cachedTicks = m_cached->m_dirs[it->second].m_mtime;
+                if (cachedTicks == ticks && cachedTicks < m_trustedBefore) {
+                    reuse(path, it->second, parent, ticks);
+                    return;
+                }
+            }
+        }
+        scan(path, relPath, parent, ticks);
+    }
+
+    uint32_t addDirectory(std::string_view relPath, uint32_t parent, int64_t mtime)
+    {
+        const uint32_t index = static_cast<uint32_t>(m_index.m_dirs.size());
+        m_index.m_dirs.push_back(Directory{
+            .m_mtime      = mtime,
+            .m_path       = m_index.addString(relPath),
+            .m_pathLength = static_cast<uint32_t>(relPath.size()),
+            .m_parent     = index == 0 ? 0 : parent,
+        });
+        return index;
+    }
+
+    void reuse(const std_path& path, uint32_t cachedDir, uint32_t parent, int64_t mtime)
+    {
+        const Directory& dir   = m_cached->m_dirs[cachedDir];
+        const uint32_t   index = addDirectory(m_cached->getString(dir.m_path, dir.m_pathLength), parent, mtime);
+        m_index.m_stats.m_reusedDirs++;
+
+        for (const uint32_t recordIndex : m_cachedRecords[cachedDir]) {
+            Record record = m_cached->m_records[recordIndex];
+            record.m_dir  = index;
+            record.m_name = m_index.addString(m_cached->getName(m_cached->m_records[recordIndex]));
+            m_index.m_records.push_back(record);
+        }
+        for (const uint32_t child : m_cachedChildren[cachedDir]) {
+            const Directory&       childDir = m_cached->m_dirs[child];
+            const std::string_view relPath  = m_cached->getString(childDir.m_path, childDir.m_pathLength);
+            const std::string_view name     = relPath.substr(relPath.find_last_of('/') + 1);
+            visit(path / string2path(std::string(name)), relPath, index);
+        }
+    }
+
+    void scan(const std_path& path, std::string_view relPath, uint32_t parent, int64_t mtime)
+    {
+        const uint32_t index = addDirectory(relPath, parent, mtime);
+        m_index.m_stats.m_scannedDirs++;
+
+        std::vector<std::string> subdirs;
+        for (const auto& it : std_fs::directory_iterator(path)) {
+            const std::string name = path2string(it.path().filename());
+            if (it.is_directory() && !it.is_symlink()) {
+                subdirs.push_back(name);
+                continue;
+            }
+            if (!it.is_regular_file())
+                continue;
+
+            size_t             idLength = 0;
+            const ResourceType type     = detectResource(name, idLength);
+            if (type == ResourceType::Invalid || name.size() > std::numeric_limits<uint16_t>::max())
+                continue;
+
+            m_index.m_records.push_back(Record{
+                .m_type       = type,
+                .m_dir        = index,
+                .m_name       = m_index.addString(name),
+                .m_nameLength = static_cast<uint16_t>(name.size()),
+                .m_idLength   = static_cast<uint16_t>(idLength),
+            });
+        }
+        for (const std::string& name : subdirs) {
+            const std::string childPath = relPath.empty() ? name : std::string(relPath) + "/" + name;
+            visit(path / string2path(name), childPath, index);
+        }
+    }
+};
+
+ModScanIndex::ConstPtr ModScanIndex::create(const Mernel::std_path& modRoot, const Mernel::std_path& packPath, const Mernel::std_path& cacheFile) noexcept
+{
+    std::shared_ptr<ModScanIndex> result(new ModScanIndex());
+    result->m_root = modRoot;
+    try {
+        if (!modRoot.empty()) {
+            std::unique_ptr<ModScanIndex> cached;
+            std::string                   buffer;
+            if (!cacheFile.empty() && readFileIntoBufferNoexcept(cacheFile, buffer)) {
+                cached.reset(new ModScanIndex());
+                if (!cached->load(buffer) || cached->m_root != modRoot)
+                    cached.reset();
+            }
+            result->m_stats.m_cacheLoaded = cached != nullptr;
+            result->m_scanTime            = toTicks(std_fs::file_time_type::clock::now());
+
+            Scanner scanner(*result, cached.get());
+            scanner.visit(modRoot, "", 0);
+            result->m_stats.m_dirs = result->m_dirs.size();
+
+            if (!cacheFile.empty() && result->m_stats.m_scannedDirs > 0) {
+                // other processes may read or write the same index, so write to temporary file and rename it.
+                const auto      tmpPath = cacheFile.parent_path() / (path2string(cacheFile.filename()) + "." + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".tmp");
+                std::error_code ec;
+                std_fs::create_directories(cacheFile.parent_path(), ec);
+                if (writeFileFromBufferNoexcept(tmpPath, result->save())) {
+                    std_fs::rename(tmpPath, cacheFile, ec);
+                    result->m_stats.m_cacheSaved = !ec;
+                    if (ec) {
+                        Logger(Logger::Warning) << "Failed to write mod scan index " << path2string(cacheFile) << ": " << ec.message();
+                        std_fs::remove(tmpPath, ec);
+                    }
+                } else {
+                    Logger(Logger::Warning) << "Failed to write mod scan index " << path2string(tmpPath);
+                }
+            }
+        }
+        if (!packPath.empty()) {
+            result->m_pack = ModPack::open(packPath);
+            if (result->m_pack)
+                result->addPacked();
+        }
+    }
+    catch (std::exception& ex) {
+        Logger(Logger::Err) << "Failed to scan mod '" << path2string(modRoot.empty() ? packPath : modRoot) << "': " << ex.what();
+    }
+    return result;
+}
+
+Mernel::std_path ModScanIndex::makeCachePath(const Mernel::std_path& cacheDir, const std::string& modId, const Mernel::std_path& modRoot)
+{
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(ModPack::hashName(path2string(modRoot))));
+    return cacheDir / string2path(modId + "-" + hash + ".fhscan");
+}
+
+ResourceType ModScanIndex::detectResource(std::string_view fileName, size_t& idLength) noexcept
+{
+    // leading dot is a hidden file, not an extension.
+    const size_t extStart = fileName.find('.', 1);
+    if (extStart == std::string_view::npos)
+        return ResourceType::Invalid;
+
+    auto it = g_knownTypes.find(fileName.substr(extStart));
+    if (it == g_knownTypes.cend())
+        return ResourceType::Invalid;
+
+    idLength = extStart;
+    return it->second;
+}
+
+Mernel::std_path ModScanIndex::getPath(const Record& record) const
+{
+    if (record.m_packIndex != s_loose)
+        return m_pack->getPath() / string2path(std::string(m_pack->getName(record.m_packIndex)));
+
+    const Directory&       dir     = m_dirs[record.m_dir];
+    const std::string_view relPath = getString(dir.m_path, dir.m_pathLength);
+    const std_path         name    = string2path(std::string(getName(record)));
+    return relPath.empty() ? m_root / name : m_root / string2path(std::string(relPath)) / name;
+}
+
+uint32_t ModScanIndex::addString(std::string_view str)
+{
+    if (m_arena.size() + str.size() > std::numeric_limits<uint32_t>::max())
+        throw std::runtime_error("Too many file names in mod");
+
+    const uint32_t offset = static_cast<uint32_t>(m_arena.size());
+    m_arena += str;
+    return offset;
+}
+
+void ModScanIndex::addPacked()
+{
+    for (size_t i = 0; i < m_pack->size(); ++i) {
+        const std::string_view fullName = m_pack->getName(i);
+        const std::string_view name     = fullName.substr(fullName.find_last_of('/') + 1);
+        size_t                 idLength = 0;
+        const ResourceType     type     = detectResource(name, idLength);
+        if (type == ResourceType::Invalid)
+            continue;
+        // packs made by older packer may have media; they are not usable through a path into the pack.
+        if (type == ResourceType::Sound || type == ResourceType::Music || type == ResourceType::Video)
+            continue;
+
+        m_records.push_back(Record{
+            .m_type       = type,
+            .m_packIndex  = static_cast<uint32_t>(i),
+            .m_name       = addString(name),
+            .m_nameLength = static_cast<uint16_t>(name.size()),
+            .m_idLength   = static_cast<uint16_t>(idLength),
+        });
+    }
+}
+
+bool ModScanIndex::load(const std::string& buffer) noexcept
+{
+    try {
+        Reader reader(buffer);
+        char   magic[sizeof(s_magic)];
+        reader.readRaw(magic, sizeof(magic));
+        if (std::memcmp(magic, s_magic, sizeof(s_magic)) != 0)
+            return false;
+        if (reader.readPod<uint32_t>() != s_version || reader.readPod<uint32_t>() != s_endianMarker)
+            return false;
+        if (reader.readPod<uint64_t>() != ModPack::hashName(std::string_view(buffer).substr(s_payloadOffset)))
+            return false;
+
+        m_scanTime               = reader.readPod<int64_t>();
+        const uint32_t rootSize  = reader.readPod<uint32_t>();
+        const uint32_t dirCount  = reader.readPod<uint32_t>();
+        const uint32_t recCount  = reader.readPod<uint32_t>();
+        const uint32_t arenaSize = reader.readPod<uint32_t>();
+        if (rootSize > buffer.size() || dirCount > buffer.size() || recCount > buffer.size() || arenaSize > buffer.size() || !dirCount)
+            return false;
+
+        std::string root(rootSize, '\0');
+        reader.readRaw(root.data(), root.size());
+        m_root = string2path(root);
+        m_dirs.resize(dirCount);
+        reader.readRaw(m_dirs.data(), m_dirs.size() * sizeof(Directory));
+        m_records.resize(recCount);
+        reader.readRaw(m_records.data(), m_records.size() * sizeof(Record));
+        m_arena.resize(arenaSize);
+        reader.readRaw(m_arena.data(), m_arena.size());
+        if (!reader.atEnd())
+            return false;
+
+        for (uint32_t i = 0; i < dirCount; ++i) {
+            const Directory& dir = m_dirs[i];
+            if (uint64_t(dir.m_path) + dir.m_pathLength > arenaSize || (i > 0 ? dir.m_parent >= i : dir.m_parent != 0))
+                return false;
+        }
+        for (const Record& record : m_records) {
+            if (record.m_type <= ResourceType::Invalid || record.m_type > ResourceType::DbIndex || record.m_dir >= dirCount
+                || record.m_packIndex != s_loose || uint64_t(record.m_name) + record.m_nameLength > arenaSize
+                || record.m_idLength >= record.m_nameLength)
+                return false;
+        }
+        return true;
+    }
+    catch (std::exception& ex) {
+        Logger(Logger::Warning) << "Mod scan index is corrupted: " << ex.what();
+        return false;
+    }
+}
+
+std::string ModScanIndex::save() const
+{
+    const std::string root = path2string(m_root);
+
+    Writer writer;
+    writer.writeRaw(s_magic, sizeof(s_magic));
+    writer.writePod(s_version);
+    writer.writePod(s_endianMarker);
+    writer.writePod(uint64_t(0)); // checksum of the payload.
+    writer.writePod(m_scanTime);
+    writer.writePod(static_cast<uint32_t>(root.size()));
+    writer.writePod(static_cast<uint32_t>(m_dirs.size()));
+    writer.writePod(static_cast<uint32_t>(m_records.size()));
+    writer.writePod(static_cast<uint32_t>(m_arena.size()));
+    writer.writeRaw(root.data(), root.size());
+    writer.writeRaw(m_dirs.data(), m_dirs.size() * sizeof(Directory));
+    writer.writeRaw(m_records.data(), m_records.size() * sizeof(Record));
+    writer.writeRaw(m_arena.data(), m_arena.size());
+
+    const uint64_t checksum = ModPack::hashName(std::string_view(writer.m_buffer).substr(s_payloadOffset));
+    std::memcpy(writer.m_buffer.data() + s_payloadOffset - sizeof(checksum), &checksum, sizeof(checksum));
+    return std::move(writer.m_buffer);
+}
+
+}
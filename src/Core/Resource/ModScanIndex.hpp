@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+#pragma once
+
+#include "IResourceLibrary.hpp"
+#include "ModPack.hpp"
+
+#include "CoreResourceExport.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace FreeHeroes::Core {
+
+// Resource files of one mod (loose folder and/or pack) as compact records; all strings are offsets into one arena.
+// Loose part is persisted to a cache file and reused on next start: directory records are trusted while
+// directory modification time is the same (adding, removing or renaming a file changes it), so a warm start costs
+// one stat per directory instead of a full tree walk. Changed directories are rescanned alone.
+class CORERESOURCE_EXPORT ModScanIndex {
+public:
+    static constexpr const uint32_t s_loose = uint32_t(-1);
+
+    struct Directory {
+        int64_t  m_mtime      = 0; // last_write_time() ticks.
+        uint32_t m_path       = 0; // relative to mod root with '/' separator, empty for root.
+        uint32_t m_pathLength = 0;
+        uint32_t m_parent     = 0; // index of parent directory; root is the first one and refers to itself.
+        uint32_t m_reserved   = 0;
+    };
+
+    struct Record {
+        ResourceType m_type       = ResourceType::Invalid;
+        uint32_t     m_dir        = 0;       // loose record directory.
+        uint32_t     m_packIndex  = s_loose; // index of packed entry in ModPack.
+        uint32_t     m_name       = 0;       // file name.
+        uint16_t     m_nameLength = 0;
+        uint16_t     m_idLength   = 0; // id is the file name prefix before the first dot.
+    };
+
+    struct ScanStats {
+        size_t m_dirs        = 0;
+        size_t m_reusedDirs  = 0;
+        size_t m_scannedDirs = 0;
+        bool   m_cacheLoaded = false;
+        bool   m_cacheSaved  = false;
+    };
+
+    using ConstPtr = std::shared_ptr<const ModScanIndex>;
+
+public:
+    // modRoot and packPath can be empty. Without cacheFile folder is always scanned fully.
+    static ConstPtr create(const Mernel::std_path& modRoot, const Mernel::std_path& packPath, const Mernel::std_path& cacheFile) noexcept;
+
+    // '<cacheDir>/<modId>-<hash of modRoot>.fhscan'
+    static Mernel::std_path makeCachePath(const Mernel::std_path& cacheDir, const std::string& modId, const Mernel::std_path& modRoot);
+
+    // 'name.fhsprite.json' -> Sprite, id length 4; Invalid for unknown extension.
+    static ResourceType detectResource(std::string_view fileName, size_t& idLength) noexcept;
+
+    size_t        size() const noexcept { return m_records.size(); }
+    const Record& getRecord(size_t index) const noexcept { return m_records[index]; }
+
+    std::string_view getId(const Record& record) const noexcept { return getString(record.m_name, record.m_idLength); }
+    std::string_view getName(const Record& record) const noexcept { return getString(record.m_name, record.m_nameLength); }
+
+    // Loose file path, or virtual '<pack>/<name>' path for packed record.
+    Mernel::std_path getPath(const Record& record) const;
+
+    const Mernel::std_path& getRoot() const noexcept { return m_root; }
+    const ModPack*          getPack() const noexcept { return m_pack.get(); }
+    const ScanStats&        getStats() const noexcept { return m_stats; }
+
+    ModScanIndex(const ModScanIndex&)            = delete;
+    ModScanIndex& operator=(const ModScanIndex&) = delete;
+
+private:
+    ModScanIndex() = default;
+
+    std::string_view getString(uint32_t offset, uint32_t length) const noexcept { return std::string_view(m_arena).substr(offset, length); }
+    uint32_t         addString(std::string_view str);
+
+    struct Scanner;
+
+    void addPacked();
+
+    bool        load(const std::string& buffer) noexcept;
+    std::string save() const;
+
+private:
+    Mernel::std_path       m_root;
+    ModPack::ConstPtr      m_pack;
+    std::string            m_arena;
+    std::vector<Directory> m_dirs;
+    std::vector<Record>    m_records; // loose records go first, then packed.
+    int64_t                m_scanTime = 0;
+    ScanStats              m_stats;
+};
+
+}
@@ -6,47 +6,141 @@
 
 #include "ResourceLibrary.hpp"
 
+#include "MernelPlatform/FileIOUtils.hpp"
+#include "MernelPlatform/Logger.hpp"
+
 namespace FreeHeroes::Core {
 
-bool ResourceLibrary::contains(ResourceType type, const std::string& id) const noexcept
+namespace {
+
+// 'dir/name.fhsprite.json' -> 'dir/name' + siblingExt
+std::string makeSiblingName(std::string_view name, std::string_view siblingExt)
 {
-    auto itType = m_media.find(type);
-    if (itType == m_media.cend())
-        return false;
+    const size_t filenameStart = name.find_last_of('/') + 1;
+    const size_t extStart      = name.find('.', filenameStart);
+    return std::string(name.substr(0, extStart)).append(siblingExt);
+}
 
-    auto& idMapping = itType->second;
-    return idMapping.contains(id);
+ResourceData makeOwnData(Mernel::ByteArrayHolder holder)
+{
+    auto buffer = std::make_shared<Mernel::ByteArrayHolder>(std::move(holder));
+    return ResourceData{ .m_data = { buffer->data(), buffer->size() }, .m_owner = buffer };
 }
 
-bool ResourceLibrary::fileExists(ResourceType type, const std::string& id) const noexcept
+}
+
+ResourceLibrary::ResourceLibrary(std::vector<ModScanIndex::ConstPtr> mods)
+    : m_mods(std::move(mods))
+{
+    std::map<ResourceType, size_t> counts;
+    for (const auto& mod : m_mods) {
+        for (size_t i = 0; i < mod->size(); ++i)
+            counts[mod->getRecord(i).m_type]++;
+    }
+    for (const auto& [type, count] : counts)
+        m_media[type].reserve(count);
+
+    for (const auto& mod : m_mods) {
+        for (const bool packed : { true, false }) {
+            for (size_t i = 0; i < mod->size(); ++i) {
+                const ModScanIndex::Record& record = mod->getRecord(i);
+                if ((record.m_packIndex != ModScanIndex::s_loose) != packed)
+                    continue;
+
+                m_media[record.m_type][mod->getId(record)] = Location{ .m_mod = mod.get(), .m_record = &record };
+            }
+        }
+    }
+}
+
+const ResourceLibrary::Location* ResourceLibrary::find(ResourceType type, const std::string& id) const noexcept
 {
     auto itType = m_media.find(type);
     if (itType == m_media.cend())
-        return false;
+        return nullptr;
 
     auto& idMapping = itType->second;
-    auto  it        = idMapping.find(id);
+    auto  it        = idMapping.find(std::string_view(id));
     if (it == idMapping.cend())
+        return nullptr;
+
+    return &it->second;
+}
+
+bool ResourceLibrary::contains(ResourceType type, const std::string& id) const noexcept
+{
+    return find(type, id) != nullptr;
+}
+
+bool ResourceLibrary::fileExists(ResourceType type, const std::string& id) const noexcept
+{
+    const Location* location = find(type, id);
+    if (!location)
         return false;
+    if (location->m_record->m_packIndex != ModScanIndex::s_loose)
+        return true; // pack is mapped for the library lifetime.
 
-    const Mernel::std_path& desc = it->second;
-    std::error_code         ec;
-    return Mernel::std_fs::exists(desc, ec);
+    std::error_code ec;
+    return Mernel::std_fs::exists(location->m_mod->getPath(*location->m_record), ec);
 }
 
 Mernel::std_path ResourceLibrary::get(ResourceType type, const std::string& id) const noexcept
 {
-    auto itType = m_media.find(type);
-    if (itType == m_media.cend())
+    const Location* location = find(type, id);
+    if (!location)
         return {};
 
-    auto& idMapping = itType->second;
-    auto  it        = idMapping.find(id);
-    if (it == idMapping.cend())
+    return location->m_mod->getPath(*location->m_record);
+}
+
+Mernel::std_path ResourceLibrary::getStoragePath(ResourceType type, const std::string& id) const noexcept
+{
+    const Location* location = find(type, id);
+    if (!location)
         return {};
 
-    const Mernel::std_path& desc = it->second;
-    return desc;
+    if (location->m_record->m_packIndex != ModScanIndex::s_loose)
+        return location->m_mod->getPack()->getPath();
+
+    return location->m_mod->getPath(*location->m_record);
+}
+
+ResourceData ResourceLibrary::getData(ResourceType type, const std::string& id, std::string_view siblingExt) const noexcept
+{
+    const Location* location = find(type, id);
+    if (!location)
+        return {};
+
+    try {
+        const ModScanIndex::Record& record = *location->m_record;
+        if (record.m_packIndex != ModScanIndex::s_loose) {
+            const ModPack* pack  = location->m_mod->getPack();
+            size_t         index = record.m_packIndex;
+            if (!siblingExt.empty()) {
+                index = pack->find(makeSiblingName(pack->getName(index), siblingExt));
+                if (index == ModPack::s_notFound)
+                    return {};
+            }
+            if (pack->getEntry(index).m_compression != ModPack::Compression::None)
+                return makeOwnData(pack->read(index));
+
+            return ResourceData{ .m_data = pack->view(index), .m_owner = pack->shared_from_this() };
+        }
+
+        Mernel::std_path path = location->m_mod->getPath(record);
+        if (!siblingExt.empty())
+            path = path.parent_path() / Mernel::string2path(makeSiblingName(Mernel::path2string(path.filename()), siblingExt));
+
+        std::error_code ec;
+        if (!Mernel::std_fs::exists(path, ec))
+            return {};
+
+        return makeOwnData(Mernel::readFileIntoHolder(path));
+    }
+    catch (std::exception& ex) {
+        Mernel::Logger(Mernel::Logger::Err) << "Failed to read resource '" << id << "': " << ex.what();
+        return {};
+    }
 }
 
 }
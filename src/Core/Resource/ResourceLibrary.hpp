@@ -7,6 +7,8 @@
 
 #include "IResourceLibrary.hpp"
 
+#include "ModScanIndex.hpp"
+
 #include <map>
 #include <unordered_map>
 #include <memory>
@@ -15,20 +17,30 @@ namespace FreeHeroes::Core {
 
 class ResourceLibrary : public IResourceLibrary {
 public:
-    using IdMappingMedia   = std::unordered_map<std::string, Mernel::std_path>;
+    struct Location {
+        const ModScanIndex*         m_mod    = nullptr;
+        const ModScanIndex::Record* m_record = nullptr;
+    };
+
+    // ids are views into ModScanIndex string arenas, so building the mapping does not allocate per entry strings.
+    using IdMappingMedia   = std::unordered_map<std::string_view, Location>;
     using TypeMappingMedia = std::map<ResourceType, IdMappingMedia>;
 
-    ResourceLibrary(TypeMappingMedia mapping)
-        : m_media(std::move(mapping))
-    {
-    }
+    // mods are in load order, later mod overrides earlier; loose files of mod override its packed ones.
+    explicit ResourceLibrary(std::vector<ModScanIndex::ConstPtr> mods);
 
     bool             contains(ResourceType type, const std::string& id) const noexcept override;
     bool             fileExists(ResourceType type, const std::string& id) const noexcept override;
     Mernel::std_path get(ResourceType type, const std::string& id) const noexcept override;
+    Mernel::std_path getStoragePath(ResourceType type, const std::string& id) const noexcept override;
+    ResourceData     getData(ResourceType type, const std::string& id, std::string_view siblingExt) const noexcept override;
+
+private:
+    const Location* find(ResourceType type, const std::string& id) const noexcept;
 
 private:
-    const TypeMappingMedia m_media;
+    const std::vector<ModScanIndex::ConstPtr> m_mods; // owns strings and packs of m_media.
+    TypeMappingMedia                          m_media;
 };
 
 }
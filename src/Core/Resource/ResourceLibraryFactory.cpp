@@ -5,6 +5,7 @@
  */
 #include "ResourceLibraryFactory.hpp"
 
+#include "ModScanIndex.hpp"
 #include "ResourceLibrary.hpp"
 
 #include "MernelPlatform/StringUtils.hpp"
@@ -17,61 +18,35 @@ using namespace Mernel;
 
 namespace {
 const std::string_view g_modFolderSuffix{ "fhmod" };
-
-const std::map<std::string, ResourceType> g_knownTypes{
-    { ".fhsprite.json", ResourceType::Sprite },
-    { ".wav", ResourceType::Sound },
-    { ".mp3", ResourceType::Music },
-    { ".webp", ResourceType::Video },
-    { ".fhdb.json", ResourceType::DbSegment },
-    { ".fhdbindex.json", ResourceType::DbIndex },
-};
-
-void mergeMappings(ResourceLibrary::TypeMappingMedia& dest, const ResourceLibrary::TypeMappingMedia& source)
-{
-    for (const auto& [type, idMapping] : source) {
-        auto& idMappingDest = dest[type];
-        for (const auto& [id, path] : idMapping) {
-            idMappingDest[id] = path;
-        }
-    }
-}
-
 }
 
 struct ResourceLibraryFactory::Impl {
     struct Mod {
-        std_path                          m_modRoot;
-        bool                              m_scanned = false;
-        ResourceLibrary::TypeMappingMedia m_modMapping;
+        std_path               m_modRoot;
+        std_path               m_packPath;
+        ModScanIndex::ConstPtr m_index;
 
-        void scanIfNeeded() noexcept
+        void scanIfNeeded(const std::string& id, const std_path& indexCacheDir) noexcept
         {
-            m_scanned = true;
-            for (const auto& it : std_fs::recursive_directory_iterator(m_modRoot)) {
-                if (!it.is_regular_file())
-                    continue;
-
-                const auto  path    = it.path();
-                auto        name    = path.filename();
-                std::string fullExt = "";
-                while (name.has_extension()) {
-                    fullExt = path2string(name.extension()) + fullExt;
-                    name    = name.stem();
-                }
-                const auto id = path2string(name);
-
-                auto typeIt = g_knownTypes.find(fullExt);
-                if (typeIt == g_knownTypes.cend())
-                    continue;
-                const ResourceType type = typeIt->second;
-
-                //Logger(Logger::Warning) << path;
-                m_modMapping[type][id] = path;
-            }
+            if (m_index)
+                return;
+
+            const std_path cacheFile = indexCacheDir.empty() || m_modRoot.empty() ? std_path() : ModScanIndex::makeCachePath(indexCacheDir, id, m_modRoot);
+            m_index                  = ModScanIndex::create(m_modRoot, m_packPath, cacheFile);
+
+            const auto& stats = m_index->getStats();
+            Logger(Logger::Info) << "Mod '" << id << "' index: " << m_index->size() << " resources, " << stats.m_dirs << " dirs ("
+                                 << stats.m_reusedDirs << " from cache, " << stats.m_scannedDirs << " scanned)";
         }
     };
 
+    const std_path m_indexCacheDir;
+
+    explicit Impl(std_path indexCacheDir)
+        : m_indexCacheDir(std::move(indexCacheDir))
+    {
+    }
+
     std::map<std::string, Mod> m_mods;
 
     void searchForSpecialModFolders(const std_path& folder)
@@ -81,26 +56,38 @@ struct ResourceLibraryFactory::Impl {
             return;
 
         for (const auto& it : std_fs::directory_iterator(folder)) {
-            if (!it.is_directory())
+            const bool isDirectory = it.is_directory();
+            if (!isDirectory && !it.is_regular_file())
                 continue;
 
             auto parts = splitLine(path2string(it.path().filename()), '.');
+            if (!isDirectory) {
+                if (parts.size() == 2 && "." + parts[1] == ModPack::s_extension)
+                    registerMod(parts[0], it.path(), &Mod::m_packPath);
+                continue;
+            }
             if (parts.size() != 2 || parts[1] != g_modFolderSuffix) {
                 searchForSpecialModFolders(it.path());
                 continue;
             }
-            const auto id = parts[0];
-            if (m_mods.contains(id)) {
-                Logger(Logger::Err) << "Found duplicate paths for mod id '" << id << "', both '" << path2string(m_mods[id].m_modRoot) << "' and '" << path2string(it.path()) << "'";
-            }
-            Logger(Logger::Info) << "Registered mod '" << id << "' at '" << path2string(it.path()) << "'";
-            m_mods[id] = { .m_modRoot = it.path() };
+            registerMod(parts[0], it.path(), &Mod::m_modRoot);
+        }
+    }
+
+    // mod can have both folder and pack with the same id.
+    void registerMod(const std::string& id, const std_path& path, std_path Mod::*field)
+    {
+        Mod& mod = m_mods[id];
+        if (!(mod.*field).empty()) {
+            Logger(Logger::Err) << "Found duplicate paths for mod id '" << id << "', both '" << path2string(mod.*field) << "' and '" << path2string(path) << "'";
         }
+        Logger(Logger::Info) << "Registered mod '" << id << "' at '" << path2string(path) << "'";
+        mod.*field = path;
     }
 };
 
-ResourceLibraryFactory::ResourceLibraryFactory()
-    : m_impl(std::make_unique<Impl>())
+ResourceLibraryFactory::ResourceLibraryFactory(Mernel::std_path indexCacheDir)
+    : m_impl(std::make_unique<Impl>(std::move(indexCacheDir)))
 {
 }
 
@@ -114,30 +101,30 @@ void ResourceLibraryFactory::scanForMods(const Mernel::std_path& root)
 void ResourceLibraryFactory::scanModSubfolders() const noexcept
 {
     for (auto&& [id, mod] : m_impl->m_mods)
-        mod.scanIfNeeded();
+        mod.scanIfNeeded(id, m_impl->m_indexCacheDir);
 }
 
 IResourceLibrary::ConstPtr ResourceLibraryFactory::create(const ModOrder& loadOrder) const noexcept
 {
     scanModSubfolders();
-    const std::set<std::string>       orderSet(loadOrder.cbegin(), loadOrder.cend());
-    ResourceLibrary::TypeMappingMedia mapping;
-    ModOrder                          realOrder;
+    const std::set<std::string>         orderSet(loadOrder.cbegin(), loadOrder.cend());
+    std::vector<ModScanIndex::ConstPtr> mods;
+    ModOrder                            realOrder;
     for (const auto& id : loadOrder) {
         if (!m_impl->m_mods.contains(id))
             continue;
 
-        mergeMappings(mapping, m_impl->m_mods[id].m_modMapping);
+        mods.push_back(m_impl->m_mods[id].m_index);
         realOrder.push_back(id);
     }
     for (auto&& [id, mod] : m_impl->m_mods) {
         if (orderSet.contains(id))
             continue;
-        mergeMappings(mapping, m_impl->m_mods[id].m_modMapping);
+        mods.push_back(mod.m_index);
         realOrder.push_back(id);
     }
     Logger(Logger::Notice) << "Resource index is created, requested order: <" << loadOrder << ">, resulting order: <" << realOrder << ">";
-    return std::make_shared<ResourceLibrary>(std::move(mapping));
+    return std::make_shared<ResourceLibrary>(std::move(mods));
 }
 
 }
@@ -13,7 +13,8 @@ namespace FreeHeroes::Core {
 
 class CORERESOURCE_EXPORT ResourceLibraryFactory : public IResourceLibraryFactory {
 public:
-    ResourceLibraryFactory();
+    // indexCacheDir - where to keep scan index of mod folders (see ModScanIndex); empty to scan them fully every time.
+    explicit ResourceLibraryFactory(Mernel::std_path indexCacheDir = {});
     ~ResourceLibraryFactory();
 
     void scanForMods(const Mernel::std_path& root);
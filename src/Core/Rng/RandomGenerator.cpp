@@ -85,6 +85,8 @@ int __hacked_clz(uint32_t n)
 
 #include <random>
 #include <iostream>
+#include <cstring>
+#include <type_traits>
 
 namespace FreeHeroes::Core {
 
@@ -94,6 +96,7 @@ using Distribution8  = hacked_libcxx::uniform_int_distribution<uint8_t>;
 class RandomGenerator : public IRandomGenerator {
 public:
     RandomGenerator();
+    RandomGenerator(const RandomGenerator&) = default;
     ~RandomGenerator();
 
     void setSeed(uint64_t seedValue) override
@@ -116,14 +119,24 @@ public:
 
     std::vector<uint8_t> serialize() const override
     {
-        std::vector<uint8_t> result;
-
+        static_assert(std::is_trivially_copyable_v<decltype(engine)>);
+        std::vector<uint8_t> result(sizeof(seed) + sizeof(engine));
+        std::memcpy(result.data(), &seed, sizeof(seed));
+        std::memcpy(result.data() + sizeof(seed), &engine, sizeof(engine));
         return result;
     }
 
     void deserialize(const std::vector<uint8_t>& state) override
     {
-        (void) state; // @todo: when we start writing networking code that become very handy.
+        if (state.size() != sizeof(seed) + sizeof(engine))
+            return;
+        std::memcpy(&seed, state.data(), sizeof(seed));
+        std::memcpy(&engine, state.data() + sizeof(seed), sizeof(engine));
+    }
+
+    IRandomGeneratorPtr clone() const override
+    {
+        return std::make_shared<RandomGenerator>(*this);
     }
 
     uint64_t gen(uint64_t max) override
@@ -7,6 +7,9 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <random>
+
 using namespace FreeHeroes::Core;
 
 namespace FreeHeroes::Core {
@@ -223,3 +226,194 @@ const std::vector<DistanceTestParams> testParams = []() -> std::vector<DistanceT
 INSTANTIATE_TEST_SUITE_P(InstantiationName,
                          DistanceTest,
                          testing::ValuesIn(testParams));
+
+namespace {
+
+// Straightforward set-based path finder, used as reference for the bitboard implementation.
+class ReferencePathFinder {
+public:
+    ReferencePathFinder(const BattleFieldGeometry& field)
+        : field(field)
+        , matrix(field.width * field.height, -1)
+    {
+    }
+
+    void floodFill(const BattlePosition start)
+    {
+        std::fill(matrix.begin(), matrix.end(), -1);
+        std::vector<int> remain(matrix.size(), 1);
+        remain[index(start)] = 0;
+        if (!goThroughObstacles) {
+            for (auto ob : obstacles)
+                if (field.isValid(ob))
+                    remain[index(ob)] = 0;
+        }
+        matrix[index(start)] = 0;
+        BattlePositionSet edge{ start };
+        for (int step = 1;; ++step) {
+            BattlePositionSet nextEdge;
+            for (auto edgePos : edge) {
+                for (auto [dir, pos] : field.getAdjacent(edgePos)) {
+                    if (remain[index(pos)] == 1)
+                        nextEdge.insert(pos);
+                }
+            }
+            if (nextEdge.empty())
+                break;
+            for (auto pos : nextEdge) {
+                remain[index(pos)] = 0;
+                matrix[index(pos)] = step;
+            }
+            edge = nextEdge;
+        }
+    }
+
+    BattlePositionPath fromStartTo(const BattlePosition end, int limit) const
+    {
+        static const std::vector<BattleDirection> priorities{
+            BattleDirection::BR,
+            BattleDirection::R,
+            BattleDirection::TR,
+            BattleDirection::TL,
+            BattleDirection::L,
+            BattleDirection::BL,
+        };
+        auto dirOrder = [](BattleDirection left, BattleDirection right) {
+            return std::find(priorities.cbegin(), priorities.cend(), left) < std::find(priorities.cbegin(), priorities.cend(), right);
+        };
+
+        BattlePositionPath result;
+        const int          endVal = matrix[index(end)];
+        if (endVal < 0 || obstacles.contains(end) || (limit != -1 && endVal > limit))
+            return result;
+
+        BattlePosition current = end;
+        result.push_back(current);
+        BattlePositionSet visited;
+        while (true) {
+            auto edge = field.getAdjacent(current);
+            std::erase_if(edge, [this, &visited](const auto& p) { return visited.contains(p.second) || (!goThroughObstacles && obstacles.contains(p.second)); });
+            if (edge.empty())
+                break;
+
+            auto minIt = std::min_element(edge.cbegin(), edge.cend(), [this, &dirOrder](const auto left, const auto right) {
+                const int valLeft  = matrix[index(left.second)];
+                const int valRight = matrix[index(right.second)];
+                if (valLeft < 0)
+                    return false;
+                if (valRight < 0)
+                    return true;
+                if (valRight != valLeft)
+                    return valLeft < valRight;
+                return dirOrder(left.first, right.first);
+            });
+            current    = minIt->second;
+            result.push_back(current);
+            visited.insert(current);
+            if (matrix[index(current)] == 0)
+                break;
+        }
+        std::reverse(result.begin(), result.end());
+        result.erase(result.begin());
+        return result;
+    }
+
+    BattlePositionDistanceMap findDistances(int limit) const
+    {
+        BattlePositionDistanceMap result;
+        if (limit == 0)
+            return result;
+        for (int w = 0; w < field.width; ++w) {
+            for (int h = 0; h < field.height; ++h) {
+                const int distance = matrix[index({ w, h })];
+                if (distance <= 0 || (limit != -1 && distance > limit) || obstacles.contains({ w, h }))
+                    continue;
+                result[{ w, h }] = distance;
+            }
+        }
+        return result;
+    }
+
+    int distanceTo(const BattlePosition pos) const { return matrix[index(pos)]; }
+
+    int index(const BattlePosition pos) const { return pos.y * field.width + pos.x; }
+
+    const BattleFieldGeometry field;
+    std::vector<int>          matrix;
+    BattlePositionSet         obstacles;
+    bool                      goThroughObstacles = false;
+};
+
+}
+
+TEST(BitboardPathFind, MatchesReference)
+{
+    std::mt19937 rng(42);
+    for (const BattleFieldGeometry geometry : { BattleFieldGeometry{ 15, 11 }, BattleFieldGeometry{ 17, 11 }, BattleFieldGeometry{ 4, 4 }, BattleFieldGeometry{ 5, 3 } }) {
+        const BattlePositionSet all = geometry.getAllPositions();
+        const std::vector       allVec(all.cbegin(), all.cend());
+        for (int iteration = 0; iteration < 200; ++iteration) {
+            const int         density = iteration % 5 * 10;
+            BattlePositionSet obstacles;
+            for (auto pos : all) {
+                if (int(rng() % 100) < density)
+                    obstacles.insert(pos);
+            }
+            const BattlePosition start     = allVec[rng() % allVec.size()];
+            const bool           goThrough = iteration % 3 == 0;
+            obstacles.erase(start);
+
+            ReferencePathFinder reference(geometry);
+            reference.obstacles          = obstacles;
+            reference.goThroughObstacles = goThrough;
+            reference.floodFill(start);
+
+            BattleFieldPathFinder finder(geometry);
+            finder.setObstacles(obstacles);
+            finder.setGoThroughObstacles(goThrough);
+            finder.floodFill(start);
+
+            for (auto pos : all)
+                ASSERT_EQ(finder.distanceTo(pos), reference.distanceTo(pos)) << "start=" << start << " pos=" << pos;
+
+            for (int limit : { -1, 0, 1, 3, 6 }) {
+                ASSERT_EQ(finder.findDistances(limit), reference.findDistances(limit));
+                BattlePositionSet available;
+                for (auto& [pos, distance] : reference.findDistances(limit))
+                    available.insert(pos);
+                ASSERT_EQ(finder.findAvailable(limit), available);
+            }
+
+            for (auto end : all) {
+                const int limit = iteration % 2 ? -1 : int(rng() % 8);
+                ASSERT_EQ(finder.fromStartTo(end, limit), reference.fromStartTo(end, limit)) << "start=" << start << " end=" << end;
+            }
+        }
+    }
+}
+
+TEST(BitboardPathFind, WidenForLarge)
+{
+    std::mt19937 rng(7);
+    for (const BattleFieldGeometry geometry : { BattleFieldGeometry{ 15, 11 }, BattleFieldGeometry{ 5, 3 } }) {
+        const BattleFieldMasks masks(geometry);
+        for (int iteration = 0; iteration < 50; ++iteration) {
+            BattlePositionSet obstacles;
+            for (auto pos : geometry.getAllPositions()) {
+                if (rng() % 4 == 0)
+                    obstacles.insert(pos);
+            }
+            for (bool mirrored : { false, true }) {
+                BattlePositionSet expected;
+                for (auto pos : obstacles) {
+                    expected.insert(pos);
+                    expected.insert({ mirrored ? pos.x + 1 : pos.x - 1, pos.y });
+                }
+                for (int h = 0; h < geometry.height; ++h)
+                    expected.insert({ mirrored ? 0 : geometry.width - 1, h });
+
+                ASSERT_EQ(masks.widenForLarge(masks.fromPositions(obstacles), mirrored), masks.fromPositions(expected));
+            }
+        }
+    }
+}
@@ -0,0 +1,382 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+
+#include "AdventureArmy.hpp"
+#include "AdventureEstimation.hpp"
+#include "BattleManager.hpp"
+#include "BattleReplay.hpp"
+#include "BattleSandbox.hpp"
+#include "BattleState.hpp"
+#include "GameDatabaseContainer.hpp"
+#include "IAI.hpp"
+#include "IGameDatabase.hpp"
+#include "IRandomGenerator.hpp"
+#include "LibrarySpell.hpp"
+#include "LibraryTerrain.hpp"
+#include "LibraryUnit.hpp"
+#include "RandomGenerator.hpp"
+#include "ResourceLibraryFactory.hpp"
+
+#include "MernelPlatform/AppLocations.hpp"
+#include "MernelPlatform/FileIOUtils.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace FreeHeroes;
+using namespace FreeHeroes::Core;
+using namespace Mernel;
+
+namespace {
+
+std_path getResourcesPath()
+{
+    return AppLocations("FreeHeroes").getBinDir() / "gameResources";
+}
+
+IResourceLibrary::ConstPtr makeResourceLibrary(const std_path& resourcesPath)
+{
+    ResourceLibraryFactory factory;
+    factory.scanForMods(resourcesPath);
+    factory.scanModSubfolders();
+    return factory.create({});
+}
+
+void fillSquad(AdventureSquad& squad, const std::vector<LibraryUnitConstPtr>& units, size_t offset)
+{
+    squad.stacks.clear();
+    for (size_t i = 0; i < 7; ++i)
+        squad.stacks.push_back(AdventureStack(units[(offset + i) % units.size()], 10 + static_cast<int>(i)));
+}
+
+void expectSameState(const BattleState& expected, const BattleState& actual)
+{
+    ASSERT_EQ(expected.stacks.size(), actual.stacks.size());
+    for (size_t i = 0; i < expected.stacks.size(); ++i) {
+        const BattleState::Stack& e = expected.stacks[i];
+        const BattleState::Stack& a = actual.stacks[i];
+        EXPECT_EQ(e.adventure, a.adventure) << "stack " << i;
+        EXPECT_EQ(e.side, a.side) << "stack " << i;
+        EXPECT_EQ(e.count, a.count) << "stack " << i;
+        EXPECT_EQ(e.health, a.health) << "stack " << i;
+        EXPECT_EQ(e.remainingShoots, a.remainingShoots) << "stack " << i;
+        EXPECT_EQ(e.castsDone, a.castsDone) << "stack " << i;
+        EXPECT_EQ(e.speedOrder, a.speedOrder) << "stack " << i;
+        EXPECT_EQ(e.sameSpeedOrder, a.sameSpeedOrder) << "stack " << i;
+        EXPECT_EQ(e.roundState.baseRoll, a.roundState.baseRoll) << "stack " << i;
+        EXPECT_EQ(e.roundState.baseRollCount, a.roundState.baseRollCount) << "stack " << i;
+        EXPECT_EQ(e.roundState.finishedTurn, a.roundState.finishedTurn) << "stack " << i;
+        EXPECT_EQ(e.roundState.waited, a.roundState.waited) << "stack " << i;
+        EXPECT_EQ(e.roundState.hadHighMorale, a.roundState.hadHighMorale) << "stack " << i;
+        EXPECT_EQ(e.roundState.hadLowMorale, a.roundState.hadLowMorale) << "stack " << i;
+        EXPECT_EQ(e.roundState.retaliationsDone, a.roundState.retaliationsDone) << "stack " << i;
+        EXPECT_EQ(e.roundState.guardBonus, a.roundState.guardBonus) << "stack " << i;
+        EXPECT_TRUE(e.pos == a.pos) << "stack " << i;
+        EXPECT_EQ(e.appliedEffects.size(), a.appliedEffects.size()) << "stack " << i;
+        EXPECT_TRUE(e.current == a.current) << "stack " << i;
+        EXPECT_EQ(e.cells.words, a.cells.words) << "stack " << i;
+    }
+    EXPECT_EQ(expected.alive, actual.alive);
+    EXPECT_EQ(expected.roundQueue, actual.roundQueue);
+    EXPECT_EQ(expected.current, actual.current);
+    for (size_t i = 0; i < expected.heroes.size(); ++i) {
+        EXPECT_EQ(expected.heroes[i].mana, actual.heroes[i].mana) << "hero " << i;
+        EXPECT_EQ(expected.heroes[i].castedInRound, actual.heroes[i].castedInRound) << "hero " << i;
+    }
+    EXPECT_EQ(expected.roundIndex, actual.roundIndex);
+    EXPECT_EQ(expected.battleFinished, actual.battleFinished);
+    EXPECT_EQ(expected.attackerHadFirstTurn, actual.attackerHadFirstTurn);
+    EXPECT_EQ(expected.defenderHadFirstTurn, actual.defenderHadFirstTurn);
+    EXPECT_EQ(expected.rng, actual.rng);
+}
+
+// Runs default AI on both sides of the battle, returns steps done.
+int runDefaultAI(BattleManager& battle, int stepLimit, BattleReplayData* replay = nullptr)
+{
+    IBattleView&                          battleView = battle;
+    std::unique_ptr<BattleReplayRecorder> recorder;
+    IBattleControl*                       control = &battle;
+    if (replay) {
+        recorder = std::make_unique<BattleReplayRecorder>(battle, *replay);
+        control  = recorder.get();
+    }
+    auto aiAtt = battle.makeAI(IAI::AIParams{}, *control);
+    auto aiDef = battle.makeAI(IAI::AIParams{}, *control);
+    int  step  = 0;
+    for (; step < stepLimit && !battleView.isFinished(); ++step) {
+        IAI& ai = battleView.getCurrentSide() == BattleStack::Side::Attacker ? *aiAtt : *aiDef;
+        ai.runStep();
+    }
+    return step;
+}
+
+class BattleStateTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        const std_path resourcesPath = getResourcesPath();
+        if (!std_fs::exists(resourcesPath))
+            GTEST_SKIP() << "no game resources at " << path2string(resourcesPath);
+
+        m_resourceLibrary = makeResourceLibrary(resourcesPath);
+        ASSERT_TRUE(m_resourceLibrary);
+        m_container = std::make_unique<GameDatabaseContainer>(m_resourceLibrary.get());
+        m_database  = m_container->getDatabase(GameVersion::HOTA);
+        ASSERT_TRUE(m_database);
+
+        for (auto* unit : m_database->units()->records()) {
+            if (!unit->battleMachineArtifact)
+                m_units.push_back(unit);
+        }
+        ASSERT_FALSE(m_units.empty());
+        m_terrain = m_database->terrains()->records()[0];
+    }
+
+    // Creates and starts a battle between two seven-stack squads.
+    void startBattle(uint64_t seed)
+    {
+        m_attAdv = AdventureArmy();
+        m_defAdv = AdventureArmy();
+        fillSquad(m_attAdv.squad, m_units, 0);
+        fillSquad(m_defAdv.squad, m_units, m_units.size() / 2);
+        startPreparedBattle(seed);
+    }
+
+    // Same, for squads and heroes already set in m_attAdv and m_defAdv.
+    void startPreparedBattle(uint64_t seed)
+    {
+        m_battle.reset();
+        AdventureEstimation(m_database).calculateArmy(m_attAdv, m_terrain);
+        AdventureEstimation(m_database).calculateArmy(m_defAdv, m_terrain);
+
+        m_att = std::make_unique<BattleArmy>(&m_attAdv, BattleStack::Side::Attacker);
+        m_def = std::make_unique<BattleArmy>(&m_defAdv, BattleStack::Side::Defender);
+
+        m_rng = m_rngFactory.create();
+        m_rng->setSeed(seed);
+
+        BattleFieldPreset fieldPreset;
+        fieldPreset.field = BattleFieldGeometry{ 15, 11 };
+
+        m_battle = std::make_unique<BattleManager>(*m_att,
+                                                   *m_def,
+                                                   fieldPreset,
+                                                   m_rng,
+                                                   m_database->gameRules(),
+                                                   [this](BattleStack::Side side, LibraryUnitConstPtr unit, int count) -> AdventureStackConstPtr {
+                                                       auto&                    army   = side == BattleStack::Side::Attacker ? m_attAdv : m_defAdv;
+                                                       AdventureStackMutablePtr result = army.squad.addHidden(unit, count);
+                                                       AdventureEstimation(m_database).calculateArmySummon(army, m_terrain, result);
+                                                       return result;
+                                                   });
+        m_battle->start();
+    }
+
+    IResourceLibrary::ConstPtr             m_resourceLibrary;
+    std::unique_ptr<GameDatabaseContainer> m_container;
+    const IGameDatabase*                   m_database = nullptr;
+    std::vector<LibraryUnitConstPtr>       m_units;
+    LibraryTerrainConstPtr                 m_terrain = nullptr;
+    RandomGeneratorFactory                 m_rngFactory;
+
+    AdventureArmy                     m_attAdv;
+    AdventureArmy                     m_defAdv;
+    std::unique_ptr<BattleArmy>       m_att;
+    std::unique_ptr<BattleArmy>       m_def;
+    std::shared_ptr<IRandomGenerator> m_rng;
+    std::unique_ptr<BattleManager>    m_battle;
+};
+
+}
+
+TEST_F(BattleStateTest, SaveRestore)
+{
+    startBattle(42);
+
+    BattleState initial;
+    m_battle->saveState(initial);
+
+    BattleReplayData replay;
+    const int        steps = runDefaultAI(*m_battle, 30, &replay);
+    ASSERT_GT(steps, 0);
+    ASSERT_FALSE(replay.m_records.empty());
+
+    BattleState afterActions;
+    m_battle->saveState(afterActions);
+
+    m_battle->restoreState(initial);
+    BattleState restored;
+    m_battle->saveState(restored);
+    expectSameState(initial, restored);
+
+    // rng is restored too, so the same actions give the same rolls.
+    for (const auto& action : replay.m_records)
+        ASSERT_TRUE(m_battle->applyAction(action));
+
+    BattleState replayed;
+    m_battle->saveState(replayed);
+    expectSameState(afterActions, replayed);
+}
+
+TEST_F(BattleStateTest, SandboxSameSeed)
+{
+    startBattle(42);
+
+    BattleSandbox first(*m_battle);
+    BattleSandbox second(*m_battle);
+    EXPECT_EQ(first.rng().serialize(), second.rng().serialize());
+
+    BattleState source, copy;
+    m_battle->saveState(source);
+    first.manager().saveState(copy);
+    expectSameState(source, copy);
+
+    for (uint64_t seed : { 1, 2 }) {
+        first.manager().restoreState(source);
+        second.manager().restoreState(source);
+        first.rng().setSeed(seed);
+        second.rng().setSeed(seed);
+
+        const int firstSteps  = runDefaultAI(first.manager(), 1000);
+        const int secondSteps = runDefaultAI(second.manager(), 1000);
+        EXPECT_EQ(firstSteps, secondSteps);
+
+        BattleState firstState, secondState;
+        first.manager().saveState(firstState);
+        second.manager().saveState(secondState);
+        expectSameState(firstState, secondState);
+    }
+
+    // sandboxes must not touch the source battle.
+    BattleState sourceAfter;
+    m_battle->saveState(sourceAfter);
+    expectSameState(source, sourceAfter);
+}
+
+TEST_F(BattleStateTest, SearchAI)
+{
+    startBattle(42);
+
+    IBattleView&         battleView = *m_battle;
+    BattleReplayData     replay;
+    BattleReplayRecorder recorder(*m_battle, replay);
+
+    IAI::AIParams searchParams;
+    searchParams.searchDepth  = 2;
+    searchParams.searchTimeMs = 200;
+    auto aiSearch             = m_battle->makeAI(searchParams, recorder);
+    auto aiDefault            = m_battle->makeAI(IAI::AIParams{}, recorder);
+
+    int searchSteps = 0;
+    for (int step = 0; step < 1000 && !battleView.isFinished(); ++step) {
+        if (battleView.getCurrentSide() == BattleStack::Side::Defender) {
+            aiDefault->runStep();
+            continue;
+        }
+        BattleState before;
+        m_battle->saveState(before);
+        const size_t recordsBefore = replay.m_records.size();
+
+        aiSearch->runStep();
+        searchSteps++;
+
+        // search works on copies: the real battle gets exactly one action.
+        ASSERT_EQ(replay.m_records.size(), recordsBefore + 1);
+        BattleState after;
+        m_battle->saveState(after);
+
+        m_battle->restoreState(before);
+        ASSERT_TRUE(m_battle->applyAction(replay.m_records.back()));
+        BattleState replayed;
+        m_battle->saveState(replayed);
+        expectSameState(after, replayed);
+    }
+    EXPECT_TRUE(battleView.isFinished());
+    EXPECT_GT(searchSteps, 0);
+
+    const IAI::SearchStats stats = aiSearch->getSearchStats();
+    EXPECT_GT(stats.nodes, 0);
+    EXPECT_GT(stats.elapsedUS, 0);
+}
+
+TEST_F(BattleStateTest, IncrementalUpdateSameAsFull)
+{
+    std::vector<LibraryUnitConstPtr> shooters, melee;
+    for (auto* unit : m_units)
+        (unit->primary.shoots > 0 ? shooters : melee).push_back(unit);
+    ASSERT_FALSE(shooters.empty());
+    ASSERT_FALSE(melee.empty());
+
+    std::vector<LibrarySpellConstPtr> spells;
+    for (auto* spell : m_database->spells()->records()) {
+        if (spell->type == LibrarySpell::Type::Temp || spell->type == LibrarySpell::Type::Offensive || spell->type == LibrarySpell::Type::Summon
+            || spell->type == LibrarySpell::Type::Rising)
+            spells.push_back(spell);
+    }
+    const auto& heroes = m_database->heroes()->records();
+    ASSERT_GE(heroes.size(), 2U);
+
+    int casts = 0, blockedShooters = 0;
+    for (int battleIndex = 0; battleIndex < 8; ++battleIndex) {
+        // shooters on both sides get blocked and unblocked as melee stacks come and go.
+        for (auto* army : { &m_attAdv, &m_defAdv }) {
+            const size_t offset = army == &m_attAdv ? battleIndex * 3 : battleIndex * 3 + shooters.size() / 2;
+            *army               = AdventureArmy();
+            for (size_t i = 0; i < 3; ++i)
+                army->squad.stacks.push_back(AdventureStack(shooters[(offset + i) % shooters.size()], 10 + static_cast<int>(i)));
+            for (size_t i = 0; i < 4; ++i)
+                army->squad.stacks.push_back(AdventureStack(melee[(offset + i) % melee.size()], 10 + static_cast<int>(i)));
+
+            army->hero.reset(heroes[(offset + battleIndex) % heroes.size()]);
+            army->hero.hasSpellBook                          = true;
+            army->hero.currentBasePrimary.magic.intelligence = 10;
+            for (auto* spell : spells)
+                army->hero.setSpellAvailable(spell, true);
+        }
+        startPreparedBattle(battleIndex);
+        m_battle->setUpdateMode(BattleManager::UpdateMode::Verify);
+
+        IBattleView&    battleView = *m_battle;
+        IBattleControl& control    = *m_battle;
+        auto            aiAtt      = m_battle->makeAI(IAI::AIParams{}, control);
+        auto            aiDef      = m_battle->makeAI(IAI::AIParams{}, control);
+        for (int step = 0; step < 1000 && !battleView.isFinished(); ++step) {
+            // hero casts every few steps, spell and target vary with the step.
+            if (step % 3 == 0 && battleView.getAvailableActions().heroCast) {
+                const auto  hero         = battleView.getHero(battleView.getCurrentSide());
+                const auto& heroSpells   = hero->estimated.availableSpells;
+                const auto  targetStacks = battleView.getAllStacks(true);
+                bool        casted       = false;
+                for (size_t i = 0; i < heroSpells.size() && !casted; ++i) {
+                    const auto& details = heroSpells[(step + i) % heroSpells.size()];
+                    if (details.manaCost > hero->mana)
+                        continue;
+                    for (size_t j = 0; j < targetStacks.size() && !casted; ++j) {
+                        const BattlePlanCastParams params{
+                            .m_target     = targetStacks[(step + j) % targetStacks.size()]->pos.mainPos(),
+                            .m_spell      = details.spell,
+                            .m_isHeroCast = true,
+                        };
+                        if (battleView.findPlanCast(params).isValid())
+                            casted = control.doCast(params);
+                    }
+                }
+                casts += casted;
+                if (battleView.isFinished())
+                    break;
+            }
+            IAI& ai = battleView.getCurrentSide() == BattleStack::Side::Attacker ? *aiAtt : *aiDef;
+            ai.runStep();
+
+            for (auto stack : battleView.getAllStacks(true))
+                blockedShooters += stack->current.canAttackRanged && stack->current.rangeAttackIsBlocked;
+        }
+        EXPECT_TRUE(battleView.isFinished()) << "battle " << battleIndex;
+        EXPECT_EQ(m_battle->getVerifyFailures(), 0U) << "battle " << battleIndex;
+    }
+    // make sure interesting cases were actually played.
+    EXPECT_GT(casts, 0);
+    EXPECT_GT(blockedShooters, 0);
+}
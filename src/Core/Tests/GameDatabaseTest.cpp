@@ -0,0 +1,299 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+
+#include "GameDatabaseContainer.hpp"
+#include "GameDatabasePropertyWriter.hpp"
+#include "GameDatabaseSnapshot.hpp"
+#include "LibraryReflection.hpp"
+#include "ResourceLibraryFactory.hpp"
+
+#include "MernelPlatform/AppLocations.hpp"
+#include "MernelPlatform/FileIOUtils.hpp"
+#include "MernelPlatform/PropertyTree.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace FreeHeroes;
+using namespace FreeHeroes::Core;
+using namespace Mernel;
+
+namespace {
+
+template<class T>
+void compareRecords(const IGameDatabase* expected, const IGameDatabase* actual)
+{
+    const auto& expectedRecords = expected->container<T>()->records();
+    const auto& actualRecords   = actual->container<T>()->records();
+    ASSERT_EQ(expectedRecords.size(), actualRecords.size());
+    for (size_t i = 0; i < expectedRecords.size(); ++i) {
+        PropertyTree               expectedJson, actualJson;
+        PropertyTreeWriterDatabase writer;
+        writer.valueToJson(*expectedRecords[i], expectedJson);
+        writer.valueToJson(*actualRecords[i], actualJson);
+        EXPECT_EQ(expectedRecords[i]->id, actualRecords[i]->id);
+        EXPECT_EQ(expectedJson, actualJson) << "record: " << expectedRecords[i]->id;
+    }
+}
+
+void compareDatabases(const IGameDatabase* expected, const IGameDatabase* actual)
+{
+    compareRecords<LibraryArtifact>(expected, actual);
+    compareRecords<LibraryBuilding>(expected, actual);
+    compareRecords<LibraryDwelling>(expected, actual);
+    compareRecords<LibraryFaction>(expected, actual);
+    compareRecords<LibraryHero>(expected, actual);
+    compareRecords<LibraryHeroSpec>(expected, actual);
+    compareRecords<LibraryMapBank>(expected, actual);
+    compareRecords<LibraryMapObstacle>(expected, actual);
+    compareRecords<LibraryMapVisitable>(expected, actual);
+    compareRecords<LibraryObjectDef>(expected, actual);
+    compareRecords<LibraryPlayer>(expected, actual);
+    compareRecords<LibraryResource>(expected, actual);
+    compareRecords<LibrarySecondarySkill>(expected, actual);
+    compareRecords<LibrarySpell>(expected, actual);
+    compareRecords<LibraryTerrain>(expected, actual);
+    compareRecords<LibraryUnit>(expected, actual);
+
+    PropertyTree               expectedRules, actualRules;
+    PropertyTreeWriterDatabase writer;
+    writer.valueToJson(*expected->gameRules(), expectedRules);
+    writer.valueToJson(*actual->gameRules(), actualRules);
+    EXPECT_EQ(expectedRules, actualRules);
+}
+
+std_path getResourcesPath()
+{
+    return AppLocations("FreeHeroes").getBinDir() / "gameResources";
+}
+
+IResourceLibrary::ConstPtr makeResourceLibrary(const std_path& resourcesPath)
+{
+    ResourceLibraryFactory factory;
+    factory.scanForMods(resourcesPath);
+    factory.scanModSubfolders();
+    return factory.create({});
+}
+
+}
+
+GTEST_TEST(GameDatabaseSnapshot, Roundtrip)
+{
+    PropertyTree tree;
+    tree.convertToMap();
+    tree["int"]    = PropertyTreeScalar(-42);
+    tree["double"] = PropertyTreeScalar(0.5);
+    tree["bool"]   = PropertyTreeScalar(true);
+    tree["str"]    = PropertyTreeScalar("text");
+    tree["null"]   = PropertyTree();
+    tree["empty"].convertToMap();
+    tree["list"].convertToList();
+    tree["list"].append(PropertyTreeScalar("a"));
+    tree["list"].append(PropertyTreeScalar(1));
+    tree["nested"]["key"]["deeper"] = PropertyTreeScalar(false);
+
+    const std::string buffer = GameDatabaseSnapshot::serialize(tree, 123);
+
+    PropertyTree loaded;
+    ASSERT_TRUE(GameDatabaseSnapshot::deserialize(buffer, 123, loaded));
+    EXPECT_EQ(tree, loaded);
+
+    EXPECT_FALSE(GameDatabaseSnapshot::deserialize(buffer, 124, loaded));
+    EXPECT_FALSE(GameDatabaseSnapshot::deserialize(buffer.substr(0, buffer.size() - 1), 123, loaded));
+    EXPECT_FALSE(GameDatabaseSnapshot::deserialize(buffer + "x", 123, loaded));
+    EXPECT_FALSE(GameDatabaseSnapshot::deserialize(std::string(), 123, loaded));
+}
+
+GTEST_TEST(GameDatabaseSnapshot, SameAsJson)
+{
+    const std_path resourcesPath = getResourcesPath();
+    if (!std_fs::exists(resourcesPath))
+        GTEST_SKIP() << "no game resources at " << path2string(resourcesPath);
+
+    const std_path snapshotDir = std_fs::temp_directory_path() / "FreeHeroesTests" / "DatabaseSnapshot";
+    std_fs::remove_all(snapshotDir);
+
+    auto resourceLibrary = makeResourceLibrary(resourcesPath);
+    ASSERT_TRUE(resourceLibrary);
+
+    GameDatabaseContainer jsonContainer(resourceLibrary.get());
+    const IGameDatabase*  jsonDb = jsonContainer.getDatabase(GameVersion::HOTA);
+    ASSERT_TRUE(jsonDb);
+
+    // cold start: loads JSON and writes snapshot.
+    {
+        GameDatabaseContainer coldContainer(resourceLibrary.get(), snapshotDir);
+        const IGameDatabase*  coldDb = coldContainer.getDatabase(GameVersion::HOTA);
+        ASSERT_TRUE(coldDb);
+        compareDatabases(jsonDb, coldDb);
+    }
+    std::vector<std_path> snapshots;
+    for (const auto& it : std_fs::directory_iterator(snapshotDir))
+        snapshots.push_back(it.path());
+    ASSERT_EQ(snapshots.size(), 1U);
+
+    // warm start: loads snapshot.
+    {
+        GameDatabaseContainer warmContainer(resourceLibrary.get(), snapshotDir);
+        const IGameDatabase*  warmDb = warmContainer.getDatabase(GameVersion::HOTA);
+        ASSERT_TRUE(warmDb);
+        compareDatabases(jsonDb, warmDb);
+    }
+
+    // corrupted snapshot: falls back to JSON and rewrites it.
+    ASSERT_TRUE(writeFileFromBufferNoexcept(snapshots[0], std::string("FHDBSNAP garbage")));
+    {
+        GameDatabaseContainer brokenContainer(resourceLibrary.get(), snapshotDir);
+        const IGameDatabase*  brokenDb = brokenContainer.getDatabase(GameVersion::HOTA);
+        ASSERT_TRUE(brokenDb);
+        compareDatabases(jsonDb, brokenDb);
+    }
+    std::string buffer;
+    ASSERT_TRUE(readFileIntoBufferNoexcept(snapshots[0], buffer));
+    EXPECT_GT(buffer.size(), 1000U);
+
+    std_fs::remove_all(snapshotDir);
+}
+
+GTEST_TEST(GameDatabase, ParallelLoadSameAsSequential)
+{
+    const std_path resourcesPath = getResourcesPath();
+    if (!std_fs::exists(resourcesPath))
+        GTEST_SKIP() << "no game resources at " << path2string(resourcesPath);
+
+    auto resourceLibrary = makeResourceLibrary(resourcesPath);
+    ASSERT_TRUE(resourceLibrary);
+
+    for (GameVersion version : { GameVersion::SOD, GameVersion::HOTA }) {
+        GameDatabaseContainer sequentialContainer(resourceLibrary.get(), {}, 1);
+        const IGameDatabase*  sequentialDb = sequentialContainer.getDatabase(version);
+        ASSERT_TRUE(sequentialDb);
+
+        for (int jobs : { 2, 4, 16 }) {
+            GameDatabaseContainer parallelContainer(resourceLibrary.get(), {}, jobs);
+            const IGameDatabase*  parallelDb = parallelContainer.getDatabase(version);
+            ASSERT_TRUE(parallelDb);
+            compareDatabases(sequentialDb, parallelDb);
+        }
+    }
+}
+
+GTEST_TEST(GameDatabase, PatchedShared)
+{
+    const std_path resourcesPath = getResourcesPath();
+    if (!std_fs::exists(resourcesPath))
+        GTEST_SKIP() << "no game resources at " << path2string(resourcesPath);
+
+    auto resourceLibrary = makeResourceLibrary(resourcesPath);
+    ASSERT_TRUE(resourceLibrary);
+
+    GameDatabaseContainer                 container(resourceLibrary.get());
+    const IGameDatabaseContainer::DbOrder order{ std::string(g_database_HOTA) };
+    const IGameDatabase*                  baseDb = container.getDatabase(order);
+    ASSERT_TRUE(baseDb);
+
+    const std::string playerId = baseDb->players()->records().at(0)->id;
+    PropertyTree      patch;
+    patch["players"][playerId]["untranslatedName"] = PropertyTreeScalar(std::string("Patched player"));
+    patch["players"][playerId]["pres"]["order"]     = PropertyTreeScalar(int64_t(1000));
+
+    auto patchedDb = container.getDatabase(order, patch);
+    ASSERT_TRUE(patchedDb);
+    EXPECT_EQ(patchedDb->players()->find(playerId)->untranslatedName, "Patched player");
+    EXPECT_NE(baseDb->players()->find(playerId)->untranslatedName, "Patched player");
+    EXPECT_EQ(patchedDb->players()->records().size(), baseDb->players()->records().size());
+    EXPECT_EQ(patchedDb->players()->records().back(), patchedDb->players()->find(playerId)); // sort key is patched.
+
+    // same patch gives same database while someone holds it.
+    EXPECT_EQ(container.getDatabase(order, patch), patchedDb);
+
+    // different patch is a different database.
+    PropertyTree otherPatch = patch;
+    otherPatch["players"][playerId]["untranslatedName"] = PropertyTreeScalar(std::string("Other player"));
+    auto otherDb = container.getDatabase(order, otherPatch);
+    ASSERT_TRUE(otherDb);
+    EXPECT_NE(otherDb, patchedDb);
+    EXPECT_EQ(otherDb->players()->find(playerId)->untranslatedName, "Other player");
+
+    std::weak_ptr<const IGameDatabase> weakDb = patchedDb;
+    patchedDb.reset();
+    EXPECT_TRUE(weakDb.expired());
+}
+
+GTEST_TEST(GameDatabase, PatchedLinkedRecords)
+{
+    const std_path resourcesPath = getResourcesPath();
+    if (!std_fs::exists(resourcesPath))
+        GTEST_SKIP() << "no game resources at " << path2string(resourcesPath);
+
+    auto resourceLibrary = makeResourceLibrary(resourcesPath);
+    ASSERT_TRUE(resourceLibrary);
+
+    GameDatabaseContainer                 container(resourceLibrary.get());
+    const IGameDatabaseContainer::DbOrder order{ std::string(g_database_HOTA) };
+    const IGameDatabase*                  baseDb = container.getDatabase(order);
+    ASSERT_TRUE(baseDb);
+
+    const LibraryFaction* faction = nullptr;
+    for (const auto* record : baseDb->factions()->records()) {
+        if (!record->units.empty() && !record->units[0]->objectDefs.variants.empty() && !record->units[0]->upgrades.empty()) {
+            faction = record;
+            break;
+        }
+    }
+    ASSERT_TRUE(faction);
+    const LibraryUnit*     unit     = faction->units[0];
+    const LibraryArtifact* artifact = nullptr;
+    for (const auto* record : baseDb->artifacts()->records()) {
+        if (!record->objectDefs.variants.empty() && !record->scrollSpell) { // scrolls share one object def.
+            artifact = record;
+            break;
+        }
+    }
+    ASSERT_TRUE(artifact);
+    const int baseAttack = unit->primary.ad.attack;
+    const int baseValue  = artifact->value;
+
+    PropertyTree patch;
+    patch["units"][unit->id]["primary"]["ad"]["attack"] = PropertyTreeScalar(int64_t(baseAttack + 10));
+    patch["artifacts"][artifact->id]["value"]           = PropertyTreeScalar(int64_t(baseValue + 1));
+
+    auto patchedDb = container.getDatabase(order, patch);
+    ASSERT_TRUE(patchedDb);
+
+    // patched records must be same through every link, not only through find().
+    const LibraryUnit* patchedUnit = patchedDb->units()->find(unit->id);
+    ASSERT_TRUE(patchedUnit);
+    EXPECT_EQ(patchedUnit->primary.ad.attack, baseAttack + 10);
+    const LibraryFaction* patchedFaction = patchedDb->factions()->find(faction->id);
+    ASSERT_TRUE(patchedFaction);
+    EXPECT_EQ(patchedUnit->faction, patchedFaction);
+    ASSERT_FALSE(patchedFaction->units.empty());
+    EXPECT_EQ(patchedFaction->units[0], patchedUnit);
+    EXPECT_EQ(patchedFaction->units[0]->primary.ad.attack, baseAttack + 10);
+    for (const auto* upgrade : patchedUnit->upgrades) {
+        EXPECT_EQ(upgrade->prevUpgrade, patchedUnit);
+        EXPECT_EQ(upgrade->baseUpgrade->primary.ad.attack, baseAttack + 10);
+    }
+    for (const auto& [key, objectDef] : patchedUnit->objectDefs.variants) {
+        EXPECT_EQ(patchedDb->objectDefs()->find(objectDef->id), objectDef);
+        ASSERT_EQ(objectDef->mappings.unit, patchedUnit);
+        EXPECT_EQ(objectDef->mappings.unit->primary.ad.attack, baseAttack + 10);
+    }
+
+    const LibraryArtifact* patchedArtifact = patchedDb->artifacts()->find(artifact->id);
+    ASSERT_TRUE(patchedArtifact);
+    EXPECT_EQ(patchedArtifact->value, baseValue + 1);
+    for (const auto& [key, objectDef] : patchedArtifact->objectDefs.variants) {
+        EXPECT_EQ(patchedDb->objectDefs()->find(objectDef->id), objectDef);
+        ASSERT_EQ(objectDef->mappings.artifact, patchedArtifact);
+        EXPECT_EQ(objectDef->mappings.artifact->value, baseValue + 1);
+    }
+
+    // base database is untouched.
+    EXPECT_EQ(baseDb->units()->find(unit->id)->primary.ad.attack, baseAttack);
+    EXPECT_EQ(baseDb->factions()->find(faction->id)->units[0]->primary.ad.attack, baseAttack);
+    EXPECT_EQ(baseDb->artifacts()->find(artifact->id)->value, baseValue);
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+
+#include "GameDatabaseContainer.hpp"
+#include "MapConverter.hpp"
+#include "RandomGenerator.hpp"
+#include "ResourceLibraryFactory.hpp"
+
+#include "MernelPlatform/AppLocations.hpp"
+#include "MernelPlatform/FileFormatJson.hpp"
+#include "MernelPlatform/FileIOUtils.hpp"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+using namespace FreeHeroes;
+using namespace FreeHeroes::Core;
+using namespace Mernel;
+
+namespace {
+
+std_path getResourcesPath()
+{
+    return AppLocations("FreeHeroes").getBinDir() / "gameResources";
+}
+
+IResourceLibrary::ConstPtr makeResourceLibrary(const std_path& resourcesPath)
+{
+    ResourceLibraryFactory factory;
+    factory.scanForMods(resourcesPath);
+    factory.scanModSubfolders();
+    return factory.create({});
+}
+
+}
+
+GTEST_TEST(MapGeneration, ParallelZonesSameResult)
+{
+    const std_path resourcesPath = getResourcesPath();
+    const std_path templatePath  = resourcesPath / "templates" / "jebus_balanced.json";
+    if (!std_fs::exists(templatePath))
+        GTEST_SKIP() << "no bundled template at " << path2string(templatePath);
+
+    auto resourceLibrary = makeResourceLibrary(resourcesPath);
+    ASSERT_TRUE(resourceLibrary);
+    GameDatabaseContainer  databaseContainer(resourceLibrary.get());
+    RandomGeneratorFactory rngFactory;
+
+    // every zone has own generator seeded from map seed, stage and zone index, so thread count must not matter.
+    auto generate = [&](int zoneJobs) -> std::string {
+        std::ostringstream log;
+        MapConverter       converter(log, &databaseContainer, &rngFactory, MapConverter::Settings{ .m_inputs = { .m_fhTemplate = templatePath } });
+        converter.setTemplateSettings(MapConverter::TemplateSettings{
+            .m_seed     = 42,
+            .m_zoneJobs = zoneJobs,
+            .m_mapSize  = 72,
+            .m_skipSave = true,
+        });
+        converter.run(MapConverter::Task::GenerateFHMap);
+
+        PropertyTree data;
+        converter.m_mapFH.toJson(data);
+        return writeJsonToBuffer(data, true);
+    };
+
+    const std::string expected = generate(1);
+    ASSERT_FALSE(expected.empty());
+    for (int zoneJobs : { 2, 8 }) {
+        const std::string actual = generate(zoneJobs);
+        EXPECT_TRUE(expected == actual) << "zoneJobs=" << zoneJobs;
+    }
+}
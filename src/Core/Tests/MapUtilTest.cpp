@@ -4,11 +4,15 @@
  * See LICENSE file for details.
  */
 #include "RmgUtil/MapTileContainer.hpp"
+#include "RmgUtil/MapTileRegionBitset.hpp"
 #include "RmgUtil/MapTileRegionWithEdge.hpp"
 #include "RmgUtil/MapTileRegionSegmentation.hpp"
 
 #include <gtest/gtest.h>
 
+#include <random>
+#include <set>
+
 using namespace FreeHeroes;
 
 struct CommonSegmentationParams {
@@ -914,3 +918,229 @@ GTEST_TEST(GridDetection, Basic2)
 
     ASSERT_NO_THROW(objectRegion.splitByKExt(settings));
 }
+
+// -----------------------------------------------------------------------------------------------------------
+// --------------------------------          Bitset region                ------------------------------------
+// -----------------------------------------------------------------------------------------------------------
+
+GTEST_TEST(MapTileRegionBitset, SameAsFlatSet)
+{
+    MapTileContainer tileContainer;
+    tileContainer.init(20, 18, 2);
+
+    MapTileRegion first, second;
+    for (size_t i = 0; i < tileContainer.getTileCount(); ++i) {
+        MapTilePtr tile = tileContainer.tileByIndex(i);
+        ASSERT_EQ(tile, tileContainer.find(tile->m_pos));
+        if (i % 3 == 0 || i % 7 == 0)
+            first.insert(tile);
+        if (i % 2 == 0)
+            second.insert(tile);
+    }
+    EXPECT_EQ(tileContainer.find(FHPos{ 20, 0, 0 }), nullptr);
+    EXPECT_EQ(tileContainer.find(FHPos{ -1, 0, 0 }), nullptr);
+    EXPECT_EQ(tileContainer.find(FHPos{ 0, 0, 2 }), nullptr);
+
+    const MapTileRegionBitset firstBits(&tileContainer, first);
+    const MapTileRegionBitset secondBits(&tileContainer, second);
+
+    EXPECT_EQ(firstBits.toRegion(), first);
+    EXPECT_EQ(firstBits.size(), first.size());
+    EXPECT_EQ(firstBits.first(), first[0]);
+    EXPECT_EQ(firstBits.unionWith(secondBits).toRegion(), first.unionWith(second));
+    EXPECT_EQ(firstBits.intersectWith(secondBits).toRegion(), first.intersectWith(second));
+    EXPECT_EQ(firstBits.diffWith(secondBits).toRegion(), first.diffWith(second));
+    for (MapTilePtr tile : tileContainer.m_all)
+        EXPECT_EQ(firstBits.contains(tile), first.contains(tile));
+    EXPECT_FALSE(firstBits.contains(nullptr));
+
+    MapTileRegionBitset empty(&tileContainer);
+    EXPECT_TRUE(empty.empty());
+    EXPECT_EQ(empty.first(), nullptr);
+    empty.insert(first);
+    empty.erase(first);
+    EXPECT_TRUE(empty.empty());
+}
+
+// -----------------------------------------------------------------------------------------------------------
+// --------------------------------          K-Means                      ------------------------------------
+// -----------------------------------------------------------------------------------------------------------
+
+namespace {
+
+// Previous MapTileRegionSegmentation::splitByKExt implementation (cluster loop for every tile, intSqrt for every tile/cluster pair),
+// kept as a reference for result identity.
+MapTileRegionList referenceSplitByKExt(const MapTileRegion& region, const KMeansSegmentationSettings& settingsList, size_t iterLimit)
+{
+    struct Cluster {
+        KMeansSegmentationSettings::Item m_settings;
+
+        FHPos                m_extraMassPoint;
+        FHPos                m_centroid;
+        FHPos                m_centerMass;
+        MapTilePtrSortedList m_points;
+        size_t               m_pointsCount    = 0;
+        int64_t              m_radiusPromille = 0;
+
+        int64_t distanceTo(MapTilePtr point) const
+        {
+            const auto    dx                      = int64_t(m_centroid.m_x - point->m_pos.m_x) * 1000;
+            const auto    dy                      = int64_t(m_centroid.m_y - point->m_pos.m_y) * 1000;
+            const int64_t linearDistancePromille  = intSqrt(dx * dx + dy * dy);
+            const int64_t distanceToCircumference = linearDistancePromille - m_radiusPromille;
+            const bool    isInside                = (distanceToCircumference <= 0);
+            const int64_t innerDistance           = isInside ? linearDistancePromille : m_radiusPromille;
+            const int64_t outerDistance           = isInside ? 0 : distanceToCircumference;
+            return innerDistance * m_settings.m_insideWeight + outerDistance * m_settings.m_outsideWeight;
+        }
+    };
+
+    if (region.empty())
+        return {};
+    const size_t K = settingsList.m_items.size();
+    if (K == 1)
+        return { region };
+
+    const MapTileContainer* container = region[0]->m_container;
+    std::vector<Cluster>    clusters(K);
+    for (size_t i = 0; i < K; i++) {
+        const auto& setting = settingsList.m_items[i];
+        Cluster&    cluster = clusters[i];
+        cluster.m_settings  = setting;
+        if (setting.m_extraMassPoint)
+            cluster.m_extraMassPoint = setting.m_extraMassPoint->m_pos;
+        cluster.m_centroid       = setting.m_initialCentroid->m_pos;
+        cluster.m_radiusPromille = MapTileRegionSegmentation::getRadiusPromille(setting.m_areaHint) / 2;
+    }
+
+    std::vector<size_t> nearestIndex(region.size(), size_t(-1));
+    for (size_t iter = 0; iter < iterLimit; ++iter) {
+        const bool last = iter == iterLimit - 1;
+
+        // fix repeated centroids
+        bool            hasIntersections = false;
+        std::set<FHPos> used;
+        for (const Cluster& cluster : clusters) {
+            if (!used.insert(cluster.m_centroid).second || !region.contains(container->at(cluster.m_centroid))) {
+                hasIntersections = true;
+                break;
+            }
+        }
+        if (hasIntersections) {
+            MapTileRegion rest = region;
+            for (Cluster& cluster : clusters) {
+                MapTilePtr tile = rest.findClosestPoint(cluster.m_centroid);
+                rest.erase(tile);
+                cluster.m_centroid = tile->m_pos;
+            }
+        }
+
+        bool done = true;
+        for (size_t i = 0; MapTilePtr tile : region) {
+            int64_t minDist = clusters[0].distanceTo(tile);
+            size_t  nearest = 0;
+            for (size_t k = 1; k < K; k++) {
+                const int64_t dist = clusters[k].distanceTo(tile);
+                if (dist < minDist) {
+                    minDist = dist;
+                    nearest = k;
+                }
+            }
+            done              = done && nearestIndex[i] == nearest;
+            nearestIndex[i++] = nearest;
+        }
+
+        for (Cluster& cluster : clusters) {
+            cluster.m_centerMass.m_x = cluster.m_settings.m_extraMassWeight * cluster.m_extraMassPoint.m_x;
+            cluster.m_centerMass.m_y = cluster.m_settings.m_extraMassWeight * cluster.m_extraMassPoint.m_y;
+            cluster.m_pointsCount    = cluster.m_settings.m_extraMassWeight;
+            cluster.m_points.clear();
+        }
+        for (size_t i = 0; MapTilePtr tile : region) {
+            Cluster& cluster = clusters[nearestIndex[i++]];
+            cluster.m_centerMass.m_x += tile->m_pos.m_x;
+            cluster.m_centerMass.m_y += tile->m_pos.m_y;
+            cluster.m_pointsCount++;
+            if (done || last)
+                cluster.m_points.push_back(tile);
+        }
+        for (Cluster& cluster : clusters) {
+            if (!cluster.m_pointsCount)
+                throw std::runtime_error("no points");
+            cluster.m_centerMass.m_x /= cluster.m_pointsCount;
+            cluster.m_centerMass.m_y /= cluster.m_pointsCount;
+            cluster.m_centerMass.m_z = cluster.m_centroid.m_z;
+            cluster.m_centroid       = cluster.m_centerMass;
+        }
+        if (done)
+            break;
+    }
+
+    MapTileRegionList result(K);
+    for (size_t i = 0; i < K; i++)
+        result[i] = MapTileRegion(clusters[i].m_points);
+    return result;
+}
+
+}
+
+GTEST_TEST(KMeansSegmentation, SameAsReference)
+{
+    MapTileContainer tileContainer;
+    tileContainer.init(64, 48, 1);
+
+    std::mt19937 rng(42);
+    auto         gen = [&rng](int maxValue) { return static_cast<int>(rng() % (maxValue + 1)); };
+
+    int compared = 0;
+    for (int caseIndex = 0; caseIndex < 200; ++caseIndex) {
+        const int x0      = gen(40);
+        const int y0      = gen(30);
+        const int w       = 8 + gen(23);
+        const int h       = 8 + gen(17);
+        const int density = 50 + gen(50);
+
+        MapTileRegion region;
+        for (MapTilePtr tile : tileContainer.m_all) {
+            const FHPos& pos = tile->m_pos;
+            if (pos.m_x >= x0 && pos.m_x < x0 + w && pos.m_y >= y0 && pos.m_y < y0 + h && gen(99) < density)
+                region.insert(tile);
+        }
+        if (region.size() < 20)
+            continue;
+
+        const size_t               k = 2 + gen(5);
+        KMeansSegmentationSettings settings;
+        settings.m_items.resize(k);
+        for (size_t i = 0; i < k; ++i) {
+            auto& item             = settings.m_items[i];
+            item.m_initialCentroid = region[i * region.size() / k];
+            item.m_areaHint        = region.size() / k;
+            item.m_insideWeight    = 1 + gen(2);
+            item.m_outsideWeight   = 1 + gen(3);
+            if (gen(2) == 0) {
+                item.m_extraMassPoint  = region[gen(region.size() - 1)];
+                item.m_extraMassWeight = 1 + gen(9);
+            }
+        }
+
+        MapTileRegionList expected, actual;
+        bool              expectedThrows = false, actualThrows = false;
+        try {
+            expected = referenceSplitByKExt(region, settings, 100);
+        }
+        catch (std::exception&) {
+            expectedThrows = true;
+        }
+        try {
+            actual = region.splitByKExt(settings);
+        }
+        catch (std::exception&) {
+            actualThrows = true;
+        }
+        ASSERT_EQ(expectedThrows, actualThrows) << "case " << caseIndex;
+        ASSERT_EQ(expected, actual) << "case " << caseIndex;
+        compared += !expectedThrows;
+    }
+    EXPECT_GT(compared, 100);
+}
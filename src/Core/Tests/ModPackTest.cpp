@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+
+#include "ModPack.hpp"
+#include "ResourceLibraryFactory.hpp"
+
+#include "MernelPlatform/FileIOUtils.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace FreeHeroes;
+using namespace FreeHeroes::Core;
+using namespace Mernel;
+
+namespace {
+
+std::string toString(std::span<const uint8_t> data)
+{
+    return std::string(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+std::string toString(const ByteArrayHolder& data)
+{
+    return std::string(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+class ModPackTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        m_root = std_fs::temp_directory_path() / "FreeHeroesTests" / "ModPack";
+        std_fs::remove_all(m_root);
+        m_modFolder = m_root / "src" / "test.fhmod";
+
+        m_json = "{ \"frames\": [" + std::string(2000, ' ') + "] }";
+        m_png  = std::string("\x89PNG\r\n\x1a\n", 8) + std::string(100, '\x01');
+        write("sprites/unit.fhsprite.json", m_json);
+        write("sprites/unit.png", m_png);
+        write("database/core.fhdb.json", "{}");
+        write("sounds/click.wav", "RIFF");
+    }
+    void TearDown() override
+    {
+        std_fs::remove_all(m_root);
+    }
+
+    void write(const std::string& name, const std::string& content)
+    {
+        const std_path path = m_modFolder / string2path(name);
+        std_fs::create_directories(path.parent_path());
+        ASSERT_TRUE(writeFileFromBufferNoexcept(path, content));
+    }
+
+    ModPack::PackStats pack(const std_path& packPath)
+    {
+        ModPack::PackSettings settings;
+        settings.m_compressExtensions = { ".json" };
+        return ModPack::pack(m_modFolder, packPath, settings);
+    }
+
+    std_path    m_root;
+    std_path    m_modFolder;
+    std::string m_json;
+    std::string m_png;
+};
+
+}
+
+TEST_F(ModPackTest, Roundtrip)
+{
+    const std_path           packPath = m_root / "test.fhpack";
+    const ModPack::PackStats stats    = pack(packPath);
+    EXPECT_EQ(stats.m_files, 3U);
+    EXPECT_EQ(stats.m_compressedFiles, 1U); // '{}' is not worth compressing.
+    EXPECT_EQ(stats.m_sourceBytes, m_json.size() + m_png.size() + 2);
+    EXPECT_EQ(stats.m_packBytes, std_fs::file_size(packPath));
+
+    auto modPack = ModPack::open(packPath);
+    ASSERT_TRUE(modPack);
+    ASSERT_EQ(modPack->size(), 3U);
+    for (size_t i = 1; i < modPack->size(); ++i)
+        EXPECT_LE(modPack->getEntry(i - 1).m_hash, modPack->getEntry(i).m_hash);
+
+    EXPECT_EQ(modPack->find("sounds/click.wav"), ModPack::s_notFound); // media always stays loose.
+    EXPECT_EQ(modPack->find("unit.png"), ModPack::s_notFound);
+
+    const size_t pngIndex = modPack->find("sprites/unit.png");
+    ASSERT_NE(pngIndex, ModPack::s_notFound);
+    EXPECT_EQ(modPack->getName(pngIndex), "sprites/unit.png");
+    EXPECT_EQ(modPack->getEntry(pngIndex).m_offset % ModPack::s_alignment, 0U);
+    EXPECT_EQ(toString(modPack->view(pngIndex)), m_png);
+    EXPECT_EQ(toString(modPack->read(pngIndex)), m_png);
+
+    const size_t jsonIndex = modPack->find("sprites/unit.fhsprite.json");
+    ASSERT_NE(jsonIndex, ModPack::s_notFound);
+    EXPECT_EQ(modPack->getEntry(jsonIndex).m_compression, ModPack::Compression::Zlib);
+    EXPECT_LT(modPack->getEntry(jsonIndex).m_storedSize, m_json.size());
+    EXPECT_TRUE(modPack->view(jsonIndex).empty());
+    EXPECT_EQ(toString(modPack->read(jsonIndex)), m_json);
+}
+
+TEST_F(ModPackTest, Corrupted)
+{
+    const std_path packPath = m_root / "test.fhpack";
+    pack(packPath);
+
+    std::string data = toString(readFileIntoHolder(packPath));
+    ASSERT_TRUE(writeFileFromBufferNoexcept(packPath, data.substr(0, data.size() - 10)));
+    EXPECT_FALSE(ModPack::open(packPath));
+
+    data[0] = 'X';
+    ASSERT_TRUE(writeFileFromBufferNoexcept(packPath, data));
+    EXPECT_FALSE(ModPack::open(packPath));
+}
+
+TEST_F(ModPackTest, ResourceLibrary)
+{
+    const std_path modsRoot = m_root / "mods";
+    pack(modsRoot / "test.fhpack");
+
+    {
+        ResourceLibraryFactory factory;
+        factory.scanForMods(modsRoot);
+        auto library = factory.create({ "test" });
+
+        ASSERT_TRUE(library->contains(ResourceType::Sprite, "unit"));
+        ASSERT_TRUE(library->contains(ResourceType::DbSegment, "core"));
+        EXPECT_FALSE(library->contains(ResourceType::Sound, "click"));
+        EXPECT_TRUE(library->fileExists(ResourceType::Sprite, "unit"));
+        EXPECT_EQ(library->getStoragePath(ResourceType::Sprite, "unit"), modsRoot / "test.fhpack");
+
+        EXPECT_EQ(library->getData(ResourceType::Sprite, "unit").toString(), m_json);
+        EXPECT_EQ(library->getData(ResourceType::Sprite, "unit", ".png").toString(), m_png);
+        EXPECT_EQ(library->getData(ResourceType::DbSegment, "core").toString(), "{}");
+        EXPECT_FALSE(library->getData(ResourceType::Sprite, "unit", ".bmp").isValid());
+
+        // view keeps the pack mapped after the library is gone.
+        ResourceData png = library->getData(ResourceType::Sprite, "unit", ".png");
+        library.reset();
+        EXPECT_EQ(png.toString(), m_png);
+    }
+
+    // loose folder with the same id overrides packed files, rest is still taken from the pack.
+    std_fs::rename(m_modFolder, modsRoot / "test.fhmod");
+    m_modFolder = modsRoot / "test.fhmod";
+    std_fs::remove_all(m_modFolder / "sprites");
+    write("database/core.fhdb.json", "{ \"loose\": true }");
+    {
+        ResourceLibraryFactory factory;
+        factory.scanForMods(modsRoot);
+        auto library = factory.create({ "test" });
+
+        EXPECT_EQ(library->getData(ResourceType::DbSegment, "core").toString(), "{ \"loose\": true }");
+        EXPECT_EQ(library->getStoragePath(ResourceType::DbSegment, "core"), m_modFolder / "database" / "core.fhdb.json");
+        EXPECT_EQ(library->getData(ResourceType::Sprite, "unit", ".png").toString(), m_png);
+        EXPECT_TRUE(library->contains(ResourceType::Sound, "click"));
+    }
+}
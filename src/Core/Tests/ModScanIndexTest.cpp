@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+
+#include "ModScanIndex.hpp"
+#include "ResourceLibraryFactory.hpp"
+
+#include "MernelPlatform/FileIOUtils.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <set>
+
+using namespace FreeHeroes;
+using namespace FreeHeroes::Core;
+using namespace Mernel;
+
+namespace {
+
+class ModScanIndexTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        m_root = std_fs::temp_directory_path() / "FreeHeroesTests" / "ModScanIndex";
+        std_fs::remove_all(m_root);
+        m_modRoot   = m_root / "mods" / "test.fhmod";
+        m_cacheFile = m_root / "cache" / "test.fhscan";
+
+        write("sprites/units/pikeman.fhsprite.json");
+        write("sprites/units/pikeman.png");
+        write("sprites/heroes/orrin.fhsprite.json");
+        write("database/core.fhdb.json");
+        write("database/core.fhdbindex.json");
+        write("sounds/click.wav");
+        write("readme.txt");
+        ageDirectories();
+    }
+    void TearDown() override
+    {
+        std_fs::remove_all(m_root);
+    }
+
+    void write(const std::string& name)
+    {
+        const std_path path = m_modRoot / string2path(name);
+        std_fs::create_directories(path.parent_path());
+        ASSERT_TRUE(writeFileFromBufferNoexcept(path, name));
+    }
+
+    // freshly changed directories are not trusted by the index, pretend everything was changed an hour ago.
+    void ageDirectories()
+    {
+        const auto past = std_fs::file_time_type::clock::now() - std::chrono::hours(1);
+        std_fs::last_write_time(m_modRoot, past);
+        for (const auto& it : std_fs::recursive_directory_iterator(m_modRoot)) {
+            if (it.is_directory())
+                std_fs::last_write_time(it.path(), past);
+        }
+    }
+
+    static std::set<std::string> getIds(const ModScanIndex& index)
+    {
+        std::set<std::string> result;
+        for (size_t i = 0; i < index.size(); ++i)
+            result.insert(std::string(index.getId(index.getRecord(i))));
+        return result;
+    }
+
+    std_path m_root;
+    std_path m_modRoot;
+    std_path m_cacheFile;
+};
+
+}
+
+TEST_F(ModScanIndexTest, DetectResource)
+{
+    size_t idLength = 0;
+    EXPECT_EQ(ModScanIndex::detectResource("pikeman.fhsprite.json", idLength), ResourceType::Sprite);
+    EXPECT_EQ(idLength, 7U);
+    EXPECT_EQ(ModScanIndex::detectResource("core.fhdbindex.json", idLength), ResourceType::DbIndex);
+    EXPECT_EQ(ModScanIndex::detectResource("theme.mp3", idLength), ResourceType::Music);
+    EXPECT_EQ(ModScanIndex::detectResource("pikeman.png", idLength), ResourceType::Invalid);
+    EXPECT_EQ(ModScanIndex::detectResource("a.b.fhsprite.json", idLength), ResourceType::Invalid);
+    EXPECT_EQ(ModScanIndex::detectResource(".fhdb.json", idLength), ResourceType::Invalid);
+}
+
+TEST_F(ModScanIndexTest, CacheReuse)
+{
+    auto cold = ModScanIndex::create(m_modRoot, {}, m_cacheFile);
+    EXPECT_FALSE(cold->getStats().m_cacheLoaded);
+    EXPECT_TRUE(cold->getStats().m_cacheSaved);
+    EXPECT_EQ(cold->getStats().m_dirs, 6U);
+    EXPECT_EQ(cold->getStats().m_scannedDirs, 6U);
+    EXPECT_EQ(getIds(*cold), (std::set<std::string>{ "pikeman", "orrin", "core", "click" }));
+    ASSERT_EQ(cold->size(), 5U);
+
+    auto warm = ModScanIndex::create(m_modRoot, {}, m_cacheFile);
+    EXPECT_TRUE(warm->getStats().m_cacheLoaded);
+    EXPECT_FALSE(warm->getStats().m_cacheSaved);
+    EXPECT_EQ(warm->getStats().m_reusedDirs, 6U);
+    EXPECT_EQ(warm->getStats().m_scannedDirs, 0U);
+    ASSERT_EQ(warm->size(), cold->size());
+    for (size_t i = 0; i < warm->size(); ++i) {
+        const auto& record = warm->getRecord(i);
+        EXPECT_EQ(warm->getPath(record), cold->getPath(cold->getRecord(i)));
+        EXPECT_TRUE(std_fs::exists(warm->getPath(record)));
+    }
+}
+
+TEST_F(ModScanIndexTest, ChangedDirectories)
+{
+    ModScanIndex::create(m_modRoot, {}, m_cacheFile);
+
+    // only 'heroes' and 'database' directories change.
+    write("sprites/heroes/sandro.fhsprite.json");
+    std_fs::remove(m_modRoot / "database" / "core.fhdb.json");
+
+    auto index = ModScanIndex::create(m_modRoot, {}, m_cacheFile);
+    EXPECT_TRUE(index->getStats().m_cacheLoaded);
+    EXPECT_EQ(index->getStats().m_scannedDirs, 2U);
+    EXPECT_EQ(index->getStats().m_reusedDirs, 4U);
+    EXPECT_EQ(getIds(*index), (std::set<std::string>{ "pikeman", "orrin", "sandro", "core", "click" }));
+    EXPECT_EQ(index->size(), 5U);
+
+    // new directory changes its parent.
+    ageDirectories();
+    ModScanIndex::create(m_modRoot, {}, m_cacheFile);
+    write("music/theme.mp3");
+    index = ModScanIndex::create(m_modRoot, {}, m_cacheFile);
+    EXPECT_EQ(index->getStats().m_scannedDirs, 2U);
+    EXPECT_EQ(index->getStats().m_dirs, 7U);
+    EXPECT_TRUE(getIds(*index).contains("theme"));
+
+    // removed directory disappears with its records.
+    ageDirectories();
+    ModScanIndex::create(m_modRoot, {}, m_cacheFile);
+    std_fs::remove_all(m_modRoot / "sprites" / "heroes");
+    index = ModScanIndex::create(m_modRoot, {}, m_cacheFile);
+    EXPECT_EQ(index->getStats().m_dirs, 6U);
+    EXPECT_EQ(getIds(*index), (std::set<std::string>{ "pikeman", "core", "click", "theme" }));
+}
+
+TEST_F(ModScanIndexTest, CorruptedCache)
+{
+    ModScanIndex::create(m_modRoot, {}, m_cacheFile);
+
+    std::string buffer = readFileIntoBuffer(m_cacheFile);
+    ASSERT_TRUE(writeFileFromBufferNoexcept(m_cacheFile, buffer.substr(0, buffer.size() - 1)));
+    auto index = ModScanIndex::create(m_modRoot, {}, m_cacheFile);
+    EXPECT_FALSE(index->getStats().m_cacheLoaded);
+    EXPECT_EQ(index->size(), 5U);
+
+    // any damaged byte fails the checksum, folder is rescanned.
+    buffer = readFileIntoBuffer(m_cacheFile);
+    buffer[buffer.size() - 3] ^= 0x7F;
+    ASSERT_TRUE(writeFileFromBufferNoexcept(m_cacheFile, buffer));
+    index = ModScanIndex::create(m_modRoot, {}, m_cacheFile);
+    EXPECT_FALSE(index->getStats().m_cacheLoaded);
+    EXPECT_EQ(getIds(*index), (std::set<std::string>{ "pikeman", "orrin", "core", "click" }));
+
+    // index of another folder is not used.
+    const std_path otherRoot = m_root / "other.fhmod";
+    std_fs::create_directories(otherRoot);
+    index = ModScanIndex::create(otherRoot, {}, m_cacheFile);
+    EXPECT_FALSE(index->getStats().m_cacheLoaded);
+    EXPECT_EQ(index->size(), 0U);
+}
+
+TEST_F(ModScanIndexTest, ResourceLibrary)
+{
+    for (int pass = 0; pass < 2; ++pass) {
+        ResourceLibraryFactory factory(m_root / "cache");
+        factory.scanForMods(m_root / "mods");
+        auto library = factory.create({ "test" });
+
+        ASSERT_TRUE(library->contains(ResourceType::Sprite, "pikeman"));
+        EXPECT_TRUE(library->fileExists(ResourceType::Sprite, "pikeman"));
+        EXPECT_EQ(library->get(ResourceType::Sprite, "pikeman"), m_modRoot / "sprites" / "units" / "pikeman.fhsprite.json");
+        EXPECT_EQ(library->get(ResourceType::Sound, "click"), m_modRoot / "sounds" / "click.wav");
+        EXPECT_EQ(library->getData(ResourceType::Sprite, "pikeman", ".png").toString(), "sprites/units/pikeman.png");
+        EXPECT_FALSE(library->contains(ResourceType::Sprite, "core"));
+    }
+    ASSERT_EQ(std::distance(std_fs::directory_iterator(m_root / "cache"), std_fs::directory_iterator{}), 1);
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+
+#include "Painter.hpp"
+
+#include "MernelPlatform/CommandLineUtils.hpp"
+#include "MernelPlatform/Profiler.hpp"
+
+#include <iostream>
+#include <random>
+
+using namespace FreeHeroes;
+using namespace Mernel;
+
+namespace {
+
+// Previous per-pixel Painter::drawPixmap, kept as a reference for timing.
+void referenceDrawPixmap(Pixmap& canvas, const PixmapPoint& offset, const Pixmap& pixmap, bool flipHor, bool flipVert)
+{
+    for (int y = 0; y < pixmap.height(); ++y) {
+        for (int x = 0; x < pixmap.width(); ++x) {
+            const int destX = flipHor ? -(x + offset.m_x) - 1 : x + offset.m_x;
+            const int destY = flipVert ? -(y + offset.m_y) - 1 : y + offset.m_y;
+            if (!canvas.inBounds(destX, destY))
+                continue;
+
+            auto& src  = pixmap.get(x, y).m_color;
+            auto& dest = canvas.get(destX, destY).m_color;
+            if (src.m_a == 255 || dest.m_a == 0) {
+                dest = src;
+            } else if (src.m_a != 0) {
+                const uint16_t alpha        = src.m_a;
+                const uint16_t inverseAlpha = uint16_t(255) - alpha;
+
+                dest.m_r = static_cast<uint8_t>((inverseAlpha * dest.m_r + alpha * src.m_r) / 256);
+                dest.m_g = static_cast<uint8_t>((inverseAlpha * dest.m_g + alpha * src.m_g) / 256);
+                dest.m_b = static_cast<uint8_t>((inverseAlpha * dest.m_b + alpha * src.m_b) / 256);
+                dest.m_a = 255;
+            }
+        }
+    }
+}
+
+// adventure map object-like sprite: transparent border, opaque body, antialiased edges and shadow.
+Pixmap makeSprite(std::mt19937& rng, int width, int height)
+{
+    Pixmap result(width, height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const int dx = std::abs(2 * x - width) * 100 / width;
+            const int dy = std::abs(2 * y - height) * 100 / height;
+            const int d  = std::max(dx, dy);
+
+            const uint8_t alpha            = d > 80 ? 0 : (d > 70 ? 128 : 255);
+            result.get(x, y).m_color = PixmapColor(rng() % 256, rng() % 256, rng() % 256, alpha);
+        }
+    }
+    return result;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    AbstractCommandLine parser({ "iterations" }, {});
+    if (!parser.parseArgs(std::cerr, argc, argv)) {
+        std::cerr << "Benchmarks invocation failed, correct usage is:\n";
+        std::cerr << parser.getHelp();
+        return 1;
+    }
+    const std::string iterationsStr = parser.getArg("iterations");
+    const int         iterations    = iterationsStr.empty() ? 20000 : std::atoi(iterationsStr.c_str());
+
+    std::mt19937 rng(42);
+    Pixmap       sprite = makeSprite(rng, 96, 64);
+    Pixmap       spriteWithRuns = sprite;
+    spriteWithRuns.updateOpacityRuns();
+
+    const PixmapSize canvasSize{ 1280, 1024 };
+    auto             blitOffset = [&canvasSize](int i) {
+        return PixmapPoint{ (i * 37) % (canvasSize.m_width + 96) - 96, (i * 53) % (canvasSize.m_height + 64) - 64 };
+    };
+
+    Pixmap             referenceCanvas(canvasSize);
+    Mernel::ScopeTimer referenceTimer;
+    for (int i = 0; i < iterations; ++i)
+        referenceDrawPixmap(referenceCanvas, blitOffset(i), sprite, i & 1, i & 2);
+    const int64_t referenceUS = std::max(int64_t(1), static_cast<int64_t>(referenceTimer.elapsedUS()));
+
+    int result = 0;
+    for (const Pixmap* source : { &sprite, &spriteWithRuns }) {
+        Pixmap             canvas(canvasSize);
+        Painter            painter(&canvas);
+        Mernel::ScopeTimer timer;
+        for (int i = 0; i < iterations; ++i)
+            painter.drawPixmap(blitOffset(i), *source, i & 1, i & 2);
+        const int64_t currentUS = std::max(int64_t(1), static_cast<int64_t>(timer.elapsedUS()));
+
+        const double mpix = static_cast<double>(iterations) * sprite.totalPixelSize() / currentUS;
+        std::cout << (source == &sprite ? "span blend" : "span blend + opacity runs") << ": " << currentUS << " us, "
+                  << mpix << " Mpix/s, speedup: x" << (static_cast<double>(referenceUS) / currentUS) << "\n";
+        if (canvas.m_pixels.size() != referenceCanvas.m_pixels.size()
+            || !std::equal(canvas.m_pixels.cbegin(), canvas.m_pixels.cend(), referenceCanvas.m_pixels.cbegin(), [](const auto& l, const auto& r) { return l.m_color == r.m_color; })) {
+            std::cout << "Result differs from per-pixel reference!\n";
+            result = 1;
+        }
+    }
+    std::cout << "per-pixel reference: " << referenceUS << " us.\n";
+
+    return result;
+}
@@ -16,7 +16,17 @@
 
 #include "MernelPlatform/Compression.hpp"
 
+#include "MernelExecution/ParallelExecutor.hpp"
+
+#include "MappedFile.hpp"
+
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <mutex>
+#include <span>
+#include <thread>
 
 namespace FreeHeroes {
 using namespace Mernel;
@@ -31,6 +41,60 @@ constexpr const size_t                 g_strSndSize = 40;
 constexpr const size_t                 g_strVidSize = 40;
 
 constexpr const std::string_view g_hdatChapterSeparator{ "\r\n=============================\r\n" };
+
+size_t binaryRecordSize(Archive::BinaryFormat format)
+{
+    return format == Archive::BinaryFormat::LOD ? 32 : (format == Archive::BinaryFormat::SND ? 48 : 44);
+}
+
+// Limits total size of record buffers being processed at once; record larger than the limit is processed alone.
+class MemoryBudget {
+public:
+    explicit MemoryBudget(size_t limit)
+        : m_limit(limit)
+    {}
+
+    class Lock {
+    public:
+        Lock(MemoryBudget& budget, size_t size)
+            : m_budget(budget)
+            , m_size(size)
+        {
+            std::unique_lock lock(m_budget.m_mutex);
+            m_budget.m_cond.wait(lock, [this] { return m_budget.m_used == 0 || m_budget.m_used + m_size <= m_budget.m_limit; });
+            m_budget.m_used += m_size;
+        }
+        ~Lock()
+        {
+            {
+                std::lock_guard lock(m_budget.m_mutex);
+                m_budget.m_used -= m_size;
+            }
+            m_budget.m_cond.notify_all();
+        }
+
+    private:
+        MemoryBudget& m_budget;
+        const size_t  m_size;
+    };
+
+private:
+    const size_t            m_limit;
+    size_t                  m_used = 0;
+    std::mutex              m_mutex;
+    std::condition_variable m_cond;
+};
+
+void writeFileFromView(const std_path& path, std::span<const uint8_t> data)
+{
+    std::ofstream ofs(path, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    if (!ofs)
+        throw std::runtime_error("Failed to open for write: " + path2string(path));
+    ofs.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    if (!ofs)
+        throw std::runtime_error("Failed to write: " + path2string(path));
+}
+
 }
 
 Archive::Archive(std::ostream* logOutput)
@@ -68,15 +132,29 @@ void Archive::detectFormat(const std_path& path, ByteOrderDataStreamReader& stre
 }
 
 void Archive::readBinary(ByteOrderDataStreamReader& stream)
+{
+    if (m_format == BinaryFormat::HDAT) {
+        readBinaryHDAT(stream);
+        m_isBinary = true;
+        return;
+    }
+    readBinaryDirectory(stream, stream.getBuffer().getSize());
+
+    for (auto* brec : m_binaryRecordsSortedByOffset) {
+        const auto offset = stream.getBuffer().getOffsetRead();
+        if (brec->m_offset != offset)
+            throw std::runtime_error("Record offset mismatch for '" + brec->m_basename + "', expected=" + std::to_string(brec->m_offset) + ", but get=" + std::to_string(offset));
+
+        brec->m_buffer.resize(brec->m_size);
+        stream.readBlock(brec->m_buffer.data(), brec->m_buffer.size());
+    }
+}
+
+void Archive::readBinaryDirectory(ByteOrderDataStreamReader& stream, size_t dataEndOffset)
 {
     switch (m_format) {
         case BinaryFormat::LOD:
             break;
-        case BinaryFormat::HDAT:
-            readBinaryHDAT(stream);
-            m_isBinary = true;
-            return;
-            break;
         case BinaryFormat::SND:
             break;
         case BinaryFormat::VID:
@@ -136,14 +214,13 @@ void Archive::readBinary(ByteOrderDataStreamReader& stream)
     updateIndex();
 
     const ptrdiff_t firstRecordOffset = static_cast<ptrdiff_t>(m_binaryRecordsSortedByOffset[0]->m_offset);
-    const ptrdiff_t dataEndOffset     = stream.getBuffer().getSize();
 
     {
         for (size_t i = 0; i < m_binaryRecordsSortedByOffset.size(); ++i) {
             const bool last     = i == m_binaryRecordsSortedByOffset.size() - 1;
             auto*      brec     = m_binaryRecordsSortedByOffset[i];
             auto*      brecNext = last ? nullptr : m_binaryRecordsSortedByOffset[i + 1];
-            brec->m_offsetNext  = last ? dataEndOffset : brecNext->m_offset;
+            brec->m_offsetNext  = last ? static_cast<uint32_t>(dataEndOffset) : brecNext->m_offset;
         }
 
         size_t paddingBlobCounter = 0;
@@ -158,21 +235,16 @@ void Archive::readBinary(ByteOrderDataStreamReader& stream)
             if (possiblePadding > 0) {
                 const size_t paddingSize = possiblePadding;
 
-                ByteArrayHolder blob;
-                blob.resize(paddingSize);
                 BinaryRecord padbrec;
                 padbrec.m_basename = "__PAD_" + std::to_string(paddingBlobCounter++);
                 padbrec.m_size     = paddingSize;
                 padbrec.m_fullSize = paddingSize;
-                padbrec.m_buffer   = blob;
                 padbrec.m_offset   = brec->m_offsetNext - possiblePadding;
 
                 *m_logOutput << "detected GAP in binary data at [" << padbrec.m_offset << ".." << brec->m_offsetNext << "], creating padding blob '" << padbrec.m_basename << "' of size=" << paddingSize << '\n';
 
                 m_binaryRecordsUnnamed.push_back(std::move(padbrec));
             }
-
-            brec->m_buffer.resize(brec->m_size);
         }
     }
     updateIndex();
@@ -184,13 +256,10 @@ void Archive::readBinary(ByteOrderDataStreamReader& stream)
     if (firstRecordOffset > currentOffset) {
         size_t paddingSize = firstRecordOffset - currentOffset;
 
-        ByteArrayHolder blob;
-        blob.resize(paddingSize);
         BinaryRecord padbrec;
         padbrec.m_basename = "__PAD";
         padbrec.m_size     = paddingSize;
         padbrec.m_fullSize = paddingSize;
-        padbrec.m_buffer   = blob;
         padbrec.m_offset   = currentOffset;
 
         *m_logOutput << "detected GAP in binary data at [" << currentOffset << ".." << firstRecordOffset << "], creating padding blob '" << padbrec.m_basename << "' of size=" << paddingSize << '\n';
@@ -200,18 +269,8 @@ void Archive::readBinary(ByteOrderDataStreamReader& stream)
     }
 
     size_t i = 0;
-    for (auto* brec : m_binaryRecordsSortedByOffset) {
+    for (auto* brec : m_binaryRecordsSortedByOffset)
         brec->m_binaryDataOrder = i++;
-        const auto offset       = stream.getBuffer().getOffsetRead();
-        if (0)
-            *m_logOutput << "i= " << (i - 1) << " name=" << brec->m_basename << ", exp=" << brec->m_offset << ", s=" << brec->m_buffer.size() << ", current=" << offset << '\n';
-        if (brec->m_offset == offset) {
-            stream.readBlock(brec->m_buffer.data(), brec->m_buffer.size());
-            continue;
-        }
-
-        throw std::runtime_error("Record offset mismatch for '" + brec->m_basename + "', expected=" + std::to_string(brec->m_offset) + ", but get=" + std::to_string(offset));
-    }
 }
 
 void Archive::writeBinary(ByteOrderDataStreamWriter& stream) const
@@ -264,14 +323,7 @@ void Archive::saveToFolder(const std_path& path, bool skipExisting) const
         throw std::runtime_error("Need to convertFromBinary() first!");
 
     std_fs::create_directories(path);
-    const auto jsonFilename = path / g_indexFileName;
-
-    PropertyTree                   data;
-    Reflection::PropertyTreeWriter writer;
-    writer.valueToJson(*this, data);
-
-    std::string buffer = writeJsonToBuffer(data, true);
-    writeFileFromBuffer(jsonFilename, buffer);
+    writeIndexToFolder(path);
 
     for (const Record& rec : m_records) {
         const auto out = path / string2path(rec.fullname());
@@ -306,6 +358,18 @@ void Archive::saveToFolder(const std_path& path, bool skipExisting) const
     }
 }
 
+void Archive::writeIndexToFolder(const std_path& path) const
+{
+    const auto jsonFilename = path / g_indexFileName;
+
+    PropertyTree                   data;
+    Reflection::PropertyTreeWriter writer;
+    writer.valueToJson(*this, data);
+
+    std::string buffer = writeJsonToBuffer(data, true);
+    writeFileFromBuffer(jsonFilename, buffer);
+}
+
 void Archive::loadFromFolder(const std_path& path)
 {
     m_isBinary = false;
@@ -431,13 +495,12 @@ void Archive::convertToBinary()
     updateIndex();
 
     {
-        const size_t binaryRecordSize = m_format == BinaryFormat::LOD ? 32 : (m_format == BinaryFormat::SND ? 48 : 44);
-        const size_t baseOffset       = 0
+        const size_t baseOffset = 0
                                   + (m_format == BinaryFormat::LOD ? sizeof(g_lodSignature) : 0)
                                   + (m_format == BinaryFormat::LOD ? sizeof(m_lodFormat) : 0)
                                   + sizeof(uint32_t) // size
                                   + m_lodHeader.size()
-                                  + binaryRecordSize * m_binaryRecords.size();
+                                  + binaryRecordSize(m_format) * m_binaryRecords.size();
 
         size_t offset = baseOffset;
 
@@ -457,13 +520,18 @@ void Archive::convertFromBinary(bool uncompress)
     if (m_format == BinaryFormat::HDAT)
         return;
 
+    convertRecordsFromBinary(uncompress, true);
+}
+
+void Archive::convertRecordsFromBinary(bool uncompress, bool withData)
+{
     m_records.clear();
-    m_records.reserve(m_binaryRecords.size());
+    m_records.reserve(m_binaryRecords.size() + m_binaryRecordsUnnamed.size());
     for (BinaryRecord& brec : m_binaryRecords) {
         Record rec;
         rec.m_isPadding                 = false;
         rec.m_bufferWithFile.m_buffer   = brec.m_buffer;
-        rec.m_bufferWithFile.m_inMemory = true;
+        rec.m_bufferWithFile.m_inMemory = withData;
 
         rec.m_originalBasename   = brec.m_basename;
         rec.m_basename           = strToLower(rec.m_originalBasename);
@@ -480,7 +548,7 @@ void Archive::convertFromBinary(bool uncompress)
         rec.m_compressOnDisk        = rec.m_compressInArchive && !uncompress;
         rec.m_uncompressedSizeCache = rec.m_compressInArchive ? brec.m_fullSize : 0;
 
-        if (!rec.m_compressOnDisk && rec.m_compressInArchive) {
+        if (!rec.m_compressOnDisk && rec.m_compressInArchive && withData) {
             ByteArrayHolder uncomp;
             uncompressDataBuffer(rec.m_bufferWithFile.m_buffer, uncomp, { .m_type = CompressionType::Zlib, .m_skipCRC = true });
             rec.m_bufferWithFile.m_buffer          = uncomp;
@@ -501,11 +569,111 @@ void Archive::convertFromBinary(bool uncompress)
         rec.m_basename = rec.m_originalBasename = brec.m_basename;
         rec.m_binaryOrder                       = brec.m_binaryDataOrder;
         rec.m_bufferWithFile.m_buffer           = brec.m_buffer;
-        rec.m_bufferWithFile.m_inMemory         = true;
+        rec.m_bufferWithFile.m_inMemory         = withData;
         m_records.push_back(std::move(rec));
     }
 }
 
+void Archive::extractToFolder(const Mernel::std_path& archivePath, const Mernel::std_path& folder, const ExtractSettings& settings)
+{
+    Core::MappedFile file;
+    if (!file.open(archivePath))
+        throw std::runtime_error("Failed to open archive: " + path2string(archivePath));
+
+    // header and directory are small compared to record data, they are copied and parsed as usual.
+    auto readPrefix = [&file](size_t size) {
+        ByteArrayHolder holder;
+        holder.resize(std::min(size, file.size()));
+        if (holder.size())
+            std::memcpy(holder.data(), file.data(), holder.size());
+        return holder;
+    };
+    auto parsePrefix = [&readPrefix](size_t size, auto&& parser) {
+        ByteArrayHolder           holder = readPrefix(size);
+        ByteOrderBuffer           bobuffer(holder);
+        ByteOrderDataStreamReader reader(bobuffer, ByteOrderDataStream::s_littleEndian);
+        parser(reader);
+    };
+
+    clear();
+    parsePrefix(sizeof(g_lodSignature), [this, &archivePath](ByteOrderDataStreamReader& reader) { detectFormat(archivePath, reader); });
+
+    if (m_format == BinaryFormat::HDAT) {
+        // texts with few small blobs, nothing to parallelize.
+        parsePrefix(file.size(), [this](ByteOrderDataStreamReader& reader) { readBinary(reader); });
+        convertFromBinary(settings.m_uncompress);
+        saveToFolder(folder, settings.m_skipExisting);
+        return;
+    }
+
+    const size_t countOffset = m_format == BinaryFormat::LOD ? sizeof(g_lodSignature) + sizeof(m_lodFormat) : 0;
+    const size_t headerSize  = countOffset + sizeof(uint32_t) + (m_format == BinaryFormat::LOD ? 80 : 0);
+    uint32_t     count       = 0;
+    parsePrefix(countOffset + sizeof(uint32_t), [countOffset, &count](ByteOrderDataStreamReader& reader) {
+        reader.getBuffer().setOffsetRead(countOffset);
+        reader >> count;
+    });
+
+    parsePrefix(headerSize + size_t(count) * binaryRecordSize(m_format), [this, &file](ByteOrderDataStreamReader& reader) {
+        readBinaryDirectory(reader, file.size());
+        size_t offset = reader.getBuffer().getOffsetRead();
+        for (const auto* brec : m_binaryRecordsSortedByOffset) {
+            if (brec->m_offset != offset)
+                throw std::runtime_error("Record offset mismatch for '" + brec->m_basename + "', expected=" + std::to_string(brec->m_offset) + ", but get=" + std::to_string(offset));
+            offset += brec->m_size;
+        }
+        if (offset > file.size())
+            throw std::runtime_error("Record data exceeds archive size " + std::to_string(file.size()));
+    });
+
+    m_isBinary = false;
+    convertRecordsFromBinary(settings.m_uncompress, false);
+
+    std_fs::create_directories(folder);
+    writeIndexToFolder(folder);
+
+    MemoryBudget                    budget(settings.m_memoryBudget);
+    std::vector<std::exception_ptr> errors(m_records.size());
+    TaskQueue                       taskQueue;
+    for (size_t i = 0; i < m_records.size(); ++i) {
+        Record&             rec  = m_records[i];
+        const BinaryRecord& brec = i < m_binaryRecords.size() ? m_binaryRecords[i] : m_binaryRecordsUnnamed[i - m_binaryRecords.size()];
+
+        rec.m_bufferWithFile.m_path = folder / string2path(rec.fullname());
+        if (settings.m_skipExisting && std_fs::exists(rec.m_bufferWithFile.m_path))
+            continue;
+
+        const std::span<const uint8_t> data(file.data() + brec.m_offset, brec.m_size);
+        const bool                     uncompress = rec.m_compressInArchive && !rec.m_compressOnDisk;
+        taskQueue.addTask([&budget, &error = errors[i], &path = rec.m_bufferWithFile.m_path, data, uncompress, fullSize = brec.m_fullSize] {
+            try {
+                if (!uncompress) {
+                    writeFileFromView(path, data); // straight from the mapping.
+                    return;
+                }
+                MemoryBudget::Lock lock(budget, data.size() + fullSize);
+                ByteArrayHolder    comp;
+                comp.resize(data.size());
+                std::memcpy(comp.data(), data.data(), data.size());
+                ByteArrayHolder uncomp;
+                uncompressDataBuffer(comp, uncomp, { .m_type = CompressionType::Zlib, .m_skipCRC = true });
+                writeFileFromHolder(path, uncomp);
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+        });
+    }
+    ParallelExecutor executor(settings.m_jobs > 0 ? settings.m_jobs : static_cast<int>(std::thread::hardware_concurrency()));
+    executor.execQueue(taskQueue);
+
+    // first error in archive order, so it does not depend on scheduling.
+    for (const auto& error : errors) {
+        if (error)
+            std::rethrow_exception(error);
+    }
+}
+
 void Archive::readBinaryHDAT(ByteOrderDataStreamReader& stream)
 {
     std::array<uint8_t, 4> signature;
@@ -8,9 +8,11 @@
 #include "MernelPlatform/ByteOrderStream.hpp"
 #include "MernelPlatform/FsUtils.hpp"
 
+#include "LegacyConverterUtilExport.hpp"
+
 namespace FreeHeroes {
 
-class Archive {
+class LEGACYCONVERTERUTIL_EXPORT Archive {
 public:
     enum class BinaryFormat
     {
@@ -23,6 +25,13 @@ public:
     using ByteOrderDataStreamReader = Mernel::ByteOrderDataStreamReader;
     using ByteOrderDataStreamWriter = Mernel::ByteOrderDataStreamWriter;
 
+    struct ExtractSettings {
+        bool   m_uncompress   = false;
+        bool   m_skipExisting = false;
+        int    m_jobs         = 0;                 // 0 - hardware concurrency.
+        size_t m_memoryBudget = 256 * 1024 * 1024; // record buffers in flight, bytes.
+    };
+
 public:
     BinaryFormat m_format = BinaryFormat::Invalid;
 
@@ -90,10 +99,23 @@ public:
     void convertToBinary();
     void convertFromBinary(bool uncompress);
 
+    // Same result as readBinary() + convertFromBinary() + saveToFolder(), but archive file is memory-mapped
+    // and only its header and directory are parsed; records are uncompressed and written by parallel jobs
+    // straight from the mapping. Records are left on disk, not in memory, like after loadFromFolder().
+    void extractToFolder(const Mernel::std_path& archivePath, const Mernel::std_path& folder, const ExtractSettings& settings);
+
 private:
     void readBinaryHDAT(ByteOrderDataStreamReader& stream);
     void writeBinaryHDAT(ByteOrderDataStreamWriter& stream) const;
 
+    // header and directory, sets sizes, data order and paddings of binary records; does not read record data.
+    void readBinaryDirectory(ByteOrderDataStreamReader& stream, size_t dataEndOffset);
+
+    // m_records from binary records; withData=false leaves them without buffers, to be read from files later.
+    void convertRecordsFromBinary(bool uncompress, bool withData);
+
+    void writeIndexToFolder(const Mernel::std_path& path) const;
+
 private:
     struct BinaryRecord {
         std::string          m_basename;
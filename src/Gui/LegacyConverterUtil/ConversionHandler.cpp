@@ -31,6 +31,7 @@ ENUM_REFLECTION_STRINGIFY(
     ArchiveSaveDat,
     ArchiveLoadFolder,
     ArchiveSaveFolder,
+    ArchiveExtractDat,
 
     ArchiveRoundTripFolder,
     ArchiveRoundTripMemory,
@@ -117,6 +118,12 @@ void ConversionHandler::run(Task task, int recurse) noexcept(false)
                 setOutput(m_outputs.m_folder);
                 runMember(writeArchiveToFolder);
             } break;
+            case Task::ArchiveExtractDat:
+            {
+                setInput(m_inputs.m_datFile);
+                setOutput(m_outputs.m_folder);
+                runMember(extractArchiveToFolder);
+            } break;
 
             case Task::ArchiveRoundTripFolder:
             {
@@ -357,6 +364,19 @@ void ConversionHandler::readArchiveFromFolder()
     m_archive->loadFromFolder(m_inputFilename);
 }
 
+void ConversionHandler::extractArchiveToFolder()
+{
+    if (m_settings.m_cleanupFolder) {
+        Mernel::std_fs::remove_all(m_outputFilename);
+    }
+    m_archive->extractToFolder(m_inputFilename, m_outputFilename, Archive::ExtractSettings{
+                                                                      .m_uncompress   = m_settings.m_uncompressArchive,
+                                                                      .m_skipExisting = !m_settings.m_forceWrite,
+                                                                      .m_jobs         = m_settings.m_jobs,
+                                                                  });
+    m_logOutput << m_currentIndent << "Extracted " << m_archive->m_records.size() << " records from: " << Mernel::path2string(m_inputFilename) << '\n';
+}
+
 void ConversionHandler::binaryDeserializeSprite()
 {
     ByteOrderBuffer           bobuffer(m_binaryBuffer);
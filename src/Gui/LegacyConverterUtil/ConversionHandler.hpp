@@ -43,6 +43,7 @@ public:
         bool     m_prettyJson          = false;
         bool     m_mergePng            = false;
         bool     m_transparentKeyColor = false;
+        int      m_jobs                = 0; // 0 - hardware concurrency.
     };
 
     enum class Task
@@ -53,6 +54,7 @@ public:
         ArchiveSaveDat,
         ArchiveLoadFolder,
         ArchiveSaveFolder,
+        ArchiveExtractDat, // same as ArchiveLoadDat + ArchiveSaveFolder, but does not load whole archive into memory.
 
         ArchiveRoundTripFolder,
         ArchiveRoundTripMemory,
@@ -108,6 +110,7 @@ private:
 
     void writeArchiveToFolder();
     void readArchiveFromFolder();
+    void extractArchiveToFolder();
 
     void binaryDeserializeSprite();
     void binaryDeserializeSpriteMsk();
@@ -344,8 +344,7 @@ void GameExtract::run(const DetectedSources& sources) const
         try {
             m_onProgress(current++, total);
             if (wrapper.m_doExtract) {
-                wrapper.m_converter->run(ConversionHandler::Task::ArchiveLoadDat);
-                wrapper.m_converter->run(ConversionHandler::Task::ArchiveSaveFolder);
+                wrapper.m_converter->run(ConversionHandler::Task::ArchiveExtractDat);
                 //sendMessage(wrapper.m_datFilename + " extracted.");
             } else {
                 wrapper.m_converter->run(ConversionHandler::Task::ArchiveLoadFolder);
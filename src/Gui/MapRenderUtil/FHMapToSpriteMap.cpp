@@ -21,6 +21,11 @@
 
 #include "IGraphicsLibrary.hpp"
 
+#include "MernelPlatform/Logger.hpp"
+#include "MernelPlatform/Profiler.hpp"
+
+#include <set>
+
 #ifndef DISABLE_QT
 #include <QColor>
 #endif
@@ -70,15 +75,18 @@ SpriteMap MapRenderer::render(const FHMap& fhMap, const Gui::IGraphicsLibrary* g
 
     bool hasMissingSprites = false;
 
-    auto makeItemById = [&makeItem, &hasMissingSprites, graphicsLibrary, this](SpriteMap::Layer layer, const std::string& id, const FHPos& pos, int priority = 0) -> SpriteMap::Item {
+    // every def is decoded in background as soon as it is first referenced, while the rest of the map is processed.
+    Mernel::ScopeTimer    timer;
+    std::set<std::string> spriteIds;
+
+    auto makeItemById = [&makeItem, &spriteIds, graphicsLibrary](SpriteMap::Layer layer, const std::string& id, const FHPos& pos, int priority = 0) -> SpriteMap::Item {
         auto item    = makeItem(pos, priority);
         item.m_layer = layer;
 
-        auto sprite = graphicsLibrary->getObjectAnimation(id);
-        if (m_settings.m_strict) {
-            if (!sprite || !sprite->preload())
-                hasMissingSprites = true;
-        }
+        if (spriteIds.insert(id).second)
+            graphicsLibrary->prefetch({ id }, Gui::AsyncLoadPriority::Normal);
+
+        auto sprite        = graphicsLibrary->getObjectAnimation(id);
         item.m_sprite      = sprite;
         item.m_spriteGroup = 0;
         item.addInfo("def", id);
@@ -615,6 +623,11 @@ SpriteMap MapRenderer::render(const FHMap& fhMap, const Gui::IGraphicsLibrary* g
         addValueInfo(item, obj);
     }
     if (m_settings.m_strict) {
+        for (const auto& id : spriteIds) {
+            auto sprite = graphicsLibrary->getObjectAnimation(id);
+            if (!sprite || !sprite->preload()) // waits for background decoding.
+                hasMissingSprites = true;
+        }
         if (hasMissingSprites)
             throw std::runtime_error("Some sprites are missing; make sure to convert all data from LOD files!");
 
@@ -661,6 +674,9 @@ SpriteMap MapRenderer::render(const FHMap& fhMap, const Gui::IGraphicsLibrary* g
         z++;
     }
 
+    result.compile();
+    Mernel::Logger(Mernel::Logger::Info) << "MapRenderer: " << spriteIds.size() << " sprites referenced, render took " << timer.elapsedUS() / 1000 << " ms";
+
     return result;
 }
 
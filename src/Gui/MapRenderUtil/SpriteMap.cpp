@@ -82,6 +82,98 @@ std::string SpriteMap::layerTypeToString(Layer layer)
 
 #endif
 
+void SpriteMap::compile()
+{
+    m_compiledPlanes.clear();
+    m_compiledPlanes.resize(m_planes.size());
+    for (size_t z = 0; z < m_planes.size(); ++z) {
+        const Plane&   plane    = m_planes[z];
+        CompiledPlane& compiled = m_compiledPlanes[z];
+
+        int    rowMin = 0, rowMax = -1;
+        size_t count  = 0;
+        for (const auto& [priority, grid] : plane.m_grids) {
+            if (grid.m_rowsSlices.empty())
+                continue;
+            const int gridMin = grid.m_rowsSlices.cbegin()->first;
+            const int gridMax = grid.m_rowsSlices.crbegin()->first;
+            rowMin            = rowMax < rowMin ? gridMin : std::min(rowMin, gridMin);
+            rowMax            = std::max(rowMax, gridMax);
+            for (const auto& [rowIndex, rowSlice] : grid.m_rowsSlices) {
+                for (const auto& [rowPriority, row] : rowSlice.m_rows) {
+                    for (const auto& [colIndex, cell] : row.m_cells)
+                        count += cell.m_items.size();
+                }
+            }
+        }
+        compiled.m_rowMin = rowMin;
+        compiled.m_rowMax = rowMax;
+        compiled.m_commands.reserve(count);
+        compiled.m_meta.reserve(count);
+
+        const size_t rowCount = rowMax >= rowMin ? rowMax - rowMin + 1 : 0;
+        for (const auto& [priority, grid] : plane.m_grids) {
+            CompiledPlane::PriorityBucket bucket;
+            bucket.m_priority = priority;
+            bucket.m_rowOffsets.reserve(rowCount + 1);
+
+            auto rowSliceIt = grid.m_rowsSlices.cbegin();
+            for (int y = rowMin; y <= rowMax; ++y) {
+                bucket.m_rowOffsets.push_back(static_cast<uint32_t>(compiled.m_commands.size()));
+                if (rowSliceIt == grid.m_rowsSlices.cend() || rowSliceIt->first != y)
+                    continue;
+                for (const auto& [rowPriority, row] : rowSliceIt->second.m_rows) {
+                    for (const auto& [colIndex, cell] : row.m_cells) {
+                        for (const Item& item : cell.m_items) {
+                            compiled.m_commands.push_back(DrawCommand{
+                                .m_sprite        = item.m_sprite.get(),
+                                .m_keyColor      = item.m_keyColor,
+                                .m_flagColor     = item.m_flagColor,
+                                .m_layer         = item.m_layer,
+                                .m_spriteGroup   = item.m_spriteGroup,
+                                .m_flipHor       = item.m_flipHor,
+                                .m_flipVert      = item.m_flipVert,
+                                .m_shiftHalfTile = item.m_shiftHalfTile,
+                                .m_isOverlayItem = item.m_isOverlayItem,
+                                .m_x             = item.m_x,
+                                .m_y             = item.m_y,
+                                .m_opacity       = item.m_opacity,
+                            });
+                            compiled.m_meta.push_back(ItemMeta{
+                                .m_score              = item.m_score,
+                                .m_info               = item.m_info,
+                                .m_generationId       = item.m_generationId,
+                                .m_overlayInfo        = item.m_overlayInfo,
+                                .m_overlayInfoOffsetX = item.m_overlayInfoOffsetX,
+                                .m_overlayInfoFont    = item.m_overlayInfoFont,
+                            });
+                        }
+                    }
+                }
+                ++rowSliceIt;
+            }
+            bucket.m_rowOffsets.push_back(static_cast<uint32_t>(compiled.m_commands.size()));
+            compiled.m_buckets.push_back(std::move(bucket));
+        }
+    }
+}
+
+std::vector<uint32_t> SpriteMap::CompiledPlane::findItems(int x, int y) const
+{
+    std::vector<uint32_t> result;
+    if (y < m_rowMin || y > m_rowMax)
+        return result;
+    for (const auto& bucket : m_buckets) {
+        const uint32_t begin = bucket.m_rowOffsets[y - m_rowMin];
+        const uint32_t end   = bucket.m_rowOffsets[y - m_rowMin + 1];
+        for (uint32_t i = begin; i < end; ++i) {
+            if (m_commands[i].m_x == x)
+                result.push_back(i);
+        }
+    }
+    return result;
+}
+
 bool SpriteRenderSettings::isFilteredOut(const FHPos& pos) const
 {
     if (!m_useRenderWindow)
@@ -12,6 +12,8 @@
 #include "MapRenderUtilExport.hpp"
 #include "Pixmap.hpp"
 
+#include <algorithm>
+#include <limits>
 #include <vector>
 #include <map>
 #include <string>
@@ -148,7 +150,103 @@ struct MAPRENDERUTIL_EXPORT SpriteMap {
         std::map<int, LayerGrid> m_grids; // item by draw priority
     };
 
-    std::vector<Plane> m_planes;
+    static constexpr int s_maxObjectRows = 6;
+    static constexpr int s_maxObjectCols = 8;
+
+    // inclusive tile bounds; default is unbounded.
+    struct TileWindow {
+        int m_xMin = std::numeric_limits<int>::min();
+        int m_yMin = std::numeric_limits<int>::min();
+        int m_xMax = std::numeric_limits<int>::max();
+        int m_yMax = std::numeric_limits<int>::max();
+
+        bool contains(int x, int y) const { return x >= m_xMin && x <= m_xMax && y >= m_yMin && y <= m_yMax; }
+    };
+
+    // Flat copy of Item fields painters need on every frame. Sprite is owned by the Item in m_planes.
+    struct DrawCommand {
+        const Gui::IAsyncSprite* m_sprite = nullptr;
+
+        PixmapColor m_keyColor;
+        PixmapColor m_flagColor;
+
+        Layer m_layer         = Layer::Invalid;
+        int   m_spriteGroup   = 0;
+        bool  m_flipHor       = false;
+        bool  m_flipVert      = false;
+        bool  m_shiftHalfTile = false;
+        bool  m_isOverlayItem = false;
+
+        int m_x = 0;
+        int m_y = 0;
+
+        double m_opacity = 1.0;
+    };
+    // Item fields used by filters, overlay text and inspector; same index as DrawCommand.
+    struct ItemMeta {
+        Core::MapScore m_score;
+
+        std::vector<std::pair<std::string, std::string>> m_info;
+
+        std::string m_generationId;
+        std::string m_overlayInfo;
+        int         m_overlayInfoOffsetX = -1;
+        int         m_overlayInfoFont    = 12;
+    };
+
+    // Immutable render representation of Plane: commands in the same order as m_grids traversal
+    // (priority, row, row priority, column, insertion); inside every priority commands are bucketed by row,
+    // so visible row range is found without walking the tree.
+    struct CompiledPlane {
+        struct PriorityBucket {
+            int                   m_priority = 0;
+            std::vector<uint32_t> m_rowOffsets; // m_rowOffsets[y - m_rowMin] .. m_rowOffsets[y - m_rowMin + 1] are commands of row y
+        };
+
+        std::vector<DrawCommand>    m_commands;
+        std::vector<ItemMeta>       m_meta;
+        std::vector<PriorityBucket> m_buckets; // ascending priority
+        int                         m_rowMin = 0;
+        int                         m_rowMax = -1;
+
+        // calls callback(const DrawCommand&, const ItemMeta&) in draw order for priority in [priorityMin, priorityMax] and row in [rowMin, rowMax].
+        void forEach(int priorityMin, int priorityMax, int rowMin, int rowMax, auto&& callback) const
+        {
+            rowMin = std::max(rowMin, m_rowMin);
+            rowMax = std::min(rowMax, m_rowMax);
+            if (rowMin > rowMax)
+                return;
+            for (const auto& bucket : m_buckets) {
+                if (bucket.m_priority < priorityMin)
+                    continue;
+                if (bucket.m_priority > priorityMax)
+                    break;
+                const uint32_t begin = bucket.m_rowOffsets[rowMin - m_rowMin];
+                const uint32_t end   = bucket.m_rowOffsets[rowMax - m_rowMin + 1];
+                for (uint32_t i = begin; i < end; ++i)
+                    callback(m_commands[i], m_meta[i]);
+            }
+        }
+
+        // same as forEach, but takes tiles visible on screen: objects are anchored at bottom-right tile and may cover
+        // s_maxObjectRows/s_maxObjectCols tiles above and left of anchor, and shifted items cover half of the next row.
+        void forEachVisible(int priorityMin, int priorityMax, const TileWindow& window, auto&& callback) const
+        {
+            const int rowMin = static_cast<int>(std::max<int64_t>(int64_t(window.m_yMin) - 1, m_rowMin));
+            const int rowMax = static_cast<int>(std::min<int64_t>(int64_t(window.m_yMax) + s_maxObjectRows, m_rowMax));
+            const int colMin = window.m_xMin;
+            const int colMax = static_cast<int>(std::min<int64_t>(int64_t(window.m_xMax) + s_maxObjectCols, std::numeric_limits<int>::max()));
+            forEach(priorityMin, priorityMax, rowMin, rowMax, [colMin, colMax, &callback](const DrawCommand& command, const ItemMeta& meta) {
+                if (command.m_x >= colMin && command.m_x <= colMax)
+                    callback(command, meta);
+            });
+        }
+
+        std::vector<uint32_t> findItems(int x, int y) const;
+    };
+
+    std::vector<Plane>         m_planes;
+    std::vector<CompiledPlane> m_compiledPlanes; // filled by compile()
 
     int m_width  = 0;
     int m_height = 0;
@@ -178,13 +276,13 @@ struct MAPRENDERUTIL_EXPORT SpriteMap {
             return {};
 
         for (const auto& [priority, grid] : m_planes[z].m_grids) {
-            if (!grid.m_rowsSlices.contains(y))
+            auto rowSliceIt = grid.m_rowsSlices.find(y);
+            if (rowSliceIt == grid.m_rowsSlices.cend())
                 continue;
-            const auto& rowSlice = grid.m_rowsSlices.at(y);
-            for (const auto& [rowPriorty, row] : rowSlice.m_rows) {
-                if (!row.m_cells.contains(x))
-                    continue;
-                res.push_back(&row.m_cells.at(x));
+            for (const auto& [rowPriorty, row] : rowSliceIt->second.m_rows) {
+                auto cellIt = row.m_cells.find(x);
+                if (cellIt != row.m_cells.cend())
+                    res.push_back(&cellIt->second);
             }
         }
         return res;
@@ -197,6 +295,9 @@ struct MAPRENDERUTIL_EXPORT SpriteMap {
         return &cell.m_items.back();
     }
 
+    // builds m_compiledPlanes from m_planes; call after all items are added.
+    void compile();
+
     static std::string layerTypeToString(Layer layer);
 };
 
@@ -14,6 +14,9 @@
 #include <QDebug>
 #include <QPainterPath>
 
+#include <algorithm>
+#include <limits>
+
 namespace FreeHeroes {
 
 struct SpriteMapPainter::Impl {
@@ -38,9 +41,10 @@ struct SpriteMapPainter::Impl {
     }
 };
 
-SpriteMapPainter::SpriteMapPainter(const SpritePaintSettings* settings, int depth)
+SpriteMapPainter::SpriteMapPainter(const SpritePaintSettings* settings, int depth, bool waitForSprites)
     : m_settings(settings)
     , m_depth(depth)
+    , m_waitForSprites(waitForSprites)
     , m_impl(std::make_unique<Impl>())
 {}
 
@@ -48,15 +52,16 @@ SpriteMapPainter::~SpriteMapPainter()
 {
 }
 
-void SpriteMapPainter::paint(QPainter*        painter,
-                             const SpriteMap* spriteMap,
-                             uint32_t         animationFrameOffsetTerrain,
-                             uint32_t         animationFrameOffsetObjects) const
+void SpriteMapPainter::paint(QPainter*                    painter,
+                             const SpriteMap*             spriteMap,
+                             uint32_t                     animationFrameOffsetTerrain,
+                             uint32_t                     animationFrameOffsetObjects,
+                             const SpriteMap::TileWindow& window) const
 {
     painter->setRenderHint(QPainter::SmoothPixmapTransform, m_settings->getEffectiveScale() < 100);
     const int tileSize = m_settings->m_tileSize;
 
-    auto drawOverlayText = [painter, tileSize, this](const SpriteMap::Item& item, int x, const QTransform& posTransform) {
+    auto drawOverlayText = [painter, tileSize, this](const SpriteMap::ItemMeta& item, int x, const QTransform& posTransform) {
         painter->setPen(Qt::white);
         QFont font = painter->font();
         font.setPixelSize(item.m_overlayInfoFont);
@@ -110,105 +115,110 @@ void SpriteMapPainter::paint(QPainter*        painter,
         painter->drawRect(16, 9, 3, 7);
     };
 
-    auto drawCell = [painter, tileSize, animationFrameOffsetTerrain, animationFrameOffsetObjects, &drawOverlayText, &drawHeroFlag, this](const SpriteMap::Cell& cell, int x, int y, bool isOverlayPass) {
-        for (const auto& item : cell.m_items) {
-            if (item.m_isOverlayItem && !m_settings->m_overlay)
-                continue;
+    auto drawItem = [painter, tileSize, animationFrameOffsetTerrain, animationFrameOffsetObjects, &drawOverlayText, &drawHeroFlag, this](const SpriteMap::DrawCommand& item, const SpriteMap::ItemMeta& meta, bool isOverlayPass) {
+        const int x = item.m_x;
+        const int y = item.m_y;
 
-            if (item.m_flagColor.isValid()) {
-                auto oldTransform = painter->transform();
-                painter->translate(x * tileSize, y * tileSize);
-                drawHeroFlag(item.m_flagColor.toQColor());
-                painter->setTransform(oldTransform);
-                continue;
-            }
+        if (item.m_isOverlayItem && !m_settings->m_overlay)
+            return;
 
-            if (!item.m_sprite)
-                continue;
-            auto sprite = item.m_sprite->get();
-            if (!sprite)
-                continue;
-            Gui::ISprite::SpriteSequencePtr seq = sprite->getFramesForGroup(item.m_spriteGroup);
-            if (!seq)
-                continue;
-            auto containsAnyScore = [](const std::set<Core::ScoreAttr>& filter, const Core::MapScore& score) {
-                for (auto& [key, val] : score)
-                    if (filter.contains(key))
-                        return true;
-                return false;
-            };
-            const bool isFilteredOut = (!m_settings->m_filterLayer.empty() && !m_settings->m_filterLayer.contains(item.m_layer))
-                                       || (!m_settings->m_filterGenerationId.empty() && item.m_generationId != m_settings->m_filterGenerationId)
-                                       || (!m_settings->m_filterAttr.empty() && !containsAnyScore(m_settings->m_filterAttr, item.m_score));
-            if (isFilteredOut && isOverlayPass) {
-                continue;
-            }
+        if (item.m_flagColor.isValid()) {
+            auto oldTransform = painter->transform();
+            painter->translate(x * tileSize, y * tileSize);
+            drawHeroFlag(item.m_flagColor.toQColor());
+            painter->setTransform(oldTransform);
+            return;
+        }
 
-            const auto psrHash = item.m_x * 7U + item.m_y * 13U;
+        if (!item.m_sprite)
+            return;
+        if (!m_waitForSprites && !item.m_sprite->isReady()) {
+            item.m_sprite->preloadAsync(Gui::AsyncLoadPriority::High); // window is visible, go before prefetch.
+            return;
+        }
+        auto sprite = item.m_sprite->get();
+        if (!sprite)
+            return;
+        Gui::ISprite::SpriteSequencePtr seq = sprite->getFramesForGroup(item.m_spriteGroup);
+        if (!seq)
+            return;
+        auto containsAnyScore = [](const std::set<Core::ScoreAttr>& filter, const Core::MapScore& score) {
+            for (auto& [key, val] : score)
+                if (filter.contains(key))
+                    return true;
+            return false;
+        };
+        const bool isFilteredOut = (!m_settings->m_filterLayer.empty() && !m_settings->m_filterLayer.contains(item.m_layer))
+                                   || (!m_settings->m_filterGenerationId.empty() && meta.m_generationId != m_settings->m_filterGenerationId)
+                                   || (!m_settings->m_filterAttr.empty() && !containsAnyScore(m_settings->m_filterAttr, meta.m_score));
+        if (isFilteredOut && isOverlayPass) {
+            return;
+        }
 
-            const size_t frameIndex = psrHash + (item.m_layer == SpriteMap::Layer::Terrain ? animationFrameOffsetTerrain : animationFrameOffsetObjects);
-            const auto   frame      = seq->m_frames[frameIndex % seq->m_frames.size()];
+        const auto psrHash = item.m_x * 7U + item.m_y * 13U;
 
-            const QSize boundingSize = seq->m_boundarySize.toQSize();
+        const size_t frameIndex = psrHash + (item.m_layer == SpriteMap::Layer::Terrain ? animationFrameOffsetTerrain : animationFrameOffsetObjects);
+        const auto   frame      = seq->m_frames[frameIndex % seq->m_frames.size()];
 
-            auto oldTransform = painter->transform();
-            painter->translate(x * tileSize, y * tileSize);
+        const QSize boundingSize = seq->m_boundarySize.toQSize();
 
-            auto posTransform = painter->transform();
+        auto oldTransform = painter->transform();
+        painter->translate(x * tileSize, y * tileSize);
 
-            if (item.m_shiftHalfTile) {
-                painter->translate(0, tileSize / 2);
-            }
+        auto posTransform = painter->transform();
 
-            // @todo:
-            //painter->translate(frame.paddingLeftTop.x(), frame.paddingLeftTop.y());
-            painter->scale(item.m_flipHor ? -1 : 1, item.m_flipVert ? -1 : 1);
+        if (item.m_shiftHalfTile) {
+            painter->translate(0, tileSize / 2);
+        }
 
-            if (item.m_flipHor) {
-                painter->translate(-boundingSize.width(), 0);
-            }
-            if (item.m_flipVert) {
-                painter->translate(0, -boundingSize.height());
-            }
-            if (boundingSize.width() > tileSize || boundingSize.height() > tileSize) {
-                painter->translate(-boundingSize.width() + tileSize, -boundingSize.height() + tileSize);
-            }
+        // @todo:
+        //painter->translate(frame.paddingLeftTop.x(), frame.paddingLeftTop.y());
+        painter->scale(item.m_flipHor ? -1 : 1, item.m_flipVert ? -1 : 1);
 
-            double opacity = item.m_opacity;
-            if (isFilteredOut) {
-                if (item.m_layer == SpriteMap::Layer::Terrain)
-                    opacity = 1.0;
-                else if (item.m_opacity != 1.0) {
-                    opacity = 0.0;
-                } else {
-                    opacity = 0.25;
-                }
+        if (item.m_flipHor) {
+            painter->translate(-boundingSize.width(), 0);
+        }
+        if (item.m_flipVert) {
+            painter->translate(0, -boundingSize.height());
+        }
+        if (boundingSize.width() > tileSize || boundingSize.height() > tileSize) {
+            painter->translate(-boundingSize.width() + tileSize, -boundingSize.height() + tileSize);
+        }
+
+        double opacity = item.m_opacity;
+        if (isFilteredOut) {
+            if (item.m_layer == SpriteMap::Layer::Terrain)
+                opacity = 1.0;
+            else if (item.m_opacity != 1.0) {
+                opacity = 0.0;
+            } else {
+                opacity = 0.25;
             }
-            painter->setOpacity(opacity);
-
-            if (!isOverlayPass)
-                painter->drawPixmap(frame.m_paddingLeftTop.toQPoint(), frame.m_frame.toQtPixmap());
-            painter->setOpacity(1.0);
-            if (!isOverlayPass && item.m_keyColor.isValid()) {
-                QPixmap pix     = frame.m_frame.toQtPixmap();
-                QImage  imgOrig = pix.toImage();
-                pix.fill(Qt::transparent);
-                QImage img = pix.toImage();
-
-                for (int imgy = 0; imgy < img.height(); imgy++) {
-                    for (int imgx = 0; imgx < img.width(); imgx++) {
-                        if (imgOrig.pixelColor(imgx, imgy).alpha() == 1)
-                            img.setPixelColor(imgx, imgy, item.m_keyColor.toQColor());
-                    }
+        }
+        painter->setOpacity(opacity);
+
+        if (!isOverlayPass)
+            painter->drawPixmap(frame.m_paddingLeftTop.toQPoint(), frame.m_frame.toQtPixmap());
+        painter->setOpacity(1.0);
+        if (!isOverlayPass && item.m_keyColor.isValid()) {
+            QPixmap pix     = frame.m_frame.toQtPixmap();
+            QImage  imgOrig = pix.toImage();
+            pix.fill(Qt::transparent);
+            QImage img = pix.toImage();
+
+            for (int imgy = 0; imgy < img.height(); imgy++) {
+                for (int imgx = 0; imgx < img.width(); imgx++) {
+                    if (imgOrig.pixelColor(imgx, imgy).alpha() == 1)
+                        img.setPixelColor(imgx, imgy, item.m_keyColor.toQColor());
                 }
-                pix = QPixmap::fromImage(img);
-                painter->drawPixmap(frame.m_paddingLeftTop.toQPoint(), pix);
             }
-            if (isOverlayPass && !item.m_overlayInfo.empty())
-                drawOverlayText(item, x, posTransform);
-
-            painter->setTransform(oldTransform);
+            pix = QPixmap::fromImage(img);
+            painter->drawPixmap(frame.m_paddingLeftTop.toQPoint(), pix);
         }
+        if (isOverlayPass && !meta.m_overlayInfo.empty())
+            drawOverlayText(meta, x, posTransform);
+
+        painter->setTransform(oldTransform);
     };
 
     auto drawGrid = [painter, spriteMap, tileSize](QColor color, int alpha) {
@@ -227,17 +237,10 @@ void SpriteMapPainter::paint(QPainter*        painter,
 
     // low level (terrains/roads) paint
 
-    for (const auto& [priority, grid] : spriteMap->m_planes[m_depth].m_grids) {
-        if (priority >= 0)
-            break;
-        for (const auto& [rowIndex, rowSlice] : grid.m_rowsSlices) {
-            for (const auto& [rowPriority, row] : rowSlice.m_rows) {
-                for (const auto& [colIndex, cell] : row.m_cells) {
-                    drawCell(cell, colIndex, rowIndex, false);
-                }
-            }
-        }
-    }
+    const auto& plane = spriteMap->m_compiledPlanes[m_depth];
+    plane.forEachVisible(std::numeric_limits<int>::min(), -1, window, [&drawItem](const SpriteMap::DrawCommand& item, const SpriteMap::ItemMeta& meta) {
+        drawItem(item, meta, false);
+    });
 
     // middle-layer paint
     if (m_settings->m_grid && !m_settings->m_gridOnTop) {
@@ -245,37 +248,23 @@ void SpriteMapPainter::paint(QPainter*        painter,
     }
 
     // top-level (objects) paint
-    for (const auto& [priority, grid] : spriteMap->m_planes[m_depth].m_grids) {
-        if (priority < 0)
-            continue;
-        for (const auto& [rowIndex, rowSlice] : grid.m_rowsSlices) {
-            for (const auto& [rowPriority, row] : rowSlice.m_rows) {
-                for (const auto& [colIndex, cell] : row.m_cells) {
-                    drawCell(cell, colIndex, rowIndex, false);
-                }
-            }
-        }
-    }
+    plane.forEachVisible(0, std::numeric_limits<int>::max(), window, [&drawItem](const SpriteMap::DrawCommand& item, const SpriteMap::ItemMeta& meta) {
+        drawItem(item, meta, false);
+    });
 
     // item text overlay
     if (m_settings->m_overlay) {
-        for (const auto& [priority, grid] : spriteMap->m_planes[m_depth].m_grids) {
-            if (priority < 0)
-                continue;
-            for (const auto& [rowIndex, rowSlice] : grid.m_rowsSlices) {
-                for (const auto& [rowPriority, row] : rowSlice.m_rows) {
-                    for (const auto& [colIndex, cell] : row.m_cells) {
-                        drawCell(cell, colIndex, rowIndex, true);
-                    }
-                }
-            }
-        }
+        plane.forEachVisible(0, std::numeric_limits<int>::max(), window, [&drawItem](const SpriteMap::DrawCommand& item, const SpriteMap::ItemMeta& meta) {
+            drawItem(item, meta, true);
+        });
     }
 
     // block mask
     if (m_settings->m_blockMask) {
         for (const auto& [y, row] : spriteMap->m_planes[m_depth].m_merged.m_rows) {
             for (const auto& [x, cell] : row.m_cells) {
+                if (!window.contains(x, y))
+                    continue;
                 auto oldTransform = painter->transform();
                 painter->translate(x * tileSize, y * tileSize);
 
@@ -296,6 +285,8 @@ void SpriteMapPainter::paint(QPainter*        painter,
     // debug paint
     for (const auto& [y, row] : spriteMap->m_planes[m_depth].m_merged.m_rows) {
         for (const auto& [x, cell] : row.m_cells) {
+            if (!window.contains(x, y))
+                continue;
             for (const auto& debugPiece : cell.m_debug) {
                 auto oldTransform = painter->transform();
                 painter->translate(x * tileSize, y * tileSize);
@@ -334,6 +325,36 @@ void SpriteMapPainter::paint(QPainter*        painter,
     }
 }
 
+SpriteMapPainter::AnimationInfo SpriteMapPainter::getAnimationInfo(const SpriteMap* spriteMap, const SpriteMap::TileWindow& window) const
+{
+    AnimationInfo result;
+    const auto&   plane = spriteMap->m_compiledPlanes[m_depth];
+    plane.forEachVisible(std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), window, [&result, this](const SpriteMap::DrawCommand& item, const SpriteMap::ItemMeta&) {
+        if (!item.m_sprite || item.m_flagColor.isValid())
+            return;
+        if (item.m_isOverlayItem && !m_settings->m_overlay)
+            return;
+        if (!m_waitForSprites && !item.m_sprite->isReady()) {
+            item.m_sprite->preloadAsync(Gui::AsyncLoadPriority::High);
+            result.m_pending.push_back(item.m_sprite);
+            return;
+        }
+        auto sprite = item.m_sprite->get();
+        if (!sprite) // missing sprite is never painted, nothing to wait for.
+            return;
+        const bool isTerrain = item.m_layer == SpriteMap::Layer::Terrain;
+        if (isTerrain ? (!m_settings->m_animateTerrain || result.m_terrain) : (!m_settings->m_animateObjects || result.m_objects))
+            return;
+        Gui::ISprite::SpriteSequencePtr seq = sprite->getFramesForGroup(item.m_spriteGroup);
+        if (!seq || seq->m_frames.size() <= 1)
+            return;
+        (isTerrain ? result.m_terrain : result.m_objects) = true;
+    });
+    std::sort(result.m_pending.begin(), result.m_pending.end());
+    result.m_pending.erase(std::unique(result.m_pending.begin(), result.m_pending.end()), result.m_pending.end());
+    return result;
+}
+
 void SpriteMapPainter::paintMinimap(QPainter*        painter,
                                     const SpriteMap* spriteMap,
                                     QSize            minimapSize,
@@ -17,13 +17,26 @@ namespace FreeHeroes {
 
 class MAPRENDERUTIL_EXPORT SpriteMapPainter {
 public:
-    SpriteMapPainter(const SpritePaintSettings* settings, int depth);
+    // waitForSprites = false: sprites which are not decoded yet are skipped and queued for loading with High priority,
+    // getAnimationInfo() reports them so caller can repaint on IAsyncSprite::onReady().
+    SpriteMapPainter(const SpritePaintSettings* settings, int depth, bool waitForSprites = true);
     ~SpriteMapPainter();
 
-    void paint(QPainter*        painter,
-               const SpriteMap* spriteMap,
-               uint32_t         animationFrameOffsetTerrain,
-               uint32_t         animationFrameOffsetObjects) const;
+    // window - visible tiles; items partially visible from outside of it are drawn too.
+    void paint(QPainter*                    painter,
+               const SpriteMap*             spriteMap,
+               uint32_t                     animationFrameOffsetTerrain,
+               uint32_t                     animationFrameOffsetObjects,
+               const SpriteMap::TileWindow& window = {}) const;
+
+    struct AnimationInfo {
+        bool m_terrain = false; // has multi-frame terrain sprites and terrain animation is on
+        bool m_objects = false; // same for objects
+
+        std::vector<const Gui::IAsyncSprite*> m_pending; // sprites not ready yet, unique; always empty when waiting for sprites
+    };
+    // describes items which paint() would draw for the window.
+    AnimationInfo getAnimationInfo(const SpriteMap* spriteMap, const SpriteMap::TileWindow& window) const;
 
     void paintMinimap(QPainter*        painter,
                       const SpriteMap* spriteMap,
@@ -33,6 +46,7 @@ public:
 private:
     const SpritePaintSettings* m_settings;
     const int                  m_depth;
+    const bool                 m_waitForSprites;
 
     struct Impl;
     std::unique_ptr<Impl> m_impl;
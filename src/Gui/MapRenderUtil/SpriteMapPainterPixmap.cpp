@@ -9,6 +9,8 @@
 #include "SpriteMap.hpp"
 #include "Painter.hpp"
 
+#include <limits>
+
 namespace FreeHeroes {
 
 struct SpriteMapPainterPixmap::Impl {
@@ -24,10 +26,11 @@ SpriteMapPainterPixmap::~SpriteMapPainterPixmap()
 {
 }
 
-void SpriteMapPainterPixmap::paint(Painter*         painter,
-                                   const SpriteMap* spriteMap,
-                                   uint32_t         animationFrameOffsetTerrain,
-                                   uint32_t         animationFrameOffsetObjects) const
+void SpriteMapPainterPixmap::paint(Painter*                     painter,
+                                   const SpriteMap*             spriteMap,
+                                   uint32_t                     animationFrameOffsetTerrain,
+                                   uint32_t                     animationFrameOffsetObjects,
+                                   const SpriteMap::TileWindow& window) const
 {
     const int tileSize = m_settings->m_tileSize;
 
@@ -45,90 +48,84 @@ void SpriteMapPainterPixmap::paint(Painter*         painter,
         painter->drawRect(PixmapPoint(4, 16), PixmapSize(4, 1), PixmapColor(0, 0, 0, 30));
     };
 
-    auto drawCell = [painter, tileSize, animationFrameOffsetTerrain, animationFrameOffsetObjects, &drawHeroFlag, this](const SpriteMap::Cell& cell, int x, int y) {
-        for (const auto& item : cell.m_items) {
-            if (item.m_isOverlayItem && !m_settings->m_overlay)
-                continue;
-
-            if (item.m_flagColor.isValid()) {
-                auto oldTransform = painter->getTransform();
-                painter->translate(x * tileSize, y * tileSize);
-                drawHeroFlag(item.m_flagColor);
-                painter->setTransform(oldTransform);
-                continue;
-            }
+    auto drawItem = [painter, tileSize, animationFrameOffsetTerrain, animationFrameOffsetObjects, &drawHeroFlag, this](const SpriteMap::DrawCommand& item, const SpriteMap::ItemMeta& meta) {
+        const int x = item.m_x;
+        const int y = item.m_y;
 
-            if (!item.m_sprite)
-                continue;
-            auto sprite = item.m_sprite->get();
-            if (!sprite)
-                continue;
-            Gui::ISprite::SpriteSequencePtr seq = sprite->getFramesForGroup(item.m_spriteGroup);
-            if (!seq)
-                continue;
-            auto containsAnyScore = [](const std::set<Core::ScoreAttr>& filter, const Core::MapScore& score) {
-                for (auto& [key, val] : score)
-                    if (filter.contains(key))
-                        return true;
-                return false;
-            };
-            const bool isFilteredOut = (!m_settings->m_filterLayer.empty() && !m_settings->m_filterLayer.contains(item.m_layer))
-                                       || (!m_settings->m_filterGenerationId.empty() && item.m_generationId != m_settings->m_filterGenerationId)
-                                       || (!m_settings->m_filterAttr.empty() && !containsAnyScore(m_settings->m_filterAttr, item.m_score));
-            if (isFilteredOut) {
-                continue;
-            }
+        if (item.m_isOverlayItem && !m_settings->m_overlay)
+            return;
 
-            const auto psrHash = item.m_x * 7U + item.m_y * 13U;
+        if (item.m_flagColor.isValid()) {
+            auto oldTransform = painter->getTransform();
+            painter->translate(x * tileSize, y * tileSize);
+            drawHeroFlag(item.m_flagColor);
+            painter->setTransform(oldTransform);
+            return;
+        }
 
-            const size_t frameIndex = psrHash + (item.m_layer == SpriteMap::Layer::Terrain ? animationFrameOffsetTerrain : animationFrameOffsetObjects);
-            const auto   frame      = seq->m_frames[frameIndex % seq->m_frames.size()];
+        if (!item.m_sprite)
+            return;
+        auto sprite = item.m_sprite->get();
+        if (!sprite)
+            return;
+        Gui::ISprite::SpriteSequencePtr seq = sprite->getFramesForGroup(item.m_spriteGroup);
+        if (!seq)
+            return;
+        auto containsAnyScore = [](const std::set<Core::ScoreAttr>& filter, const Core::MapScore& score) {
+            for (auto& [key, val] : score)
+                if (filter.contains(key))
+                    return true;
+            return false;
+        };
+        const bool isFilteredOut = (!m_settings->m_filterLayer.empty() && !m_settings->m_filterLayer.contains(item.m_layer))
+                                   || (!m_settings->m_filterGenerationId.empty() && meta.m_generationId != m_settings->m_filterGenerationId)
+                                   || (!m_settings->m_filterAttr.empty() && !containsAnyScore(m_settings->m_filterAttr, meta.m_score));
+        if (isFilteredOut) {
+            return;
+        }
 
-            const auto boundingSize = seq->m_boundarySize;
+        const auto psrHash = item.m_x * 7U + item.m_y * 13U;
 
-            auto oldTransform = painter->getTransform();
-            painter->translate(x * tileSize, y * tileSize);
+        const size_t frameIndex = psrHash + (item.m_layer == SpriteMap::Layer::Terrain ? animationFrameOffsetTerrain : animationFrameOffsetObjects);
+        const auto   frame      = seq->m_frames[frameIndex % seq->m_frames.size()];
 
-            if (item.m_shiftHalfTile) {
-                painter->translate(0, tileSize / 2);
-            }
-            if (item.m_flipHor) {
-                painter->translate(+boundingSize.m_width, 0);
-            }
-            if (item.m_flipVert) {
-                painter->translate(0, +boundingSize.m_height);
-            }
+        const auto boundingSize = seq->m_boundarySize;
 
-            if (boundingSize.m_width > tileSize || boundingSize.m_height > tileSize) {
-                painter->translate(-boundingSize.m_width + tileSize, -boundingSize.m_height + tileSize);
-            }
+        auto oldTransform = painter->getTransform();
+        painter->translate(x * tileSize, y * tileSize);
 
-            Pixmap        pixCopy;
-            const Pixmap* pxPtr = &frame.m_frame;
-            if (item.m_keyColor.isValid()) {
-                pixCopy = frame.m_frame;
-                pxPtr   = &pixCopy;
-                for (auto& p : pixCopy.m_pixels) {
-                    if (p.m_color.m_a == 1) {
-                        p.m_color = item.m_keyColor;
-                    }
-                }
-            }
-            painter->drawPixmap(frame.m_paddingLeftTop, *pxPtr, item.m_flipHor, item.m_flipVert);
+        if (item.m_shiftHalfTile) {
+            painter->translate(0, tileSize / 2);
+        }
+        if (item.m_flipHor) {
+            painter->translate(+boundingSize.m_width, 0);
+        }
+        if (item.m_flipVert) {
+            painter->translate(0, +boundingSize.m_height);
+        }
 
-            painter->setTransform(oldTransform);
+        if (boundingSize.m_width > tileSize || boundingSize.m_height > tileSize) {
+            painter->translate(-boundingSize.m_width + tileSize, -boundingSize.m_height + tileSize);
         }
-    };
 
-    for (const auto& [priority, grid] : spriteMap->m_planes[m_depth].m_grids) {
-        for (const auto& [rowIndex, rowSlice] : grid.m_rowsSlices) {
-            for (const auto& [rowPriority, row] : rowSlice.m_rows) {
-                for (const auto& [colIndex, cell] : row.m_cells) {
-                    drawCell(cell, colIndex, rowIndex);
+        Pixmap     pixCopy;
+        PixmapView pixView = frame.m_frame;
+        if (item.m_keyColor.isValid()) {
+            pixCopy = frame.m_frame.toPixmap();
+            for (auto& p : pixCopy.m_pixels) {
+                if (p.m_color.m_a == 1) {
+                    p.m_color = item.m_keyColor;
                 }
             }
+            pixView = pixCopy.view();
         }
-    }
+        painter->drawPixmap(frame.m_paddingLeftTop, pixView, item.m_flipHor, item.m_flipVert);
+
+        painter->setTransform(oldTransform);
+    };
+
+    const auto& plane = spriteMap->m_compiledPlanes[m_depth];
+    plane.forEachVisible(std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), window, drawItem);
 }
 
 }
@@ -16,10 +16,12 @@ public:
     SpriteMapPainterPixmap(const SpritePaintSettings* settings, int depth);
     ~SpriteMapPainterPixmap();
 
-    void paint(Painter*         painter,
-               const SpriteMap* spriteMap,
-               uint32_t         animationFrameOffsetTerrain,
-               uint32_t         animationFrameOffsetObjects) const;
+    // window - visible tiles; items partially visible from outside of it are drawn too.
+    void paint(Painter*                     painter,
+               const SpriteMap*             spriteMap,
+               uint32_t                     animationFrameOffsetTerrain,
+               uint32_t                     animationFrameOffsetObjects,
+               const SpriteMap::TileWindow& window = {}) const;
 
 private:
     const SpritePaintSettings* m_settings;
@@ -488,7 +488,7 @@ void MapEditorWidget::showCurrentItem()
 void MapEditorWidget::updateAll()
 {
     for (auto* s : m_impl->m_mapSprites)
-        s->update();
+        s->invalidateCache();
     m_impl->m_minimapWidget->update();
 }
 }
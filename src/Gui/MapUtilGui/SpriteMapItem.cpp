@@ -9,7 +9,13 @@
 
 #include "SpriteMapPainter.hpp"
 
+#include <QCoreApplication>
 #include <QDebug>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+
+#include <algorithm>
+#include <cmath>
 
 namespace FreeHeroes {
 
@@ -18,12 +24,19 @@ SpriteMapItem::SpriteMapItem(const SpriteMap* spriteMap, const SpritePaintSettin
     , m_spritePaintSettings(spritePaintSettings)
     , m_currentDepth(depth)
     , m_animationFrameDurationMs(animationFrameDurationMs)
-    , m_painter(std::make_unique<SpriteMapPainter>(m_spritePaintSettings, m_currentDepth))
+    , m_painter(std::make_unique<SpriteMapPainter>(m_spritePaintSettings, m_currentDepth, false))
+    , m_readyGuard(std::make_shared<ReadyGuard>(ReadyGuard{ .m_item = this }))
 {
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption); // for exposedRect
+
+    m_chunkCols = (m_spriteMap->m_width + s_chunkTiles - 1) / s_chunkTiles;
+    m_chunkRows = (m_spriteMap->m_height + s_chunkTiles - 1) / s_chunkTiles;
+    m_chunks.resize(m_chunkCols * m_chunkRows);
 }
 
 SpriteMapItem::~SpriteMapItem()
 {
+    m_readyGuard->m_item = nullptr;
 }
 
 void SpriteMapItem::tick(uint32_t msecElapsed)
@@ -38,22 +51,118 @@ void SpriteMapItem::tick(uint32_t msecElapsed)
     if (!m_spritePaintSettings->m_animateTerrain && !m_spritePaintSettings->m_animateObjects)
         return;
 
-    if (m_spritePaintSettings->m_animateTerrain)
+    const bool animateTerrain = m_spritePaintSettings->m_animateTerrain;
+    const bool animateObjects = m_spritePaintSettings->m_animateObjects;
+    if (animateTerrain)
         m_animationFrameOffsetTerrain += frameTick;
-    if (m_spritePaintSettings->m_animateObjects)
+    if (animateObjects)
         m_animationFrameOffsetObjects += frameTick;
 
+    for (int chunkY = 0; chunkY < m_chunkRows; ++chunkY) {
+        for (int chunkX = 0; chunkX < m_chunkCols; ++chunkX) {
+            // invalid chunks are rendered when exposed, animation alone does not need to repaint them.
+            const Chunk& chunk = m_chunks[chunkY * m_chunkCols + chunkX];
+            if (chunk.m_valid && ((animateTerrain && chunk.m_animatedTerrain) || (animateObjects && chunk.m_animatedObjects)))
+                update(chunkRect(chunkX, chunkY));
+        }
+    }
+}
+
+void SpriteMapItem::invalidateCache()
+{
+    for (Chunk& chunk : m_chunks)
+        chunk.m_valid = false;
     update();
 }
 
+QRectF SpriteMapItem::chunkRect(int chunkX, int chunkY) const
+{
+    const int chunkSize = s_chunkTiles * m_spritePaintSettings->m_tileSize;
+    return QRectF(chunkX * chunkSize, chunkY * chunkSize, chunkSize, chunkSize);
+}
+
+void SpriteMapItem::renderChunk(Chunk& chunk, int chunkX, int chunkY)
+{
+    const int                   tileSize  = m_spritePaintSettings->m_tileSize;
+    const int                   chunkSize = s_chunkTiles * tileSize;
+    const SpriteMap::TileWindow window{
+        .m_xMin = chunkX * s_chunkTiles,
+        .m_yMin = chunkY * s_chunkTiles,
+        .m_xMax = chunkX * s_chunkTiles + s_chunkTiles - 1,
+        .m_yMax = chunkY * s_chunkTiles + s_chunkTiles - 1,
+    };
+    const auto info = m_painter->getAnimationInfo(m_spriteMap, window);
+
+    if (chunk.m_pixmap.isNull())
+        chunk.m_pixmap = QPixmap(chunkSize, chunkSize);
+    chunk.m_pixmap.fill(Qt::transparent);
+    {
+        QPainter chunkPainter(&chunk.m_pixmap);
+        chunkPainter.translate(-window.m_xMin * tileSize, -window.m_yMin * tileSize);
+        m_painter->paint(&chunkPainter, m_spriteMap, m_animationFrameOffsetTerrain, m_animationFrameOffsetObjects, window);
+    }
+
+    // sprites which were not ready are skipped; chunk is repainted when each of them is loaded.
+    // Pending sprites are a subset of ones from the first render, so callbacks are registered only once.
+    if (!info.m_pending.empty() && !chunk.m_waitingSprites) {
+        chunk.m_waitingSprites = static_cast<int>(info.m_pending.size());
+        const int chunkIndex   = chunkY * m_chunkCols + chunkX;
+        for (const Gui::IAsyncSprite* sprite : info.m_pending) {
+            sprite->onReady([guard = m_readyGuard, chunkIndex](bool) {
+                QMetaObject::invokeMethod(
+                    QCoreApplication::instance(), [guard, chunkIndex] {
+                        if (guard->m_item)
+                            guard->m_item->onSpriteReady(chunkIndex);
+                    },
+                    Qt::QueuedConnection);
+            });
+        }
+    }
+
+    chunk.m_valid           = true;
+    chunk.m_animatedTerrain = info.m_terrain;
+    chunk.m_animatedObjects = info.m_objects;
+    chunk.m_frameTerrain    = m_animationFrameOffsetTerrain;
+    chunk.m_frameObjects    = m_animationFrameOffsetObjects;
+}
+
+void SpriteMapItem::onSpriteReady(int chunkIndex)
+{
+    Chunk& chunk = m_chunks[chunkIndex];
+    chunk.m_waitingSprites--;
+    chunk.m_valid = false;
+    update(chunkRect(chunkIndex % m_chunkCols, chunkIndex / m_chunkCols));
+}
+
 QRectF SpriteMapItem::boundingRect() const
 {
     return QRectF{ QPointF{ 0., 0. }, QSizeF(m_spriteMap->m_width, m_spriteMap->m_height) * m_spritePaintSettings->m_tileSize };
 }
 
-void SpriteMapItem::paint(QPainter* painter, const QStyleOptionGraphicsItem*, QWidget*)
+void SpriteMapItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget*)
 {
-    m_painter->paint(painter, m_spriteMap, m_animationFrameOffsetTerrain, m_animationFrameOffsetObjects);
+    const QRectF exposed = option->exposedRect.intersected(boundingRect());
+    if (exposed.isEmpty() || m_chunks.empty())
+        return;
+
+    const int chunkSize = s_chunkTiles * m_spritePaintSettings->m_tileSize;
+    const int chunkXMin = std::clamp(static_cast<int>(std::floor(exposed.left() / chunkSize)), 0, m_chunkCols - 1);
+    const int chunkXMax = std::clamp(static_cast<int>(std::floor(exposed.right() / chunkSize)), 0, m_chunkCols - 1);
+    const int chunkYMin = std::clamp(static_cast<int>(std::floor(exposed.top() / chunkSize)), 0, m_chunkRows - 1);
+    const int chunkYMax = std::clamp(static_cast<int>(std::floor(exposed.bottom() / chunkSize)), 0, m_chunkRows - 1);
+
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, m_spritePaintSettings->getEffectiveScale() < 100);
+    for (int chunkY = chunkYMin; chunkY <= chunkYMax; ++chunkY) {
+        for (int chunkX = chunkXMin; chunkX <= chunkXMax; ++chunkX) {
+            Chunk&     chunk = m_chunks[chunkY * m_chunkCols + chunkX];
+            const bool stale = !chunk.m_valid
+                               || (chunk.m_animatedTerrain && chunk.m_frameTerrain != m_animationFrameOffsetTerrain)
+                               || (chunk.m_animatedObjects && chunk.m_frameObjects != m_animationFrameOffsetObjects);
+            if (stale)
+                renderChunk(chunk, chunkX, chunkY);
+            painter->drawPixmap(chunkRect(chunkX, chunkY).topLeft(), chunk.m_pixmap);
+        }
+    }
 }
 
 }
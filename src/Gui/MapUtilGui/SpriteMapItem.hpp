@@ -6,6 +6,9 @@
 #pragma once
 
 #include <QGraphicsItem>
+#include <QPixmap>
+
+#include <memory>
 
 namespace FreeHeroes {
 
@@ -26,11 +29,33 @@ public:
 
     void tick(uint32_t msecElapsed);
 
+    // drops cached chunks and repaints; call after paint settings change.
+    void invalidateCache();
+
     // QGraphicsItem interface
 public:
     QRectF boundingRect() const override;
     void   paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
 
+private:
+    // Map is painted by chunks of s_chunkTiles x s_chunkTiles tiles, each cached in a pixmap.
+    // Chunk is repainted only when invalidated or when it contains animated sprites and their frame changed;
+    // animation tick marks dirty only such chunks.
+    struct Chunk {
+        QPixmap  m_pixmap;
+        bool     m_valid           = false;
+        bool     m_animatedTerrain = false;
+        bool     m_animatedObjects = false;
+        uint32_t m_frameTerrain    = 0;
+        uint32_t m_frameObjects    = 0;
+        int      m_waitingSprites  = 0; // onReady() callbacks not fired yet
+    };
+    static constexpr int s_chunkTiles = 16;
+
+    QRectF chunkRect(int chunkX, int chunkY) const;
+    void   renderChunk(Chunk& chunk, int chunkX, int chunkY);
+    void   onSpriteReady(int chunkIndex);
+
 private:
     const SpriteMap* const           m_spriteMap;
     const SpritePaintSettings* const m_spritePaintSettings;
@@ -43,6 +68,17 @@ private:
     uint32_t m_animationFrameOffsetObjects = 0;
 
     std::unique_ptr<SpriteMapPainter> m_painter;
+
+    // sprite ready callbacks come from loader threads and reach the item only through GUI thread event,
+    // guard is reset in destructor so late events are ignored.
+    struct ReadyGuard {
+        SpriteMapItem* m_item = nullptr;
+    };
+    std::shared_ptr<ReadyGuard> m_readyGuard;
+
+    int                m_chunkCols = 0;
+    int                m_chunkRows = 0;
+    std::vector<Chunk> m_chunks;
 };
 
 }
@@ -10,7 +10,14 @@
 #include "MernelPlatform/Logger.hpp"
 #include "MernelPlatform/StringUtils.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <functional>
+#include <mutex>
+#include <thread>
 
 #ifndef DISABLE_QT
 #include "FsUtilsQt.hpp"
@@ -24,6 +31,86 @@
 namespace FreeHeroes::Gui {
 using namespace Core;
 
+namespace {
+
+size_t cacheShardHash(const std::string& key)
+{
+    return std::hash<std::string>{}(key);
+}
+size_t cacheShardHash(const IGraphicsLibrary::PixmapKey& key)
+{
+    return cacheShardHash(key.resourceName);
+}
+size_t cacheShardHash(const IGraphicsLibrary::PixmapKeyList& keys)
+{
+    return keys.empty() ? 0 : cacheShardHash(keys[0].resourceName);
+}
+
+}
+
+// Bounded pool of decoding threads. Higher priority tasks are taken first, same priority in FIFO order.
+// Pending tasks are dropped on destruction.
+class AsyncLoader {
+public:
+    explicit AsyncLoader(size_t threadCount)
+    {
+        for (size_t i = 0; i < threadCount; ++i)
+            m_threads.emplace_back([this] { threadFunc(); });
+    }
+    ~AsyncLoader()
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_stop = true;
+        }
+        m_cond.notify_all();
+        for (auto& thread : m_threads)
+            thread.join();
+    }
+
+    void enqueue(AsyncLoadPriority priority, std::function<void()> task)
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_queues[static_cast<size_t>(priority)].push_back(std::move(task));
+        }
+        m_cond.notify_one();
+    }
+
+private:
+    void threadFunc()
+    {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock lock(m_mutex);
+                m_cond.wait(lock, [this] {
+                    return m_stop || std::any_of(m_queues.cbegin(), m_queues.cend(), [](const auto& queue) { return !queue.empty(); });
+                });
+                if (m_stop)
+                    return;
+                for (auto& queue : m_queues) {
+                    if (queue.empty())
+                        continue;
+                    task = std::move(queue.front());
+                    queue.pop_front();
+                    break;
+                }
+            }
+            task();
+        }
+    }
+
+private:
+    std::mutex                                         m_mutex;
+    std::condition_variable                            m_cond;
+    std::array<std::deque<std::function<void()>>, 3> m_queues; // by AsyncLoadPriority
+    bool                                               m_stop = false;
+    std::vector<std::thread>                           m_threads;
+};
+
+// Thread-safe: records are looked up under lock of one of the shards, and every record is loaded once.
+// Records are never removed, so references to them stay valid.
 template<class Key, class Object>
 class CacheContainer {
 public:
@@ -31,20 +118,61 @@ public:
         Key             m_key;
         CacheContainer* m_container = nullptr;
         Object          m_object;
-        bool            m_exists     = false;
-        bool            m_loadCached = false;
-        bool            m_loadResult = false;
+        bool            m_exists = false;
+
+        std::once_flag    m_loadOnce;
+        std::atomic<bool> m_loadCached = false;
+        bool              m_loadResult = false;
+
+        std::atomic<int>                m_queuedPriority = s_notQueued;
+        std::mutex                      m_callbacksMutex;
+        std::vector<AsyncReadyCallback> m_callbacks;
 
         bool exists() { return m_exists; }
         bool isLoaded() { return m_loadCached && m_loadResult; }
+        bool isReady() { return m_loadCached; }
         bool preload()
         {
-            if (m_loadCached)
-                return m_loadResult;
-            m_loadResult = m_container->m_factory(m_key, m_object);
-            m_loadCached = true;
+            std::vector<AsyncReadyCallback> callbacks;
+            std::call_once(m_loadOnce, [this, &callbacks] {
+                m_loadResult = m_container->m_factory(m_key, m_object);
+
+                std::lock_guard lock(m_callbacksMutex);
+                m_loadCached = true;
+                callbacks.swap(m_callbacks);
+            });
+            // outside of call_once, so callback can use the record.
+            for (auto& callback : callbacks)
+                callback(m_loadResult);
             return m_loadResult;
         }
+        void preloadAsync(AsyncLoadPriority priority)
+        {
+            AsyncLoader* loader = m_container->m_loader;
+            if (!loader || m_loadCached)
+                return;
+
+            // queue again only with higher priority; the stale task will find the record loaded.
+            const int value  = static_cast<int>(priority);
+            int       queued = m_queuedPriority;
+            do {
+                if (queued <= value)
+                    return;
+            } while (!m_queuedPriority.compare_exchange_weak(queued, value));
+
+            loader->enqueue(priority, [this] { preload(); });
+        }
+        void onReady(AsyncReadyCallback callback)
+        {
+            {
+                std::lock_guard lock(m_callbacksMutex);
+                if (!m_loadCached) {
+                    m_callbacks.push_back(std::move(callback));
+                    return;
+                }
+            }
+            callback(m_loadResult);
+        }
         Object get()
         {
             preload();
@@ -54,21 +182,34 @@ public:
 
     AsyncRecord& makeAsyncRecord(const Key& key)
     {
-        auto it = m_records.find(key);
-        if (it != m_records.cend())
-            return it->second;
+        Shard&                      shard = m_shards[cacheShardHash(key) % s_shardCount];
+        std::lock_guard<std::mutex> lock(shard.m_mutex);
+
+        auto [it, inserted] = shard.m_records.try_emplace(key);
+        AsyncRecord& result = it->second;
+        if (!inserted)
+            return result;
 
-        AsyncRecord& result = m_records[key];
-        result.m_key        = key;
-        result.m_container  = this;
-        result.m_exists     = m_existCheck(key);
+        result.m_key       = key;
+        result.m_container = this;
+        result.m_exists    = m_existCheck(key);
 
         return result;
     }
 
     std::function<bool(const Key&)>          m_existCheck;
     std::function<bool(const Key&, Object&)> m_factory;
-    std::map<Key, AsyncRecord>               m_records;
+    AsyncLoader*                             m_loader = nullptr; // without loader preloadAsync() does nothing.
+
+private:
+    static constexpr size_t s_shardCount = 16;
+    static constexpr int    s_notQueued  = static_cast<int>(AsyncLoadPriority::Low) + 1;
+
+    struct Shard {
+        std::mutex                 m_mutex;
+        std::map<Key, AsyncRecord> m_records;
+    };
+    std::array<Shard, s_shardCount> m_shards;
 };
 
 using SpriteContainer = CacheContainer<std::string, SpritePtr>;
@@ -84,27 +225,44 @@ public:
     bool      exists() const override { return m_record.exists(); }
     bool      isLoaded() const override { return m_record.isLoaded(); }
     bool      preload() const override { return m_record.preload(); }
+    bool      isReady() const override { return m_record.isReady(); }
+    void      preloadAsync(AsyncLoadPriority priority) const override { m_record.preloadAsync(priority); }
     SpritePtr get() const override { return m_record.get(); }
+    void      onReady(AsyncReadyCallback callback) const override { m_record.onReady(std::move(callback)); }
 };
 #ifndef DISABLE_QT
 class GraphicsLibrary::AsyncPixmap : public IAsyncPixmap {
 public:
     PixmapContainer::AsyncRecord& m_record;
+    SpriteContainer::AsyncRecord& m_spriteRecord;
     AsyncPixmap(GraphicsLibrary::Impl* impl, const PixmapKey& resourceCode);
 
     bool    exists() const override { return m_record.exists(); }
     bool    isLoaded() const override { return m_record.isLoaded(); }
     bool    preload() const override { return m_record.preload(); }
+    bool    isReady() const override { return m_record.isReady() || m_spriteRecord.isReady(); }
+    void    preloadAsync(AsyncLoadPriority priority) const override { m_spriteRecord.preloadAsync(priority); }
     QPixmap get() const override { return m_record.get(); }
+    void    onReady(AsyncReadyCallback callback) const override { m_spriteRecord.onReady(std::move(callback)); }
 };
 class GraphicsLibrary::AsyncIcon : public IAsyncIcon {
 public:
-    IconContainer::AsyncRecord& m_record;
+    IconContainer::AsyncRecord&                m_record;
+    std::vector<SpriteContainer::AsyncRecord*> m_spriteRecords;
     AsyncIcon(GraphicsLibrary::Impl* impl, const PixmapKeyList& resourceCodes);
 
     bool  exists() const override { return m_record.exists(); }
     bool  isLoaded() const override { return m_record.isLoaded(); }
     bool  preload() const override { return m_record.preload(); }
+    bool  isReady() const override
+    {
+        return m_record.isReady() || std::all_of(m_spriteRecords.cbegin(), m_spriteRecords.cend(), [](auto* record) { return record->isReady(); });
+    }
+    void preloadAsync(AsyncLoadPriority priority) const override
+    {
+        for (auto* record : m_spriteRecords)
+            record->preloadAsync(priority);
+    }
     QIcon get() const override { return m_record.get(); }
 };
 
@@ -118,6 +276,8 @@ public:
     bool    exists() const override { return m_exists; }
     bool    isLoaded() const override { return true; }
     bool    preload() const override { return true; }
+    bool    isReady() const override { return true; }
+    void    preloadAsync(AsyncLoadPriority) const override {}
     QMovie* create(QObject* parent) const override;
 };
 #endif
@@ -130,6 +290,9 @@ struct GraphicsLibrary::Impl {
     CacheContainer<PixmapKey, QPixmap>   m_pixmapCache;
     CacheContainer<PixmapKeyList, QIcon> m_iconCache;
 #endif
+    // destroyed before caches, so running tasks never see a dead record. QPixmap must be created on GUI thread,
+    // so background tasks only decode sprites (Pixmap decodes through QImage or stb, never QPixmap).
+    AsyncLoader m_loader{ std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 4) };
 
     bool      createSprite(const std::string& resourceName, SpritePtr& result);
     bool      checkSprite(const std::string& resourceName);
@@ -152,6 +315,7 @@ struct GraphicsLibrary::Impl {
     {
         m_spriteCache.m_existCheck = [this](const std::string& resourceName) { return checkSprite(resourceName); };
         m_spriteCache.m_factory    = [this](const std::string& resourceName, SpritePtr& result) { return createSprite(resourceName, result); };
+        m_spriteCache.m_loader     = &m_loader;
 #ifndef DISABLE_QT
         m_pixmapCache.m_existCheck = [this](const PixmapKey& resourceCode) { return checkSprite(resourceCode.resourceName); };
         m_iconCache.m_existCheck   = [this](const PixmapKeyList& resourceCodes) {
@@ -212,6 +376,12 @@ IAsyncIconPtr GraphicsLibrary::getIcon(const PixmapKeyList& resourceCodes) const
 
 #endif
 
+void GraphicsLibrary::prefetch(const std::vector<std::string>& resourceNames, AsyncLoadPriority priority) const
+{
+    for (const auto& resourceName : resourceNames)
+        m_impl->m_spriteCache.makeAsyncRecord(resourceName).preloadAsync(priority);
+}
+
 IGraphicsLibrary::PixmapKey GraphicsLibrary::splitKeyFromString(const std::string& resourceName) const
 {
     auto        parts      = Mernel::splitLine(resourceName, ":");
@@ -236,10 +406,15 @@ bool GraphicsLibrary::Impl::createSprite(const std::string& resourceName, Sprite
         return false;
     }
 
-    const auto path       = m_resourceLibrary->get(ResourceType::Sprite, resourceName);
-    auto       spriteImpl = std::make_shared<Sprite>();
+    // packed sprites are decoded straight from the mapped pack.
+    const auto         path       = m_resourceLibrary->get(ResourceType::Sprite, resourceName);
+    const ResourceData jsonData   = m_resourceLibrary->getData(ResourceType::Sprite, resourceName);
+    const ResourceData pngData    = m_resourceLibrary->getData(ResourceType::Sprite, resourceName, ".png");
+    auto               spriteImpl = std::make_shared<Sprite>();
     try {
-        spriteImpl->load(path);
+        if (!jsonData.isValid() || !pngData.isValid())
+            throw std::runtime_error("failed to read sprite files");
+        spriteImpl->loadFromData(jsonData.m_data, pngData.m_data);
     }
     catch (std::exception& ex) {
         Mernel::Logger(Mernel::Logger::Err) << "Failed to load sprite:" << path << ", " << ex.what();
@@ -320,12 +495,17 @@ bool GraphicsLibrary::Impl::createIcon(const PixmapKeyList& resourceCodes, QIcon
 }
 GraphicsLibrary::AsyncPixmap::AsyncPixmap(Impl* impl, const PixmapKey& resourceCode)
     : m_record(impl->m_pixmapCache.makeAsyncRecord(resourceCode))
+    , m_spriteRecord(impl->m_spriteCache.makeAsyncRecord(resourceCode.resourceName))
 {
 }
 
 GraphicsLibrary::AsyncIcon::AsyncIcon(Impl* impl, const PixmapKeyList& resourceCodes)
     : m_record(impl->m_iconCache.makeAsyncRecord(resourceCodes))
 {
+    for (const auto& code : resourceCodes) {
+        if (!code.resourceName.empty())
+            m_spriteRecords.push_back(&impl->m_spriteCache.makeAsyncRecord(code.resourceName));
+    }
 }
 
 GraphicsLibrary::AsyncMovie::AsyncMovie(Impl* impl, const std::string& resourceName)
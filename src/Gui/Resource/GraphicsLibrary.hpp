@@ -24,6 +24,8 @@ public:
 
     PixmapKey splitKeyFromString(const std::string& resourceName) const override;
 
+    void prefetch(const std::vector<std::string>& resourceNames, AsyncLoadPriority priority) const override;
+
 private:
     class AsyncSprite;
     class AsyncPixmap;
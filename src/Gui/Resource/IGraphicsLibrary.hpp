@@ -43,6 +43,9 @@ public:
 
     virtual PixmapKey splitKeyFromString(const std::string& resourceName) const = 0;
 
+    // queue sprites decoding in background; already loaded and queued ones are skipped.
+    virtual void prefetch(const std::vector<std::string>& resourceNames, AsyncLoadPriority priority = AsyncLoadPriority::Low) const = 0;
+
     IAsyncPixmapPtr getPixmap(const std::string& resourceCode) const
     {
         auto key = splitKeyFromString(resourceCode);
@@ -7,6 +7,7 @@
 
 #include "ISprites.hpp"
 
+#include <functional>
 #include <memory>
 
 class QIcon;
@@ -16,24 +17,42 @@ class QPixmap;
 
 namespace FreeHeroes::Gui {
 
+// Background decoding order; visible resources should use High.
+enum class AsyncLoadPriority
+{
+    High,
+    Normal,
+    Low,
+};
+
 class IGuiAsyncResource {
 public:
     virtual ~IGuiAsyncResource() = default;
 
     virtual bool exists() const   = 0;
     virtual bool isLoaded() const = 0;
-    virtual bool preload() const  = 0;
+    virtual bool preload() const  = 0; // loads on the caller thread, or waits if it is already loading.
+
+    // isReady() never blocks: true when get() has nothing to decode.
+    virtual bool isReady() const                                                            = 0;
+    virtual void preloadAsync(AsyncLoadPriority priority = AsyncLoadPriority::Normal) const = 0;
 };
 
+// callback argument is preload() result; it is called on a loader thread, or immediately if the resource is ready.
+using AsyncReadyCallback = std::function<void(bool)>;
+
 class IAsyncSprite : public IGuiAsyncResource {
 public:
-    virtual SpritePtr get() const = 0;
+    virtual SpritePtr get() const                                = 0;
+    virtual void      onReady(AsyncReadyCallback callback) const = 0;
 };
 using IAsyncSpritePtr = std::shared_ptr<const IAsyncSprite>;
 
+// QPixmap is created on get() caller thread; background work is the sprite decoding.
 class IAsyncPixmap : public IGuiAsyncResource {
 public:
-    virtual QPixmap get() const = 0;
+    virtual QPixmap get() const                                = 0;
+    virtual void    onReady(AsyncReadyCallback callback) const = 0;
 };
 using IAsyncPixmapPtr = std::shared_ptr<const IAsyncPixmap>;
 
@@ -14,7 +14,7 @@ namespace FreeHeroes::Gui {
 class ISprite {
 public:
     struct SpriteFrame {
-        Pixmap      m_frame;
+        PixmapView  m_frame; // points into sequence atlas.
         PixmapPoint m_paddingLeftTop;
     };
 
@@ -33,10 +33,11 @@ public:
     };
 
     struct SpriteSequence {
-        std::vector<SpriteFrame> m_frames;
-        PixmapSize               m_boundarySize;
-        SpriteSequenceParams     m_params;
-        SpriteSequenceMask       m_mask;
+        std::shared_ptr<const Pixmap> m_atlas; // keeps frame views valid.
+        std::vector<SpriteFrame>      m_frames;
+        PixmapSize                    m_boundarySize;
+        SpriteSequenceParams          m_params;
+        SpriteSequenceMask            m_mask;
     };
 
     using SpriteSequencePtr = std::shared_ptr<const SpriteSequence>;
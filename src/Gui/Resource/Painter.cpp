@@ -8,10 +8,21 @@
 
 #include "MernelPlatform/Profiler.hpp"
 
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FH_PAINTER_SSE2 1
+#include <emmintrin.h>
+#endif
+
 namespace FreeHeroes {
 
 namespace {
 
+using Pixel = Pixmap::Pixel;
+static_assert(sizeof(Pixel) == 4);
+
 void blend(PixmapColor& dest, const PixmapColor& src)
 {
     uint16_t alpha        = src.m_a;
@@ -23,55 +34,241 @@ void blend(PixmapColor& dest, const PixmapColor& src)
     dest.m_a = 255;
 }
 
+void drawPixel(const Pixel& src, Pixel& dest)
+{
+    if (src.m_color.m_a == 255 || dest.m_color.m_a == 0)
+        dest = src;
+    else if (src.m_color.m_a != 0)
+        blend(dest.m_color, src.m_color);
+}
+
+#ifdef FH_PAINTER_SSE2
+__m128i load4(const Pixel* pixels)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
 }
 
-void Painter::drawPixmap(const PixmapPoint& offset, const Pixmap& pixmap, bool flipHor, bool flipVert)
+void store4(Pixel* pixels, __m128i value)
 {
-    //Mernel::ProfilerScope scope("drawPixmap");
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), value);
+}
+
+template<bool reverse>
+__m128i order4(__m128i value)
+{
+    if constexpr (reverse)
+        return _mm_shuffle_epi32(value, _MM_SHUFFLE(0, 1, 2, 3));
+    return value;
+}
+
+// same math as blend() for 4 pixels: 16-bit lanes never overflow, as inverseAlpha * dest + alpha * src <= 255 * 255.
+__m128i blend4(__m128i src, __m128i dest)
+{
+    const __m128i zero      = _mm_setzero_si128();
+    const __m128i max16     = _mm_set1_epi16(255);
+    const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000U));
+
+    const __m128i srcLo   = _mm_unpacklo_epi8(src, zero);
+    const __m128i srcHi   = _mm_unpackhi_epi8(src, zero);
+    const __m128i destLo  = _mm_unpacklo_epi8(dest, zero);
+    const __m128i destHi  = _mm_unpackhi_epi8(dest, zero);
+    const __m128i alphaLo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(srcLo, 0xFF), 0xFF);
+    const __m128i alphaHi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(srcHi, 0xFF), 0xFF);
+
+    const __m128i resultLo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(max16, alphaLo), destLo), _mm_mullo_epi16(alphaLo, srcLo)), 8);
+    const __m128i resultHi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(max16, alphaHi), destHi), _mm_mullo_epi16(alphaHi, srcHi)), 8);
+    return _mm_or_si128(_mm_packus_epi16(resultLo, resultHi), alphaMask);
+}
+
+// drawPixel() for 4 pixels.
+__m128i draw4(__m128i src, __m128i dest)
+{
+    const __m128i zero      = _mm_setzero_si128();
+    const __m128i srcAlpha  = _mm_srli_epi32(src, 24);
+    const __m128i destAlpha = _mm_srli_epi32(dest, 24);
+    const __m128i copyMask  = _mm_or_si128(_mm_cmpeq_epi32(srcAlpha, _mm_set1_epi32(255)), _mm_cmpeq_epi32(destAlpha, zero));
+    if (_mm_movemask_epi8(copyMask) == 0xFFFF)
+        return src;
+
+    const __m128i keepMask  = _mm_andnot_si128(copyMask, _mm_cmpeq_epi32(srcAlpha, zero));
+    const __m128i blendMask = _mm_andnot_si128(_mm_or_si128(copyMask, keepMask), _mm_set1_epi32(-1));
+    const __m128i blended   = _mm_movemask_epi8(blendMask) ? blend4(src, dest) : zero;
+    return _mm_or_si128(_mm_and_si128(copyMask, src), _mm_or_si128(_mm_and_si128(keepMask, dest), _mm_and_si128(blendMask, blended)));
+}
+#endif
+
+// Span functions: src[i] goes to dest[i], or to dest[-i] when reverse (horizontal flip).
+
+template<bool reverse>
+void drawSpan(const Pixel* src, Pixel* dest, int count)
+{
+    int i = 0;
+#ifdef FH_PAINTER_SSE2
+    for (; i + 4 <= count; i += 4) {
+        Pixel* destBlock = reverse ? dest - i - 3 : dest + i;
+        store4(destBlock, draw4(order4<reverse>(load4(src + i)), load4(destBlock)));
+    }
+#endif
+    for (; i < count; ++i)
+        drawPixel(src[i], reverse ? dest[-i] : dest[i]);
+}
+
+// all src pixels are opaque.
+template<bool reverse>
+void copySpan(const Pixel* src, Pixel* dest, int count)
+{
+    if constexpr (!reverse) {
+        std::memcpy(dest, src, count * sizeof(Pixel));
+    } else {
+        int i = 0;
+#ifdef FH_PAINTER_SSE2
+        for (; i + 4 <= count; i += 4)
+            store4(dest - i - 3, order4<true>(load4(src + i)));
+#endif
+        for (; i < count; ++i)
+            dest[-i] = src[i];
+    }
+}
+
+// all src pixels are fully transparent: only fully transparent dest pixels are changed.
+template<bool reverse>
+void drawTransparentSpan(const Pixel* src, Pixel* dest, int count)
+{
+    int i = 0;
+#ifdef FH_PAINTER_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4) {
+        Pixel*        destBlock = reverse ? dest - i - 3 : dest + i;
+        const __m128i destValue = load4(destBlock);
+        const __m128i copyMask  = _mm_cmpeq_epi32(_mm_srli_epi32(destValue, 24), zero);
+        const int     copyBits  = _mm_movemask_epi8(copyMask);
+        if (!copyBits)
+            continue;
+        const __m128i srcValue = order4<reverse>(load4(src + i));
+        store4(destBlock, _mm_or_si128(_mm_and_si128(copyMask, srcValue), _mm_andnot_si128(copyMask, destValue)));
+    }
+#endif
+    for (; i < count; ++i) {
+        Pixel& destPixel = reverse ? dest[-i] : dest[i];
+        if (destPixel.m_color.m_a == 0)
+            destPixel = src[i];
+    }
+}
+
+// draws source row y columns [x0, x1) to destRow, source column x goes to destRow[baseX + x] (or [baseX - x] when reverse).
+template<bool reverse>
+void drawRow(const PixmapView& pixmap, int y, int x0, int x1, Pixel* destRow, int baseX)
+{
+    const Pixel* src      = pixmap.row(y);
+    auto         destForX = [destRow, baseX](int x) { return destRow + (reverse ? baseX - x : baseX + x); };
+    if (!pixmap.hasOpacityRuns()) {
+        drawSpan<reverse>(src + x0, destForX(x0), x1 - x0);
+        return;
+    }
 
-    int h = pixmap.m_size.m_height;
-    int w = pixmap.m_size.m_width;
-    for (int y = 0; y < h; ++y) {
-        for (int x = 0; x < w; ++x) {
-            const int xWithOffset  = x + offset.m_x;
-            const int yWithOffset  = y + offset.m_y;
-            const int xTransformed = flipHor ? -xWithOffset - 1 : xWithOffset;
-            const int yTransformed = flipVert ? -yWithOffset - 1 : yWithOffset;
-            const int destX        = xTransformed + m_offset.m_x;
-            const int destY        = yTransformed + m_offset.m_y;
-            if (!m_canvas.inBounds(destX, destY))
-                continue;
-
-            auto& srcColor  = pixmap.get(x, y);
-            auto& destColor = m_canvas.get(destX, destY);
-            if (srcColor.m_color.m_a == 255 || destColor.m_color.m_a == 0)
-                destColor = srcColor;
-            else if (srcColor.m_color.m_a == 0)
-                continue;
-            else
-                blend(destColor.m_color, srcColor.m_color);
+    // runs are in source coordinates; an atlas row holds several frames, so skip runs ending before the view.
+    const Pixmap&             source    = *pixmap.m_runsSource;
+    const int                 originX   = pixmap.m_sourceOffset.m_x;
+    const int                 sourceY   = pixmap.m_sourceOffset.m_y + y;
+    const Pixmap::OpacityRun* runsBegin = source.m_opacityRuns.data() + source.m_opacityRowOffsets[sourceY];
+    const Pixmap::OpacityRun* runsEnd   = source.m_opacityRuns.data() + source.m_opacityRowOffsets[sourceY + 1];
+    const Pixmap::OpacityRun* firstRun  = std::upper_bound(runsBegin, runsEnd, originX + x0, [](int x, const Pixmap::OpacityRun& run) {
+        return x < run.m_start + run.m_length;
+    });
+    for (const Pixmap::OpacityRun* run = firstRun; run != runsEnd && run->m_start < originX + x1; ++run) {
+        const int start = std::max(run->m_start - originX, x0);
+        const int end   = std::min(run->m_start + run->m_length - originX, x1);
+        if (start >= end)
+            continue;
+
+        const Pixel* srcSpan  = src + start;
+        Pixel*       destSpan = destForX(start);
+        switch (run->m_type) {
+            case Pixmap::OpacityRun::Type::Opaque:
+                copySpan<reverse>(srcSpan, destSpan, end - start);
+                break;
+            case Pixmap::OpacityRun::Type::Transparent:
+                drawTransparentSpan<reverse>(srcSpan, destSpan, end - start);
+                break;
+            case Pixmap::OpacityRun::Type::Mixed:
+                drawSpan<reverse>(srcSpan, destSpan, end - start);
+                break;
         }
     }
 }
 
+void blendFillSpan(const PixmapColor& color, Pixel* dest, int count)
+{
+    int i = 0;
+#ifdef FH_PAINTER_SSE2
+    uint32_t colorValue;
+    std::memcpy(&colorValue, &color, sizeof(colorValue));
+    const __m128i src = _mm_set1_epi32(static_cast<int>(colorValue));
+    for (; i + 4 <= count; i += 4)
+        store4(dest + i, blend4(src, load4(dest + i)));
+#endif
+    for (; i < count; ++i)
+        blend(dest[i].m_color, color);
+}
+
+// source coordinates range [from, to) that lands into [0, destSize) when dest = base + dir * source.
+void clipSpan(int base, int dir, int sourceSize, int destSize, int& from, int& to)
+{
+    from = dir > 0 ? -base : base - destSize + 1;
+    to   = dir > 0 ? destSize - base : base + 1;
+    from = std::max(from, 0);
+    to   = std::min(to, sourceSize);
+}
+
+}
+
+void Painter::drawPixmap(const PixmapPoint& offset, const PixmapView& pixmap, bool flipHor, bool flipVert)
+{
+    //Mernel::ProfilerScope scope("drawPixmap");
+
+    // flip mirrors source around painter origin: pixel (x, y) goes to (baseX + dirX * x, baseY + dirY * y).
+    const int dirX  = flipHor ? -1 : 1;
+    const int dirY  = flipVert ? -1 : 1;
+    const int baseX = m_offset.m_x + (flipHor ? -offset.m_x - 1 : offset.m_x);
+    const int baseY = m_offset.m_y + (flipVert ? -offset.m_y - 1 : offset.m_y);
+
+    int x0, x1, y0, y1;
+    clipSpan(baseX, dirX, pixmap.width(), m_canvas.width(), x0, x1);
+    clipSpan(baseY, dirY, pixmap.height(), m_canvas.height(), y0, y1);
+    if (pixmap.isNull() || x0 >= x1 || y0 >= y1)
+        return;
+
+    for (int y = y0; y < y1; ++y) {
+        Pixel* destRow = m_canvas.m_pixels.data() + (baseY + dirY * y) * m_canvas.width();
+        if (flipHor)
+            drawRow<true>(pixmap, y, x0, x1, destRow, baseX);
+        else
+            drawRow<false>(pixmap, y, x0, x1, destRow, baseX);
+    }
+    m_canvas.resetOpacityRuns();
+}
+
 void Painter::drawRect(const PixmapPoint& topLeft, const PixmapSize& size, const PixmapColor& color)
 {
     if (color.m_a == 0)
         return;
-    int h = size.m_height;
-    int w = size.m_width;
-    for (int y = 0; y < h; ++y) {
-        for (int x = 0; x < w; ++x) {
-            const int destX = x + topLeft.m_x + m_offset.m_x;
-            const int destY = y + topLeft.m_y + m_offset.m_y;
-            if (!m_canvas.inBounds(destX, destY))
-                continue;
-            auto& destColor = m_canvas.get(destX, destY);
-            if (color.m_a == 255)
-                destColor.m_color = color;
-            else
-                blend(destColor.m_color, color);
-        }
+
+    const int baseX = topLeft.m_x + m_offset.m_x;
+    const int baseY = topLeft.m_y + m_offset.m_y;
+
+    int x0, x1, y0, y1;
+    clipSpan(baseX, 1, size.m_width, m_canvas.width(), x0, x1);
+    clipSpan(baseY, 1, size.m_height, m_canvas.height(), y0, y1);
+    if (x0 >= x1 || y0 >= y1)
+        return;
+
+    for (int y = y0; y < y1; ++y) {
+        Pixel* dest = m_canvas.m_pixels.data() + (baseY + y) * m_canvas.width() + baseX + x0;
+        if (color.m_a == 255)
+            std::fill(dest, dest + (x1 - x0), Pixel{ color });
+        else
+            blendFillSpan(color, dest, x1 - x0);
     }
+    m_canvas.resetOpacityRuns();
 }
 }
@@ -18,7 +18,11 @@ public:
     {
     }
 
-    void drawPixmap(const PixmapPoint& offset, const Pixmap& pixmap, bool flipHor = false, bool flipVert = false);
+    void drawPixmap(const PixmapPoint& offset, const Pixmap& pixmap, bool flipHor = false, bool flipVert = false)
+    {
+        drawPixmap(offset, pixmap.view(), flipHor, flipVert);
+    }
+    void drawPixmap(const PixmapPoint& offset, const PixmapView& pixmap, bool flipHor = false, bool flipVert = false);
     void drawRect(const PixmapPoint& topLeft, const PixmapSize& size, const PixmapColor& color);
 
     void translate(int x, int y)
@@ -37,6 +37,7 @@
 
 #ifndef DISABLE_QT
 #include <QPixmap>
+#include <QImage>
 #include <QBuffer>
 #endif
 
@@ -80,26 +81,31 @@ void Pixmap::savePng(const Mernel::std_path& path) const
 }
 
 void Pixmap::loadPngFromBuffer(const Mernel::ByteArrayHolder& holder)
+{
+    loadPngFromData({ holder.data(), holder.size() });
+}
+
+void Pixmap::loadPngFromData(std::span<const uint8_t> data)
 {
 #ifndef DISABLE_QT
     {
-        QPixmap pix;
-        if (pix.loadFromData(holder.data(), holder.size())) {
-            fromQtPixmap(pix);
+        QImage img; // sprites are decoded on loader threads, so no QPixmap here.
+        if (img.loadFromData(data.data(), static_cast<int>(data.size()))) {
+            fromQtImage(img);
             return;
         }
     }
 #endif
 
     int      w, h, channelsInFile;
-    stbi_uc* data = stbi_load_from_memory(holder.data(), (int) holder.size(), &w, &h, &channelsInFile, 4);
-    if (!data)
+    stbi_uc* decoded = stbi_load_from_memory(data.data(), (int) data.size(), &w, &h, &channelsInFile, 4);
+    if (!decoded)
         throw std::runtime_error("Failed to decode png");
     m_size = { w, h };
     updateSize();
     for (int y = 0; y < h; ++y) {
         for (int x = 0; x < w; ++x) {
-            auto* src = data + y * w * 4 + x * 4;
+            auto* src = decoded + y * w * 4 + x * 4;
             auto& clr = get(x, y).m_color;
             clr.m_r   = src[0];
             clr.m_g   = src[1];
@@ -107,6 +113,7 @@ void Pixmap::loadPngFromBuffer(const Mernel::ByteArrayHolder& holder)
             clr.m_a   = src[3];
         }
     }
+    stbi_image_free(decoded);
 }
 
 void Pixmap::savePngToBuffer(Mernel::ByteArrayHolder& holder) const
@@ -115,8 +122,8 @@ void Pixmap::savePngToBuffer(Mernel::ByteArrayHolder& holder) const
     {
         QByteArray buffer;
         QBuffer    buf(&buffer);
-        QPixmap    pix = toQtPixmap();
-        if (pix.save(&buf)) {
+        QImage     img = toQtImage();
+        if (img.save(&buf, "PNG")) {
             holder.resize(buffer.size());
             memcpy(holder.data(), buffer.data(), buffer.size());
             return;
@@ -140,15 +147,7 @@ void Pixmap::loadBmp(const Mernel::std_path& path)
 
 Pixmap Pixmap::subframe(const PixmapPoint& offset, const PixmapSize& size) const
 {
-    Pixmap result(size);
-    int    h = size.m_height;
-    int    w = size.m_width;
-    for (int y = 0; y < h; ++y) {
-        for (int x = 0; x < w; ++x) {
-            result.get(x, y) = get(x + offset.m_x, y + offset.m_y);
-        }
-    }
-    return result;
+    return view(offset, size).toPixmap();
 }
 
 Pixmap Pixmap::padToSize(const PixmapSize& size, const PixmapPoint& leftTop) const
@@ -156,12 +155,70 @@ Pixmap Pixmap::padToSize(const PixmapSize& size, const PixmapPoint& leftTop) con
     if (size == m_size)
         return *this;
 
+    return view().padToSize(size, leftTop);
+}
+
+Pixmap PixmapView::toPixmap() const
+{
+    Pixmap result(m_size);
+    if (isNull())
+        return result;
+
+    for (int y = 0; y < m_size.m_height; ++y)
+        std::memcpy(&result.get(0, y), row(y), m_size.m_width * sizeof(Pixel));
+    return result;
+}
+
+Pixmap PixmapView::padToSize(const PixmapSize& size, const PixmapPoint& leftTop) const
+{
+    if (size == m_size)
+        return toPixmap();
+
     Pixmap  result(size);
     Painter p{ &result };
     p.drawPixmap(leftTop, *this);
     return result;
 }
 
+void Pixmap::updateOpacityRuns()
+{
+    // short uniform spans are merged into neighbour Mixed ones, as switching kernels costs more than blending them.
+    constexpr const int s_minUniformRun = 8;
+
+    resetOpacityRuns();
+    m_opacityRowOffsets.reserve(m_size.m_height + 1);
+    const int w = m_size.m_width;
+    for (int y = 0; y < m_size.m_height; ++y) {
+        m_opacityRowOffsets.push_back(static_cast<int>(m_opacityRuns.size()));
+        const size_t rowStart = m_opacityRuns.size();
+
+        auto addRun = [this, rowStart](OpacityRun run) {
+            if (run.m_type != OpacityRun::Type::Mixed && run.m_length < s_minUniformRun)
+                run.m_type = OpacityRun::Type::Mixed;
+            if (m_opacityRuns.size() > rowStart && m_opacityRuns.back().m_type == run.m_type)
+                m_opacityRuns.back().m_length += run.m_length;
+            else
+                m_opacityRuns.push_back(run);
+        };
+
+        const Pixel* row = m_pixels.data() + y * w;
+        OpacityRun   run;
+        for (int x = 0; x < w; ++x) {
+            const uint8_t          alpha = row[x].m_color.m_a;
+            const OpacityRun::Type type  = alpha == 0 ? OpacityRun::Type::Transparent : (alpha == 255 ? OpacityRun::Type::Opaque : OpacityRun::Type::Mixed);
+            if (run.m_length && run.m_type != type) {
+                addRun(run);
+                run = OpacityRun{ .m_start = x };
+            }
+            run.m_type = type;
+            run.m_length++;
+        }
+        if (run.m_length)
+            addRun(run);
+    }
+    m_opacityRowOffsets.push_back(static_cast<int>(m_opacityRuns.size()));
+}
+
 void Pixmap::flipVertical()
 {
     Pixmap result(m_size);
@@ -173,6 +230,7 @@ void Pixmap::flipVertical()
         }
     }
     m_pixels = std::move(result.m_pixels);
+    resetOpacityRuns();
 }
 
 std::string PixmapColor::toString() const noexcept
@@ -232,33 +290,51 @@ QSize PixmapSize::toQSize() const noexcept
 }
 QPixmap Pixmap::toQtPixmap() const
 {
+    return view().toQtPixmap();
+}
+
+QImage Pixmap::toQtImage() const
+{
+    return view().toQtImage();
+}
+
+QPixmap PixmapView::toQtPixmap() const
+{
+    if (isNull())
+        return QPixmap();
+
+    return QPixmap::fromImage(toQtImage());
+}
+
+QImage PixmapView::toQtImage() const
+{
+    if (isNull())
+        return QImage();
+
     int    h = m_size.m_height;
     int    w = m_size.m_width;
     QImage result(w, h, QImage::Format_RGBA8888);
     for (int y = 0; y < h; ++y) {
         uchar* line = result.scanLine(y);
-        memcpy(line, m_pixels.data() + y * w, w * 4);
+        memcpy(line, row(y), w * 4);
     }
-    return QPixmap::fromImage(std::move(result));
+    return result;
 }
 
 void Pixmap::fromQtPixmap(const QPixmap& pixmap)
 {
-    int h  = pixmap.height();
-    int w  = pixmap.width();
-    m_size = { w, h };
+    fromQtImage(pixmap.toImage());
+}
+
+void Pixmap::fromQtImage(const QImage& image)
+{
+    const QImage img = image.convertToFormat(QImage::Format_RGBA8888);
+    int          h   = img.height();
+    int          w   = img.width();
+    m_size           = { w, h };
     updateSize();
-    QImage img = pixmap.toImage();
-    for (int y = 0; y < h; ++y) {
-        for (int x = 0; x < w; ++x) {
-            auto&      colorDest = get(x, y).m_color;
-            const auto colorSrc  = img.pixelColor(x, y);
-            colorDest.m_r        = colorSrc.red();
-            colorDest.m_g        = colorSrc.green();
-            colorDest.m_b        = colorSrc.blue();
-            colorDest.m_a        = colorSrc.alpha();
-        }
-    }
+    for (int y = 0; y < h; ++y)
+        memcpy(&get(0, y), img.constScanLine(y), w * 4);
 }
 #endif
 
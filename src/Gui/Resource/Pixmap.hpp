@@ -8,6 +8,7 @@
 #include <vector>
 #include <memory>
 #include <algorithm>
+#include <span>
 
 #include "MernelPlatform/FsUtils.hpp"
 #include "MernelPlatform/ByteBuffer.hpp"
@@ -15,12 +16,15 @@
 #include "GuiResourceExport.hpp"
 
 class QPixmap;
+class QImage;
 class QSize;
 class QPoint;
 class QColor;
 
 namespace FreeHeroes {
 
+struct PixmapView;
+
 struct GUIRESOURCE_EXPORT PixmapPoint {
     int m_x = 0;
     int m_y = 0;
@@ -106,16 +110,36 @@ struct GUIRESOURCE_EXPORT Pixmap {
     {
         for (auto& pix : m_pixels)
             pix.m_color = color;
+        resetOpacityRuns();
     }
 
     struct Pixel {
         PixmapColor m_color;
     };
 
+    // Span of row pixels that are all fully transparent, all fully opaque, or anything else (Mixed).
+    struct OpacityRun {
+        enum class Type : uint8_t
+        {
+            Mixed,
+            Transparent,
+            Opaque,
+        };
+        int  m_start  = 0;
+        int  m_length = 0;
+        Type m_type   = Type::Mixed;
+    };
+
     PixmapSize m_size;
 
     std::vector<Pixel> m_pixels;
 
+    // Row opacity runs, Painter uses them to copy opaque spans without blending.
+    // Not tracked automatically: build them with updateOpacityRuns() once pixels are final (e.g. sprite frames),
+    // and call resetOpacityRuns() after changing pixels directly.
+    std::vector<OpacityRun> m_opacityRuns;
+    std::vector<int>        m_opacityRowOffsets; // runs of row y are [m_opacityRowOffsets[y], m_opacityRowOffsets[y + 1]).
+
     Pixel& get(int x, int y)
     {
         const int yOffset = m_size.m_width * y;
@@ -155,22 +179,89 @@ struct GUIRESOURCE_EXPORT Pixmap {
     void updateSize()
     {
         m_pixels.resize(totalPixelSize());
+        resetOpacityRuns();
+    }
+
+    bool hasOpacityRuns() const { return m_opacityRowOffsets.size() == static_cast<size_t>(m_size.m_height) + 1; }
+    void updateOpacityRuns();
+    void resetOpacityRuns()
+    {
+        m_opacityRuns.clear();
+        m_opacityRowOffsets.clear();
     }
 
     void loadPng(const Mernel::std_path& path);
     void savePng(const Mernel::std_path& path) const;
 
     void loadPngFromBuffer(const Mernel::ByteArrayHolder& holder);
+    void loadPngFromData(std::span<const uint8_t> data);
     void savePngToBuffer(Mernel::ByteArrayHolder& holder) const;
 
     void loadBmp(const Mernel::std_path& path);
 
+    PixmapView view() const;
+    PixmapView view(const PixmapPoint& offset, const PixmapSize& size) const;
+
     Pixmap subframe(const PixmapPoint& offset, const PixmapSize& size) const;
     Pixmap padToSize(const PixmapSize& size, const PixmapPoint& leftTop) const;
     void   flipVertical();
 
+    // QImage variants are safe to use off the GUI thread, QPixmap ones are not.
     QPixmap toQtPixmap() const;
+    QImage  toQtImage() const;
     void    fromQtPixmap(const QPixmap& pixmap);
+    void    fromQtImage(const QImage& image);
 };
 
+// Non-owning read-only view to a Pixmap or its rectangle (e.g. a sprite frame in the atlas); source must outlive the view.
+// Use toPixmap() when an own copy is needed for changing pixels.
+struct GUIRESOURCE_EXPORT PixmapView {
+    using Pixel      = Pixmap::Pixel;
+    using OpacityRun = Pixmap::OpacityRun;
+
+    const Pixel* m_pixels = nullptr; // left-top pixel.
+    int          m_stride = 0;       // distance between rows, in pixels.
+    PixmapSize   m_size;
+
+    // Source with opacity runs, or nullptr if it has none. Runs are in source coordinates:
+    // view pixel (x, y) is source pixel (x + m_sourceOffset.m_x, y + m_sourceOffset.m_y).
+    const Pixmap* m_runsSource = nullptr;
+    PixmapPoint   m_sourceOffset;
+
+    bool isNull() const { return !m_pixels || m_size.m_width <= 0 || m_size.m_height <= 0; }
+
+    int width() const { return m_size.m_width; }
+    int height() const { return m_size.m_height; }
+
+    const Pixel* row(int y) const { return m_pixels + static_cast<ptrdiff_t>(m_stride) * y; }
+    const Pixel& get(int x, int y) const { return row(y)[x]; }
+
+    bool hasOpacityRuns() const { return m_runsSource != nullptr; }
+
+    Pixmap toPixmap() const;
+    Pixmap padToSize(const PixmapSize& size, const PixmapPoint& leftTop) const;
+
+    QPixmap toQtPixmap() const;
+    QImage  toQtImage() const;
+};
+
+inline PixmapView Pixmap::view() const
+{
+    return view(PixmapPoint{}, m_size);
+}
+
+inline PixmapView Pixmap::view(const PixmapPoint& offset, const PixmapSize& size) const
+{
+    if (isNull() || size.m_width <= 0 || size.m_height <= 0)
+        return PixmapView{};
+
+    return PixmapView{
+        .m_pixels       = m_pixels.data() + static_cast<ptrdiff_t>(m_size.m_width) * offset.m_y + offset.m_x,
+        .m_stride       = m_size.m_width,
+        .m_size         = size,
+        .m_runsSource   = hasOpacityRuns() ? this : nullptr,
+        .m_sourceOffset = offset,
+    };
+}
+
 }
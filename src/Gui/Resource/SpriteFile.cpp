@@ -395,6 +395,7 @@ void replaceColors(Pixmap& pix, const PixmapColor& src, const PixmapColor& dest)
         if (p.m_color == src)
             p.m_color = dest;
     }
+    pix.resetOpacityRuns();
 }
 
 struct AnimationPaletteShift {
@@ -1320,7 +1321,7 @@ void SpriteFile::saveGuiSprite(const Mernel::std_path& jsonFilePath, const Merne
     }
 
     Gui::Sprite uiSprite;
-    uiSprite.m_bitmap       = *m_bitmaps[0].m_pixmap.get();
+    *uiSprite.m_bitmap      = *m_bitmaps[0].m_pixmap.get();
     uiSprite.m_boundarySize = { m_boundaryWidth + boundaryPadWidth, m_boundaryHeight + boundaryPadHeight };
     std::vector<const Frame*> headerOrderFrames;
     for (const Group& group : m_groups) {
@@ -1356,7 +1357,7 @@ void SpriteFile::saveGuiSprite(const Mernel::std_path& jsonFilePath, const Merne
     if (handlers.isMap()) {
         for (const auto& [key, routineParam] : handlers.getMap()) {
             if (key == "flip_vertical") {
-                uiSprite.m_bitmap.flipVertical();
+                uiSprite.m_bitmap->flipVertical();
             } else if (key == "fix_colors") {
                 const std::map<std::string, PixmapColor> names{
                     { "tr", PixmapColor(0, 0, 0, 0) },
@@ -1369,9 +1370,9 @@ void SpriteFile::saveGuiSprite(const Mernel::std_path& jsonFilePath, const Merne
                         continue;
                     PixmapColor src(routineParam[name].getScalar().toString());
 
-                    replaceColors(uiSprite.m_bitmap, src, destColor);
+                    replaceColors(*uiSprite.m_bitmap, src, destColor);
                 }
-                *m_bitmaps[0].m_pixmap.get() = uiSprite.m_bitmap;
+                *m_bitmaps[0].m_pixmap.get() = *uiSprite.m_bitmap;
             }
         }
     }
@@ -30,16 +30,28 @@ std_path makePngPath(const std_path& jsonFilePath)
 void Sprite::load(const std_path& jsonFilePath)
 {
     Mernel::ProfilerScope scope1("Sprite::load");
+    std::string           jsonBuffer;
+    ByteArrayHolder       pngHolder;
+    {
+        Mernel::ProfilerScope scope2("read json file");
+        jsonBuffer = Mernel::readFileIntoBuffer(jsonFilePath);
+    }
+    {
+        Mernel::ProfilerScope scope2("read image file");
+        auto                  pngPath = makePngPath(jsonFilePath);
+        pngHolder                     = Mernel::readFileIntoHolder(pngPath);
+    }
+    loadFromData({ reinterpret_cast<const uint8_t*>(jsonBuffer.data()), jsonBuffer.size() }, { pngHolder.data(), pngHolder.size() });
+}
+
+void Sprite::loadFromData(std::span<const uint8_t> jsonData, std::span<const uint8_t> pngData)
+{
+    Mernel::ProfilerScope scope1("Sprite::loadFromData");
     {
-        std::string          buffer;
         Mernel::PropertyTree data;
-        {
-            Mernel::ProfilerScope scope2("read json file");
-            buffer = Mernel::readFileIntoBuffer(jsonFilePath);
-        }
         {
             Mernel::ProfilerScope scope2("parse json");
-            data = Mernel::readJsonFromBuffer(buffer);
+            data = Mernel::readJsonFromBuffer(std::string(reinterpret_cast<const char*>(jsonData.data()), jsonData.size()));
         }
 
         {
@@ -49,16 +61,12 @@ void Sprite::load(const std_path& jsonFilePath)
         }
     }
     {
-        ByteArrayHolder holder;
-        {
-            Mernel::ProfilerScope scope2("read image file");
-            auto                  pngPath = makePngPath(jsonFilePath);
-            holder                        = Mernel::readFileIntoHolder(pngPath);
-        }
-        {
-            Mernel::ProfilerScope scope2("load pixmap");
-            m_bitmap.loadPngFromBuffer(holder);
-        }
+        Mernel::ProfilerScope scope2("load pixmap");
+        m_bitmap->loadPngFromData(pngData);
+    }
+    {
+        Mernel::ProfilerScope scope2("opacity runs");
+        m_bitmap->updateOpacityRuns();
     }
 }
 
@@ -73,7 +81,7 @@ void Sprite::save(const std_path& jsonFilePath) const
     Mernel::std_fs::create_directories(jsonFilePath.parent_path());
     auto                    pngPath = makePngPath(jsonFilePath);
     Mernel::ByteArrayHolder holder;
-    m_bitmap.savePngToBuffer(holder);
+    m_bitmap->savePngToBuffer(holder);
     Mernel::writeFileFromHolder(pngPath, holder);
     if (!Mernel::std_fs::exists(pngPath)) {
         Mernel::std_fs::remove(jsonFilePath);
@@ -94,11 +102,16 @@ ISprite::SpriteSequencePtr Sprite::getFramesForGroup(int groupId) const
 {
     if (!m_groups.contains(groupId))
         return nullptr;
-    const Group& group = m_groups.at(groupId);
+    const Group&                group = m_groups.at(groupId);
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
     if (group.m_cache)
         return group.m_cache;
     auto seq = std::make_shared<SpriteSequence>();
 
+    if (!m_bitmap->hasOpacityRuns())
+        m_bitmap->updateOpacityRuns();
+
+    seq->m_atlas  = m_bitmap;
     seq->m_params = group.m_params;
 
     seq->m_boundarySize = m_boundarySize;
@@ -110,8 +123,7 @@ ISprite::SpriteSequencePtr Sprite::getFramesForGroup(int groupId) const
             continue;
         }
 
-        auto framePix = m_bitmap.subframe(frame.m_bitmapOffset, frame.m_bitmapSize);
-        seq->m_frames.push_back(SpriteFrame{ .m_frame = std::move(framePix), .m_paddingLeftTop = frame.m_padding });
+        seq->m_frames.push_back(SpriteFrame{ .m_frame = m_bitmap->view(frame.m_bitmapOffset, frame.m_bitmapSize), .m_paddingLeftTop = frame.m_padding });
     }
     group.m_cache = seq;
     return seq;
@@ -11,11 +11,13 @@
 #include "MernelPlatform/FsUtils.hpp"
 
 #include <map>
+#include <mutex>
+#include <span>
 
 namespace FreeHeroes::Gui {
 
 struct GUIRESOURCE_EXPORT Sprite : public ISprite {
-    Pixmap m_bitmap;
+    std::shared_ptr<Pixmap> m_bitmap = std::make_shared<Pixmap>(); // atlas of all frames, shared with frame sequences.
 
     struct FrameImpl {
         PixmapPoint m_padding;
@@ -41,7 +43,10 @@ struct GUIRESOURCE_EXPORT Sprite : public ISprite {
 
     std::map<int, Group> m_groups;
 
+    mutable std::mutex m_cacheMutex; // guards Group::m_cache, so frames can be requested from several threads.
+
     void load(const Mernel::std_path& jsonFilePath);
+    void loadFromData(std::span<const uint8_t> jsonData, std::span<const uint8_t> pngData);
     void save(const Mernel::std_path& jsonFilePath) const;
 
     int               getGroupsCount() const override { return static_cast<int>(m_groups.size()); }
@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+
+#include "Archive.hpp"
+
+#include "MernelPlatform/FileIOUtils.hpp"
+#include "MernelPlatform/StringUtils.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <map>
+#include <sstream>
+
+using namespace FreeHeroes;
+using namespace Mernel;
+
+namespace {
+
+ByteArrayHolder toHolder(const std::string& data)
+{
+    ByteArrayHolder holder;
+    holder.resize(data.size());
+    if (!data.empty())
+        std::memcpy(holder.data(), data.data(), data.size());
+    return holder;
+}
+
+std::string toString(const ByteArrayHolder& data)
+{
+    return std::string(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+std::string makePayload(size_t size, int seed)
+{
+    // repeated text compresses well, counter bytes keep it from being trivial.
+    std::string result;
+    result.reserve(size);
+    for (size_t i = 0; result.size() < size; ++i)
+        result += "record " + std::to_string(seed) + ":" + std::to_string(i % 97) + ";";
+    result.resize(size);
+    return result;
+}
+
+Archive::Record makeRecord(const std::string& basename, const std::string& ext, const std::string& payload, bool compress, size_t order)
+{
+    Archive::Record rec;
+    rec.m_originalBasename          = basename;
+    rec.m_basename                  = strToLower(basename);
+    rec.m_originalExtWithDot        = ext;
+    rec.m_extWithDot                = strToLower(ext);
+    rec.m_compressInArchive         = compress;
+    rec.m_binaryOrder               = order;
+    rec.m_bufferWithFile.m_buffer   = toHolder(payload);
+    rec.m_bufferWithFile.m_inMemory = true;
+    return rec;
+}
+
+std::string writeArchive(const Archive& archive)
+{
+    ByteArrayHolder           binary;
+    ByteOrderBuffer           bobuffer(binary);
+    ByteOrderDataStreamWriter writer(bobuffer, ByteOrderDataStream::s_littleEndian);
+    archive.writeBinary(writer);
+    return toString(binary);
+}
+
+std::map<std::string, std::string> readFolder(const std_path& folder)
+{
+    std::map<std::string, std::string> result;
+    for (const auto& it : std_fs::directory_iterator(folder))
+        result[path2string(it.path().filename())] = readFileIntoBuffer(it.path());
+    return result;
+}
+
+class ArchiveTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        m_root = std_fs::temp_directory_path() / "FreeHeroesTests" / "Archive";
+        std_fs::remove_all(m_root);
+        std_fs::create_directories(m_root);
+        m_lodPath = m_root / "synthetic.lod";
+
+        Archive archive(&m_log);
+        archive.m_format    = Archive::BinaryFormat::LOD;
+        archive.m_lodFormat = 200;
+        archive.m_lodHeader.resize(80);
+        archive.m_lodHeader[5] = 0x42;
+
+        // data order differs from directory order, and there is a gap between records.
+        archive.m_records.push_back(makeRecord("Pikeman", ".DEF", makePayload(20000, 1), true, 1));
+        archive.m_records.push_back(makeRecord("AdvMap", ".txt", makePayload(300, 2), false, 0));
+        archive.m_records.push_back(makeRecord("Archer", ".def", makePayload(50000, 3), true, 4));
+        archive.m_records.push_back(makeRecord("NoExt", "", makePayload(10, 4), false, 3));
+        Archive::Record padding = makeRecord("__PAD_0", "", std::string(7, '\xAB'), false, 2);
+        padding.m_isPadding     = true;
+        archive.m_records.push_back(std::move(padding));
+
+        archive.convertToBinary();
+        m_lod = writeArchive(archive);
+        ASSERT_TRUE(writeFileFromBufferNoexcept(m_lodPath, m_lod));
+    }
+    void TearDown() override
+    {
+        std_fs::remove_all(m_root);
+    }
+
+    // readBinary + convertFromBinary + saveToFolder, everything in memory.
+    void extractReference(const std_path& folder, bool uncompress)
+    {
+        ByteArrayHolder           binary = toHolder(m_lod);
+        ByteOrderBuffer           bobuffer(binary);
+        ByteOrderDataStreamReader reader(bobuffer, ByteOrderDataStream::s_littleEndian);
+
+        Archive archive(&m_log);
+        archive.detectFormat(m_lodPath, reader);
+        reader.getBuffer().setOffsetRead(0);
+        archive.readBinary(reader);
+        archive.convertFromBinary(uncompress);
+        archive.saveToFolder(folder, false);
+    }
+
+    std::ostringstream m_log;
+    std_path           m_root;
+    std_path           m_lodPath;
+    std::string        m_lod;
+};
+
+}
+
+TEST_F(ArchiveTest, ExtractSameAsInMemory)
+{
+    for (const bool uncompress : { true, false }) {
+        const std_path reference = m_root / ("reference" + std::to_string(uncompress));
+        const std_path extracted = m_root / ("extracted" + std::to_string(uncompress));
+        extractReference(reference, uncompress);
+
+        Archive archive(&m_log);
+        // tiny budget, so records wait for each other.
+        archive.extractToFolder(m_lodPath, extracted, { .m_uncompress = uncompress, .m_jobs = 4, .m_memoryBudget = 1000 });
+
+        const auto expected = readFolder(reference);
+        const auto actual   = readFolder(extracted);
+        ASSERT_EQ(expected.size(), 6U); // 5 records and index.
+        EXPECT_EQ(expected, actual);
+        EXPECT_EQ(expected.contains("pikeman.def.gz"), !uncompress);
+        if (uncompress) {
+            EXPECT_EQ(actual.at("archer.def"), makePayload(50000, 3));
+        }
+        EXPECT_EQ(actual.at("__PAD_0"), std::string(7, '\xAB'));
+    }
+}
+
+TEST_F(ArchiveTest, RoundTrip)
+{
+    for (const bool uncompress : { true, false }) {
+        const std_path extracted = m_root / ("extracted" + std::to_string(uncompress));
+        {
+            Archive archive(&m_log);
+            archive.extractToFolder(m_lodPath, extracted, { .m_uncompress = uncompress, .m_jobs = 2 });
+
+            // records are loaded lazily from extracted files.
+            archive.convertToBinary();
+            EXPECT_EQ(writeArchive(archive), m_lod);
+        }
+
+        Archive archive(&m_log);
+        archive.loadFromFolder(extracted);
+        archive.convertToBinary();
+        EXPECT_EQ(writeArchive(archive), m_lod);
+    }
+}
+
+TEST_F(ArchiveTest, Truncated)
+{
+    ASSERT_TRUE(writeFileFromBufferNoexcept(m_lodPath, m_lod.substr(0, m_lod.size() - 1)));
+
+    Archive archive(&m_log);
+    EXPECT_THROW(archive.extractToFolder(m_lodPath, m_root / "extracted", {}), std::runtime_error);
+}
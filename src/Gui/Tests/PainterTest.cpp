@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2024 Smirnov Vladimir / mapron1@gmail.com
+ * SPDX-License-Identifier: MIT
+ * See LICENSE file for details.
+ */
+#include "Painter.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+using namespace FreeHeroes;
+
+namespace {
+
+void referenceBlend(PixmapColor& dest, const PixmapColor& src)
+{
+    uint16_t alpha        = src.m_a;
+    uint16_t inverseAlpha = uint16_t(255) - alpha;
+
+    dest.m_r = static_cast<uint8_t>((inverseAlpha * dest.m_r + alpha * src.m_r) / 256);
+    dest.m_g = static_cast<uint8_t>((inverseAlpha * dest.m_g + alpha * src.m_g) / 256);
+    dest.m_b = static_cast<uint8_t>((inverseAlpha * dest.m_b + alpha * src.m_b) / 256);
+    dest.m_a = 255;
+}
+
+// Previous per-pixel Painter implementation.
+void referenceDrawPixmap(Pixmap& canvas, const PixmapPoint& transform, const PixmapPoint& offset, const Pixmap& pixmap, bool flipHor, bool flipVert)
+{
+    for (int y = 0; y < pixmap.height(); ++y) {
+        for (int x = 0; x < pixmap.width(); ++x) {
+            const int xWithOffset = x + offset.m_x;
+            const int yWithOffset = y + offset.m_y;
+            const int destX       = (flipHor ? -xWithOffset - 1 : xWithOffset) + transform.m_x;
+            const int destY       = (flipVert ? -yWithOffset - 1 : yWithOffset) + transform.m_y;
+            if (!canvas.inBounds(destX, destY))
+                continue;
+
+            auto& srcColor  = pixmap.get(x, y);
+            auto& destColor = canvas.get(destX, destY);
+            if (srcColor.m_color.m_a == 255 || destColor.m_color.m_a == 0)
+                destColor = srcColor;
+            else if (srcColor.m_color.m_a != 0)
+                referenceBlend(destColor.m_color, srcColor.m_color);
+        }
+    }
+}
+
+void referenceDrawRect(Pixmap& canvas, const PixmapPoint& transform, const PixmapPoint& topLeft, const PixmapSize& size, const PixmapColor& color)
+{
+    if (color.m_a == 0)
+        return;
+    for (int y = 0; y < size.m_height; ++y) {
+        for (int x = 0; x < size.m_width; ++x) {
+            const int destX = x + topLeft.m_x + transform.m_x;
+            const int destY = y + topLeft.m_y + transform.m_y;
+            if (!canvas.inBounds(destX, destY))
+                continue;
+            auto& destColor = canvas.get(destX, destY);
+            if (color.m_a == 255)
+                destColor.m_color = color;
+            else
+                referenceBlend(destColor.m_color, color);
+        }
+    }
+}
+
+// mostly transparent/opaque pixels with long uniform spans, like sprite frames.
+Pixmap makeRandomPixmap(std::mt19937& rng, int width, int height)
+{
+    auto   gen = [&rng](int max) { return std::uniform_int_distribution<int>(0, max)(rng); };
+    Pixmap result(width, height);
+    for (auto& pixel : result.m_pixels) {
+        const int     kind  = gen(9);
+        const uint8_t alpha = kind < 4 ? 0 : (kind < 7 ? 255 : gen(255));
+        pixel.m_color       = PixmapColor(gen(255), gen(255), gen(255), alpha);
+    }
+    for (int y = 0; y < height; ++y) {
+        const int     start  = gen(width);
+        const int     length = gen(width - start);
+        const uint8_t alpha  = gen(1) ? 0 : 255;
+        for (int x = start; x < start + length; ++x)
+            result.get(x, y).m_color.m_a = alpha;
+    }
+    return result;
+}
+
+void expectSamePixels(const Pixmap& expected, const Pixmap& actual)
+{
+    ASSERT_EQ(expected.m_size, actual.m_size);
+    for (int y = 0; y < expected.height(); ++y) {
+        for (int x = 0; x < expected.width(); ++x) {
+            ASSERT_EQ(expected.get(x, y).m_color, actual.get(x, y).m_color) << "at " << x << ", " << y;
+        }
+    }
+}
+
+}
+
+GTEST_TEST(Painter, ClipEdges)
+{
+    Pixmap source(3, 2);
+    for (int y = 0; y < 2; ++y)
+        for (int x = 0; x < 3; ++x)
+            source.get(x, y).m_color = PixmapColor(x * 10, y * 10, 0, 255);
+
+    Pixmap  canvas(4, 4);
+    Painter painter(&canvas);
+    painter.drawPixmap({ -1, 3 }, source);
+    EXPECT_EQ(canvas.get(0, 3).m_color, PixmapColor(10, 0, 0, 255));
+    EXPECT_EQ(canvas.get(1, 3).m_color, PixmapColor(20, 0, 0, 255));
+    EXPECT_EQ(canvas.get(2, 3).m_color, PixmapColor());
+    EXPECT_EQ(canvas.get(0, 2).m_color, PixmapColor());
+
+    // flips mirror around painter origin.
+    canvas.fill(PixmapColor());
+    painter.setTransform({ 4, 4 });
+    painter.drawPixmap({ 0, 0 }, source, true, true);
+    EXPECT_EQ(canvas.get(3, 3).m_color, PixmapColor(0, 0, 0, 255));
+    EXPECT_EQ(canvas.get(1, 3).m_color, PixmapColor(20, 0, 0, 255));
+    EXPECT_EQ(canvas.get(3, 2).m_color, PixmapColor(0, 10, 0, 255));
+    EXPECT_EQ(canvas.get(0, 3).m_color, PixmapColor());
+
+    // completely outside.
+    const Pixmap before = canvas;
+    painter.setTransform({});
+    painter.drawPixmap({ 4, 0 }, source);
+    painter.drawPixmap({ 0, -2 }, source);
+    painter.drawPixmap({ 0, 0 }, source, true, false);
+    painter.drawRect({ -5, 0 }, { 5, 4 }, PixmapColor(1, 2, 3));
+    expectSamePixels(before, canvas);
+}
+
+GTEST_TEST(Painter, SameAsPerPixel)
+{
+    std::mt19937 rng(42);
+    auto         gen = [&rng](int min, int max) { return std::uniform_int_distribution<int>(min, max)(rng); };
+    for (int i = 0; i < 3000; ++i) {
+        Pixmap canvas   = makeRandomPixmap(rng, gen(1, 40), gen(1, 40));
+        Pixmap expected = canvas;
+        Pixmap source   = makeRandomPixmap(rng, gen(0, 40), gen(0, 40));
+        if (i % 2)
+            source.updateOpacityRuns();
+
+        const PixmapPoint transform{ gen(-50, 50), gen(-50, 50) };
+        const PixmapPoint offset{ gen(-50, 50), gen(-50, 50) };
+        const bool        flipHor  = gen(0, 1);
+        const bool        flipVert = gen(0, 1);
+        const PixmapSize  rectSize{ gen(0, 40), gen(0, 40) };
+        const PixmapColor rectColor(gen(0, 255), gen(0, 255), gen(0, 255), gen(0, 2) ? gen(0, 255) : 255);
+
+        Painter painter(&canvas);
+        painter.setTransform(transform);
+        painter.drawPixmap(offset, source, flipHor, flipVert);
+        painter.drawRect(offset, rectSize, rectColor);
+
+        referenceDrawPixmap(expected, transform, offset, source, flipHor, flipVert);
+        referenceDrawRect(expected, transform, offset, rectSize, rectColor);
+
+        ASSERT_NO_FATAL_FAILURE(expectSamePixels(expected, canvas)) << "iteration " << i;
+    }
+}
+
+GTEST_TEST(Painter, OpacityRuns)
+{
+    Pixmap pixmap(20, 2);
+    for (int x = 0; x < 20; ++x) {
+        pixmap.get(x, 0).m_color.m_a = x < 10 ? 0 : 255;
+        pixmap.get(x, 1).m_color.m_a = x % 2 ? 128 : 255;
+    }
+    pixmap.updateOpacityRuns();
+    ASSERT_TRUE(pixmap.hasOpacityRuns());
+    ASSERT_EQ(pixmap.m_opacityRowOffsets, (std::vector<int>{ 0, 2, 3 }));
+    EXPECT_EQ(pixmap.m_opacityRuns[0].m_type, Pixmap::OpacityRun::Type::Transparent);
+    EXPECT_EQ(pixmap.m_opacityRuns[0].m_length, 10);
+    EXPECT_EQ(pixmap.m_opacityRuns[1].m_type, Pixmap::OpacityRun::Type::Opaque);
+    EXPECT_EQ(pixmap.m_opacityRuns[1].m_start, 10);
+    EXPECT_EQ(pixmap.m_opacityRuns[2].m_type, Pixmap::OpacityRun::Type::Mixed);
+    EXPECT_EQ(pixmap.m_opacityRuns[2].m_length, 20);
+
+    pixmap.fill(PixmapColor());
+    EXPECT_FALSE(pixmap.hasOpacityRuns());
+}
+
+GTEST_TEST(Painter, AtlasView)
+{
+    std::mt19937 rng(7);
+    auto         gen = [&rng](int min, int max) { return std::uniform_int_distribution<int>(min, max)(rng); };
+    for (int i = 0; i < 1000; ++i) {
+        Pixmap atlas = makeRandomPixmap(rng, gen(1, 60), gen(1, 40));
+        if (i % 2)
+            atlas.updateOpacityRuns();
+
+        const PixmapPoint frameOffset{ gen(0, atlas.width() - 1), gen(0, atlas.height() - 1) };
+        const PixmapSize  frameSize{ gen(1, atlas.width() - frameOffset.m_x), gen(1, atlas.height() - frameOffset.m_y) };
+        const PixmapView  view  = atlas.view(frameOffset, frameSize);
+        const Pixmap      frame = atlas.subframe(frameOffset, frameSize);
+        ASSERT_EQ(view.hasOpacityRuns(), atlas.hasOpacityRuns());
+        ASSERT_NO_FATAL_FAILURE(expectSamePixels(frame, view.toPixmap()));
+
+        Pixmap canvas   = makeRandomPixmap(rng, gen(1, 40), gen(1, 40));
+        Pixmap expected = canvas;
+
+        const PixmapPoint transform{ gen(-30, 30), gen(-30, 30) };
+        const PixmapPoint offset{ gen(-30, 30), gen(-30, 30) };
+        const bool        flipHor  = gen(0, 1);
+        const bool        flipVert = gen(0, 1);
+
+        Painter painter(&canvas);
+        painter.setTransform(transform);
+        painter.drawPixmap(offset, view, flipHor, flipVert);
+
+        referenceDrawPixmap(expected, transform, offset, frame, flipHor, flipVert);
+
+        ASSERT_NO_FATAL_FAILURE(expectSamePixels(expected, canvas)) << "iteration " << i;
+    }
+}